@@ -9028,6 +9028,20 @@ typedef struct
 #define REGCOPY(dest, src)  *((uint32_t *)&(dest)) = *((uint32_t *)&(src))
 #define CLEAR(dest)         *((uint32_t *)&(dest)) = 0
 
+/**
+  * @brief Place a function in SRAM to run without flash wait states
+  * @details GCC places it in the .ramfunc section that gcc_arm.ld copies to SRAM with .data.
+  *          ARM Compiler needs an execution region in SRAM listing .ramfunc in the scatter file,
+  *          otherwise the function stays in flash. IAR uses its own __ramfunc keyword.
+  */
+#if defined ( __ICCARM__ )
+#define __RAMFUNC           __ramfunc
+#elif defined ( __CC_ARM ) || defined ( __ARMCC_VERSION )
+#define __RAMFUNC           __attribute__((section(".ramfunc"), noinline))
+#else
+#define __RAMFUNC           __attribute__((section(".ramfunc"), noinline, long_call))
+#endif
+
 
 typedef volatile unsigned char  vu8;        ///< Define 8-bit unsigned volatile data type
 typedef volatile unsigned short vu16;       ///< Define 16-bit unsigned volatile data type
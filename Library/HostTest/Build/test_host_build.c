@@ -0,0 +1,53 @@
+/**************************************************************************//**
+ * @file     test_host_build.c
+ * @version  V3.00
+ * @brief    Check the register model the host variant of StdDriver runs on
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include "NUC1311.h"
+#include "host_reg.h"
+
+int main(void)
+{
+    uint32_t u32Freq;
+
+    HostReg_Reset();
+
+    /* Registers live at their device addresses */
+    HOST_CHECK((uintptr_t)&PA->PMD == 0x50004000UL);
+    HOST_CHECK((uintptr_t)&CLK->APBCLK == 0x50000208UL);
+    HOST_CHECK((uintptr_t)&TIMER2->TCSR == 0x40110000UL);
+    HOST_CHECK((uintptr_t)&CAN1->IF[1].CREQ == 0x40184080UL);
+
+    /* Drivers read and write them as on the chip */
+    GPIO_SetMode(PB, BIT3 | BIT5, GPIO_PMD_OUTPUT);
+    HOST_CHECK(PB->PMD == ((GPIO_PMD_OUTPUT << 6) | (GPIO_PMD_OUTPUT << 10)));
+
+    CLK_EnableModuleClock(TMR0_MODULE);
+    CLK_EnableModuleClock(UART1_MODULE);
+    HOST_CHECK(CLK->APBCLK == (CLK_APBCLK_TMR0_EN_Msk | CLK_APBCLK_UART1_EN_Msk));
+
+    /* TIMER0 clocked by the 12 MHz HXT after reset */
+    u32Freq = TIMER_Open(TIMER0, TIMER_PERIODIC_MODE, 1000);
+    HOST_CHECK(u32Freq == 1000);
+    HOST_CHECK(TIMER0->TCMPR == 12000);
+    HOST_CHECK((TIMER0->TCSR & TIMER_TCSR_MODE_Msk) == TIMER_PERIODIC_MODE);
+
+    /* Core state */
+    NVIC_EnableIRQ(TMR0_IRQn);
+    HOST_CHECK(NVIC->ISER[0] == (1UL << TMR0_IRQn));
+    __set_PRIMASK(1);
+    HOST_CHECK(__get_PRIMASK() == 1);
+
+    HostReg_Reset();
+    HOST_CHECK((PB->PMD == 0) && (CLK->APBCLK == 0) && (NVIC->ISER[0] == 0) && (__get_PRIMASK() == 0));
+
+    printf("test_host_build: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,252 @@
+/**************************************************************************//**
+ * @file     NUC1311.h
+ * @version  V3.00
+ * @brief    CAN register model for the CAN tests
+ *
+ * @note     The message interface registers move data to and from a message RAM of 32 objects when CREQ
+ *           is written, and stay busy for a few reads of CREQ as the controller does. host_can.cpp has the
+ *           model, the bus that sends the pending objects and receives frames into the accepting objects, and
+ *           the CAN driver built against it.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUC1311_H__
+#define __NUC1311_H__
+
+#include "host_model.h"
+
+typedef struct
+{
+    HOST_REG_T CREQ;
+    HOST_REG_T CMASK;
+    HOST_REG_T MASK1;
+    HOST_REG_T MASK2;
+    HOST_REG_T ARB1;
+    HOST_REG_T ARB2;
+    HOST_REG_T MCON;
+    HOST_REG_T DAT_A1;
+    HOST_REG_T DAT_A2;
+    HOST_REG_T DAT_B1;
+    HOST_REG_T DAT_B2;
+} CAN_IF_T;
+
+typedef struct
+{
+    HOST_REG_T CON;
+    HOST_REG_T STATUS;
+    HOST_REG_T ERR;
+    HOST_REG_T BTIME;
+    HOST_REG_T IIDR;
+    HOST_REG_T TEST;
+    HOST_REG_T BRPE;
+    CAN_IF_T IF[2];
+    HOST_REG_T TXREQ1;
+    HOST_REG_T TXREQ2;
+    HOST_REG_T NDAT1;
+    HOST_REG_T NDAT2;
+    HOST_REG_T IPND1;
+    HOST_REG_T IPND2;
+    HOST_REG_T MVLD1;
+    HOST_REG_T MVLD2;
+} CAN_T;
+
+typedef struct TIMER_T TIMER_T;
+
+#define TRUE                        (1UL)
+#define FALSE                       (0UL)
+
+/* Bit fields of NUC1311.h, unsigned long is 32 bits on the device */
+#define CAN_CON_TEST_Pos              7
+#define CAN_CON_TEST_Msk              (1u << CAN_CON_TEST_Pos)
+#define CAN_CON_CCE_Pos               6
+#define CAN_CON_CCE_Msk               (1u << CAN_CON_CCE_Pos)
+#define CAN_CON_DAR_Pos               5
+#define CAN_CON_DAR_Msk               (1u << CAN_CON_DAR_Pos)
+#define CAN_CON_EIE_Pos               3
+#define CAN_CON_EIE_Msk               (1u << CAN_CON_EIE_Pos)
+#define CAN_CON_SIE_Pos               2
+#define CAN_CON_SIE_Msk               (1u << CAN_CON_SIE_Pos)
+#define CAN_CON_IE_Pos                1
+#define CAN_CON_IE_Msk                (1u << CAN_CON_IE_Pos)
+#define CAN_CON_INIT_Pos              0
+#define CAN_CON_INIT_Msk              (1u << CAN_CON_INIT_Pos)
+#define CAN_STATUS_BOFF_Pos           7
+#define CAN_STATUS_BOFF_Msk           (1u << CAN_STATUS_BOFF_Pos)
+#define CAN_STATUS_EWARN_Pos          6
+#define CAN_STATUS_EWARN_Msk          (1u << CAN_STATUS_EWARN_Pos)
+#define CAN_STATUS_EPASS_Pos          5
+#define CAN_STATUS_EPASS_Msk          (1u << CAN_STATUS_EPASS_Pos)
+#define CAN_STATUS_RXOK_Pos           4
+#define CAN_STATUS_RXOK_Msk           (1u << CAN_STATUS_RXOK_Pos)
+#define CAN_STATUS_TXOK_Pos           3
+#define CAN_STATUS_TXOK_Msk           (1u << CAN_STATUS_TXOK_Pos)
+#define CAN_STATUS_LEC_Pos            0
+#define CAN_STATUS_LEC_Msk            (0x3u << CAN_STATUS_LEC_Pos)
+#define CAN_ERR_RP_Pos                15
+#define CAN_ERR_RP_Msk                (1u << CAN_ERR_RP_Pos)
+#define CAN_ERR_REC_Pos               8
+#define CAN_ERR_REC_Msk               (0x7Fu << CAN_ERR_REC_Pos)
+#define CAN_ERR_TEC_Pos               0
+#define CAN_ERR_TEC_Msk               (0xFFu << CAN_ERR_TEC_Pos)
+#define CAN_BTIME_TSEG2_Pos           12
+#define CAN_BTIME_TSEG2_Msk           (0x7u << CAN_BTIME_TSEG2_Pos)
+#define CAN_BTIME_TSEG1_Pos           8
+#define CAN_BTIME_TSEG1_Msk           (0xFu << CAN_BTIME_TSEG1_Pos)
+#define CAN_BTIME_SJW_Pos             6
+#define CAN_BTIME_SJW_Msk             (0x3u << CAN_BTIME_SJW_Pos)
+#define CAN_BTIME_BRP_Pos             0
+#define CAN_BTIME_BRP_Msk             (0x3Fu << CAN_BTIME_BRP_Pos)
+#define CAN_IIDR_INTID_Pos            0
+#define CAN_IIDR_INTID_Msk            (0xFFFFu << CAN_IIDR_INTID_Pos)
+#define CAN_TEST_RX_Pos               7
+#define CAN_TEST_RX_Msk               (1u << CAN_TEST_RX_Pos)
+#define CAN_TEST_TX_Pos               5
+#define CAN_TEST_TX_Msk               (0x3u << CAN_TEST_TX_Pos)
+#define CAN_TEST_LBACK_Pos            4
+#define CAN_TEST_LBACK_Msk            (1u << CAN_TEST_LBACK_Pos)
+#define CAN_TEST_SILENT_Pos           3
+#define CAN_TEST_SILENT_Msk           (1u << CAN_TEST_SILENT_Pos)
+#define CAN_TEST_BASIC_Pos            2
+#define CAN_TEST_BASIC_Msk            (1u << CAN_TEST_BASIC_Pos)
+#define CAN_BRPE_BRPE_Pos             0
+#define CAN_BRPE_BRPE_Msk             (0xFu << CAN_BRPE_BRPE_Pos)
+#define CAN_IF_CREQ_BUSY_Pos          15
+#define CAN_IF_CREQ_BUSY_Msk          (1u << CAN_IF_CREQ_BUSY_Pos)
+#define CAN_IF_CREQ_MSGNUM_Pos        0
+#define CAN_IF_CREQ_MSGNUM_Msk        (0x3Fu << CAN_IF_CREQ_MSGNUM_Pos)
+#define CAN_IF_CMASK_WRRD_Pos         7
+#define CAN_IF_CMASK_WRRD_Msk         (1u << CAN_IF_CMASK_WRRD_Pos)
+#define CAN_IF_CMASK_MASK_Pos         6
+#define CAN_IF_CMASK_MASK_Msk         (1u << CAN_IF_CMASK_MASK_Pos)
+#define CAN_IF_CMASK_ARB_Pos          5
+#define CAN_IF_CMASK_ARB_Msk          (1u << CAN_IF_CMASK_ARB_Pos)
+#define CAN_IF_CMASK_CONTROL_Pos      4
+#define CAN_IF_CMASK_CONTROL_Msk      (1u << CAN_IF_CMASK_CONTROL_Pos)
+#define CAN_IF_CMASK_CLRINTPND_Pos    3
+#define CAN_IF_CMASK_CLRINTPND_Msk    (1u << CAN_IF_CMASK_CLRINTPND_Pos)
+#define CAN_IF_CMASK_TXRQSTNEWDAT_Pos 2
+#define CAN_IF_CMASK_TXRQSTNEWDAT_Msk (1u << CAN_IF_CMASK_TXRQSTNEWDAT_Pos)
+#define CAN_IF_CMASK_DATAA_Pos        1
+#define CAN_IF_CMASK_DATAA_Msk        (1u << CAN_IF_CMASK_DATAA_Pos)
+#define CAN_IF_CMASK_DATAB_Pos        0
+#define CAN_IF_CMASK_DATAB_Msk        (1u << CAN_IF_CMASK_DATAB_Pos)
+#define CAN_IF_MASK1_MSK_Pos          0
+#define CAN_IF_MASK1_MSK_Msk          (0xFFu << CAN_IF_MASK1_MSK_Pos)
+#define CAN_IF_MASK2_MXTD_Pos         15
+#define CAN_IF_MASK2_MXTD_Msk         (1u << CAN_IF_MASK2_MXTD_Pos)
+#define CAN_IF_MASK2_MDIR_Pos         14
+#define CAN_IF_MASK2_MDIR_Msk         (1u << CAN_IF_MASK2_MDIR_Pos)
+#define CAN_IF_MASK2_MSK_Pos          0
+#define CAN_IF_MASK2_MSK_Msk          (0x1FFu << CAN_IF_MASK2_MSK_Pos)
+#define CAN_IF_ARB1_ID_Pos            0
+#define CAN_IF_ARB1_ID_Msk            (0xFFFFu << CAN_IF_ARB1_ID_Pos)
+#define CAN_IF_ARB2_MSGVAL_Pos        15
+#define CAN_IF_ARB2_MSGVAL_Msk        (1u << CAN_IF_ARB2_MSGVAL_Pos)
+#define CAN_IF_ARB2_XTD_Pos           14
+#define CAN_IF_ARB2_XTD_Msk           (1u << CAN_IF_ARB2_XTD_Pos)
+#define CAN_IF_ARB2_DIR_Pos           13
+#define CAN_IF_ARB2_DIR_Msk           (1u << CAN_IF_ARB2_DIR_Pos)
+#define CAN_IF_ARB2_ID_Pos            0
+#define CAN_IF_ARB2_ID_Msk            (0x1FFFu << CAN_IF_ARB2_ID_Pos)
+#define CAN_IF_MCON_NEWDAT_Pos        15
+#define CAN_IF_MCON_NEWDAT_Msk        (1u << CAN_IF_MCON_NEWDAT_Pos)
+#define CAN_IF_MCON_MSGLST_Pos        14
+#define CAN_IF_MCON_MSGLST_Msk        (1u << CAN_IF_MCON_MSGLST_Pos)
+#define CAN_IF_MCON_INTPND_Pos        13
+#define CAN_IF_MCON_INTPND_Msk        (1u << CAN_IF_MCON_INTPND_Pos)
+#define CAN_IF_MCON_UMASK_Pos         12
+#define CAN_IF_MCON_UMASK_Msk         (1u << CAN_IF_MCON_UMASK_Pos)
+#define CAN_IF_MCON_TXIE_Pos          11
+#define CAN_IF_MCON_TXIE_Msk          (1u << CAN_IF_MCON_TXIE_Pos)
+#define CAN_IF_MCON_RXIE_Pos          10
+#define CAN_IF_MCON_RXIE_Msk          (1u << CAN_IF_MCON_RXIE_Pos)
+#define CAN_IF_MCON_RMTEN_Pos         9
+#define CAN_IF_MCON_RMTEN_Msk         (1u << CAN_IF_MCON_RMTEN_Pos)
+#define CAN_IF_MCON_TXRQST_Pos        8
+#define CAN_IF_MCON_TXRQST_Msk        (1u << CAN_IF_MCON_TXRQST_Pos)
+#define CAN_IF_MCON_EOB_Pos           7
+#define CAN_IF_MCON_EOB_Msk           (1u << CAN_IF_MCON_EOB_Pos)
+#define CAN_IF_MCON_DLC_Pos           0
+#define CAN_IF_MCON_DLC_Msk           (0xFu << CAN_IF_MCON_DLC_Pos)
+#define CAN_IF_DAT_A1_DATA1_Pos       8
+#define CAN_IF_DAT_A1_DATA1_Msk       (0xFFu << CAN_IF_DAT_A1_DATA1_Pos)
+#define CAN_IF_DAT_A1_DATA0_Pos       0
+#define CAN_IF_DAT_A1_DATA0_Msk       (0xFFu << CAN_IF_DAT_A1_DATA0_Pos)
+#define CAN_IF_DAT_A2_DATA3_Pos       8
+#define CAN_IF_DAT_A2_DATA3_Msk       (0xFFu << CAN_IF_DAT_A2_DATA3_Pos)
+#define CAN_IF_DAT_A2_DATA2_Pos       0
+#define CAN_IF_DAT_A2_DATA2_Msk       (0xFFu << CAN_IF_DAT_A2_DATA2_Pos)
+#define CAN_IF_DAT_B1_DATA5_Pos       8
+#define CAN_IF_DAT_B1_DATA5_Msk       (0xFFu << CAN_IF_DAT_B1_DATA5_Pos)
+#define CAN_IF_DAT_B1_DATA4_Pos       0
+#define CAN_IF_DAT_B1_DATA4_Msk       (0xFFu << CAN_IF_DAT_B1_DATA4_Pos)
+#define CAN_IF_DAT_B2_DATA7_Pos       8
+#define CAN_IF_DAT_B2_DATA7_Msk       (0xFFu << CAN_IF_DAT_B2_DATA7_Pos)
+#define CAN_IF_DAT_B2_DATA6_Pos       0
+#define CAN_IF_DAT_B2_DATA6_Msk       (0xFFu << CAN_IF_DAT_B2_DATA6_Pos)
+#define CAN_IF_TXRQST1_TXRQST_Pos     0
+#define CAN_IF_TXRQST1_TXRQST_Msk     (0xFFFFu << CAN_IF_TXRQST1_TXRQST_Pos)
+#define CAN_IF_TXRQST2_TXRQST_Pos     0
+#define CAN_IF_TXRQST2_TXRQST_Msk     (0xFFFFu << CAN_IF_TXRQST2_TXRQST_Pos)
+#define CAN_IF_NDAT1_NEWDATA_Pos      0
+#define CAN_IF_NDAT1_NEWDATA_Msk      (0xFFFFu << CAN_IF_NDAT1_NEWDATA_Pos)
+#define CAN_IF_NDAT2_NEWDATA_Pos      0
+#define CAN_IF_NDAT2_NEWDATA_Msk      (0xFFFFu << CAN_IF_NDAT2_NEWDATA_Pos)
+#define CAN_IF_IPND1_INTPND_Pos       0
+#define CAN_IF_IPND1_INTPND_Msk       (0xFFFFu << CAN_IF_IPND1_INTPND_Pos)
+#define CAN_IF_IPND2_INTPND_Pos       0
+#define CAN_IF_IPND2_INTPND_Msk       (0xFFFFu << CAN_IF_IPND2_INTPND_Pos)
+#define CAN_IF_MVLD1_MSGVAL_Pos       0
+#define CAN_IF_MVLD1_MSGVAL_Msk       (0xFFFFu << CAN_IF_MVLD1_MSGVAL_Pos)
+#define CAN_IF_MVLD2_MSGVAL_Pos       0
+#define CAN_IF_MVLD2_MSGVAL_Msk       (0xFFFFu << CAN_IF_MVLD2_MSGVAL_Pos)
+#define CAN_WUEN_WAKUP_EN_Pos         0
+#define CAN_WUEN_WAKUP_EN_Msk         (1u << CAN_WUEN_WAKUP_EN_Pos)
+#define CAN_WUSTATUS_WAKUP_STS_Pos    0
+#define CAN_WUSTATUS_WAKUP_STS_Msk    (1u << CAN_WUSTATUS_WAKUP_STS_Pos)
+
+extern uint32_t SystemCoreClock;
+
+void SystemCoreClockUpdate(void);
+uint32_t CLK_GetPCLKFreq(void);
+
+#include "can.h"
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Model of a CAN module                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Mask;                               /* MASK2 << 16 | MASK1 */
+    uint32_t u32Arb;                                /* ARB2 << 16 | ARB1 */
+    uint32_t u32Mcon;
+    uint8_t au8Data[8];
+    uint32_t u32LoadTime;                           /* u32Time of the module when TXRQST was last set */
+} HOST_CAN_OBJ_T;
+
+typedef struct
+{
+    CAN_T sReg;
+    HOST_CAN_OBJ_T asObj[32];
+    uint32_t u32Time;                               /* Set by the test, stamped on each object loaded */
+    uint32_t u32Loads;                              /* Transfers to a message object that set TXRQST */
+    uint32_t u32Unmasked;                           /* Interface transfers started with interrupts enabled */
+    uint32_t u32BusyWrites;                         /* Interface registers written while the interface was busy */
+    uint32_t u32StatusInt;                          /* 1 while the status interrupt is pending */
+} HOST_CAN_T;
+
+extern HOST_CAN_T g_asHostCan[2];
+
+#define CAN0                        (&g_asHostCan[0].sReg)
+#define CAN1                        (&g_asHostCan[1].sReg)
+
+void HostCan_Reset(void);
+int32_t HostCan_Transmit(CAN_T *tCAN, STR_CANMSG_T *psMsg);
+int32_t HostCan_Receive(CAN_T *tCAN, const STR_CANMSG_T *psMsg);
+void HostCan_Status(CAN_T *tCAN, uint32_t u32Status);
+
+#endif /* __NUC1311_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,344 @@
+/**************************************************************************//**
+ * @file     host_can.cpp
+ * @version  V3.00
+ * @brief    CAN module model for the CAN tests
+ *
+ * @note     A CREQ write moves the data selected by CMASK between the interface and the message object, then
+ *           keeps the interface busy for the next reads of CREQ. Interface accesses while it is busy and transfers
+ *           started with interrupts enabled are counted, as an interrupt handler could take the interface in
+ *           between. HostCan_Transmit() sends the lowest numbered object with TXRQST set, as the controller does.
+ *           HostCan_Receive() stores a data frame in the lowest numbered receive object that accepts it.
+ *           HostCan_Status() raises the status interrupt, which a read of STATUS releases.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NUC1311.h"
+
+/* The CAN driver, built against the model */
+#include "../../StdDriver/src/can.c"
+
+#define HOST_CAN_BUSY_READS     3       /* Reads of CREQ that still see BUSY after a transfer request */
+
+HOST_CAN_T g_asHostCan[2];
+uint32_t SystemCoreClock = 48000000;
+
+static uint32_t s_au32Busy[2][2];
+
+void SystemCoreClockUpdate(void)
+{
+}
+
+uint32_t CLK_GetPCLKFreq(void)
+{
+    return SystemCoreClock;
+}
+
+/* Module and interface of an interface register */
+static HOST_CAN_T *HostCan_Find(HOST_REG_T *psReg, uint32_t *pu32If)
+{
+    uint32_t i, j;
+    uint8_t *pu8Reg = (uint8_t *)psReg;
+
+    for(i = 0; i < 2; i++)
+    {
+        for(j = 0; j < 2; j++)
+        {
+            uint8_t *pu8If = (uint8_t *)&g_asHostCan[i].sReg.IF[j];
+
+            if((pu8Reg >= pu8If) && (pu8Reg < pu8If + sizeof(CAN_IF_T)))
+            {
+                *pu32If = j;
+                return &g_asHostCan[i];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void HostCan_Transfer(HOST_CAN_T *psCan, CAN_IF_T *psIf, uint32_t u32MsgNum)
+{
+    HOST_CAN_OBJ_T *psObj = &psCan->asObj[(u32MsgNum - 1) & 31];
+    uint32_t u32Mask = psIf->CMASK.u32Val;
+
+    if(u32Mask & CAN_IF_CMASK_WRRD_Msk)
+    {
+        if(u32Mask & CAN_IF_CMASK_MASK_Msk)
+            psObj->u32Mask = (psIf->MASK2.u32Val << 16) | (psIf->MASK1.u32Val & 0xFFFF);
+        if(u32Mask & CAN_IF_CMASK_ARB_Msk)
+            psObj->u32Arb = (psIf->ARB2.u32Val << 16) | (psIf->ARB1.u32Val & 0xFFFF);
+        if(u32Mask & CAN_IF_CMASK_CONTROL_Msk)
+            psObj->u32Mcon = psIf->MCON.u32Val & 0xFFFF;
+        else if(u32Mask & CAN_IF_CMASK_TXRQSTNEWDAT_Msk)
+            psObj->u32Mcon |= CAN_IF_MCON_TXRQST_Msk | CAN_IF_MCON_NEWDAT_Msk;
+        if(u32Mask & CAN_IF_CMASK_DATAA_Msk)
+        {
+            psObj->au8Data[0] = (uint8_t)psIf->DAT_A1.u32Val;
+            psObj->au8Data[1] = (uint8_t)(psIf->DAT_A1.u32Val >> 8);
+            psObj->au8Data[2] = (uint8_t)psIf->DAT_A2.u32Val;
+            psObj->au8Data[3] = (uint8_t)(psIf->DAT_A2.u32Val >> 8);
+        }
+        if(u32Mask & CAN_IF_CMASK_DATAB_Msk)
+        {
+            psObj->au8Data[4] = (uint8_t)psIf->DAT_B1.u32Val;
+            psObj->au8Data[5] = (uint8_t)(psIf->DAT_B1.u32Val >> 8);
+            psObj->au8Data[6] = (uint8_t)psIf->DAT_B2.u32Val;
+            psObj->au8Data[7] = (uint8_t)(psIf->DAT_B2.u32Val >> 8);
+        }
+        if(psObj->u32Mcon & CAN_IF_MCON_TXRQST_Msk)
+        {
+            psCan->u32Loads++;
+            psObj->u32LoadTime = psCan->u32Time;
+        }
+    }
+    else
+    {
+        if(u32Mask & CAN_IF_CMASK_MASK_Msk)
+        {
+            psIf->MASK1.u32Val = psObj->u32Mask & 0xFFFF;
+            psIf->MASK2.u32Val = psObj->u32Mask >> 16;
+        }
+        if(u32Mask & CAN_IF_CMASK_ARB_Msk)
+        {
+            psIf->ARB1.u32Val = psObj->u32Arb & 0xFFFF;
+            psIf->ARB2.u32Val = psObj->u32Arb >> 16;
+        }
+        if(u32Mask & CAN_IF_CMASK_CONTROL_Msk)
+            psIf->MCON.u32Val = psObj->u32Mcon;
+        if(u32Mask & CAN_IF_CMASK_DATAA_Msk)
+        {
+            psIf->DAT_A1.u32Val = psObj->au8Data[0] | ((uint32_t)psObj->au8Data[1] << 8);
+            psIf->DAT_A2.u32Val = psObj->au8Data[2] | ((uint32_t)psObj->au8Data[3] << 8);
+        }
+        if(u32Mask & CAN_IF_CMASK_DATAB_Msk)
+        {
+            psIf->DAT_B1.u32Val = psObj->au8Data[4] | ((uint32_t)psObj->au8Data[5] << 8);
+            psIf->DAT_B2.u32Val = psObj->au8Data[6] | ((uint32_t)psObj->au8Data[7] << 8);
+        }
+        if(u32Mask & CAN_IF_CMASK_CLRINTPND_Msk)
+            psObj->u32Mcon &= ~CAN_IF_MCON_INTPND_Msk;
+        if(u32Mask & CAN_IF_CMASK_TXRQSTNEWDAT_Msk)
+            psObj->u32Mcon &= ~CAN_IF_MCON_NEWDAT_Msk;
+    }
+}
+
+static void HostCan_IfWrite(HOST_REG_T *psReg, uint32_t u32Val)
+{
+    uint32_t u32If = 0;
+    HOST_CAN_T *psCan = HostCan_Find(psReg, &u32If);
+    uint32_t u32Idx = (uint32_t)(psCan - g_asHostCan);
+    CAN_IF_T *psIf = &psCan->sReg.IF[u32If];
+
+    if(s_au32Busy[u32Idx][u32If])
+        psCan->u32BusyWrites++;
+
+    if(psReg != &psIf->CREQ)
+    {
+        psReg->u32Val = u32Val & 0xFFFF;
+        return;
+    }
+
+    /* Clearing BUSY, as CAN_BasicSendMsg() does, starts nothing */
+    psReg->u32Val = u32Val & (CAN_IF_CREQ_MSGNUM_Msk | CAN_IF_CREQ_BUSY_Msk);
+    if((u32Val & CAN_IF_CREQ_MSGNUM_Msk) == 0)
+        return;
+
+    if(__get_PRIMASK() == 0)
+        psCan->u32Unmasked++;
+    HostCan_Transfer(psCan, psIf, u32Val & CAN_IF_CREQ_MSGNUM_Msk);
+    psReg->u32Val |= CAN_IF_CREQ_BUSY_Msk;
+    s_au32Busy[u32Idx][u32If] = HOST_CAN_BUSY_READS;
+}
+
+static uint32_t HostCan_CreqRead(HOST_REG_T *psReg)
+{
+    uint32_t u32If = 0;
+    HOST_CAN_T *psCan = HostCan_Find(psReg, &u32If);
+    uint32_t *pu32Busy = &s_au32Busy[psCan - g_asHostCan][u32If];
+
+    if(*pu32Busy && (--*pu32Busy == 0))
+        psReg->u32Val &= ~CAN_IF_CREQ_BUSY_Msk;
+
+    return psReg->u32Val;
+}
+
+/* Interrupt pending and new data bits and IIDR from the message objects */
+static void HostCan_Update(HOST_CAN_T *psCan)
+{
+    uint32_t i, u32Pend = 0, u32New = 0;
+
+    psCan->sReg.IIDR.u32Val = 0;
+    for(i = 32; i-- > 0;)
+    {
+        if(psCan->asObj[i].u32Mcon & CAN_IF_MCON_INTPND_Msk)
+        {
+            u32Pend |= 1ul << i;
+            psCan->sReg.IIDR.u32Val = i + 1;
+        }
+        if(psCan->asObj[i].u32Mcon & CAN_IF_MCON_NEWDAT_Msk)
+            u32New |= 1ul << i;
+    }
+    psCan->sReg.IPND1.u32Val = u32Pend & 0xFFFF;
+    psCan->sReg.IPND2.u32Val = u32Pend >> 16;
+    psCan->sReg.NDAT1.u32Val = u32New & 0xFFFF;
+    psCan->sReg.NDAT2.u32Val = u32New >> 16;
+    if(psCan->u32StatusInt)
+        psCan->sReg.IIDR.u32Val = CAN_IIDR_STATUS;
+}
+
+static uint32_t HostCan_PendRead(HOST_REG_T *psReg)
+{
+    uint8_t *pu8Reg = (uint8_t *)psReg;
+
+    HostCan_Update(&g_asHostCan[(pu8Reg >= (uint8_t *)CAN1) && (pu8Reg < (uint8_t *)(CAN1 + 1))]);
+    return psReg->u32Val;
+}
+
+static uint32_t HostCan_StatusRead(HOST_REG_T *psReg)
+{
+    g_asHostCan[psReg == &CAN1->STATUS].u32StatusInt = 0;
+    return psReg->u32Val;
+}
+
+/**
+  * @brief      Reset both modules: message RAM cleared, interfaces idle.
+  */
+void HostCan_Reset(void)
+{
+    HOST_REG_T *psReg;
+    uint32_t i, j;
+
+    for(i = 0; i < 2; i++)
+    {
+        HOST_CAN_T *psCan = &g_asHostCan[i];
+
+        memset(psCan->asObj, 0, sizeof(psCan->asObj));
+        psCan->u32Time = 0;
+        psCan->u32Loads = 0;
+        psCan->u32Unmasked = 0;
+        psCan->u32BusyWrites = 0;
+        psCan->u32StatusInt = 0;
+        psCan->sReg.STATUS.u32Val = 0;
+
+        for(j = 0; j < 2; j++)
+        {
+            s_au32Busy[i][j] = 0;
+            for(psReg = &psCan->sReg.IF[j].CREQ; psReg <= &psCan->sReg.IF[j].DAT_B2; psReg++)
+            {
+                psReg->u32Val = 0;
+                psReg->pfnWrite = HostCan_IfWrite;
+            }
+            psCan->sReg.IF[j].CREQ.pfnRead = HostCan_CreqRead;
+        }
+        psCan->sReg.IIDR.pfnRead = HostCan_PendRead;
+        psCan->sReg.IPND1.pfnRead = HostCan_PendRead;
+        psCan->sReg.IPND2.pfnRead = HostCan_PendRead;
+        psCan->sReg.NDAT1.pfnRead = HostCan_PendRead;
+        psCan->sReg.NDAT2.pfnRead = HostCan_PendRead;
+        psCan->sReg.STATUS.pfnRead = HostCan_StatusRead;
+    }
+}
+
+/**
+  * @brief      Send the lowest numbered message object with a transmission request.
+  * @return     The message object, 0 ~ 31, or -1 if none is pending. Its interrupt is pending if TXIE is set.
+  */
+int32_t HostCan_Transmit(CAN_T *tCAN, STR_CANMSG_T *psMsg)
+{
+    HOST_CAN_T *psCan = &g_asHostCan[tCAN == CAN1];
+    HOST_CAN_OBJ_T *psObj;
+    uint32_t i;
+
+    for(i = 0; i < 32; i++)
+    {
+        psObj = &psCan->asObj[i];
+        if((psObj->u32Arb & (CAN_IF_ARB2_MSGVAL_Msk << 16)) && (psObj->u32Mcon & CAN_IF_MCON_TXRQST_Msk))
+            break;
+    }
+    if(i == 32)
+        return -1;
+
+    psMsg->IdType = (psObj->u32Arb & (CAN_IF_ARB2_XTD_Msk << 16)) ? CAN_EXT_ID : CAN_STD_ID;
+    if(psMsg->IdType == CAN_STD_ID)
+        psMsg->Id = (psObj->u32Arb >> 18) & 0x7FF;
+    else
+        psMsg->Id = psObj->u32Arb & 0x1FFFFFFF;
+    psMsg->FrameType = (psObj->u32Arb & (CAN_IF_ARB2_DIR_Msk << 16)) ? CAN_DATA_FRAME : CAN_REMOTE_FRAME;
+    psMsg->DLC = (uint8_t)(psObj->u32Mcon & CAN_IF_MCON_DLC_Msk);
+    memcpy(psMsg->Data, psObj->au8Data, 8);
+
+    psObj->u32Mcon &= ~(CAN_IF_MCON_TXRQST_Msk | CAN_IF_MCON_NEWDAT_Msk);
+    if(psObj->u32Mcon & CAN_IF_MCON_TXIE_Msk)
+        psObj->u32Mcon |= CAN_IF_MCON_INTPND_Msk;
+    psCan->sReg.STATUS.u32Val |= CAN_STATUS_TXOK_Msk;
+
+    return (int32_t)i;
+}
+
+/**
+  * @brief      Receive a data frame from the bus.
+  * @return     The message object that stored it, 0 ~ 31, or -1 if no receive object accepts it.
+  * @details    The identifier is compared under the object mask if UMASK is set, else in full. The object takes
+  *             the identifier received, data and DLC, NEWDAT is set and the interrupt is pending if RXIE is set.
+  */
+int32_t HostCan_Receive(CAN_T *tCAN, const STR_CANMSG_T *psMsg)
+{
+    HOST_CAN_T *psCan = &g_asHostCan[tCAN == CAN1];
+    HOST_CAN_OBJ_T *psObj;
+    uint32_t u32Arb, u32Mask, i;
+
+    if(psMsg->FrameType != CAN_DATA_FRAME)
+        return -1;
+
+    if(psMsg->IdType == CAN_STD_ID)
+        u32Arb = (psMsg->Id & 0x7FF) << 18;
+    else
+        u32Arb = (psMsg->Id & 0x1FFFFFFF) | (CAN_IF_ARB2_XTD_Msk << 16);
+
+    for(i = 0; i < 32; i++)
+    {
+        psObj = &psCan->asObj[i];
+        if((psObj->u32Arb & ((CAN_IF_ARB2_MSGVAL_Msk | CAN_IF_ARB2_DIR_Msk) << 16)) != (CAN_IF_ARB2_MSGVAL_Msk << 16))
+            continue;
+
+        u32Mask = 0x1FFFFFFF | (CAN_IF_ARB2_XTD_Msk << 16);
+        if(psObj->u32Mcon & CAN_IF_MCON_UMASK_Msk)
+        {
+            u32Mask = psObj->u32Mask & 0x1FFFFFFF;
+            if(psObj->u32Mask & (CAN_IF_MASK2_MXTD_Msk << 16))
+                u32Mask |= CAN_IF_ARB2_XTD_Msk << 16;
+        }
+        if(((psObj->u32Arb ^ u32Arb) & u32Mask) == 0)
+            break;
+    }
+    if(i == 32)
+        return -1;
+
+    psObj->u32Arb = (psObj->u32Arb & ~(0x1FFFFFFF | (CAN_IF_ARB2_XTD_Msk << 16))) | u32Arb;
+    memcpy(psObj->au8Data, psMsg->Data, 8);
+    psObj->u32Mcon &= ~CAN_IF_MCON_DLC_Msk;
+    if(psObj->u32Mcon & CAN_IF_MCON_NEWDAT_Msk)
+        psObj->u32Mcon |= CAN_IF_MCON_MSGLST_Msk;
+    psObj->u32Mcon |= CAN_IF_MCON_NEWDAT_Msk | (psMsg->DLC & CAN_IF_MCON_DLC_Msk);
+    if(psObj->u32Mcon & CAN_IF_MCON_RXIE_Msk)
+        psObj->u32Mcon |= CAN_IF_MCON_INTPND_Msk;
+    psCan->sReg.STATUS.u32Val |= CAN_STATUS_RXOK_Msk;
+
+    return (int32_t)i;
+}
+
+/**
+  * @brief      Change the status and raise the status interrupt.
+  */
+void HostCan_Status(CAN_T *tCAN, uint32_t u32Status)
+{
+    HOST_CAN_T *psCan = &g_asHostCan[tCAN == CAN1];
+
+    psCan->sReg.STATUS.u32Val = u32Status;
+    psCan->u32StatusInt = 1;
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,170 @@
+/**************************************************************************//**
+ * @file     test_can_diag.cpp
+ * @version  V3.00
+ * @brief    CAN bus diagnostics test on the CAN model
+ *
+ * @note     The status interrupts are fed to CANDIAG_StatusHandler() as CAN_IRQDispatch() passes them on, and the
+ *           software timers of the diagnostics are run by the test. Checked: the window length from the bit timing,
+ *           the load from the default and the counted frame lengths, frames merged by a late interrupt, the last
+ *           error code counted once, the error states and the bus-off recovery wait with its back-off, also
+ *           after a recovery that raises no status interrupt.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NUC1311.h"
+#include "../../StdDriver/src/can_diag.c"
+
+#define TICK_FREQ       1000
+#define WINDOW_MS       100
+
+static CANDIAG_T s_sDiag;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Software timer service of the test: the timers only record their setting, Timer_Fire() expires one     */
+/*---------------------------------------------------------------------------------------------------------*/
+int32_t SWTIMER_Start(SWTIMER_T *psTmr, uint32_t u32Ticks, uint32_t u32Period, SWTIMER_FUNC_T pfnFunc, void *pvArg)
+{
+    psTmr->u32Expire = u32Ticks;
+    psTmr->u32Period = u32Period;
+    psTmr->pfnFunc = pfnFunc;
+    psTmr->pvArg = pvArg;
+    psTmr->u8Active = 1;
+
+    return 0;
+}
+
+void SWTIMER_Stop(SWTIMER_T *psTmr)
+{
+    psTmr->u8Active = 0;
+}
+
+static void Timer_Fire(SWTIMER_T *psTmr)
+{
+    HOST_CHECK(psTmr->u8Active);
+    if(psTmr->u32Period == 0)
+        psTmr->u8Active = 0;
+    psTmr->pfnFunc(psTmr->pvArg);
+    HOST_CHECK(__get_PRIMASK() == 0);
+}
+
+static void Diag_Status(uint32_t u32Status)
+{
+    CANDIAG_StatusHandler(CAN0, u32Status, &s_sDiag);
+    HOST_CHECK(__get_PRIMASK() == 0);
+}
+
+int main(void)
+{
+    static const uint32_t au32Wait[] = {CANDIAG_BOFF_MIN_MS, CANDIAG_BOFF_MIN_MS * 2, CANDIAG_BOFF_MIN_MS * 4};
+    STR_CANMSG_T sMsg = {CAN_EXT_ID, CAN_DATA_FRAME, 0x123, 2, {0}};
+    CANDIAG_STAT_T sStat;
+    uint32_t i;
+
+    HostCan_Reset();
+
+    /* 48 MHz / 6 / 16 time quanta = 500 kbps */
+    CAN0->BTIME = (5 << CAN_BTIME_BRP_Pos) | (10 << CAN_BTIME_TSEG1_Pos) | (3 << CAN_BTIME_TSEG2_Pos);
+    HOST_CHECK(CAN_GetCANBitRate(CAN0) == 500000);
+
+    HOST_CHECK(CANDIAG_Open(&s_sDiag, CAN0, 0, WINDOW_MS) == CANDIAG_ERR_PARAM);
+    HOST_CHECK(CANDIAG_Open(&s_sDiag, CAN0, TICK_FREQ, 0) == CANDIAG_ERR_PARAM);
+    HOST_CHECK(CANDIAG_Open(&s_sDiag, CAN0, TICK_FREQ, WINDOW_MS) == 0);
+    HOST_CHECK(s_sDiag.u32WinBits == 500000 / 1000 * WINDOW_MS);
+    HOST_CHECK(s_sDiag.sWinTmr.u8Active && (s_sDiag.sWinTmr.u32Period == WINDOW_MS * TICK_FREQ / 1000));
+
+    /* 200 frames of the default length in the window: 200 * 111 / 50000 = 44.4 % */
+    for(i = 0; i < 100; i++)
+    {
+        Diag_Status(CAN_STATUS_TXOK_Msk);
+        Diag_Status(CAN_STATUS_RXOK_Msk);
+    }
+    Timer_Fire(&s_sDiag.sWinTmr);
+    HOST_CHECK(s_sDiag.sStat.u16Load == 444);
+
+    /* Counted frames set the mean length: extended identifier and 2 bytes, 83 bits */
+    for(i = 0; i < 100; i++)
+    {
+        Diag_Status(CAN_STATUS_RXOK_Msk);
+        CANDIAG_CountFrame(&s_sDiag, &sMsg, CANDIAG_DIR_RX);
+    }
+    Timer_Fire(&s_sDiag.sWinTmr);
+    HOST_CHECK((s_sDiag.sStat.u16Load == 166) && (s_sDiag.sStat.u16LoadMax == 444));
+    HOST_CHECK(s_sDiag.sStat.u32RxBytes == 200);
+
+    /* A frame sent and one received before the interrupt is serviced count once each, two of a kind once */
+    Diag_Status(CAN_STATUS_TXOK_Msk | CAN_STATUS_RXOK_Msk);
+    Diag_Status(CAN_STATUS_RXOK_Msk);
+    HOST_CHECK(s_sDiag.u32WinFrames == 3);
+
+    /* Last error code: a stuff error is counted once, then marked as consumed */
+    CAN0->STATUS = 1;
+    Diag_Status(1);
+    HOST_CHECK((s_sDiag.sStat.au16Lec[0] == 1) && (s_sDiag.sStat.u8Lec == 1));
+    HOST_CHECK((CAN0->STATUS.u32Val & CANDIAG_LEC_MSK) == CANDIAG_LEC_UNUSED);
+    Diag_Status(CANDIAG_LEC_UNUSED);
+    HOST_CHECK(s_sDiag.sStat.au16Lec[0] == 1);
+
+    /* Error states and counters */
+    CAN0->ERR = 100 | (5 << CAN_ERR_REC_Pos);
+    Diag_Status(CAN_STATUS_EWARN_Msk | 3);
+    HOST_CHECK((s_sDiag.sStat.u8State == CANDIAG_STATE_WARNING) && (s_sDiag.sStat.u16Warning == 1));
+    HOST_CHECK((s_sDiag.sStat.u8Tec == 100) && (s_sDiag.sStat.u8Rec == 5) && (s_sDiag.sStat.au16Lec[2] == 1));
+    CAN0->ERR = 200 | CAN_ERR_RP_Msk;
+    Diag_Status(CAN_STATUS_EPASS_Msk | CAN_STATUS_EWARN_Msk);
+    HOST_CHECK((s_sDiag.sStat.u8State == CANDIAG_STATE_PASSIVE) && (s_sDiag.sStat.u16Passive == 1));
+    HOST_CHECK((s_sDiag.sStat.u8Rec == 128) && (s_sDiag.sStat.u8TecMax == 200) && (s_sDiag.sStat.u16Warning == 1));
+
+    /* Bus-off: the recovery wait doubles within a window, a repeated status is not a new bus-off */
+    for(i = 0; i < 3; i++)
+    {
+        CAN0->CON = CAN_CON_INIT_Msk;
+        Diag_Status(CAN_STATUS_BOFF_Msk | CAN_STATUS_EPASS_Msk | CAN_STATUS_EWARN_Msk);
+        Diag_Status(CAN_STATUS_BOFF_Msk | CAN_STATUS_EPASS_Msk | CAN_STATUS_EWARN_Msk);
+        HOST_CHECK(s_sDiag.sBoffTmr.u32Expire == au32Wait[i] * TICK_FREQ / 1000);
+        HOST_CHECK(s_sDiag.sStat.u16BusOff == i + 1);
+        Timer_Fire(&s_sDiag.sBoffTmr);
+        HOST_CHECK((CAN0->CON.u32Val & CAN_CON_INIT_Msk) == 0);
+        HOST_CHECK(s_sDiag.sStat.u16Recover == i + 1);
+        Diag_Status(CAN_STATUS_EPASS_Msk | CAN_STATUS_EWARN_Msk);
+    }
+    Timer_Fire(&s_sDiag.sWinTmr);
+    HOST_CHECK(s_sDiag.sStat.u8Backoff == 3);
+    Timer_Fire(&s_sDiag.sWinTmr);
+    HOST_CHECK(s_sDiag.sStat.u8Backoff == 0);
+
+    /* The wait stops at the longest */
+    for(i = 0; i < 12; i++)
+    {
+        Diag_Status(CAN_STATUS_BOFF_Msk);
+        Diag_Status(0);
+    }
+    HOST_CHECK(s_sDiag.sBoffTmr.u32Expire == CANDIAG_BOFF_MAX_MS * TICK_FREQ / 1000);
+
+    /* No status interrupt after the recovery: the window reads the state from STATUS and still ends the back-off */
+    Timer_Fire(&s_sDiag.sWinTmr);
+    Diag_Status(CAN_STATUS_BOFF_Msk | CAN_STATUS_EPASS_Msk);
+    Timer_Fire(&s_sDiag.sBoffTmr);
+    CAN0->STATUS = CAN_STATUS_EPASS_Msk | CAN_STATUS_EWARN_Msk;
+    Timer_Fire(&s_sDiag.sWinTmr);
+    HOST_CHECK((s_sDiag.sStat.u8State == CANDIAG_STATE_PASSIVE) && (s_sDiag.sStat.u8Backoff != 0));
+    Timer_Fire(&s_sDiag.sWinTmr);
+    HOST_CHECK(s_sDiag.sStat.u8Backoff == 0);
+
+    CANDIAG_GetStat(&s_sDiag, &sStat);
+    HOST_CHECK((sStat.u32TxFrames == 101) && (sStat.u32RxFrames == 202));
+    CANDIAG_ClearStat(&s_sDiag);
+    CANDIAG_GetStat(&s_sDiag, &sStat);
+    HOST_CHECK((sStat.u32TxFrames == 0) && (sStat.u16BusOff == 0));
+
+    CANDIAG_Close(&s_sDiag);
+    HOST_CHECK(!s_sDiag.sWinTmr.u8Active && !s_sDiag.sBoffTmr.u8Active);
+
+    printf("test_can_diag: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
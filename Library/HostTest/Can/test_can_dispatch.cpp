@@ -0,0 +1,109 @@
+/**************************************************************************//**
+ * @file     test_can_dispatch.cpp
+ * @version  V3.00
+ * @brief    CAN interrupt dispatcher test on the CAN model
+ *
+ * @note     Frames are received into two objects, two more objects and the status interrupt are made pending,
+ *           and one CAN_IRQDispatch() call must serve them all: the status first with RxOK and TxOK cleared,
+ *           then the objects from 0 up. Pending bits left by a handler, or of an object without handler, are
+ *           cleared by the dispatcher. The handler tables of CAN0 and CAN1 are separate.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NUC1311.h"
+
+#define STATUS_CALL     100     /* Entry of the status handler in the call order */
+
+static uint32_t s_au32Order[64], s_u32Calls, s_u32Status;
+static STR_CANMSG_T s_asRx[32];
+
+/* pvArg non-NULL: read the object, which releases it. NULL: leave it pending. */
+static void Msg_Handler(CAN_T *tCAN, uint32_t u32MsgNum, void *pvArg)
+{
+    s_au32Order[s_u32Calls++] = u32MsgNum;
+    if(pvArg != NULL)
+        HOST_CHECK(CAN_Receive(tCAN, u32MsgNum, &s_asRx[u32MsgNum]) == TRUE);
+}
+
+static void Status_Handler(CAN_T *tCAN, uint32_t u32Status, void *pvArg)
+{
+    (void)tCAN;
+    HOST_CHECK(pvArg == &s_u32Status);
+    s_u32Status = u32Status;
+    s_au32Order[s_u32Calls++] = STATUS_CALL;
+}
+
+static uint32_t Obj_Pending(uint32_t u32Module, uint32_t u32MsgNum)
+{
+    return (g_asHostCan[u32Module].asObj[u32MsgNum].u32Mcon & CAN_IF_MCON_INTPND_Msk) != 0;
+}
+
+int main(void)
+{
+    STR_CANMSG_T sMsg = {CAN_STD_ID, CAN_DATA_FRAME, 0x105, 8, {1, 2, 3, 4, 5, 6, 7, 8}};
+    uint32_t u32Status;
+
+    HostCan_Reset();
+
+    /* CAN_SetRxMsg() leaves the mask at 0, so object 0 is opened once object 5 holds its frame */
+    HOST_CHECK(CAN_SetRxMsg(CAN0, 5, CAN_STD_ID, 0x105) == TRUE);
+    HOST_CHECK(HostCan_Receive(CAN0, &sMsg) == 5);
+    HOST_CHECK(CAN_SetRxMsg(CAN0, 0, CAN_STD_ID, 0x100) == TRUE);
+    sMsg.Id = 0x100;
+    sMsg.DLC = 2;
+    HOST_CHECK(HostCan_Receive(CAN0, &sMsg) == 0);
+
+    CAN_InstallMsgHandler(CAN0, 0, Msg_Handler, s_asRx);
+    CAN_InstallMsgHandler(CAN0, 5, Msg_Handler, s_asRx);
+    CAN_InstallMsgHandler(CAN0, 31, Msg_Handler, NULL);
+    CAN_InstallMsgHandler(CAN0, CAN_MSG_OBJ_CNT, Msg_Handler, NULL);
+    CAN_InstallStatusHandler(CAN0, Status_Handler, &s_u32Status);
+
+    g_asHostCan[0].asObj[7].u32Mcon |= CAN_IF_MCON_INTPND_Msk;
+    g_asHostCan[0].asObj[31].u32Mcon |= CAN_IF_MCON_INTPND_Msk;
+    u32Status = CAN_STATUS_EWARN_Msk | CAN_STATUS_RXOK_Msk | CAN_STATUS_TXOK_Msk;
+    HostCan_Status(CAN0, u32Status);
+
+    /* Status, 0, 5, 7 without handler and 31 in one call */
+    HOST_CHECK(CAN_IRQDispatch(CAN0) == 5);
+    HOST_CHECK(__get_PRIMASK() == 0);
+    HOST_CHECK(s_u32Calls == 4);
+    HOST_CHECK((s_au32Order[0] == STATUS_CALL) && (s_au32Order[1] == 0) && (s_au32Order[2] == 5) &&
+               (s_au32Order[3] == 31));
+    HOST_CHECK(s_u32Status == u32Status);
+    HOST_CHECK(CAN0->STATUS.u32Val == CAN_STATUS_EWARN_Msk);
+    HOST_CHECK((CAN0->IPND1 == 0) && (CAN0->IPND2 == 0) && (CAN0->NDAT1 == 0));
+    HOST_CHECK((s_asRx[0].Id == 0x100) && (s_asRx[0].DLC == 2) && (s_asRx[0].Data[1] == 2));
+    HOST_CHECK((s_asRx[5].Id == 0x105) && (s_asRx[5].DLC == 8) && (s_asRx[5].Data[7] == 8));
+
+    /* Nothing left */
+    HOST_CHECK(CAN_IRQDispatch(CAN0) == 0);
+    HOST_CHECK(s_u32Calls == 4);
+
+    /* The handlers of CAN0 are not called for CAN1 */
+    g_asHostCan[1].asObj[0].u32Mcon |= CAN_IF_MCON_INTPND_Msk;
+    g_asHostCan[1].asObj[31].u32Mcon |= CAN_IF_MCON_INTPND_Msk;
+    HOST_CHECK(CAN_IRQDispatch(CAN1) == 2);
+    HOST_CHECK(s_u32Calls == 4);
+    HOST_CHECK(!Obj_Pending(1, 0) && !Obj_Pending(1, 31));
+
+    /* Removed handlers are not called */
+    CAN_InstallMsgHandler(CAN0, 31, NULL, NULL);
+    CAN_InstallStatusHandler(CAN0, NULL, NULL);
+    g_asHostCan[0].asObj[31].u32Mcon |= CAN_IF_MCON_INTPND_Msk;
+    HostCan_Status(CAN0, CAN_STATUS_TXOK_Msk);
+    HOST_CHECK(CAN_IRQDispatch(CAN0) == 2);
+    HOST_CHECK(s_u32Calls == 4);
+    HOST_CHECK(!Obj_Pending(0, 31));
+
+    HOST_CHECK(g_asHostCan[0].u32Unmasked + g_asHostCan[1].u32Unmasked == 0);
+
+    printf("test_can_dispatch: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,198 @@
+/**************************************************************************//**
+ * @file     test_can_txq.cpp
+ * @version  V3.00
+ * @brief    CAN priority transmit queue test on the CAN model
+ *
+ * @note     Random bursts of frames are queued while the model bus sends the lowest numbered pending
+ *           object and raises its interrupt. Every frame carries a serial number. When a frame goes out,
+ *           no frame queued before it was loaded may still wait if it wins arbitration against it or has
+ *           the same identifier and an earlier serial. Pools of 1, 3 and 8 objects are run. Also checked:
+ *           the interface is idle and unmasked transfers are absent when the handler returns, the queue
+ *           full case and the statistics.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NUC1311.h"
+#include "../../StdDriver/src/can_txq.c"
+
+#define QUEUE_SIZE      32
+#define STEPS           20000
+#define FRAMES_MAX      (STEPS * 4)
+#define FIRST_OBJ       2
+
+typedef struct
+{
+    uint32_t u32Key;
+    uint32_t u32Sent;
+} FRAME_T;
+
+static const STR_CANMSG_T s_asIdent[] =
+{
+    {CAN_STD_ID, CAN_DATA_FRAME, 0x100, 8, {0}},
+    {CAN_STD_ID, CAN_DATA_FRAME, 0x101, 8, {0}},
+    {CAN_STD_ID, CAN_REMOTE_FRAME, 0x101, 4, {0}},
+    {CAN_STD_ID, CAN_DATA_FRAME, 0x7FF, 8, {0}},
+    {CAN_STD_ID, CAN_DATA_FRAME, 0x005, 8, {0}},
+    {CAN_EXT_ID, CAN_DATA_FRAME, 0x04000000, 8, {0}},   /* Same base ID as 0x100, loses against it */
+    {CAN_EXT_ID, CAN_DATA_FRAME, 0x1FFFFFFF, 8, {0}},
+    {CAN_EXT_ID, CAN_REMOTE_FRAME, 0x1FFFFFFF, 4, {0}},
+    {CAN_EXT_ID, CAN_DATA_FRAME, 0x00000001, 8, {0}},
+    {CAN_EXT_ID, CAN_DATA_FRAME, 0x12345678, 8, {0}},
+};
+
+#define IDENT_CNT       (sizeof(s_asIdent) / sizeof(s_asIdent[0]))
+
+static FRAME_T s_asFrame[FRAMES_MAX];
+static uint32_t s_u32Serial, s_u32Sent, s_u32Now;
+static uint32_t s_au32Wait[QUEUE_SIZE + CANTXQ_MAX_OBJ], s_u32WaitCnt;    /* Serials queued, not sent */
+static CANTXQ_ENTRY_T s_asBuf[QUEUE_SIZE];
+static CANTXQ_LAT_T s_asLat[4];
+static CANTXQ_T s_sQ;
+
+uint64_t TSTAMP_Get(void)
+{
+    return s_u32Now;
+}
+
+static int32_t Queue_Frame(uint32_t u32Ident)
+{
+    STR_CANMSG_T sMsg = s_asIdent[u32Ident];
+    int32_t i32Ret;
+
+    memcpy(sMsg.Data, &s_u32Serial, 4);
+    sMsg.Data[4] = (uint8_t)u32Ident;
+    i32Ret = CANTXQ_Send(&s_sQ, &sMsg);
+    if(i32Ret == 0)
+    {
+        s_asFrame[s_u32Serial].u32Key = CANTXQ_Key(&sMsg);
+        s_asFrame[s_u32Serial].u32Sent = 0;
+        s_au32Wait[s_u32WaitCnt++] = s_u32Serial++;
+        g_asHostCan[0].u32Time = s_u32Serial;
+    }
+
+    return i32Ret;
+}
+
+/* Send one frame on the bus and run the interrupt, returns 1 on an ordering error */
+static uint32_t Bus_Step(void)
+{
+    STR_CANMSG_T sMsg;
+    uint32_t u32Serial, u32Load, u32Key, i, u32Bad = 0;
+    int32_t i32Obj;
+
+    i32Obj = HostCan_Transmit(CAN0, &sMsg);
+    if(i32Obj < 0)
+        return 0;
+
+    memcpy(&u32Serial, sMsg.Data, 4);
+    u32Key = s_asFrame[u32Serial].u32Key;
+    u32Load = g_asHostCan[0].asObj[i32Obj].u32LoadTime;
+    HOST_CHECK(u32Key == CANTXQ_Key((STR_CANMSG_T *)&s_asIdent[sMsg.Data[4]]));
+
+    /* Frames queued before this one was loaded that had to go first */
+    for(i = 0; i < s_u32WaitCnt; i++)
+    {
+        uint32_t u32Other = s_au32Wait[i];
+
+        if((u32Other < u32Load) && (u32Other != u32Serial) &&
+                ((s_asFrame[u32Other].u32Key < u32Key) || ((s_asFrame[u32Other].u32Key == u32Key) && (u32Other < u32Serial))))
+            u32Bad = 1;
+    }
+
+    for(i = 0; s_au32Wait[i] != u32Serial; i++);
+    s_au32Wait[i] = s_au32Wait[--s_u32WaitCnt];
+    HOST_CHECK(s_asFrame[u32Serial].u32Sent == 0);
+    s_asFrame[u32Serial].u32Sent = 1;
+    s_u32Sent++;
+
+    HOST_CHECK(CANTXQ_IRQHandler(&s_sQ, (uint32_t)i32Obj) == 1);
+    HOST_CHECK((g_asHostCan[0].asObj[i32Obj].u32Mcon & CAN_IF_MCON_INTPND_Msk) == 0);
+    HOST_CHECK((CAN0->IF[0].CREQ.u32Val & CAN_IF_CREQ_BUSY_Msk) == 0);
+    HOST_CHECK(__get_PRIMASK() == 0);
+
+    return u32Bad;
+}
+
+static void Run_Pool(uint32_t u32ObjCount)
+{
+    uint32_t u32Step, u32Bad = 0, u32Full = 0, u32Burst, i, u32Frames = 0;
+
+    HostCan_Reset();
+    s_u32Serial = 0;
+    s_u32Sent = 0;
+    s_u32WaitCnt = 0;
+
+    HOST_CHECK(CANTXQ_Open(&s_sQ, CAN0, FIRST_OBJ, u32ObjCount, s_asBuf, QUEUE_SIZE) == 0);
+    CANTXQ_SetLatencyTable(&s_sQ, s_asLat, 4);
+
+    for(u32Step = 0; u32Step < STEPS; u32Step++)
+    {
+        s_u32Now += 1 + (uint32_t)rand() % 200;
+
+        /* Bursts, with phases where the traffic is more than the bus can take */
+        if((rand() % (((u32Step / 1000) & 1) ? 3 : 6)) == 0)
+        {
+            u32Burst = 1 + (uint32_t)rand() % 6;
+            for(i = 0; i < u32Burst; i++)
+            {
+                if(Queue_Frame((uint32_t)rand() % IDENT_CNT) == CANTXQ_ERR_FULL)
+                    u32Full++;
+            }
+        }
+        else
+        {
+            u32Bad += Bus_Step();
+        }
+    }
+    while(CANTXQ_GET_PENDING(&s_sQ))
+        u32Bad += Bus_Step();
+
+    HOST_CHECK(u32Bad == 0);
+    HOST_CHECK(s_u32WaitCnt == 0);
+    HOST_CHECK(HostCan_Transmit(CAN0, NULL) == -1);
+    HOST_CHECK(g_asHostCan[0].u32Unmasked == 0);
+    HOST_CHECK(g_asHostCan[0].u32BusyWrites == 0);
+
+    /* Statistics */
+    HOST_CHECK(u32Full > 0);
+    HOST_CHECK(s_sQ.sStat.u32Full == u32Full);
+    HOST_CHECK((s_sQ.sStat.u32Queued == s_u32Serial) && (s_sQ.sStat.u32Sent == s_u32Sent));
+    HOST_CHECK(s_sQ.sStat.u32QueueHigh == QUEUE_SIZE);
+    for(i = 0; i < 4; i++)
+    {
+        u32Frames += s_asLat[i].u32Frames;
+        HOST_CHECK(s_asLat[i].u32MaxUs * s_asLat[i].u32Frames >= s_asLat[i].u32TotalUs);
+    }
+    HOST_CHECK(s_sQ.sStat.u32Untracked > 0);
+    HOST_CHECK(u32Frames + s_sQ.sStat.u32Untracked == s_u32Sent);
+
+    printf("test_can_txq: %u objects, %u frames, %u refused\n", (unsigned)u32ObjCount, (unsigned)s_u32Sent,
+           (unsigned)u32Full);
+
+    CANTXQ_Close(&s_sQ);
+    HOST_CHECK(CANTXQ_GET_PENDING(&s_sQ) == 0);
+}
+
+int main(void)
+{
+    srand(1311);
+
+    HostCan_Reset();
+    HOST_CHECK(CANTXQ_Open(&s_sQ, CAN0, 30, 3, s_asBuf, QUEUE_SIZE) == CANTXQ_ERR_PARAM);
+    HOST_CHECK(CANTXQ_Open(&s_sQ, CAN0, 0, CANTXQ_MAX_OBJ + 1, s_asBuf, QUEUE_SIZE) == CANTXQ_ERR_PARAM);
+    HOST_CHECK(CANTXQ_IRQHandler(&s_sQ, 0) == 0);
+
+    Run_Pool(1);
+    Run_Pool(3);
+    Run_Pool(CANTXQ_MAX_OBJ);
+
+    printf("test_can_txq: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,385 @@
+/**************************************************************************//**
+ * @file     test_isotp.cpp
+ * @version  V3.00
+ * @brief    ISO-TP transport test on two CAN modules of the CAN model joined by a bus
+ *
+ * @note     Link A on CAN0 and link B on CAN1 talk through the model bus, one frame per tick of the
+ *           software timer. The interrupts go through CAN_IRQDispatch(). Checked: every message length
+ *           without flow limits, block size and separation times, full duplex, overflow, lost frames
+ *           (N_Bs, N_Cr, sequence error), extended identifiers and a peer that never acknowledges
+ *           (N_As, N_Ar). The interface is idle and the CPU unmasked whenever a handler returns.
+ *           The software timer service is replaced by a list of timers run on the tick of the test.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NUC1311.h"
+#include "../../StdDriver/src/isotp.c"
+
+#define TICK_FREQ       10000           /* 100 us per tick, about one 8-byte frame at 1 Mbps */
+#define TIMER_MAX       8
+#define NODE_A          0
+#define NODE_B          1
+
+static SWTIMER_T *s_apsTmr[TIMER_MAX];
+static uint32_t s_u32Now;
+
+static ISOTP_T s_sA, s_sB;
+static uint8_t s_au8RxA[ISOTP_MAX_LEN], s_au8RxB[ISOTP_MAX_LEN];
+static uint8_t s_au8TxA[ISOTP_MAX_LEN], s_au8TxB[ISOTP_MAX_LEN];
+static int32_t s_i32ResA, s_i32ResB, s_i32GotA, s_i32GotB;
+
+static uint32_t s_u32Frames;            /* Frames on the bus */
+static uint32_t s_u32Drop;              /* Frame on the bus not received, 1 for the first, 0 for none */
+static uint32_t s_au32Deaf[2];          /* 1 if the frames of the node are not acknowledged */
+static uint32_t s_u32LastCf, s_u32MinGap;   /* Spacing of the consecutive frames of A */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Software timer service of the test                                                                     */
+/*---------------------------------------------------------------------------------------------------------*/
+int32_t SWTIMER_Start(SWTIMER_T *psTmr, uint32_t u32Ticks, uint32_t u32Period, SWTIMER_FUNC_T pfnFunc, void *pvArg)
+{
+    uint32_t i;
+
+    HOST_CHECK((u32Ticks > 0) && (u32Period == 0));
+
+    SWTIMER_Stop(psTmr);
+    psTmr->u32Expire = s_u32Now + u32Ticks;
+    psTmr->pfnFunc = pfnFunc;
+    psTmr->pvArg = pvArg;
+    psTmr->u8Active = 1;
+
+    for(i = 0; s_apsTmr[i] != NULL; i++);
+    s_apsTmr[i] = psTmr;
+
+    return 0;
+}
+
+void SWTIMER_Stop(SWTIMER_T *psTmr)
+{
+    uint32_t i;
+
+    psTmr->u8Active = 0;
+    for(i = 0; i < TIMER_MAX; i++)
+    {
+        if(s_apsTmr[i] == psTmr)
+            s_apsTmr[i] = NULL;
+    }
+}
+
+static uint32_t Timer_Count(void)
+{
+    uint32_t i, u32Cnt = 0;
+
+    for(i = 0; i < TIMER_MAX; i++)
+        u32Cnt += (s_apsTmr[i] != NULL);
+
+    return u32Cnt;
+}
+
+static void Timer_Run(void)
+{
+    SWTIMER_T *psTmr;
+    uint32_t i;
+
+    for(i = 0; i < TIMER_MAX; i++)
+    {
+        psTmr = s_apsTmr[i];
+        if((psTmr != NULL) && ((int32_t)(s_u32Now - psTmr->u32Expire) >= 0))
+        {
+            s_apsTmr[i] = NULL;
+            psTmr->u8Active = 0;
+            psTmr->pfnFunc(psTmr->pvArg);
+            HOST_CHECK(__get_PRIMASK() == 0);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Links                                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+static void Link_RxA(ISOTP_T *psLink, uint8_t *pu8Data, int32_t i32Len)
+{
+    (void)psLink;
+    s_i32GotA = i32Len;
+    if((i32Len > 0) && ((pu8Data != s_au8RxA) || memcmp(pu8Data, s_au8TxB, (size_t)i32Len)))
+        s_i32GotA = -100;
+}
+
+static void Link_RxB(ISOTP_T *psLink, uint8_t *pu8Data, int32_t i32Len)
+{
+    (void)psLink;
+    s_i32GotB = i32Len;
+    if((i32Len > 0) && ((pu8Data != s_au8RxB) || memcmp(pu8Data, s_au8TxA, (size_t)i32Len)))
+        s_i32GotB = -100;
+}
+
+static void Link_DoneA(ISOTP_T *psLink, int32_t i32Result)
+{
+    (void)psLink;
+    s_i32ResA = i32Result;
+}
+
+static void Link_DoneB(ISOTP_T *psLink, int32_t i32Result)
+{
+    (void)psLink;
+    s_i32ResB = i32Result;
+}
+
+static void Link_Interrupt(CAN_T *tCAN, uint32_t u32MsgNum, void *pvArg)
+{
+    (void)tCAN;
+    HOST_CHECK(ISOTP_IRQHandler((ISOTP_T *)pvArg, u32MsgNum) == 1);
+}
+
+static void Link_Install(ISOTP_T *psLink)
+{
+    CAN_InstallMsgHandler(psLink->tCAN, psLink->u8TxObj, Link_Interrupt, psLink);
+    CAN_InstallMsgHandler(psLink->tCAN, psLink->u8RxObj, Link_Interrupt, psLink);
+}
+
+static void Link_Setup(uint32_t u32IdType, uint32_t u32BlockSize, uint32_t u32STmin, uint32_t u32SizeB)
+{
+    uint32_t i;
+
+    /* Counted over the test before: the model is reset for each case */
+    HOST_CHECK(g_asHostCan[0].u32Unmasked + g_asHostCan[1].u32Unmasked == 0);
+    HOST_CHECK(g_asHostCan[0].u32BusyWrites + g_asHostCan[1].u32BusyWrites == 0);
+
+    HostCan_Reset();
+    for(i = 0; i < TIMER_MAX; i++)
+        s_apsTmr[i] = NULL;
+    for(i = 0; i < 32; i++)
+    {
+        CAN_InstallMsgHandler(CAN0, i, NULL, NULL);
+        CAN_InstallMsgHandler(CAN1, i, NULL, NULL);
+    }
+
+    if(u32IdType == CAN_STD_ID)
+    {
+        HOST_CHECK(ISOTP_Open(&s_sA, CAN0, 0, 1, CAN_STD_ID, 0x7E0, 0x7E8, TICK_FREQ) == 0);
+        HOST_CHECK(ISOTP_Open(&s_sB, CAN1, 0, 1, CAN_STD_ID, 0x7E8, 0x7E0, TICK_FREQ) == 0);
+    }
+    else
+    {
+        HOST_CHECK(ISOTP_Open(&s_sA, CAN0, 3, 2, CAN_EXT_ID, 0x18DA10F1, 0x18DAF110, TICK_FREQ) == 0);
+        HOST_CHECK(ISOTP_Open(&s_sB, CAN1, 5, 4, CAN_EXT_ID, 0x18DAF110, 0x18DA10F1, TICK_FREQ) == 0);
+    }
+    Link_Install(&s_sA);
+    Link_Install(&s_sB);
+    ISOTP_SetRxBuffer(&s_sA, s_au8RxA, sizeof(s_au8RxA), Link_RxA);
+    ISOTP_SetRxBuffer(&s_sB, s_au8RxB, u32SizeB, Link_RxB);
+    ISOTP_SetFlowControl(&s_sB, u32BlockSize, u32STmin);
+
+    s_i32ResA = s_i32ResB = s_i32GotA = s_i32GotB = 1234;
+    s_u32Frames = 0;
+    s_u32Drop = 0;
+    s_au32Deaf[NODE_A] = s_au32Deaf[NODE_B] = 0;
+    s_u32LastCf = 0;
+    s_u32MinGap = 0xFFFFFFFF;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Bus                                                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+static void Bus_Dispatch(CAN_T *tCAN)
+{
+    CAN_IRQDispatch(tCAN);
+    HOST_CHECK(__get_PRIMASK() == 0);
+    HOST_CHECK((tCAN->IF[0].CREQ.u32Val & CAN_IF_CREQ_BUSY_Msk) == 0);
+    HOST_CHECK((tCAN->IF[1].CREQ.u32Val & CAN_IF_CREQ_BUSY_Msk) == 0);
+}
+
+/* One tick: timers, then at most one frame on the bus, the nodes taking turns. Returns 0 once all is idle. */
+static uint32_t Bus_Step(void)
+{
+    static CAN_T *const atCAN[2] = {CAN0, CAN1};
+    STR_CANMSG_T sMsg;
+    uint32_t u32Node, i;
+
+    s_u32Now++;
+    Timer_Run();
+
+    for(i = 0; i < 2; i++)
+    {
+        u32Node = (s_u32Now + i) & 1;
+        if(s_au32Deaf[u32Node] || (HostCan_Transmit(atCAN[u32Node], &sMsg) < 0))
+            continue;
+
+        s_u32Frames++;
+        if((u32Node == NODE_A) && ((sMsg.Data[0] & 0xF0) == 0x20))
+        {
+            if(s_u32LastCf && (s_u32Now - s_u32LastCf < s_u32MinGap))
+                s_u32MinGap = s_u32Now - s_u32LastCf;
+            s_u32LastCf = s_u32Now;
+        }
+        HOST_CHECK(sMsg.DLC == 8);
+        if(s_u32Frames != s_u32Drop)
+            HOST_CHECK(HostCan_Receive(atCAN[u32Node ^ 1], &sMsg) >= 0);
+
+        Bus_Dispatch(atCAN[u32Node]);
+        Bus_Dispatch(atCAN[u32Node ^ 1]);
+        return 1;
+    }
+
+    return Timer_Count() != 0;
+}
+
+static uint32_t Bus_Run(void)
+{
+    uint32_t u32Start = s_u32Now;
+
+    while(Bus_Step());
+
+    return s_u32Now - u32Start;
+}
+
+/* Frames of a message of u32Len bytes, flow controls included */
+static uint32_t Frame_Count(uint32_t u32Len, uint32_t u32BlockSize)
+{
+    uint32_t u32Cf;
+
+    if(u32Len <= 7)
+        return 1;
+
+    u32Cf = (u32Len - 6 + 6) / 7;
+
+    return 2 + u32Cf + (u32BlockSize ? (u32Cf - 1) / u32BlockSize : 0);
+}
+
+int main(void)
+{
+    uint32_t i, u32Len, u32Ticks, u32Bad = 0;
+
+    srand(1311);
+    for(i = 0; i < ISOTP_MAX_LEN; i++)
+    {
+        s_au8TxA[i] = (uint8_t)rand();
+        s_au8TxB[i] = (uint8_t)rand();
+    }
+
+    HostCan_Reset();
+    HOST_CHECK(ISOTP_Open(&s_sA, CAN0, 3, 3, CAN_STD_ID, 0x7E0, 0x7E8, TICK_FREQ) == ISOTP_ERR_PARAM);
+    HOST_CHECK(ISOTP_Open(&s_sA, CAN0, 0, 1, CAN_STD_ID + 2, 0x7E0, 0x7E8, TICK_FREQ) == ISOTP_ERR_PARAM);
+
+    /* Every length, no flow limits */
+    for(u32Len = 1; u32Len <= ISOTP_MAX_LEN; u32Len += (u32Len < 300) ? 1 : 97)
+    {
+        Link_Setup(CAN_STD_ID, 0, 0, ISOTP_MAX_LEN);
+        HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, u32Len, Link_DoneA) == 0);
+        Bus_Run();
+        if((s_i32ResA != 0) || (s_i32GotB != (int32_t)u32Len) || (s_u32Frames != Frame_Count(u32Len, 0)))
+        {
+            if(u32Bad++ < 10)
+                printf("length %u: result %d, received %d, %u frames\n", (unsigned)u32Len, (int)s_i32ResA,
+                       (int)s_i32GotB, (unsigned)s_u32Frames);
+        }
+    }
+    HOST_CHECK(u32Bad == 0);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 0, Link_DoneA) == ISOTP_ERR_PARAM);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, ISOTP_MAX_LEN + 1, Link_DoneA) == ISOTP_ERR_PARAM);
+
+    /* Block size 3 and 5 ms between consecutive frames, also before the first of a block */
+    Link_Setup(CAN_STD_ID, 3, 5, ISOTP_MAX_LEN);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 1000, Link_DoneA) == 0);
+    u32Ticks = Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32GotB == 1000));
+    HOST_CHECK(s_u32Frames == Frame_Count(1000, 3));
+    HOST_CHECK(s_u32MinGap >= 5 * TICK_FREQ / 1000);
+    HOST_CHECK(u32Ticks >= 142 * 5 * TICK_FREQ / 1000);
+
+    /* 300 us */
+    Link_Setup(CAN_STD_ID, 0, 0xF3, ISOTP_MAX_LEN);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 100, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32GotB == 100));
+    HOST_CHECK((s_u32MinGap >= 3) && (s_u32MinGap <= 5));
+
+    /* Full duplex, the flow controls of each side share the TX object with its consecutive frames */
+    Link_Setup(CAN_STD_ID, 2, 0, ISOTP_MAX_LEN);
+    ISOTP_SetFlowControl(&s_sA, 1, 0);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, ISOTP_MAX_LEN, Link_DoneA) == 0);
+    HOST_CHECK(ISOTP_Send(&s_sB, s_au8TxB, 3000, Link_DoneB) == 0);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 10, Link_DoneA) == ISOTP_ERR_BUSY);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32ResB == 0));
+    HOST_CHECK((s_i32GotA == 3000) && (s_i32GotB == ISOTP_MAX_LEN));
+    HOST_CHECK(s_u32Frames == Frame_Count(ISOTP_MAX_LEN, 2) + Frame_Count(3000, 1));
+
+    /* Larger than the receive buffer */
+    Link_Setup(CAN_STD_ID, 0, 0, 100);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 200, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == ISOTP_ERR_OVERFLOW) && (s_i32GotB == ISOTP_ERR_OVERFLOW));
+
+    /* Second consecutive frame lost */
+    Link_Setup(CAN_STD_ID, 0, 0, ISOTP_MAX_LEN);
+    s_u32Drop = 4;
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 100, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32GotB == ISOTP_ERR_SEQ));
+
+    /* Flow control lost: N_Bs at the sender, N_Cr at the receiver */
+    Link_Setup(CAN_STD_ID, 0, 0, ISOTP_MAX_LEN);
+    s_u32Drop = 2;
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 100, Link_DoneA) == 0);
+    u32Ticks = Bus_Run();
+    HOST_CHECK((s_i32ResA == ISOTP_ERR_TIMEOUT) && (s_i32GotB == ISOTP_ERR_TIMEOUT));
+    HOST_CHECK(u32Ticks >= ISOTP_TIMEOUT_MS * TICK_FREQ / 1000);
+
+    /* Last consecutive frame lost: N_Cr */
+    Link_Setup(CAN_STD_ID, 0, 0, ISOTP_MAX_LEN);
+    s_u32Drop = Frame_Count(100, 0);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 100, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32GotB == ISOTP_ERR_TIMEOUT));
+
+    /* Extended identifiers */
+    Link_Setup(CAN_EXT_ID, 8, 1, ISOTP_MAX_LEN);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 777, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32GotB == 777));
+
+    /* No acknowledge for A: N_As withdraws the frame, the link sends again once the bus is back */
+    Link_Setup(CAN_STD_ID, 0, 0, ISOTP_MAX_LEN);
+    s_au32Deaf[NODE_A] = 1;
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 5, Link_DoneA) == 0);
+    u32Ticks = Bus_Run();
+    HOST_CHECK(s_i32ResA == ISOTP_ERR_TIMEOUT);
+    HOST_CHECK(u32Ticks >= ISOTP_TIMEOUT_MS * TICK_FREQ / 1000);
+    HOST_CHECK((g_asHostCan[0].asObj[0].u32Mcon & CAN_IF_MCON_TXRQST_Msk) == 0);
+    HOST_CHECK(!ISOTP_IS_TX_BUSY(&s_sA));
+    s_au32Deaf[NODE_A] = 0;
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 50, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32GotB == 50));
+
+    /* No acknowledge for B: its flow control is withdrawn (N_Ar) and the reception ends */
+    Link_Setup(CAN_STD_ID, 0, 0, ISOTP_MAX_LEN);
+    s_au32Deaf[NODE_B] = 1;
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 100, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == ISOTP_ERR_TIMEOUT) && (s_i32GotB == ISOTP_ERR_TIMEOUT));
+    HOST_CHECK((g_asHostCan[1].asObj[0].u32Mcon & CAN_IF_MCON_TXRQST_Msk) == 0);
+    s_au32Deaf[NODE_B] = 0;
+    HOST_CHECK(ISOTP_Send(&s_sB, s_au8TxB, 100, Link_DoneB) == 0);
+    HOST_CHECK(ISOTP_Send(&s_sA, s_au8TxA, 100, Link_DoneA) == 0);
+    Bus_Run();
+    HOST_CHECK((s_i32ResA == 0) && (s_i32ResB == 0) && (s_i32GotA == 100) && (s_i32GotB == 100));
+
+    ISOTP_Close(&s_sA);
+    ISOTP_Close(&s_sB);
+    HOST_CHECK(Timer_Count() == 0);
+
+    HOST_CHECK(g_asHostCan[0].u32Unmasked + g_asHostCan[1].u32Unmasked == 0);
+    HOST_CHECK(g_asHostCan[0].u32BusyWrites + g_asHostCan[1].u32BusyWrites == 0);
+
+    printf("test_isotp: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+# Delta update test: patches made by Tool/DeltaPatch/delta_gen.py for pairs of firmware-like images are
+# applied by test_delta_apply on the flash model, with power failures (HostTest/CMakeLists.txt).
+#
+#   python3 test_delta.py path/to/test_delta_apply
+#
+# The pairs cover the edits a rebuild makes: patched bytes, code inserted or removed (everything after it
+# shifts), a grown or shrunk image, sizes that are not a whole page, and an unrelated image.
+# SPDX-License-Identifier: Apache-2.0
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DELTA_GEN = os.path.join(HERE, '..', '..', '..', 'Tool', 'DeltaPatch', 'delta_gen.py')
+POWER_FAILS = 25
+
+
+def firmware(rng, size):
+    # Instruction-like halfwords with repeated sequences, as compiled code has
+    words = [rng.randrange(0x10000) for _ in range(64)]
+    out = bytearray()
+    while len(out) < size:
+        if rng.random() < 0.3 and len(out) > 64:
+            start = rng.randrange(len(out) - 32)
+            out += out[start:start + rng.randrange(8, 32)]
+        else:
+            out += rng.choice(words).to_bytes(2, 'little')
+    return bytes(out[:size])
+
+
+def patched(rng, old, count):
+    new = bytearray(old)
+    for _ in range(count):
+        offset = rng.randrange(len(new) - 4)
+        new[offset:offset + 4] = rng.randbytes(4)
+    return bytes(new)
+
+
+def cases(rng):
+    base = firmware(rng, 0x6000)
+    yield 'same', base, base
+    yield 'bytes', base, patched(rng, base, 12)
+    yield 'insert', base, base[:0x900] + firmware(rng, 100) + base[0x900:]
+    yield 'remove', base, base[:0x1234] + base[0x1234 + 300:]
+    yield 'insert_remove', base, base[:0x400] + firmware(rng, 37) + base[0x400:0x3000] + base[0x3200:]
+    yield 'grow', base, patched(rng, base, 3) + firmware(rng, 0x2345)
+    yield 'shrink', base, patched(rng, base[:0x4321], 3)
+    yield 'odd_size', base[:0x5FFD], patched(rng, base[:0x5FFD], 2) + b'\x01'
+    yield 'unrelated', base, firmware(rng, 0x5800)
+    large = firmware(rng, 0xD000)
+    yield 'large', large, patched(rng, large[:0x8000] + firmware(rng, 0x40) + large[0x8000:0xCF00], 20)
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.stderr.write('usage: %s test_delta_apply\n' % argv[0])
+        return 2
+
+    rng = random.Random(1311)
+    failed = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        old_bin, new_bin, patch_dlt = (os.path.join(tmp, name) for name in ('old.bin', 'new.bin', 'patch.dlt'))
+        for seed, (name, old, new) in enumerate(cases(rng)):
+            with open(old_bin, 'wb') as f:
+                f.write(old)
+            with open(new_bin, 'wb') as f:
+                f.write(new)
+
+            gen = subprocess.run([sys.executable, DELTA_GEN, old_bin, new_bin, patch_dlt],
+                                 capture_output=True, text=True)
+            run = None
+            if gen.returncode == 0:
+                run = subprocess.run([argv[1], old_bin, new_bin, patch_dlt, str(seed), str(POWER_FAILS)],
+                                     capture_output=True, text=True)
+
+            ok = gen.returncode == 0 and run.returncode == 0
+            failed += not ok
+            print('%-14s %s' % (name, gen.stdout.strip().split(': ')[-1]))
+            print('%s%s' % (run.stdout if run else '', '' if ok else 'FAIL %s\n' % (gen.stderr if run is None else
+                                                                                 'exit code %d' % run.returncode)))
+
+    print('test_delta: %s' % ('PASS' if failed == 0 else 'FAIL'))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
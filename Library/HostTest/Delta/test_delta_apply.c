@@ -0,0 +1,169 @@
+/**************************************************************************//**
+ * @file     test_delta_apply.c
+ * @version  V3.00
+ * @brief    Delta firmware update applier test on the flash model, run by test_delta.py
+ *
+ * @note     test_delta_apply old.bin new.bin patch.dlt seed power_fails
+ *
+ *           The patch is applied once in one piece without a power failure, which also counts the flash
+ *           operations, then again from the old image in random pieces with power failures at random
+ *           operations. After each failure the update
+ *           resumes from the offset DELTA_Open() returns, as after a reset. Both runs must leave the new
+ *           image in flash, write only the pages that change and remove the progress marker. Sent again,
+ *           the patch must be refused by the old image check.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NUC1311.h"
+#include "../../StdDriver/src/fwslot.c"
+#include "../../StdDriver/src/kvs.c"
+#include "../../StdDriver/src/delta.c"
+
+#define IMAGE_MAX       (FMC_DATA_FLASH_BASE - FMC_APROM_BASE)
+#define KVS_PAGES       6
+#define STAGE_ADDR      (FMC_DATA_FLASH_BASE + KVS_PAGES * FMC_FLASH_PAGE_SIZE)
+
+static uint8_t s_au8Old[IMAGE_MAX], s_au8New[IMAGE_MAX], s_au8Patch[0x20000];
+static uint32_t s_u32OldLen, s_u32NewLen, s_u32PatchLen;
+static uint8_t s_au8Init[HOST_FLASH_SIZE];
+
+static KVS_T s_sKvs;
+static KVS_ENTRY_T s_asIndex[8];
+static DELTA_T s_sDelta;
+static uint32_t s_u32Fails, s_u32Resets;
+
+static uint32_t File_Load(const char *pcName, uint8_t *pu8Buf, uint32_t u32Max)
+{
+    FILE *psFile = fopen(pcName, "rb");
+    uint32_t u32Len;
+
+    if(psFile == NULL)
+    {
+        printf("cannot open %s\n", pcName);
+        exit(2);
+    }
+    u32Len = (uint32_t)fread(pu8Buf, 1, u32Max, psFile);
+    fclose(psFile);
+
+    return u32Len;
+}
+
+/* Reset, open the store and the applier, and feed the rest of the patch in random pieces */
+static int32_t Sim_Apply(uint32_t u32Ops)
+{
+    int32_t i32Off, i32Ret;
+    uint32_t u32Len;
+
+    for(;;)
+    {
+        if(setjmp(g_sHostFlashJmp) != 0)
+        {
+            s_u32Resets++;
+            continue;
+        }
+
+        /* Within the operations a clean run would still need, the replayed ones make it an estimate */
+        if(s_u32Fails != 0)
+        {
+            s_u32Fails--;
+            HostFlash_PowerFail(rand() % (int32_t)((u32Ops > g_u32HostFlashOps) ? u32Ops - g_u32HostFlashOps : 1));
+        }
+
+        if(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 8) != 0)
+            return DELTA_ERR_MARKER;
+
+        i32Off = DELTA_Open(&s_sDelta, &s_sKvs, FMC_APROM_BASE, STAGE_ADDR);
+        if(i32Off < 0)
+            break;
+
+        do
+        {
+            u32Len = 1 + rand() % 300;
+            if((uint32_t)i32Off + u32Len > s_u32PatchLen)
+                u32Len = s_u32PatchLen - (uint32_t)i32Off;
+            i32Ret = DELTA_Feed(&s_sDelta, &s_au8Patch[i32Off], u32Len);
+            i32Off += (int32_t)u32Len;
+        }
+        while((i32Ret == 0) && ((uint32_t)i32Off < s_u32PatchLen));
+
+        HostFlash_PowerFail(HOST_FLASH_NO_FAIL);
+        return i32Ret;
+    }
+
+    HostFlash_PowerFail(HOST_FLASH_NO_FAIL);
+    return i32Off;
+}
+
+/* The new image in flash, nothing left of the update in the store */
+static void Check_Done(int32_t i32Ret)
+{
+    HOST_CHECK(i32Ret == DELTA_DONE);
+    HOST_CHECK(memcmp(HOST_FLASH_PTR(FMC_APROM_BASE), s_au8New, s_u32NewLen) == 0);
+    HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 8) == 0);
+    HOST_CHECK(DELTA_Open(&s_sDelta, &s_sKvs, FMC_APROM_BASE, STAGE_ADDR) == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t u32Ops, u32Changed, u32Page, u32Pages;
+    uint8_t au8Page[FMC_FLASH_PAGE_SIZE];
+    int32_t i32Ret;
+
+    if(argc != 6)
+    {
+        printf("usage: test_delta_apply old.bin new.bin patch.dlt seed power_fails\n");
+        return 2;
+    }
+
+    s_u32OldLen = File_Load(argv[1], s_au8Old, sizeof(s_au8Old));
+    s_u32NewLen = File_Load(argv[2], s_au8New, sizeof(s_au8New));
+    s_u32PatchLen = File_Load(argv[3], s_au8Patch, sizeof(s_au8Patch));
+    srand((unsigned)atoi(argv[4]));
+
+    HostFlash_Reset();
+    memcpy(HOST_FLASH_PTR(FMC_APROM_BASE), s_au8Old, s_u32OldLen);
+    memcpy(s_au8Init, HOST_FLASH_PTR(HOST_FLASH_BASE), sizeof(s_au8Init));
+
+    /* Pages whose content changes, the tail of the last new page reads erased */
+    u32Changed = 0;
+    u32Pages = (s_u32NewLen + FMC_FLASH_PAGE_SIZE - 1) / FMC_FLASH_PAGE_SIZE;
+    for(u32Page = 0; u32Page < s_u32NewLen; u32Page += FMC_FLASH_PAGE_SIZE)
+    {
+        memset(au8Page, 0xFF, sizeof(au8Page));
+        memcpy(au8Page, &s_au8New[u32Page], (s_u32NewLen - u32Page < FMC_FLASH_PAGE_SIZE) ? s_u32NewLen - u32Page : FMC_FLASH_PAGE_SIZE);
+        if(memcmp(au8Page, HOST_FLASH_PTR(FMC_APROM_BASE + u32Page), sizeof(au8Page)) != 0)
+            u32Changed++;
+    }
+
+    /* A clean run writes each changed page once and skips the others */
+    HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 8) == 0);
+    HOST_CHECK(DELTA_Open(&s_sDelta, &s_sKvs, FMC_APROM_BASE, STAGE_ADDR) == 0);
+    g_u32HostFlashOps = 0;
+    i32Ret = DELTA_Feed(&s_sDelta, s_au8Patch, s_u32PatchLen);
+    u32Ops = g_u32HostFlashOps + 1;
+    HOST_CHECK(s_sDelta.u32Pages == u32Changed);
+    HOST_CHECK(s_sDelta.u32Pages + s_sDelta.u32Skipped == u32Pages);
+    Check_Done(i32Ret);
+
+    /* Power failures anywhere in the update */
+    memcpy(HOST_FLASH_PTR(HOST_FLASH_BASE), s_au8Init, sizeof(s_au8Init));
+    s_u32Fails = (uint32_t)atoi(argv[5]);
+    g_u32HostFlashOps = 0;
+    Check_Done(Sim_Apply(u32Ops));
+
+    /* Sent again, the patch is refused before a page is touched, unless flash still starts with the old image */
+    i32Ret = (memcmp(HOST_FLASH_PTR(FMC_APROM_BASE), s_au8Old, s_u32OldLen) == 0) ? DELTA_DONE : DELTA_ERR_OLD_IMAGE;
+    HOST_CHECK(DELTA_Feed(&s_sDelta, s_au8Patch, s_u32PatchLen) == i32Ret);
+    HOST_CHECK(memcmp(HOST_FLASH_PTR(FMC_APROM_BASE), s_au8New, s_u32NewLen) == 0);
+
+    printf("test_delta_apply: %u of %u pages, %u resets, %s\n", (unsigned)u32Changed, (unsigned)u32Pages,
+           (unsigned)s_u32Resets, (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
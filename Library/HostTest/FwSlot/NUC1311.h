@@ -0,0 +1,27 @@
+/**************************************************************************//**
+ * @file     NUC1311.h
+ * @version  V3.00
+ * @brief    Flash model for test_fwslot
+ *
+ * @note     Flash and FMC are the model of Include/host_flash.h.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUC1311_H__
+#define __NUC1311_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core_cm0.h"
+#include "host_reg.h"
+#include "host_flash.h"
+
+typedef volatile uint32_t vu32;
+
+#define M32(addr)               (*((vu32 *)(uintptr_t)(addr)))
+
+#endif /* __NUC1311_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
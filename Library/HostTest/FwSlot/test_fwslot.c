@@ -0,0 +1,177 @@
+/**************************************************************************//**
+ * @file     test_fwslot.c
+ * @version  V3.00
+ * @brief    A/B firmware slot manager test on a simulated APROM and data flash
+ *
+ * @note     Every round the running image writes and commits the other slot, and FWSLOT_Boot() is run
+ *           as the LDROM selector would at each reset. Some new images confirm themselves, the others
+ *           must be dropped after FWSLOT_TRIAL_BOOTS boots. The rounds wrap the two record pages many
+ *           times. Also checked: the slots are locked while the record is on trial, bad CRC and vector
+ *           tables are refused, and a record cut short by a power failure never takes effect.
+ *           Flash and FMC are the model of Include/host_flash.h.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "NUC1311.h"
+
+/* The slots start at the flash address of the model */
+#define FWSLOT_A_BASE   FMC_APROM_BASE
+
+#include "../../StdDriver/src/fwslot.c"
+
+static uint32_t s_au32Img[FWSLOT_SLOT_SIZE / 4];
+
+/* Image linked for a slot: stack pointer, reset vector in the slot and a body that depends on the seed */
+static uint32_t Image_Build(uint32_t u32Slot, uint32_t u32Seed, uint32_t u32Size)
+{
+    uint32_t i;
+
+    s_au32Img[0] = 0x20001000;
+    s_au32Img[1] = (FWSLOT_GET_BASE(u32Slot) + 0x101) | 1;
+    for(i = 2; i < u32Size / 4; i++)
+        s_au32Img[i] = (i + u32Seed) * 2654435761UL;
+
+    return FWSLOT_CRC32(s_au32Img, u32Size, 0);
+}
+
+/* Write the image in pieces as a download would, returns the first error */
+static int32_t Image_Write(uint32_t u32Size)
+{
+    uint32_t u32Off, u32Len;
+    int32_t i32Ret;
+
+    for(u32Off = 0; u32Off < u32Size; u32Off += u32Len)
+    {
+        u32Len = (u32Size - u32Off < 0x180) ? u32Size - u32Off : 0x180;
+        i32Ret = FWSLOT_Write(u32Off, &s_au32Img[u32Off / 4], u32Len);
+        if(i32Ret != 0)
+            return i32Ret;
+    }
+    return 0;
+}
+
+/* One reset through the LDROM selector, returns the slot booted */
+static uint32_t Sim_Reset(void)
+{
+    uint32_t u32Reset = g_u32HostReset;
+
+    HOST_CHECK(FWSLOT_Boot() == 0);
+    HOST_CHECK(g_u32HostReset == u32Reset + 1);
+    __set_PRIMASK(0);
+
+    return FWSLOT_GetActive();
+}
+
+int main(void)
+{
+    FWSLOT_REC_T sRec, sPrev;
+    uint32_t u32Round, u32Boot, u32Other, u32Size, u32Crc, u32Confirm, u32Slot;
+    uint32_t au32Save[FWSLOT_SLOT_SIZE / 4];
+
+    HostFlash_Reset();
+
+    /* Known value of CRC-32/ISO-HDLC */
+    HOST_CHECK(FWSLOT_CRC32("123456789", 9, 0) == 0xCBF43926);
+
+    /* No record yet: slot A confirmed, booted if valid */
+    HOST_CHECK(FWSLOT_ReadRecord(&sRec) == 0);
+    HOST_CHECK((sRec.u32Seq == 0) && (sRec.u8Slot == FWSLOT_A) && (sRec.u8State == FWSLOT_STATE_CONFIRMED));
+    HOST_CHECK(FWSLOT_Boot() == FWSLOT_ERR_IMAGE);
+    Image_Build(FWSLOT_A, 0, 0x1000);
+    memcpy(HOST_FLASH_PTR(FWSLOT_A_BASE), s_au32Img, 0x1000);
+    HOST_CHECK(Sim_Reset() == FWSLOT_A);
+
+    for(u32Round = 0; u32Round < 60; u32Round++)
+    {
+        u32Other = FWSLOT_GetActive() ^ 1;
+        u32Size = FWSLOT_SLOT_SIZE - 0x20 * u32Round - 4 * (u32Round & 3);
+        u32Crc = Image_Build(u32Other, u32Round + 1, u32Size);
+        u32Confirm = (u32Round % 3) != 0;
+
+        HOST_CHECK(Image_Write(u32Size) == 0);
+        HOST_CHECK(FWSLOT_Commit(u32Size, u32Crc ^ 1) == FWSLOT_ERR_CRC);
+        HOST_CHECK(FWSLOT_Commit(u32Size, u32Crc) == 0);
+        HOST_CHECK(memcmp(HOST_FLASH_PTR(FWSLOT_GET_BASE(u32Other)), s_au32Img, u32Size) == 0);
+
+        /* Until the new image is confirmed, the slot of the running image is the fall back */
+        HOST_CHECK(FWSLOT_Write(0, s_au32Img, 0x200) == FWSLOT_ERR_STATE);
+        HOST_CHECK(FWSLOT_Commit(u32Size, u32Crc) == FWSLOT_ERR_STATE);
+
+        for(u32Boot = 0; u32Boot < FWSLOT_TRIAL_BOOTS + 2; u32Boot++)
+        {
+            u32Slot = Sim_Reset();
+            if((u32Slot == u32Other) && u32Confirm)
+            {
+                HOST_CHECK(FWSLOT_Confirm() == 0);
+                HOST_CHECK(FWSLOT_Confirm() == 0);
+            }
+            else if(u32Slot == u32Other)
+            {
+                /* A trial image cannot overwrite the image it falls back to */
+                memcpy(au32Save, HOST_FLASH_PTR(FWSLOT_GET_BASE(u32Other ^ 1)), sizeof(au32Save));
+                HOST_CHECK(Image_Write(0x400) == FWSLOT_ERR_STATE);
+                HOST_CHECK(memcmp(au32Save, HOST_FLASH_PTR(FWSLOT_GET_BASE(u32Other ^ 1)), sizeof(au32Save)) == 0);
+                HOST_CHECK(u32Boot < FWSLOT_TRIAL_BOOTS);
+            }
+        }
+
+        FWSLOT_ReadRecord(&sRec);
+        HOST_CHECK(FWSLOT_GetActive() == (u32Confirm ? u32Other : (u32Other ^ 1)));
+        HOST_CHECK(sRec.u8Slot == FWSLOT_GetActive());
+        HOST_CHECK(sRec.u8State == FWSLOT_STATE_CONFIRMED);
+        if(u32Confirm)
+            HOST_CHECK((sRec.u32Size == u32Size) && (sRec.u32Crc == u32Crc));
+
+        /* The fall back image confirms nothing */
+        if(!u32Confirm)
+            HOST_CHECK(FWSLOT_Confirm() == 0);
+    }
+    HOST_CHECK(sRec.u32Seq > 2 * FMC_FLASH_PAGE_SIZE / FWSLOT_REC_SIZE);
+
+    /* A vector table that does not belong to the slot is refused */
+    u32Other = FWSLOT_GetActive() ^ 1;
+    u32Crc = Image_Build(u32Other ^ 1, 99, 0x800);
+    HOST_CHECK(Image_Write(0x800) == 0);
+    HOST_CHECK(FWSLOT_Commit(0x800, u32Crc) == FWSLOT_ERR_IMAGE);
+    HOST_CHECK(FWSLOT_Commit(0, u32Crc) == FWSLOT_ERR_PARAM);
+    HOST_CHECK(FWSLOT_Write(2, s_au32Img, 4) == FWSLOT_ERR_PARAM);
+    HOST_CHECK(FWSLOT_Write(FWSLOT_SLOT_SIZE - 4, s_au32Img, 8) == FWSLOT_ERR_PARAM);
+
+    /* Power failure at every word of a record append: the previous record stays in effect */
+    u32Crc = Image_Build(u32Other, 100, 0x800);
+    HOST_CHECK(Image_Write(0x800) == 0);
+    FWSLOT_ReadRecord(&sPrev);
+    for(u32Boot = 0; u32Boot < FWSLOT_REC_SIZE / 4; u32Boot++)
+    {
+        if(setjmp(g_sHostFlashJmp) == 0)
+        {
+            HostFlash_PowerFail((int32_t)u32Boot);
+            FWSLOT_Commit(0x800, u32Crc);
+            HOST_CHECK(0);
+        }
+        HostFlash_PowerFail(HOST_FLASH_NO_FAIL);
+        FWSLOT_ReadRecord(&sRec);
+        HOST_CHECK(memcmp(&sRec, &sPrev, sizeof(sRec)) == 0);
+        HOST_CHECK(Sim_Reset() == sPrev.u8Slot);
+        FWSLOT_ReadRecord(&sRec);
+        HOST_CHECK(sRec.u32Seq == sPrev.u32Seq);
+    }
+    HOST_CHECK(FWSLOT_Commit(0x800, u32Crc) == 0);
+    HOST_CHECK(Sim_Reset() == u32Other);
+    HOST_CHECK(FWSLOT_Confirm() == 0);
+
+    /* Neither slot valid: the selector stays in LDROM */
+    memset(HOST_FLASH_PTR(FWSLOT_A_BASE), 0xFF, 2 * FWSLOT_SLOT_SIZE);
+    u32Boot = g_u32HostReset;
+    HOST_CHECK(FWSLOT_Boot() == FWSLOT_ERR_IMAGE);
+    HOST_CHECK(g_u32HostReset == u32Boot);
+
+    printf("test_fwslot: %u records, %s\n", (unsigned)sRec.u32Seq, (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,42 @@
+/**************************************************************************//**
+ * @file     NUC1311.h
+ * @version  V3.00
+ * @brief    GPIO register model for test_gpio_bus
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUC1311_H__
+#define __NUC1311_H__
+
+#include "host_model.h"
+
+typedef struct
+{
+    HOST_REG_T PMD;
+    HOST_REG_T OFFD;
+    HOST_REG_T DOUT;
+    HOST_REG_T DMASK;
+    HOST_REG_T PIN;
+    HOST_REG_T DBEN;
+    HOST_REG_T IMD;
+    HOST_REG_T IEN;
+    HOST_REG_T ISRC;
+} GPIO_T;
+
+#define GPIO_PIN_MAX    16
+
+extern GPIO_T g_asHostPort[6];
+extern uint32_t SystemCoreClock;
+
+#define PA              (&g_asHostPort[0])
+#define PB              (&g_asHostPort[1])
+#define PC              (&g_asHostPort[2])
+#define PD              (&g_asHostPort[3])
+#define PE              (&g_asHostPort[4])
+#define PF              (&g_asHostPort[5])
+
+#endif /* __NUC1311_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,173 @@
+/**************************************************************************//**
+ * @file     test_gpio_bus.cpp
+ * @version  V3.00
+ * @brief    GPIO port bus test on a GPIO register model with DMASK
+ *
+ * @note     DOUT stores only change the bits whose DMASK bit is 0, PIN reads back DOUT. Every register
+ *           access is logged with PRIMASK, so the test also checks the masked write sequence.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "NUC1311.h"
+#include "../../StdDriver/src/gpio_bus.c"
+
+#define LOG_SIZE    16
+
+GPIO_T g_asHostPort[6];
+uint32_t SystemCoreClock = 50000000;
+
+typedef struct
+{
+    HOST_REG_T *psReg;
+    uint32_t u32Write;
+    uint32_t u32Val;
+    uint32_t u32PriMask;
+} ACCESS_T;
+
+static ACCESS_T s_asLog[LOG_SIZE];
+static uint32_t s_u32LogCnt;
+
+static void Log(HOST_REG_T *psReg, uint32_t u32Write, uint32_t u32Val)
+{
+    if(s_u32LogCnt < LOG_SIZE)
+    {
+        s_asLog[s_u32LogCnt].psReg = psReg;
+        s_asLog[s_u32LogCnt].u32Write = u32Write;
+        s_asLog[s_u32LogCnt].u32Val = u32Val;
+        s_asLog[s_u32LogCnt].u32PriMask = __get_PRIMASK();
+    }
+    s_u32LogCnt++;
+}
+
+static void Dout_Write(HOST_REG_T *psReg, uint32_t u32Val)
+{
+    GPIO_T *port = (GPIO_T *)((uint8_t *)psReg - offsetof(GPIO_T, DOUT));
+
+    Log(psReg, 1, u32Val);
+    psReg->u32Val = (psReg->u32Val & port->DMASK.u32Val) | (u32Val & ~port->DMASK.u32Val & 0xFFFF);
+}
+
+static void Dmask_Write(HOST_REG_T *psReg, uint32_t u32Val)
+{
+    Log(psReg, 1, u32Val);
+    psReg->u32Val = u32Val & 0xFFFF;
+}
+
+static uint32_t Dmask_Read(HOST_REG_T *psReg)
+{
+    Log(psReg, 0, psReg->u32Val);
+    return psReg->u32Val;
+}
+
+static uint32_t Pin_Read(HOST_REG_T *psReg)
+{
+    GPIO_T *port = (GPIO_T *)((uint8_t *)psReg - offsetof(GPIO_T, PIN));
+
+    Log(psReg, 0, port->DOUT.u32Val);
+    return port->DOUT.u32Val;
+}
+
+static void Model_Init(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < 6; i++)
+    {
+        g_asHostPort[i].DOUT.pfnWrite = Dout_Write;
+        g_asHostPort[i].DMASK.pfnWrite = Dmask_Write;
+        g_asHostPort[i].DMASK.pfnRead = Dmask_Read;
+        g_asHostPort[i].PIN.pfnRead = Pin_Read;
+        g_asHostPort[i].DOUT.u32Val = 0xFFFF;
+    }
+}
+
+/* Reference: the value spread on the pins one bit at a time */
+static uint32_t Spread(const uint8_t *pu8Pins, uint32_t u32Width, uint32_t u32Value)
+{
+    uint32_t i, u32Pattern = 0;
+
+    for(i = 0; i < u32Width; i++)
+    {
+        if(u32Value & (1UL << i))
+            u32Pattern |= (1UL << pu8Pins[i]);
+    }
+    return u32Pattern;
+}
+
+static void CheckBus(GPIO_T *port, const uint8_t *pu8Pins, uint32_t u32Width)
+{
+    GPIOBUS_T sBus;
+    uint32_t i, u32Value, u32Mask, u32Before, u32PriMask;
+
+    HOST_CHECK(GPIOBUS_Init(&sBus, port, pu8Pins, u32Width) == 0);
+    u32Mask = Spread(pu8Pins, u32Width, 0xFFFF);
+    HOST_CHECK(sBus.u32Mask == u32Mask);
+
+    for(i = 0; i < 2000; i++)
+    {
+        u32Value = (uint32_t)rand();
+        u32Before = port->DOUT.u32Val;
+        port->DMASK.u32Val = (uint32_t)rand() & 0xFFFF;     /* Mask left by other code, e.g. an interrupt */
+        u32PriMask = (uint32_t)rand() & 1;
+        __set_PRIMASK(u32PriMask);
+
+        s_u32LogCnt = 0;
+        GPIOBUS_Write(&sBus, u32Value);
+
+        /* Bus pins take the value, all other pins keep their level */
+        HOST_CHECK(port->DOUT.u32Val == ((u32Before & ~u32Mask) | Spread(pu8Pins, u32Width, u32Value)));
+
+        /* DMASK read, DMASK set, one DOUT store, DMASK restored, all with interrupts masked */
+        HOST_CHECK(s_u32LogCnt == 4);
+        HOST_CHECK(!s_asLog[0].u32Write && (s_asLog[0].psReg == &port->DMASK));
+        HOST_CHECK(s_asLog[1].u32Write && (s_asLog[1].psReg == &port->DMASK) && ((s_asLog[1].u32Val & 0xFFFF) == (~u32Mask & 0xFFFF)));
+        HOST_CHECK(s_asLog[2].u32Write && (s_asLog[2].psReg == &port->DOUT));
+        HOST_CHECK(s_asLog[3].u32Write && (s_asLog[3].psReg == &port->DMASK) && (s_asLog[3].u32Val == s_asLog[0].u32Val));
+        HOST_CHECK(s_asLog[0].u32PriMask && s_asLog[1].u32PriMask && s_asLog[2].u32PriMask && s_asLog[3].u32PriMask);
+        HOST_CHECK(__get_PRIMASK() == u32PriMask);
+
+        /* One PIN read samples the bus */
+        s_u32LogCnt = 0;
+        HOST_CHECK(GPIOBUS_Read(&sBus) == (u32Value & ((1UL << u32Width) - 1)));
+        HOST_CHECK(s_u32LogCnt == 1);
+        if(g_u32HostFail > 10)
+            break;
+    }
+    __set_PRIMASK(0);
+    port->DMASK.u32Val = 0;
+}
+
+int main(void)
+{
+    static const uint8_t au8Contig[8] = {4, 5, 6, 7, 8, 9, 10, 11};
+    static const uint8_t au8Scatter[12] = {15, 0, 7, 3, 12, 1, 9, 2, 14, 5, 11, 8};
+    static const uint8_t au8Full[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    static const uint8_t au8Dup[3] = {1, 2, 1};
+    static const uint8_t au8Range[2] = {3, 16};
+    GPIOBUS_T sBus;
+
+    Model_Init();
+    srand(32);
+
+    CheckBus(PA, au8Contig, 8);
+    HOST_CHECK(GPIOBUS_Init(&sBus, PA, au8Contig, 8) == 0 && sBus.u32Shift == 4);
+    CheckBus(PB, au8Scatter, 12);
+    HOST_CHECK(GPIOBUS_Init(&sBus, PB, au8Scatter, 12) == 0 && sBus.u32Shift == GPIOBUS_NOT_CONTIGUOUS);
+    CheckBus(PC, au8Full, 16);
+    CheckBus(PD, &au8Scatter[3], 1);
+
+    HOST_CHECK(GPIOBUS_Init(&sBus, PA, au8Dup, 3) == GPIOBUS_ERR_PARAM);
+    HOST_CHECK(GPIOBUS_Init(&sBus, PA, au8Range, 2) == GPIOBUS_ERR_PARAM);
+    HOST_CHECK(GPIOBUS_Init(&sBus, PA, au8Full, 0) == GPIOBUS_ERR_PARAM);
+    HOST_CHECK(GPIOBUS_Init(&sBus, PA, au8Full, 17) == GPIOBUS_ERR_PARAM);
+
+    printf("test_gpio_bus: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,185 @@
+/**************************************************************************//**
+ * @file     core_cm0.h
+ * @version  V3.00
+ * @brief    Host (x86) stand-in of the CMSIS Cortex-M0 core header
+ *
+ * @note     Used by the host build only. It is found before CMSIS/Include/core_cm0.h, so NUC1311.h and
+ *           every StdDriver file compile unchanged on the build machine. The core peripherals and the
+ *           PRIMASK state are plain variables in host_reg.c that the tests read and change.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __CORE_CM0_H__
+#define __CORE_CM0_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define __CM0_CMSIS_VERSION_MAIN  (0x03)
+#define __CM0_CMSIS_VERSION_SUB   (0x20)
+#define __CORTEX_M                (0x00)
+
+#define __ASM           __asm
+#define __INLINE        inline
+#define __STATIC_INLINE static inline
+#define __WEAK          __attribute__((weak))
+
+#ifdef __cplusplus
+#define __I             volatile
+#else
+#define __I             volatile const
+#endif
+#define __O             volatile
+#define __IO            volatile
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Core peripherals                                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    __IO uint32_t ISER[1];                  /* Enabled interrupts, one bit per IRQn */
+    __IO uint32_t ICER[1];
+    __IO uint32_t ISPR[1];                  /* Pending interrupts, one bit per IRQn */
+    __IO uint32_t ICPR[1];
+    __IO uint32_t IP[8];
+} NVIC_Type;
+
+typedef struct
+{
+    __I  uint32_t CPUID;
+    __IO uint32_t ICSR;
+    uint32_t RESERVED0;
+    __IO uint32_t AIRCR;
+    __IO uint32_t SCR;
+    __IO uint32_t CCR;
+    uint32_t RESERVED1;
+    __IO uint32_t SHP[2];
+    __IO uint32_t SHCSR;
+} SCB_Type;
+
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __I  uint32_t CALIB;
+} SysTick_Type;
+
+#define SCB_SCR_SLEEPDEEP_Pos       2
+#define SCB_SCR_SLEEPDEEP_Msk       (1UL << SCB_SCR_SLEEPDEEP_Pos)
+
+#define SysTick_CTRL_COUNTFLAG_Pos  16
+#define SysTick_CTRL_COUNTFLAG_Msk  (1UL << SysTick_CTRL_COUNTFLAG_Pos)
+#define SysTick_CTRL_CLKSOURCE_Pos  2
+#define SysTick_CTRL_CLKSOURCE_Msk  (1UL << SysTick_CTRL_CLKSOURCE_Pos)
+#define SysTick_CTRL_TICKINT_Pos    1
+#define SysTick_CTRL_TICKINT_Msk    (1UL << SysTick_CTRL_TICKINT_Pos)
+#define SysTick_CTRL_ENABLE_Pos     0
+#define SysTick_CTRL_ENABLE_Msk     (1UL << SysTick_CTRL_ENABLE_Pos)
+#define SysTick_LOAD_RELOAD_Msk     (0xFFFFFFUL)
+
+extern NVIC_Type g_sHostNVIC;
+extern SCB_Type g_sHostSCB;
+extern SysTick_Type g_sHostSysTick;
+
+#define NVIC            (&g_sHostNVIC)
+#define SCB             (&g_sHostSCB)
+#define SysTick         (&g_sHostSysTick)
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Core state                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+extern uint32_t g_u32HostPrimask;           /* PRIMASK, 1 while interrupts are masked */
+extern uint32_t g_u32HostWfi;               /* Number of __WFI() executed */
+extern uint32_t g_u32HostReset;             /* Number of NVIC_SystemReset() executed */
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return g_u32HostPrimask;
+}
+
+static inline void __set_PRIMASK(uint32_t u32PriMask)
+{
+    g_u32HostPrimask = u32PriMask & 1UL;
+}
+
+static inline void __disable_irq(void)
+{
+    g_u32HostPrimask = 1;
+}
+
+static inline void __enable_irq(void)
+{
+    g_u32HostPrimask = 0;
+}
+
+static inline void __NOP(void) {}
+static inline void __ISB(void) {}
+static inline void __DSB(void) {}
+static inline void __DMB(void) {}
+static inline void __WFE(void) {}
+
+static inline void __WFI(void)
+{
+    g_u32HostWfi++;
+}
+
+static inline void NVIC_EnableIRQ(int32_t IRQn)
+{
+    NVIC->ISER[0] |= (1UL << (IRQn & 0x1F));
+}
+
+static inline void NVIC_DisableIRQ(int32_t IRQn)
+{
+    NVIC->ISER[0] &= ~(1UL << (IRQn & 0x1F));
+}
+
+static inline uint32_t NVIC_GetPendingIRQ(int32_t IRQn)
+{
+    return (NVIC->ISPR[0] >> (IRQn & 0x1F)) & 1UL;
+}
+
+static inline void NVIC_SetPendingIRQ(int32_t IRQn)
+{
+    NVIC->ISPR[0] |= (1UL << (IRQn & 0x1F));
+}
+
+static inline void NVIC_ClearPendingIRQ(int32_t IRQn)
+{
+    NVIC->ISPR[0] &= ~(1UL << (IRQn & 0x1F));
+}
+
+static inline void NVIC_SetPriority(int32_t IRQn, uint32_t priority)
+{
+    NVIC->IP[(IRQn & 0x1F) >> 2] = (NVIC->IP[(IRQn & 0x1F) >> 2] & ~(0xFFUL << ((IRQn & 3) * 8))) |
+                                   ((priority << 6) & 0xFFUL) << ((IRQn & 3) * 8);
+}
+
+static inline void NVIC_SystemReset(void)
+{
+    g_u32HostReset++;
+}
+
+static inline uint32_t SysTick_Config(uint32_t ticks)
+{
+    if((ticks - 1) > SysTick_LOAD_RELOAD_Msk)
+        return 1;
+    SysTick->LOAD = ticks - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CORE_CM0_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,64 @@
+/**************************************************************************//**
+ * @file     host_flash.h
+ * @version  V3.00
+ * @brief    Host (x86) flash and FMC model, for tests of the flash based drivers
+ *
+ * @note     APROM and data flash are mapped as memory at HOST_FLASH_BASE before main(), since the host
+ *           cannot map address 0. Tests pass FMC_APROM_BASE and FMC_DATA_FLASH_BASE of this file to the
+ *           drivers, which read flash through pointers like the CPU does. The FMC functions program it like
+ *           ISP does: a program can only clear bits and an erase sets a page back to 0xFF. The model takes
+ *           the place of fmc.h, whose include guard it sets.
+ *
+ *           HostFlash_PowerFail() arms a power failure: the flash operation after the given number of them
+ *           does not complete and longjmp() returns to g_sHostFlashJmp. A page erase fails half way.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __HOST_FLASH_H__
+#define __HOST_FLASH_H__
+
+#include <stdint.h>
+#include <setjmp.h>
+
+#define __FMC_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define HOST_FLASH_BASE         0x10000000UL
+#define HOST_FLASH_SIZE         0x10000UL   /* 64 KB, the last 4 KB are data flash */
+#define HOST_FLASH_NO_FAIL      (-1)
+
+/* Host pointer of a flash address */
+#define HOST_FLASH_PTR(addr)    ((void *)(uintptr_t)(addr))
+
+#define FMC_FLASH_PAGE_SIZE     0x200
+#define FMC_APROM_BASE          HOST_FLASH_BASE
+#define FMC_DATA_FLASH_BASE     (HOST_FLASH_BASE + 0xF000UL)
+
+extern uint32_t g_u32HostFlashOps;      /* Word programs and page erases since HostFlash_Reset() */
+extern uint32_t g_u32HostVecmap;
+extern jmp_buf g_sHostFlashJmp;
+
+void HostFlash_Reset(void);
+void HostFlash_PowerFail(int32_t i32Ops);
+
+int32_t FMC_Erase(uint32_t u32PageAddr);
+uint32_t FMC_Read(uint32_t u32Addr);
+int32_t FMC_Write(uint32_t u32Addr, uint32_t u32Data);
+int32_t FMC_WriteMultiple(uint32_t u32Addr, const uint32_t *pu32Buf, uint32_t u32Count);
+uint32_t FMC_ReadDataFlashBaseAddr(void);
+uint32_t FMC_GetVECMAP(void);
+int32_t FMC_SetVectorPageAddr(uint32_t u32PageAddr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_FLASH_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
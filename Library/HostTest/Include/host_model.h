@@ -0,0 +1,75 @@
+/**************************************************************************//**
+ * @file     host_model.h
+ * @version  V3.00
+ * @brief    Host (x86) register with read and write hooks, for peripheral models in C++
+ *
+ * @note     A test that needs a peripheral reacting to register accesses declares the peripheral
+ *           structure with HOST_REG_T members in its own NUC1311.h and compiles the driver as C++.
+ *           A register without hooks behaves like plain memory.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __HOST_MODEL_H__
+#define __HOST_MODEL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core_cm0.h"
+#include "host_reg.h"
+
+struct HOST_REG_T
+{
+    uint32_t u32Val;
+    uint32_t (*pfnRead)(HOST_REG_T *psReg);
+    void (*pfnWrite)(HOST_REG_T *psReg, uint32_t u32Val);
+
+    HOST_REG_T() : u32Val(0), pfnRead(NULL), pfnWrite(NULL) {}
+
+    uint32_t Get()
+    {
+        return (pfnRead != NULL) ? pfnRead(this) : u32Val;
+    }
+
+    void Set(uint32_t u32Data)
+    {
+        if(pfnWrite != NULL)
+            pfnWrite(this, u32Data);
+        else
+            u32Val = u32Data;
+    }
+
+    operator uint32_t()
+    {
+        return Get();
+    }
+
+    HOST_REG_T &operator=(uint32_t u32Data)
+    {
+        Set(u32Data);
+        return *this;
+    }
+
+    HOST_REG_T &operator=(HOST_REG_T &sReg)
+    {
+        Set(sReg.Get());
+        return *this;
+    }
+
+    HOST_REG_T &operator|=(uint32_t u32Data)
+    {
+        Set(Get() | u32Data);
+        return *this;
+    }
+
+    HOST_REG_T &operator&=(uint32_t u32Data)
+    {
+        Set(Get() & u32Data);
+        return *this;
+    }
+};
+
+#endif /* __HOST_MODEL_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,47 @@
+/**************************************************************************//**
+ * @file     host_reg.h
+ * @version  V3.00
+ * @brief    Host (x86) register model of NUC1311 series header file
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __HOST_REG_H__
+#define __HOST_REG_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Check a condition, report the failing line and count it */
+#define HOST_CHECK(cond)                                                        \
+    do {                                                                        \
+        if(!(cond))                                                             \
+        {                                                                       \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+            g_u32HostFail++;                                                    \
+        }                                                                       \
+    } while(0)
+
+/* Write access to a register, including the read-only ones the hardware updates */
+#define HOST_REG(reg)   (*(volatile uint32_t *)(uintptr_t)&(reg))
+
+/* Exit code of a test: 0 if every check passed */
+#define HOST_RESULT()   ((g_u32HostFail == 0) ? 0 : 1)
+
+extern uint32_t g_u32HostFail;
+
+void HostReg_Reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_REG_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,348 @@
+/**************************************************************************//**
+ * @file     test_isp.c
+ * @version  V3.00
+ * @brief    ISP command core test over a loopback transport
+ *
+ * @note     SampleCode/ISP/ISP_Common/isp_user.c runs against the flash access functions of fmc_user.h
+ *           on a flash array, and ISP_Run() is fed one frame at a time through an ISP_XFER_T. The frames
+ *           are those of the ISP tool on the UART (64 bytes, two on the way) and on SPI (up to one page
+ *           plus header, variable length). Checked: packet numbers and frame checksums of the responses,
+ *           CMD_GET_XFER_INFO, APROM and data flash updates with their final checksum, the resend path
+ *           after a corrupt packet, also with the next packet parsed before the resend, and the compressed
+ *           update.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "isp_user.h"
+#include "host_reg.h"
+
+#define FLASH_SIZE      0x20000
+#define IMAGE_SIZE      0x3A54                  /* Not a whole number of pages or words */
+#define SPI_MAX_FRAME   (FMC_FLASH_PAGE_SIZE + 16)
+
+uint32_t g_apromSize = 0x10000, g_dataFlashAddr = 0x1F000, g_dataFlashSize = 0x1000;
+
+static uint8_t s_au8Flash[FLASH_SIZE];
+static uint32_t s_au32Config[2] = {0xFFFFFF7F, 0x0001F000};
+static uint8_t s_au8Image[IMAGE_SIZE], s_au8Lz[IMAGE_SIZE + IMAGE_SIZE / 8 + 1];
+static uint32_t s_au32Frame[SPI_MAX_FRAME / 4], s_au32Rsp[ISP_PKT_SIZE / 4];
+static uint32_t s_u32FrameLen, s_u32Sent, s_u32PackNo;
+static ISP_XFER_T s_sXfer;
+static jmp_buf s_sJmp;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Flash access of fmc_user.h on s_au8Flash, words as FMC_Proc() programs them                            */
+/*---------------------------------------------------------------------------------------------------------*/
+static int Flash_Check(unsigned int addr_start, unsigned int addr_end)
+{
+    if((addr_start <= addr_end) && (addr_end <= FLASH_SIZE))
+        return 0;
+    printf("flash access 0x%x..0x%x out of range\n", addr_start, addr_end);
+    g_u32HostFail++;
+    return -1;
+}
+
+int FMC_Erase_User(unsigned int u32Addr)
+{
+    u32Addr &= ~(FMC_FLASH_PAGE_SIZE - 1);
+    if(Flash_Check(u32Addr, u32Addr + FMC_FLASH_PAGE_SIZE))
+        return -1;
+    memset(&s_au8Flash[u32Addr], 0xFF, FMC_FLASH_PAGE_SIZE);
+    return 0;
+}
+
+void ReadData(unsigned int addr_start, unsigned int addr_end, unsigned int *data)
+{
+    if(addr_start >= Config0)
+    {
+        for(; addr_start < addr_end; addr_start += 4)
+            *data++ = s_au32Config[(addr_start - Config0) / 4 & 1];
+        return;
+    }
+    if(Flash_Check(addr_start, (addr_end + 3) & ~3) == 0)
+        memcpy(data, &s_au8Flash[addr_start], (addr_end - addr_start + 3) & ~3);
+}
+
+/* Programming only clears bits, a word written twice without an erase in between comes out wrong */
+void WriteData(unsigned int addr_start, unsigned int addr_end, unsigned int *data)
+{
+    uint32_t u32Word;
+
+    if(Flash_Check(addr_start, (addr_end + 3) & ~3))
+        return;
+    for(; addr_start < addr_end; addr_start += 4)
+    {
+        memcpy(&u32Word, &s_au8Flash[addr_start], 4);
+        u32Word &= *data++;
+        memcpy(&s_au8Flash[addr_start], &u32Word, 4);
+    }
+}
+
+void EraseAP(unsigned int addr_start, unsigned int addr_end)
+{
+    for(; addr_start < addr_end; addr_start += FMC_FLASH_PAGE_SIZE)
+        FMC_Erase_User(addr_start);
+}
+
+void UpdateConfig(unsigned int *data, unsigned int *res)
+{
+    s_au32Config[0] = data[0];
+    s_au32Config[1] = data[1];
+    if(res)
+        ReadData(Config0, Config0 + 8, res);
+}
+
+void GetDataFlashInfo(uint32_t *addr, uint32_t *size)
+{
+    *addr = g_dataFlashAddr;
+    *size = g_dataFlashSize;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Loopback transport: ISP_Run() receives the frame in s_au32Frame, then leaves through s_sJmp            */
+/*---------------------------------------------------------------------------------------------------------*/
+static uint32_t Xfer_Recv(uint8_t **ppu8Frame)
+{
+    if(s_u32Sent)
+        longjmp(s_sJmp, 1);
+    *ppu8Frame = (uint8_t *)s_au32Frame;
+    return s_u32FrameLen;
+}
+
+static void Xfer_Send(uint8_t *pu8Rsp, uint32_t u32Len)
+{
+    HOST_CHECK(u32Len == ISP_PKT_SIZE);
+    memcpy(s_au32Rsp, pu8Rsp, sizeof(s_au32Rsp));
+    s_u32Sent = 1;
+}
+
+static uint16_t Sum(const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint16_t u16Sum = 0;
+
+    while(u32Len--)
+        u16Sum += *pu8Buf++;
+    return u16Sum;
+}
+
+/* Send a frame of u32Len bytes: command, packet number and the data already in s_au32Frame from word 2 on */
+static void Isp_Send(uint32_t u32Cmd, uint32_t u32Len)
+{
+    uint16_t u16Sum;
+
+    s_au32Frame[0] = u32Cmd;
+    s_au32Frame[1] = s_u32PackNo;
+    u16Sum = Sum((uint8_t *)s_au32Frame, u32Len);
+    s_u32FrameLen = u32Len;
+    s_u32Sent = 0;
+    if(setjmp(s_sJmp) == 0)
+        ISP_Run(&s_sXfer);
+
+    /* The response carries the checksum of the frame read back from flash and the next packet number */
+    HOST_CHECK((s_au32Rsp[0] & 0xFFFF) == u16Sum);
+    HOST_CHECK(s_au32Rsp[1] == s_u32PackNo + 1);
+    s_u32PackNo += 2;
+}
+
+static void Isp_Connect(uint32_t u32MaxFrame, uint32_t u32Depth)
+{
+    s_sXfer.pfnRecv = Xfer_Recv;
+    s_sXfer.pfnSend = Xfer_Send;
+    s_sXfer.u32MaxFrame = u32MaxFrame;
+    s_sXfer.u32Depth = u32Depth;
+
+    s_u32PackNo = 1;
+    memset(&s_au32Frame[2], 0, u32MaxFrame - 8);
+    Isp_Send(CMD_CONNECT, u32MaxFrame);
+    Isp_Send(CMD_GET_XFER_INFO, u32MaxFrame);
+    HOST_CHECK((s_au32Rsp[2] == u32MaxFrame) && (s_au32Rsp[3] == u32Depth));
+}
+
+/* Frame length for the remaining data: the whole frame on a fixed size link, random lengths otherwise */
+static uint32_t Isp_FrameLen(uint32_t u32Head, uint32_t u32Left)
+{
+    uint32_t u32Len = s_sXfer.u32MaxFrame - u32Head;
+
+    if(s_sXfer.u32MaxFrame != ISP_PKT_SIZE)
+    {
+        u32Len = (4 + (uint32_t)rand() % u32Len) & ~3;
+        if(u32Len > u32Left)
+            u32Len = (u32Left + 3) & ~3;
+        return u32Head + u32Len;
+    }
+    return s_sXfer.u32MaxFrame;
+}
+
+/*
+ * Send pu8Data as an update command, returns the checksum of the last response. With u32Corrupt != 0 the
+ * data packet with that number is first sent corrupt and then again after CMD_RESEND_PACKET. On a link with
+ * two packets on the way, the packet after it is parsed before the resend and names the corrupt one.
+ */
+static uint16_t Isp_Update(uint32_t u32Cmd, const uint8_t *pu8Data, uint32_t u32Len, uint32_t u32Total,
+                           uint32_t u32Corrupt)
+{
+    uint32_t u32Off = 0, u32Head = 16, u32Frame, u32Chunk, u32Pkt, u32Next, u32PackNo;
+
+    for(u32Pkt = 0; (u32Pkt == 0) || (u32Off < u32Len); u32Pkt++)
+    {
+        u32Frame = Isp_FrameLen(u32Head, u32Len - u32Off);
+        u32Chunk = (u32Frame - u32Head < u32Len - u32Off) ? u32Frame - u32Head : u32Len - u32Off;
+
+        memset(&s_au32Frame[2], 0xFF, u32Frame - 8);
+        memcpy((uint8_t *)s_au32Frame + u32Head, &pu8Data[u32Off], u32Chunk);
+        if((u32Pkt == u32Corrupt) && u32Pkt)
+        {
+            ((uint8_t *)s_au32Frame)[u32Head] ^= 0x81;
+            ((uint8_t *)s_au32Frame)[u32Frame - 1] ^= 0x18;
+            s_au32Frame[0] = 0;
+            s_au32Frame[1] = s_u32PackNo;
+            s_u32FrameLen = u32Frame;
+            s_u32Sent = 0;
+            if(setjmp(s_sJmp) == 0)
+                ISP_Run(&s_sXfer);
+            u32PackNo = s_u32PackNo;
+            s_u32PackNo += 2;
+
+            /* Resend 0: the last packet */
+            memset(&s_au32Frame[2], 0, u32Frame - 8);
+            if((s_sXfer.u32Depth > 1) && (u32Off + u32Chunk < u32Len))
+            {
+                u32Next = Isp_FrameLen(8, u32Len - u32Off - u32Chunk);
+                memset(&s_au32Frame[2], 0xFF, u32Next - 8);
+                memcpy(&s_au32Frame[2], &pu8Data[u32Off + u32Chunk],
+                       (u32Next - 8 < u32Len - u32Off - u32Chunk) ? u32Next - 8 : u32Len - u32Off - u32Chunk);
+                Isp_Send(0, u32Next);
+
+                memset(&s_au32Frame[2], 0, u32Frame - 8);
+                s_au32Frame[2] = u32PackNo;
+            }
+            Isp_Send(CMD_RESEND_PACKET, u32Frame);
+            memset(&s_au32Frame[2], 0xFF, u32Frame - 8);
+            memcpy((uint8_t *)s_au32Frame + u32Head, &pu8Data[u32Off], u32Chunk);
+        }
+
+        if(u32Pkt == 0)
+        {
+            s_au32Frame[2] = 0;
+            s_au32Frame[3] = u32Total;
+        }
+        Isp_Send(u32Pkt ? 0 : u32Cmd, u32Frame);
+
+        u32Off += u32Chunk;
+        u32Head = 8;
+    }
+
+    return (uint16_t)s_au32Rsp[2];
+}
+
+/* Greedy LZ encoder in the format of Tool/LzPack/lz_pack.py */
+static uint32_t Lz_Pack(const uint8_t *pu8In, uint32_t u32Len, uint8_t *pu8Out)
+{
+    uint32_t u32Pos = 0, u32Out = 0, u32Flag = 0, u32Bit = 8, u32Dist, u32Best, u32BestDist, n;
+
+    while(u32Pos < u32Len)
+    {
+        if(u32Bit == 8)
+        {
+            u32Flag = u32Out++;
+            pu8Out[u32Flag] = 0;
+            u32Bit = 0;
+        }
+
+        u32Best = 0;
+        u32BestDist = 0;
+        for(u32Dist = 1; (u32Dist <= LZDEC_WINDOW_SIZE) && (u32Dist <= u32Pos); u32Dist++)
+        {
+            for(n = 0; (n < 66) && (u32Pos + n < u32Len) && (pu8In[u32Pos + n] == pu8In[u32Pos + n - u32Dist]); n++);
+            if(n > u32Best)
+            {
+                u32Best = n;
+                u32BestDist = u32Dist;
+            }
+        }
+
+        if(u32Best >= 3)
+        {
+            n = (u32BestDist - 1) | ((u32Best - 3) << 10);
+            pu8Out[u32Out++] = (uint8_t)n;
+            pu8Out[u32Out++] = (uint8_t)(n >> 8);
+            u32Pos += u32Best;
+        }
+        else
+        {
+            pu8Out[u32Flag] |= (uint8_t)(1 << u32Bit);
+            pu8Out[u32Out++] = pu8In[u32Pos++];
+        }
+        u32Bit++;
+    }
+
+    return u32Out;
+}
+
+int main(void)
+{
+    static const uint32_t au32Link[][2] = {{ISP_PKT_SIZE, 2}, {ISP_PKT_SIZE, 1}, {SPI_MAX_FRAME, 1}};
+    uint32_t i, u32Link, u32LzLen;
+    uint16_t u16Sum;
+
+    HostReg_Reset();
+    HOST_REG(SYS->PDID) = 0x00013100;
+    memset(s_au8Flash, 0, sizeof(s_au8Flash));
+
+    /* Code-like image: repeated sequences, runs and some noise */
+    for(i = 0; i < IMAGE_SIZE; i++)
+        s_au8Image[i] = ((i & 0x3FF) < 0x80) ? 0xFF : (uint8_t)((i % 37) * 7 + ((i % 500) == 0 ? rand() : 0));
+    u16Sum = Sum(s_au8Image, IMAGE_SIZE);
+    u32LzLen = Lz_Pack(s_au8Image, IMAGE_SIZE, s_au8Lz);
+    HOST_CHECK(u32LzLen < IMAGE_SIZE / 2);
+
+    for(u32Link = 0; u32Link < sizeof(au32Link) / sizeof(au32Link[0]); u32Link++)
+    {
+        Isp_Connect(au32Link[u32Link][0], au32Link[u32Link][1]);
+
+        Isp_Send(CMD_GET_FWVER, s_sXfer.u32MaxFrame);
+        HOST_CHECK((s_au32Rsp[2] & 0xFF) == FW_VERSION);
+        Isp_Send(CMD_GET_DEVICEID, s_sXfer.u32MaxFrame);
+        HOST_CHECK(s_au32Rsp[2] == 0x00013100);
+
+        /* Plain update over flash left dirty by the previous link */
+        HOST_CHECK(Isp_Update(CMD_UPDATE_APROM, s_au8Image, IMAGE_SIZE, IMAGE_SIZE, 0) == u16Sum);
+        HOST_CHECK(memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0);
+
+        /* A corrupt packet is sent again after CMD_RESEND_PACKET, some crossing a page boundary */
+        for(i = 1; i < 40; i += 7)
+        {
+            HOST_CHECK(Isp_Update(CMD_UPDATE_APROM, s_au8Image, IMAGE_SIZE, IMAGE_SIZE, i) == u16Sum);
+            HOST_CHECK(memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0);
+        }
+
+        /* Data flash */
+        HOST_CHECK(Isp_Update(CMD_UPDATE_DATAFLASH, &s_au8Image[0x100], 0x1000, 0x1000, 0) ==
+                   Sum(&s_au8Image[0x100], 0x1000));
+        HOST_CHECK(memcmp(&s_au8Flash[g_dataFlashAddr], &s_au8Image[0x100], 0x1000) == 0);
+
+        /* Compressed update: the checksum is the one of the decompressed image */
+        memset(s_au8Flash, 0x5A, IMAGE_SIZE);
+        HOST_CHECK(Isp_Update(CMD_UPDATE_APROM_LZ, s_au8Lz, u32LzLen, IMAGE_SIZE, 0) == u16Sum);
+        HOST_CHECK(memcmp(s_au8Flash, s_au8Image, IMAGE_SIZE) == 0);
+        Isp_Send(CMD_GET_LZ_STATUS, s_sXfer.u32MaxFrame);
+        HOST_CHECK((s_au32Rsp[2] == u32LzLen) && (s_au32Rsp[3] == IMAGE_SIZE));
+
+        /* A corrupt stream ends the update with a wrong checksum */
+        s_au8Lz[u32LzLen / 2] ^= 0x40;
+        HOST_CHECK(Isp_Update(CMD_UPDATE_APROM_LZ, s_au8Lz, u32LzLen, IMAGE_SIZE, 0) != u16Sum);
+        s_au8Lz[u32LzLen / 2] ^= 0x40;
+    }
+
+    printf("test_isp: %u bytes, %u compressed, %s\n", (unsigned)IMAGE_SIZE, (unsigned)u32LzLen,
+           (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,196 @@
+/**************************************************************************//**
+ * @file     test_kvs.c
+ * @version  V3.00
+ * @brief    Data flash key/value store test against a reference model, with power failures
+ *
+ * @note     Random sets, deletes and maintenance on the 8 data flash pages, the store compared with a
+ *           plain array after every step and after a reopen. One step in 50 is cut by a power failure;
+ *           after the reopen the key of that step must hold either its old or its new value, and every
+ *           other key must be unchanged. A compacted page brought back without its delete record, as a
+ *           partly erased page could be, must not bring the deleted key back. Flash and FMC are the model
+ *           of Include/host_flash.h.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NUC1311.h"
+#include "../../StdDriver/src/kvs.c"
+
+#define KVS_PAGES       8
+#define KEYS            20
+#define STEPS           100000
+
+static KVS_T s_sKvs;
+static KVS_ENTRY_T s_asIndex[32];
+static uint8_t s_au8Ref[KEYS][KVS_MAX_VALUE];
+static int32_t s_ai32RefLen[KEYS];     /* -1 if the key is absent */
+static uint32_t s_u32Sets, s_u32Full, s_u32Fails, s_u32Bad;    /* Kept across longjmp() */
+
+/* Committed records of a key in the pages of the store */
+static uint32_t Key_Records(uint32_t u32Key)
+{
+    uint32_t u32Page, u32Count = 0;
+
+    for(u32Page = 0; u32Page < KVS_PAGES; u32Page++)
+    {
+        if(KVS_PageValid(&s_sKvs, u32Page) &&
+                KVS_KeyInPage(KVS_PAGE_ADDR(&s_sKvs, u32Page) + KVS_HDR_SIZE,
+                              KVS_PAGE_ADDR(&s_sKvs, u32Page) + KVS_PAGE_SIZE, u32Key))
+            u32Count++;
+    }
+
+    return u32Count;
+}
+
+/* Compare every key with the reference, returns 1 on a mismatch */
+static uint32_t Ref_Check(void)
+{
+    uint8_t au8Buf[KVS_MAX_VALUE];
+    int32_t i32Ret;
+    uint32_t i;
+
+    for(i = 0; i < KEYS; i++)
+    {
+        i32Ret = KVS_Get(&s_sKvs, i, au8Buf, sizeof(au8Buf));
+        if(s_ai32RefLen[i] < 0)
+        {
+            if(i32Ret != KVS_ERR_NOT_FOUND)
+                return 1;
+        }
+        else if((i32Ret != s_ai32RefLen[i]) || (memcmp(au8Buf, s_au8Ref[i], (size_t)i32Ret) != 0))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    static uint8_t au8Page[KVS_PAGE_SIZE];
+    uint8_t au8Val[KVS_MAX_VALUE], au8Buf[KVS_MAX_VALUE];
+    uint32_t u32Step, u32Key, u32Op, u32Len, u32Tail, i;
+    int32_t i32Ret;
+
+    HostFlash_Reset();
+    srand(1311);
+
+    /* Pages that never held a store are formatted */
+    memset(HOST_FLASH_PTR(FMC_DATA_FLASH_BASE), 0xA5, KVS_PAGES * FMC_FLASH_PAGE_SIZE);
+    HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 32) == 0);
+    HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE + 4, KVS_PAGES, s_asIndex, 32) == KVS_ERR_PARAM);
+    HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 32) == 0);
+    for(i = 0; i < KEYS; i++)
+        s_ai32RefLen[i] = -1;
+
+    for(u32Step = 0; u32Step < STEPS; u32Step++)
+    {
+        u32Key = (uint32_t)rand() % KEYS;
+        u32Op = (uint32_t)rand() % 10;
+        u32Len = (uint32_t)rand() % ((rand() % 8) ? 12 : KVS_MAX_VALUE + 1);
+        for(i = 0; i < u32Len; i++)
+            au8Val[i] = (uint8_t)rand();
+
+        if(setjmp(g_sHostFlashJmp) != 0)
+        {
+            /* Power failure: the key holds its old or its new value after the reopen */
+            s_u32Fails++;
+            HostFlash_PowerFail(HOST_FLASH_NO_FAIL);
+            HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 32) == 0);
+            i32Ret = KVS_Get(&s_sKvs, u32Key, au8Buf, sizeof(au8Buf));
+            if((u32Op == 0) && (i32Ret == KVS_ERR_NOT_FOUND))
+                s_ai32RefLen[u32Key] = -1;
+            else if((u32Op != 0) && (i32Ret == (int32_t)u32Len) && (memcmp(au8Buf, au8Val, u32Len) == 0))
+            {
+                memcpy(s_au8Ref[u32Key], au8Val, u32Len);
+                s_ai32RefLen[u32Key] = (int32_t)u32Len;
+            }
+            s_u32Bad += Ref_Check();
+            continue;
+        }
+
+        if(rand() % 50 == 0)
+            HostFlash_PowerFail(rand() % ((rand() % 2) ? 6 : 300));
+
+        if(u32Op == 0)
+        {
+            i32Ret = KVS_Delete(&s_sKvs, u32Key);
+            HOST_CHECK((i32Ret == 0) || ((i32Ret == KVS_ERR_NOT_FOUND) && (s_ai32RefLen[u32Key] < 0)));
+            s_ai32RefLen[u32Key] = -1;
+        }
+        else
+        {
+            i32Ret = KVS_Set(&s_sKvs, u32Key, au8Val, u32Len);
+            if(i32Ret == KVS_ERR_FULL)
+            {
+                s_u32Full++;
+            }
+            else
+            {
+                HOST_CHECK(i32Ret == 0);
+                memcpy(s_au8Ref[u32Key], au8Val, u32Len);
+                s_ai32RefLen[u32Key] = (int32_t)u32Len;
+                s_u32Sets++;
+            }
+        }
+
+        if(rand() % 4 == 0)
+        {
+            while((i32Ret = KVS_Maintain(&s_sKvs)) > 0);
+            HOST_CHECK(i32Ret == 0);
+        }
+        HostFlash_PowerFail(HOST_FLASH_NO_FAIL);
+
+        s_u32Bad += Ref_Check();
+        if(u32Step % 1000 == 0)
+        {
+            HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 32) == 0);
+            s_u32Bad += Ref_Check();
+        }
+    }
+    HOST_CHECK(s_u32Bad == 0);
+    HOST_CHECK(s_u32Fails > STEPS / 200);
+
+    /* Key 1 set and deleted in the oldest page. Its erase after the compaction is cut short so that the value
+       comes back but not the delete record: the copy of the delete record keeps the key deleted. */
+    HOST_CHECK(KVS_Format(&s_sKvs) == 0);
+    HOST_CHECK(KVS_Set(&s_sKvs, 1, "deleted", 8) == 0);
+    HOST_CHECK(KVS_Delete(&s_sKvs, 1) == 0);
+    u32Tail = s_sKvs.u32Tail;
+    memcpy(au8Page, HOST_FLASH_PTR(KVS_PAGE_ADDR(&s_sKvs, u32Tail)), KVS_PAGE_SIZE);
+    for(i = 0; s_sKvs.u32Tail == u32Tail; i++)
+    {
+        HOST_CHECK(KVS_Set(&s_sKvs, 2, &i, 4) == 0);
+        HOST_CHECK(KVS_Maintain(&s_sKvs) >= 0);
+    }
+    memset(&au8Page[KVS_HDR_SIZE + KVS_REC_SIZE(8)], 0xFF, KVS_REC_SIZE(0));
+    memcpy(HOST_FLASH_PTR(KVS_PAGE_ADDR(&s_sKvs, u32Tail)), au8Page, KVS_PAGE_SIZE);
+    HOST_CHECK(KVS_Open(&s_sKvs, FMC_DATA_FLASH_BASE, KVS_PAGES, s_asIndex, 32) == 0);
+    HOST_CHECK(s_sKvs.u32Tail == u32Tail);
+    HOST_CHECK(KVS_Get(&s_sKvs, 1, au8Buf, sizeof(au8Buf)) == KVS_ERR_NOT_FOUND);
+    HOST_CHECK((KVS_Get(&s_sKvs, 2, &u32Len, 4) == 4) && (u32Len == i - 1));
+
+    /* The copy hides nothing once the value is gone, the next compaction of its page drops it */
+    for(i = 0; (i < 1000) && (Key_Records(1) != 0); i++)
+    {
+        HOST_CHECK(KVS_Set(&s_sKvs, 2, &i, 4) == 0);
+        HOST_CHECK(KVS_Maintain(&s_sKvs) >= 0);
+    }
+    HOST_CHECK(Key_Records(1) == 0);
+    HOST_CHECK(KVS_Get(&s_sKvs, 1, au8Buf, sizeof(au8Buf)) == KVS_ERR_NOT_FOUND);
+
+    /* Reserved key and value too long */
+    HOST_CHECK(KVS_Set(&s_sKvs, KVS_KEY_INVALID, au8Val, 4) == KVS_ERR_PARAM);
+    HOST_CHECK(KVS_Set(&s_sKvs, 1, au8Val, KVS_MAX_VALUE + 1) == KVS_ERR_PARAM);
+
+    printf("test_kvs: %u sets, %u full, %u power failures, %s\n", (unsigned)s_u32Sets, (unsigned)s_u32Full,
+           (unsigned)s_u32Fails, (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,125 @@
+/**************************************************************************//**
+ * @file     test_lin_sched.c
+ * @version  V3.00
+ * @brief    LIN master schedule test on the host register model
+ *
+ * @note     The test calls LIN_TimerIRQHandler() once per time base tick and reads the header that each slot
+ *           writes to LIN_CTL. No slave answers, so every frame closes as a header error when its slot ends.
+ *           Checked: slot lengths, table switch at the end of a slot, stop by a NULL table and restart.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include "NUC1311.h"
+#include "lin.h"
+#include "host_reg.h"
+
+static LIN_T s_sLin;
+static LIN_FRAME_T s_sFrameA, s_sFrameB, s_sFrameC;
+static uint32_t s_u32Done;
+
+static const LIN_SCHED_T s_asSched1[] =
+{
+    { &s_sFrameA, 2 },
+    { &s_sFrameB, 3 },
+};
+
+static const LIN_SCHED_T s_asSched2[] =
+{
+    { &s_sFrameC, 4 },
+};
+
+static void Frame_Done(LIN_T *psLin, LIN_FRAME_T *psFrame, int32_t i32Status)
+{
+    (void)psLin;
+    (void)psFrame;
+    HOST_CHECK(i32Status == LIN_ERR_HEADER);
+    s_u32Done++;
+}
+
+/* One time base tick, returns the frame identifier of the header started or -1 */
+static int32_t Sim_Tick(void)
+{
+    uint32_t u32Ctl;
+
+    UART1->LIN_CTL = 0;
+    LIN_TimerIRQHandler(&s_sLin);
+    HOST_CHECK(__get_PRIMASK() == 0);
+
+    u32Ctl = UART1->LIN_CTL;
+    if((u32Ctl & UART_LIN_CTL_LIN_SHD_Msk) == 0)
+        return -1;
+
+    return (int32_t)(((u32Ctl & UART_LIN_CTL_LIN_PID_Msk) >> UART_LIN_CTL_LIN_PID_Pos) & 0x3F);
+}
+
+/* Run u32Ticks ticks and check that exactly one header, i32Id, starts on the first of them */
+static void Sim_Slot(int32_t i32Id, uint32_t u32Ticks)
+{
+    HOST_CHECK(Sim_Tick() == i32Id);
+    while(--u32Ticks)
+        HOST_CHECK(Sim_Tick() == -1);
+}
+
+int main(void)
+{
+    uint32_t i;
+
+    HostReg_Reset();
+
+    HOST_CHECK(LIN_InitFrame(&s_sFrameA, 0x10, 2, LIN_FRAME_PUBLISH, LIN_CHECKSUM_ENHANCED, Frame_Done) == 0);
+    HOST_CHECK(LIN_InitFrame(&s_sFrameB, 0x11, 2, LIN_FRAME_PUBLISH, LIN_CHECKSUM_ENHANCED, Frame_Done) == 0);
+    HOST_CHECK(LIN_InitFrame(&s_sFrameC, 0x12, 2, LIN_FRAME_PUBLISH, LIN_CHECKSUM_ENHANCED, Frame_Done) == 0);
+    HOST_CHECK(LIN_MasterOpen(&s_sLin, UART1, TIMER1, 1000) == 0);
+
+    /* Idle without a table */
+    for(i = 0; i < 5; i++)
+        HOST_CHECK(Sim_Tick() == -1);
+
+    /* The first table starts with the next tick and repeats */
+    HOST_CHECK(LIN_MasterSetSchedule(&s_sLin, s_asSched1, 2) == 0);
+    for(i = 0; i < 3; i++)
+    {
+        Sim_Slot(0x10, 2);
+        Sim_Slot(0x11, 3);
+    }
+
+    /* A new table waits for the end of the slot in progress */
+    HOST_CHECK(Sim_Tick() == 0x10);
+    HOST_CHECK(LIN_MasterSetSchedule(&s_sLin, s_asSched2, 1) == 0);
+    HOST_CHECK(Sim_Tick() == -1);
+    Sim_Slot(0x12, 4);
+    Sim_Slot(0x12, 4);
+
+    /* NULL stops the schedule at the end of the slot, and the open frame is reported */
+    HOST_CHECK(Sim_Tick() == 0x12);
+    s_u32Done = 0;
+    HOST_CHECK(LIN_MasterSetSchedule(&s_sLin, NULL, 0) == 0);
+    for(i = 0; i < 3; i++)
+        HOST_CHECK(Sim_Tick() == -1);
+    HOST_CHECK(s_u32Done == 0);
+    HOST_CHECK(Sim_Tick() == -1);
+    HOST_CHECK(s_u32Done == 1);
+    for(i = 0; i < 20; i++)
+        HOST_CHECK(Sim_Tick() == -1);
+    HOST_CHECK(s_u32Done == 1);
+    HOST_CHECK(s_sLin.psSched == NULL);
+
+    /* Started again from idle */
+    HOST_CHECK(LIN_MasterSetSchedule(&s_sLin, s_asSched1, 2) == 0);
+    Sim_Slot(0x10, 2);
+    Sim_Slot(0x11, 3);
+
+    /* Invalid tables are refused and leave the running one alone */
+    HOST_CHECK(LIN_MasterSetSchedule(&s_sLin, s_asSched1, 0) == LIN_ERR_PARAM);
+    Sim_Slot(0x10, 2);
+
+    LIN_Close(&s_sLin);
+
+    printf("test_lin_sched: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
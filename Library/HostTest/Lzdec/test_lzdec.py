@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# LZ decoder test: streams written by Tool/LzPack/lz_pack.py are decoded by test_lzdec_stream with the input
+# and output cut at random sizes (HostTest/CMakeLists.txt).
+#
+#   python3 test_lzdec.py path/to/test_lzdec_stream
+#
+# The images cover text, firmware-like code, runs longer than a match, data that does not compress, sizes
+# around the window and a full APROM image. SPDX-License-Identifier: Apache-2.0
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LZ_PACK = os.path.join(HERE, '..', '..', '..', 'Tool', 'LzPack', 'lz_pack.py')
+
+
+def firmware(rng, size):
+    # Instruction-like halfwords with repeated sequences, as compiled code has
+    words = [rng.randrange(0x10000) for _ in range(64)]
+    out = bytearray()
+    while len(out) < size:
+        if rng.random() < 0.3 and len(out) > 64:
+            start = rng.randrange(len(out) - 32)
+            out += out[start:start + rng.randrange(8, 32)]
+        else:
+            out += rng.choice(words).to_bytes(2, 'little')
+    return bytes(out[:size])
+
+
+def cases(rng):
+    text = b'NuMicro NUC1311 ISP update, compressed with lz_pack.py. ' * 40
+    yield 'one_byte', b'\x5a'
+    yield 'text', text
+    yield 'zeros', bytes(5000)
+    yield 'erased', b'\xff' * 3000 + firmware(rng, 1000) + b'\xff' * 3000
+    yield 'random', rng.randbytes(4000)
+    yield 'window_1023', firmware(rng, 1023) * 3
+    yield 'window_1024', firmware(rng, 1024) * 3
+    yield 'window_1025', firmware(rng, 1025) * 3
+    yield 'firmware', firmware(rng, 0xF000)
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.stderr.write('usage: %s test_lzdec_stream\n' % argv[0])
+        return 2
+
+    rng = random.Random(1311)
+    failed = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        image_bin, image_lz = os.path.join(tmp, 'image.bin'), os.path.join(tmp, 'image.lz')
+        for seed, (name, image) in enumerate(cases(rng)):
+            with open(image_bin, 'wb') as f:
+                f.write(image)
+
+            pack = subprocess.run([sys.executable, LZ_PACK, image_bin, image_lz], capture_output=True, text=True)
+            run = None
+            if pack.returncode == 0:
+                run = subprocess.run([argv[1], image_bin, image_lz, str(seed)], capture_output=True, text=True)
+
+            ok = pack.returncode == 0 and run.returncode == 0
+            failed += not ok
+            print('%-12s %s' % (name, pack.stdout.strip().split(': ')[-1]))
+            print('%s%s' % (run.stdout if run else '', '' if ok else 'FAIL %s\n' % (pack.stderr if run is None else
+                                                                                 'exit code %d' % run.returncode)))
+
+    print('test_lzdec: %s' % ('PASS' if failed == 0 else 'FAIL'))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
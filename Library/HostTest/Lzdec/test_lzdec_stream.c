@@ -0,0 +1,116 @@
+/**************************************************************************//**
+ * @file     test_lzdec_stream.c
+ * @version  V3.00
+ * @brief    Streaming LZ decoder test, run by test_lzdec.py
+ *
+ * @note     test_lzdec_stream image.bin image.lz seed
+ *
+ *           The stream written by Tool/LzPack/lz_pack.py is decoded in 50 passes, each cutting the input
+ *           and the output at random sizes down to one byte, as ISP packets and page buffers do. Every
+ *           pass must give the image back and consume the whole stream. A match reaching back before the
+ *           start of the stream must be refused.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "NUC1311.h"
+#include "lzdec.h"
+#include "host_reg.h"
+
+#define DATA_MAX        0x20000
+#define PASSES          50
+
+static uint8_t s_au8Image[DATA_MAX], s_au8Stream[DATA_MAX + DATA_MAX / 8 + 1], s_au8Out[DATA_MAX];
+static LZDEC_T s_sLz;
+
+static uint32_t File_Load(const char *pcName, uint8_t *pu8Buf, uint32_t u32Max)
+{
+    FILE *psFile = fopen(pcName, "rb");
+    uint32_t u32Len;
+
+    if(psFile == NULL)
+    {
+        printf("cannot open %s\n", pcName);
+        exit(2);
+    }
+    u32Len = (uint32_t)fread(pu8Buf, 1, u32Max, psFile);
+    fclose(psFile);
+
+    return u32Len;
+}
+
+/* Random piece size, mostly small, sometimes up to u32Max */
+static uint32_t Rand_Len(uint32_t u32Max)
+{
+    return 1 + (uint32_t)rand() % ((rand() % 4) ? 16 : u32Max);
+}
+
+/* Decode in random pieces, returns 1 on a mismatch */
+static uint32_t Decode_Pass(uint32_t u32ImageLen, uint32_t u32StreamLen)
+{
+    uint32_t u32In = 0, u32Out = 0, u32InLen, u32OutLen, u32Used;
+    int32_t i32Ret;
+
+    LZDEC_Init(&s_sLz);
+    memset(s_au8Out, 0, u32ImageLen);
+
+    while(u32Out < u32ImageLen)
+    {
+        u32InLen = Rand_Len(300);
+        if(u32InLen > u32StreamLen - u32In)
+            u32InLen = u32StreamLen - u32In;
+        u32OutLen = Rand_Len(FMC_FLASH_PAGE_SIZE);
+        if(u32OutLen > u32ImageLen - u32Out)
+            u32OutLen = u32ImageLen - u32Out;
+
+        i32Ret = LZDEC_Decode(&s_sLz, &s_au8Stream[u32In], u32InLen, &u32Used, &s_au8Out[u32Out], u32OutLen);
+        if((i32Ret < 0) || (u32Used > u32InLen))
+            return 1;
+
+        /* No progress is only possible without input */
+        if((i32Ret == 0) && (u32Used == 0) && (u32InLen != 0))
+            return 1;
+        if((i32Ret == 0) && (u32InLen == 0))
+            return 1;
+
+        u32In += u32Used;
+        u32Out += (uint32_t)i32Ret;
+    }
+
+    return (memcmp(s_au8Out, s_au8Image, u32ImageLen) != 0) || (u32In != u32StreamLen) ||
+           (s_sLz.u32InCount != u32StreamLen) || (s_sLz.u32OutCount != u32ImageLen);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint8_t au8Bad[] = {0x01, 0x41, 0x04, 0x00};    /* Literal 'A', then a match of distance 5 */
+    uint32_t u32ImageLen, u32StreamLen, u32Bad = 0, u32Used, i;
+    uint8_t au8Out[8];
+
+    if(argc != 4)
+    {
+        printf("usage: test_lzdec_stream image.bin image.lz seed\n");
+        return 2;
+    }
+
+    u32ImageLen = File_Load(argv[1], s_au8Image, sizeof(s_au8Image));
+    u32StreamLen = File_Load(argv[2], s_au8Stream, sizeof(s_au8Stream));
+    srand((unsigned)atoi(argv[3]));
+
+    for(i = 0; i < PASSES; i++)
+        u32Bad += Decode_Pass(u32ImageLen, u32StreamLen);
+    HOST_CHECK(u32Bad == 0);
+
+    LZDEC_Init(&s_sLz);
+    HOST_CHECK(LZDEC_Decode(&s_sLz, au8Bad, sizeof(au8Bad), &u32Used, au8Out, sizeof(au8Out)) == LZDEC_ERR_FORMAT);
+
+    printf("test_lzdec_stream: %u of %u bytes, %s\n", (unsigned)u32StreamLen, (unsigned)u32ImageLen,
+           (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,24 @@
+/**************************************************************************//**
+ * @file     host_core.c
+ * @version  V3.00
+ * @brief    Host (x86) Cortex-M0 core state
+ *
+ * @note     Core peripherals and state of Include/core_cm0.h. Linked by every host test, including the
+ *           ones that bring their own peripheral model.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "core_cm0.h"
+#include "host_reg.h"
+
+NVIC_Type g_sHostNVIC;
+SCB_Type g_sHostSCB;
+SysTick_Type g_sHostSysTick;
+uint32_t g_u32HostPrimask;
+uint32_t g_u32HostWfi;
+uint32_t g_u32HostReset;
+uint32_t g_u32HostFail;
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,125 @@
+/**************************************************************************//**
+ * @file     host_flash.c
+ * @version  V3.00
+ * @brief    Host (x86) flash and FMC model
+ *
+ * @note     See Include/host_flash.h. Linked by the model tests of the flash based drivers.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "host_flash.h"
+#include "host_reg.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     MAP_FIXED
+#endif
+
+/* Flash address in the model, checked for alignment */
+#define HOST_FLASH_CHECK(addr, align)   \
+    HOST_CHECK((((addr) & ((align) - 1)) == 0) && ((addr) - HOST_FLASH_BASE < HOST_FLASH_SIZE))
+
+uint32_t g_u32HostFlashOps;
+uint32_t g_u32HostVecmap;
+jmp_buf g_sHostFlashJmp;
+
+static int32_t s_i32FailAt = HOST_FLASH_NO_FAIL;
+
+/* Count one flash operation, the armed one does not happen */
+static void HostFlash_Op(void)
+{
+    if((s_i32FailAt != HOST_FLASH_NO_FAIL) && (s_i32FailAt-- == 0))
+        longjmp(g_sHostFlashJmp, 1);
+    g_u32HostFlashOps++;
+}
+
+__attribute__((constructor)) static void HostFlash_Init(void)
+{
+    void *pvMem;
+
+    pvMem = mmap(HOST_FLASH_PTR(HOST_FLASH_BASE), HOST_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if(pvMem != HOST_FLASH_PTR(HOST_FLASH_BASE))
+    {
+        fprintf(stderr, "host_flash: cannot map flash at 0x%08X\n", (unsigned)HOST_FLASH_BASE);
+        exit(2);
+    }
+    HostFlash_Reset();
+}
+
+void HostFlash_Reset(void)
+{
+    memset(HOST_FLASH_PTR(HOST_FLASH_BASE), 0xFF, HOST_FLASH_SIZE);
+    g_u32HostFlashOps = 0;
+    g_u32HostVecmap = FMC_APROM_BASE;
+    s_i32FailAt = HOST_FLASH_NO_FAIL;
+}
+
+void HostFlash_PowerFail(int32_t i32Ops)
+{
+    s_i32FailAt = i32Ops;
+}
+
+int32_t FMC_Erase(uint32_t u32PageAddr)
+{
+    HOST_FLASH_CHECK(u32PageAddr, FMC_FLASH_PAGE_SIZE);
+
+    if(s_i32FailAt == 0)
+    {
+        memset(HOST_FLASH_PTR(u32PageAddr), 0xFF, FMC_FLASH_PAGE_SIZE / 2);
+        HostFlash_Op();
+    }
+    HostFlash_Op();
+    memset(HOST_FLASH_PTR(u32PageAddr), 0xFF, FMC_FLASH_PAGE_SIZE);
+    return 0;
+}
+
+uint32_t FMC_Read(uint32_t u32Addr)
+{
+    HOST_FLASH_CHECK(u32Addr, 4);
+    return *(volatile uint32_t *)HOST_FLASH_PTR(u32Addr);
+}
+
+int32_t FMC_Write(uint32_t u32Addr, uint32_t u32Data)
+{
+    HOST_FLASH_CHECK(u32Addr, 4);
+    HostFlash_Op();
+    *(volatile uint32_t *)HOST_FLASH_PTR(u32Addr) &= u32Data;
+    return 0;
+}
+
+int32_t FMC_WriteMultiple(uint32_t u32Addr, const uint32_t *pu32Buf, uint32_t u32Count)
+{
+    uint32_t i;
+
+    /* Programming happens a page at a time on the real part, a request must not cross one */
+    HOST_CHECK((u32Count != 0) &&
+               ((u32Addr / FMC_FLASH_PAGE_SIZE) == ((u32Addr + u32Count * 4 - 1) / FMC_FLASH_PAGE_SIZE)));
+
+    for(i = 0; i < u32Count; i++)
+        FMC_Write(u32Addr + i * 4, pu32Buf[i]);
+    return 0;
+}
+
+uint32_t FMC_ReadDataFlashBaseAddr(void)
+{
+    return FMC_DATA_FLASH_BASE;
+}
+
+uint32_t FMC_GetVECMAP(void)
+{
+    return g_u32HostVecmap;
+}
+
+int32_t FMC_SetVectorPageAddr(uint32_t u32PageAddr)
+{
+    g_u32HostVecmap = u32PageAddr;
+    return 0;
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,65 @@
+/**************************************************************************//**
+ * @file     host_reg.c
+ * @version  V3.00
+ * @brief    Host (x86) register model of NUC1311 series
+ *
+ * @note     The APB and AHB peripheral regions are mapped as zero filled memory at their device addresses
+ *           before main(), so the register pointers of NUC1311.h work unchanged. Registers keep what was
+ *           written and have no side effects. A test plays the hardware by setting the status bits and
+ *           calling the interrupt handler.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "NUC1311.h"
+#include "host_reg.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     MAP_FIXED
+#endif
+
+#define HOST_APB_SIZE           0x00200000UL    /* APB1 and APB2 */
+#define HOST_AHB_SIZE           0x00010000UL    /* GCR, CLK, INT, GPIO and FMC */
+
+static void HostReg_Map(uint32_t u32Base, uint32_t u32Size)
+{
+    void *pvMem;
+
+    pvMem = mmap((void *)(uintptr_t)u32Base, u32Size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if(pvMem != (void *)(uintptr_t)u32Base)
+    {
+        fprintf(stderr, "host_reg: cannot map registers at 0x%08X\n", (unsigned)u32Base);
+        exit(2);
+    }
+}
+
+__attribute__((constructor)) static void HostReg_Init(void)
+{
+    HostReg_Map(APB1_BASE, HOST_APB_SIZE);
+    HostReg_Map(AHB_BASE, HOST_AHB_SIZE);
+}
+
+/**
+  * @brief      Return the model to its power-on state.
+  * @return     None
+  * @details    Clears every peripheral register, the core peripherals and the PRIMASK state.
+  */
+void HostReg_Reset(void)
+{
+    memset((void *)(uintptr_t)APB1_BASE, 0, HOST_APB_SIZE);
+    memset((void *)(uintptr_t)AHB_BASE, 0, HOST_AHB_SIZE);
+    memset(&g_sHostNVIC, 0, sizeof(g_sHostNVIC));
+    memset(&g_sHostSCB, 0, sizeof(g_sHostSCB));
+    memset(&g_sHostSysTick, 0, sizeof(g_sHostSysTick));
+    g_u32HostPrimask = 0;
+    g_u32HostWfi = 0;
+    g_u32HostReset = 0;
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,119 @@
+/**************************************************************************//**
+ * @file     test_spi_clock.c
+ * @version  V3.00
+ * @brief    SPI bus clock planner test against a brute-force search
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include "NUC1311.h"
+#include "host_reg.h"
+
+/* Best rate over every clock source, BCn and DIVIDER setting */
+static uint32_t BruteForce(uint32_t u32Hclk, uint32_t u32Pll, uint32_t u32Target, uint32_t u32Policy)
+{
+    uint32_t au32Src[2], i, u32Mul, u32Div, u32Clk, u32Err, u32Best = 0, u32BestErr = 0;
+    int32_t i32Has = 0, i32Above, i32BestAbove = 0, i32Better;
+
+    au32Src[0] = u32Hclk;
+    au32Src[1] = u32Pll;
+    for(i = 0; i < 2; i++)
+    {
+        if(au32Src[i] == 0)
+            continue;
+        for(u32Mul = 1; u32Mul <= 2; u32Mul++)
+        {
+            for(u32Div = 1; u32Div <= 256; u32Div++)
+            {
+                u32Clk = au32Src[i] / (u32Mul * u32Div);
+                if(u32Clk > u32Hclk)
+                    continue;
+                i32Above = ((uint64_t)u32Target * u32Mul * u32Div < au32Src[i]) ? 1 : 0;
+                u32Err = (u32Clk > u32Target) ? (u32Clk - u32Target) : (u32Target - u32Clk);
+                if(!i32Has)
+                    i32Better = 1;
+                else if(u32Policy == SPI_CLK_NEAREST)
+                    i32Better = (u32Err < u32BestErr);
+                else if(i32Above != i32BestAbove)
+                    i32Better = !i32Above;
+                else
+                    i32Better = i32Above ? (u32Clk < u32Best) : (u32Err < u32BestErr);
+                if(i32Better)
+                {
+                    i32Has = 1;
+                    u32Best = u32Clk;
+                    u32BestErr = u32Err;
+                    i32BestAbove = i32Above;
+                }
+            }
+        }
+    }
+    return u32Best;
+}
+
+static uint32_t Err(uint32_t u32A, uint32_t u32B)
+{
+    return (u32A > u32B) ? (u32A - u32B) : (u32B - u32A);
+}
+
+int main(void)
+{
+    const uint32_t au32Hclk[] = {12000000, 22118400, 32000000, 48000000, 50000000};
+    const uint32_t au32Pll[] = {0, 22118400, 48000000, 50000000, 72000000};
+    SPI_CLK_PLAN_T sPlan;
+    uint32_t a, b, u32Policy, u32Target, u32Want, u32Clk, u32Src, u32Cases = 0;
+
+    HostReg_Reset();
+
+    /* Every source pair, both policies, targets from 0 to above HCLK */
+    for(a = 0; a < sizeof(au32Hclk) / sizeof(au32Hclk[0]); a++)
+    {
+        for(b = 0; b < sizeof(au32Pll) / sizeof(au32Pll[0]); b++)
+        {
+            for(u32Target = 0; u32Target < 60000000; u32Target += (u32Target < 200000) ? 97 : 7919)
+            {
+                for(u32Policy = SPI_CLK_NEAREST; u32Policy <= SPI_CLK_NOT_ABOVE; u32Policy++)
+                {
+                    u32Clk = SPI_PlanBusClock(au32Hclk[a], au32Pll[b], u32Target, u32Policy, &sPlan);
+                    u32Want = BruteForce(au32Hclk[a], au32Pll[b], u32Target, u32Policy);
+
+                    /* Nearest may pick another rate at the same distance */
+                    if(u32Policy == SPI_CLK_NEAREST)
+                        HOST_CHECK(Err(u32Clk, u32Target) == Err(u32Want, u32Target));
+                    else
+                        HOST_CHECK(u32Clk == u32Want);
+
+                    /* The plan produces the rate it reports */
+                    u32Src = (sPlan.u32ClkSel == CLK_CLKSEL1_SPI0_S_HCLK) ? au32Hclk[a] : au32Pll[b];
+                    HOST_CHECK(u32Clk == sPlan.u32BusClock);
+                    HOST_CHECK(sPlan.u32Divider <= 255);
+                    HOST_CHECK(u32Clk == u32Src / ((sPlan.u32Divider + 1) * (sPlan.u32BCn ? 1 : 2)));
+                    u32Cases++;
+                    if(g_u32HostFail > 10)
+                        return HOST_RESULT();
+                }
+            }
+        }
+    }
+
+    /* SPI_SetBusClock() programs CLKSEL1, BCn and DIVIDER so that SPI_GetBusClock() reads the plan back */
+    CLK->PLLCON = CLK_PLLCON_50MHz_HXT;
+    CLK->CLKSEL0 = CLK_CLKSEL0_HCLK_S_HXT;      /* HCLK 12 MHz, PLL 50 MHz */
+    HOST_CHECK(SPI_SetBusClock(SPI0, 5000000) == 5000000);
+    HOST_CHECK((CLK->CLKSEL1 & CLK_CLKSEL1_SPI0_S_Msk) == CLK_CLKSEL1_SPI0_S_PLL);
+    HOST_CHECK(SPI_GetBusClock(SPI0) == 5000000);
+    HOST_CHECK(SPI_SetBusClock(SPI0, 20000000) == 12000000);
+    HOST_CHECK(SPI_GetBusClock(SPI0) == 12000000);
+
+    CLK->CLKSEL0 = CLK_CLKSEL0_HCLK_S_PLL;      /* HCLK 50 MHz */
+    HOST_CHECK(SPI_Open(SPI0, SPI_MASTER, SPI_MODE_0, 8, 1000000) == 1000000);
+    HOST_CHECK(SPI_GetBusClock(SPI0) == 1000000);
+    HOST_CHECK(SPI_SetBusClock(SPI0, 0) == 50000000 / 512);
+
+    printf("test_spi_clock: %u cases, %s\n", (unsigned)u32Cases, (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,49 @@
+/**************************************************************************//**
+ * @file     NUC1311.h
+ * @version  V3.00
+ * @brief    SPI register model for test_spi_flash
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUC1311_H__
+#define __NUC1311_H__
+
+#include "host_model.h"
+
+typedef struct
+{
+    HOST_REG_T CNTRL;
+    HOST_REG_T DIVIDER;
+    HOST_REG_T SSR;
+    HOST_REG_T RESERVE0;
+    HOST_REG_T RX;
+    HOST_REG_T RESERVE1[3];
+    HOST_REG_T TX;
+    HOST_REG_T RESERVE2[4];
+    HOST_REG_T VARCLK;
+    HOST_REG_T RESERVE3;
+    HOST_REG_T CNTRL2;
+    HOST_REG_T FIFO_CTL;
+    HOST_REG_T STATUS;
+} SPI_T;
+
+#define SPI_CNTRL_TX_NEG_Pos        2
+#define SPI_CNTRL_TX_NEG_Msk        (1ul << SPI_CNTRL_TX_NEG_Pos)
+#define SPI_SSR_SSR_Pos             0
+#define SPI_SSR_SSR_Msk             (1ul << SPI_SSR_SSR_Pos)
+#define SPI_SSR_SS_LVL_Pos          2
+#define SPI_SSR_SS_LVL_Msk          (1ul << SPI_SSR_SS_LVL_Pos)
+#define SPI_SSR_AUTOSS_Pos          3
+#define SPI_SSR_AUTOSS_Msk          (1ul << SPI_SSR_AUTOSS_Pos)
+#define SPI_STATUS_RX_EMPTY_Pos     24
+#define SPI_STATUS_RX_EMPTY_Msk     (1ul << SPI_STATUS_RX_EMPTY_Pos)
+#define SPI_STATUS_TX_FULL_Pos      27
+#define SPI_STATUS_TX_FULL_Msk      (1ul << SPI_STATUS_TX_FULL_Pos)
+
+#include "spi.h"
+
+#endif /* __NUC1311_H__ */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
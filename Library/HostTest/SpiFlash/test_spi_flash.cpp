@@ -0,0 +1,303 @@
+/**************************************************************************//**
+ * @file     test_spi_flash.cpp
+ * @version  V3.00
+ * @brief    SPI NOR Flash driver test against a simulated flash on the SPI register model
+ *
+ * @note     The model answers JEDEC ID, read status, write enable, fast read, page program and sector
+ *           erase on a 4 MB array, keeps WIP set for a few status reads after program and erase, and
+ *           flags an RX FIFO overrun if the driver has more than SPIFLASH_FIFO_DEPTH bytes in flight.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "NUC1311.h"
+#include "../../StdDriver/src/spi_flash.c"
+
+#define FLASH_SIZE      (4UL << 20)
+#define FLASH_ID        0xEF4016UL      /* 32 Mbit, capacity code 0x16 */
+#define FLASH_WIP_POLLS 3               /* Status reads that still see WIP after program or erase */
+#define RX_FIFO_DEPTH   8
+
+static uint8_t s_au8Flash[FLASH_SIZE];
+static uint8_t s_au8Ref[FLASH_SIZE];
+
+static uint8_t s_au8Rx[RX_FIFO_DEPTH];
+static uint32_t s_u32RxHead, s_u32RxCnt;
+static uint32_t s_u32Overrun;
+
+static uint32_t s_u32Selected;
+static uint32_t s_u32Pos;               /* Byte index in the current command */
+static uint8_t s_u8Cmd;
+static uint32_t s_u32Addr;
+static uint32_t s_u32Wel, s_u32WipPolls;
+static uint32_t s_u32Commands;
+
+static SPI_T s_sSpi;
+
+static void Flash_Select(uint32_t u32Sel)
+{
+    if(u32Sel && !s_u32Selected)
+        s_u32Pos = 0;
+    else if(!u32Sel && s_u32Selected && (s_u32Pos > 0))
+    {
+        /* Program and erase start when CS goes high */
+        s_u32Commands++;
+        if((s_u8Cmd == SPIFLASH_CMD_PAGE_PROGRAM) || (s_u8Cmd == SPIFLASH_CMD_SECTOR_ERASE))
+            s_u32WipPolls = FLASH_WIP_POLLS;
+        if(s_u8Cmd == SPIFLASH_CMD_SECTOR_ERASE && s_u32Wel && (s_u32Pos == 4))
+            memset(&s_au8Flash[s_u32Addr & ~(SPIFLASH_SECTOR_SIZE - 1)], 0xFF, SPIFLASH_SECTOR_SIZE);
+        if(s_u8Cmd != SPIFLASH_CMD_WRITE_ENABLE && s_u8Cmd != SPIFLASH_CMD_READ_STATUS &&
+                s_u8Cmd != SPIFLASH_CMD_READ_JEDEC_ID && s_u8Cmd != SPIFLASH_CMD_FAST_READ)
+            s_u32Wel = 0;
+    }
+    s_u32Selected = u32Sel;
+}
+
+static uint8_t Flash_Shift(uint8_t u8Out)
+{
+    uint32_t u32Pos = s_u32Pos++;
+    uint8_t u8In = 0xFF;
+
+    if(!s_u32Selected)
+        return 0xFF;
+
+    if(u32Pos == 0)
+    {
+        s_u8Cmd = u8Out;
+        if(s_u8Cmd == SPIFLASH_CMD_WRITE_ENABLE)
+            s_u32Wel = 1;
+        return 0xFF;
+    }
+
+    switch(s_u8Cmd)
+    {
+        case SPIFLASH_CMD_READ_JEDEC_ID:
+            if(u32Pos <= 3)
+                u8In = (uint8_t)(FLASH_ID >> (8 * (3 - u32Pos)));
+            break;
+        case SPIFLASH_CMD_READ_STATUS:
+            u8In = (uint8_t)((s_u32WipPolls ? SPIFLASH_SR_WIP : 0) | (s_u32Wel ? SPIFLASH_SR_WEL : 0));
+            if(s_u32WipPolls && (--s_u32WipPolls == 0))
+                s_u32Wel = 0;
+            break;
+        case SPIFLASH_CMD_FAST_READ:
+        case SPIFLASH_CMD_PAGE_PROGRAM:
+        case SPIFLASH_CMD_SECTOR_ERASE:
+            if(u32Pos <= 3)
+                s_u32Addr = (s_u32Addr << 8) | u8Out;
+            else if(s_u8Cmd == SPIFLASH_CMD_FAST_READ)
+            {
+                if(u32Pos >= 5)
+                    u8In = s_au8Flash[(s_u32Addr + u32Pos - 5) & (FLASH_SIZE - 1)];
+            }
+            else if((s_u8Cmd == SPIFLASH_CMD_PAGE_PROGRAM) && s_u32Wel)
+            {
+                /* Address wraps within the page, bits can only be cleared */
+                uint32_t u32A = (s_u32Addr & ~(SPIFLASH_PAGE_SIZE - 1)) | ((s_u32Addr + u32Pos - 4) & (SPIFLASH_PAGE_SIZE - 1));
+                s_au8Flash[u32A & (FLASH_SIZE - 1)] &= u8Out;
+            }
+            break;
+        default:
+            break;
+    }
+    return u8In;
+}
+
+static void Spi_SsrWrite(HOST_REG_T *psReg, uint32_t u32Val)
+{
+    psReg->u32Val = u32Val;
+    /* Line low when SS0 is asserted active low */
+    Flash_Select(((u32Val & SPI_SS0) != 0) && ((u32Val & SPI_SSR_SS_LVL_Msk) == 0));
+}
+
+static void Spi_TxWrite(HOST_REG_T *psReg, uint32_t u32Val)
+{
+    psReg->u32Val = u32Val;
+    if(s_u32RxCnt == RX_FIFO_DEPTH)
+    {
+        s_u32Overrun++;
+        return;
+    }
+    s_au8Rx[(s_u32RxHead + s_u32RxCnt) % RX_FIFO_DEPTH] = Flash_Shift((uint8_t)u32Val);
+    s_u32RxCnt++;
+}
+
+static uint32_t Spi_RxRead(HOST_REG_T *psReg)
+{
+    (void)psReg;
+    uint8_t u8Data = 0;
+
+    if(s_u32RxCnt)
+    {
+        u8Data = s_au8Rx[s_u32RxHead];
+        s_u32RxHead = (s_u32RxHead + 1) % RX_FIFO_DEPTH;
+        s_u32RxCnt--;
+    }
+    return u8Data;
+}
+
+static uint32_t Spi_StatusRead(HOST_REG_T *psReg)
+{
+    (void)psReg;
+    return (s_u32RxCnt == 0) ? SPI_STATUS_RX_EMPTY_Msk : 0;
+}
+
+/* Baseline SPI driver functions called by SPIFLASH_Open() */
+uint32_t SPI_Open(SPI_T *spi, uint32_t u32MasterSlave, uint32_t u32SPIMode, uint32_t u32DataWidth, uint32_t u32BusClock)
+{
+    spi->CNTRL = u32MasterSlave | u32SPIMode | (u32DataWidth << 3);
+    return u32BusClock;
+}
+
+void SPI_DisableAutoSS(SPI_T *spi)
+{
+    spi->SSR = spi->SSR & ~(SPI_SSR_AUTOSS_Msk | SPI_SSR_SSR_Msk);
+}
+
+void SPI_EnableFIFO(SPI_T *spi, uint32_t u32TxThreshold, uint32_t u32RxThreshold)
+{
+    spi->FIFO_CTL = (u32TxThreshold << 28) | (u32RxThreshold << 24);
+}
+
+void SPI_ClearRxFIFO(SPI_T *spi)
+{
+    (void)spi;
+    s_u32RxCnt = 0;
+}
+
+void SPI_ClearTxFIFO(SPI_T *spi)
+{
+    (void)spi;
+}
+
+static void Model_Init(void)
+{
+    s_sSpi.SSR.pfnWrite = Spi_SsrWrite;
+    s_sSpi.TX.pfnWrite = Spi_TxWrite;
+    s_sSpi.RX.pfnRead = Spi_RxRead;
+    s_sSpi.STATUS.pfnRead = Spi_StatusRead;
+    memset(s_au8Flash, 0xFF, sizeof(s_au8Flash));
+    memset(s_au8Ref, 0xFF, sizeof(s_au8Ref));
+}
+
+static void WaitIdle(SPIFLASH_T *flash)
+{
+    uint32_t u32Polls = 0;
+
+    while(SPIFLASH_Poll(flash) == SPIFLASH_BUSY)
+        u32Polls++;
+    HOST_CHECK(u32Polls == FLASH_WIP_POLLS);
+}
+
+static void Program(SPIFLASH_T *flash, uint32_t u32Addr, const uint8_t *pu8Data, uint32_t u32Len)
+{
+    uint32_t i;
+
+    HOST_CHECK(SPIFLASH_ProgramPage(flash, u32Addr, pu8Data, u32Len) == SPIFLASH_OK);
+    HOST_CHECK(SPIFLASH_IS_BUSY(flash));
+    for(i = 0; i < u32Len; i++)
+        s_au8Ref[u32Addr + i] &= pu8Data[i];
+    WaitIdle(flash);
+}
+
+static void CheckRead(SPIFLASH_T *flash, uint32_t u32Addr, uint32_t u32Len)
+{
+    static uint8_t au8Buf[3 * SPIFLASH_SECTOR_SIZE];
+
+    memset(au8Buf, 0x5A, u32Len);
+    HOST_CHECK(SPIFLASH_Read(flash, u32Addr, au8Buf, u32Len) == SPIFLASH_OK);
+    HOST_CHECK(memcmp(au8Buf, &s_au8Ref[u32Addr], u32Len) == 0);
+}
+
+int main(void)
+{
+    static SPIFLASH_T sFlash;
+    static uint8_t au8Page[SPIFLASH_PAGE_SIZE];
+    uint8_t u8Byte;
+    uint32_t i, u32Miss, u32Hit, u32Addr, u32Len;
+
+    Model_Init();
+    srand(26);
+
+    /* Open decodes the JEDEC ID */
+    HOST_CHECK(SPIFLASH_Open(&sFlash, &s_sSpi, 24000000) == SPIFLASH_OK);
+    HOST_CHECK(sFlash.u32JedecId == FLASH_ID);
+    HOST_CHECK(sFlash.u32Size == FLASH_SIZE);
+    HOST_CHECK(!SPIFLASH_IS_BUSY(&sFlash));
+
+    /* Program a page, reads are refused until the flash is idle again */
+    for(i = 0; i < SPIFLASH_PAGE_SIZE; i++)
+        au8Page[i] = (uint8_t)rand();
+    HOST_CHECK(SPIFLASH_ProgramPage(&sFlash, 0x1000, au8Page, SPIFLASH_PAGE_SIZE) == SPIFLASH_OK);
+    HOST_CHECK(SPIFLASH_Read(&sFlash, 0x1000, &u8Byte, 1) == SPIFLASH_BUSY);
+    HOST_CHECK(SPIFLASH_ProgramPage(&sFlash, 0x2000, au8Page, 1) == SPIFLASH_BUSY);
+    HOST_CHECK(SPIFLASH_EraseSector(&sFlash, 0x2000) == SPIFLASH_BUSY);
+    for(i = 0; i < SPIFLASH_PAGE_SIZE; i++)
+        s_au8Ref[0x1000 + i] = au8Page[i];
+    while(SPIFLASH_Poll(&sFlash) == SPIFLASH_BUSY);
+    CheckRead(&sFlash, 0x1000, SPIFLASH_PAGE_SIZE);
+
+    /* Line reads are cached, repeated small reads cost no SPI command */
+    SPIFLASH_InvalidateCache(&sFlash, 0, FLASH_SIZE);
+    u32Miss = sFlash.u32CacheMiss;
+    u32Hit = sFlash.u32CacheHit;
+    i = s_u32Commands;
+    CheckRead(&sFlash, 0x1010, 16);
+    CheckRead(&sFlash, 0x1020, 16);
+    CheckRead(&sFlash, 0x10F8, 16);                 /* Crosses into the next line */
+    HOST_CHECK(sFlash.u32CacheMiss == u32Miss + 2);
+    HOST_CHECK(sFlash.u32CacheHit == u32Hit + 2);
+    HOST_CHECK(s_u32Commands == i + 2);
+
+    /* A program invalidates the cached line, the next read returns the new data */
+    au8Page[0] = 0x00;
+    Program(&sFlash, 0x1020, au8Page, 1);
+    CheckRead(&sFlash, 0x1020, 1);
+
+    /* Erase clears the sector and its cached lines */
+    HOST_CHECK(SPIFLASH_EraseSector(&sFlash, 0x1234) == SPIFLASH_OK);
+    memset(&s_au8Ref[0x1000], 0xFF, SPIFLASH_SECTOR_SIZE);
+    WaitIdle(&sFlash);
+    CheckRead(&sFlash, 0x1000, SPIFLASH_SECTOR_SIZE);
+
+    /* Whole aligned lines stream past the cache */
+    u32Miss = sFlash.u32CacheMiss;
+    CheckRead(&sFlash, 0x3000, 2 * SPIFLASH_LINE_SIZE);
+    HOST_CHECK(sFlash.u32CacheMiss == u32Miss);
+
+    /* Random programs and reads against the reference, LRU eviction included */
+    for(i = 0; i < 400; i++)
+    {
+        u32Addr = (uint32_t)rand() % (16 * SPIFLASH_SECTOR_SIZE);
+        if((i % 5) == 0)
+        {
+            u32Len = 1 + (uint32_t)rand() % (SPIFLASH_PAGE_SIZE - (u32Addr & (SPIFLASH_PAGE_SIZE - 1)));
+            for(uint32_t j = 0; j < u32Len; j++)
+                au8Page[j] = (uint8_t)rand();
+            Program(&sFlash, u32Addr, au8Page, u32Len);
+        }
+        else
+        {
+            u32Len = 1 + (uint32_t)rand() % (2 * SPIFLASH_SECTOR_SIZE);
+            CheckRead(&sFlash, u32Addr, u32Len);
+        }
+    }
+
+    /* Range checks */
+    HOST_CHECK(SPIFLASH_Read(&sFlash, FLASH_SIZE - 1, au8Page, 2) == SPIFLASH_ERR_PARAM);
+    HOST_CHECK(SPIFLASH_ProgramPage(&sFlash, 0x10F0, au8Page, 0x20) == SPIFLASH_ERR_PARAM);
+    HOST_CHECK(SPIFLASH_ProgramPage(&sFlash, 0x1000, au8Page, 0) == SPIFLASH_ERR_PARAM);
+    HOST_CHECK(SPIFLASH_EraseSector(&sFlash, FLASH_SIZE) == SPIFLASH_ERR_PARAM);
+
+    /* The pipelined transfer never overran the RX FIFO */
+    HOST_CHECK(s_u32Overrun == 0);
+
+    printf("test_spi_flash: %s\n", (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
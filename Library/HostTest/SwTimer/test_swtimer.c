@@ -0,0 +1,161 @@
+/**************************************************************************//**
+ * @file     test_swtimer.c
+ * @version  V3.00
+ * @brief    Software timer service test on a simulated TIMER0
+ *
+ * @note     The simulation advances TDR one tick at a time and enters SWTIMER_IRQHandler() on a compare
+ *           match or when the service pends the interrupt, as the TIMER in continuous mode does. Every
+ *           callback must run exactly at its due tick, across several 24-bit TDR wraps. The exception is a
+ *           due tick on TDR value 0 or 1, which TCMPR cannot hold; it runs at TDR value 2.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "NUC1311.h"
+#include "swtimer.h"
+#include "host_reg.h"
+
+#define TMR_CNT         3000
+#define SIM_TICKS       40000000UL          /* More than two TDR wraps */
+#define NOT_DUE         0xFFFFFFFFFFFFFFFFULL
+
+static uint64_t s_u64Now;                   /* Simulated time in ticks */
+static uint32_t s_u32Irqs;
+static SWTIMER_T s_asTmr[TMR_CNT];
+static uint64_t s_au64Due[TMR_CNT];
+static uint32_t s_au32Period[TMR_CNT];
+static uint32_t s_u32Fires;
+
+/* Advance the TIMER by one tick and raise the interrupt the way the hardware does */
+static void Sim_Tick(void)
+{
+    s_u64Now++;
+    HOST_REG(TIMER0->TDR) = (uint32_t)s_u64Now & 0xFFFFFFUL;
+    if((TIMER0->TDR == TIMER0->TCMPR) || NVIC_GetPendingIRQ(TMR0_IRQn))
+    {
+        NVIC_ClearPendingIRQ(TMR0_IRQn);
+        s_u32Irqs++;
+        SWTIMER_IRQHandler();
+        HOST_CHECK(__get_PRIMASK() == 0);
+    }
+}
+
+static void Sim_Run(uint64_t u64Ticks)
+{
+    while(u64Ticks--)
+        Sim_Tick();
+}
+
+static void Random_Func(void *pvArg)
+{
+    uint32_t i = (uint32_t)(uintptr_t)pvArg;
+    uint32_t u32Ticks;
+
+    s_u32Fires++;
+    if((s_au64Due[i] != s_u64Now) && !(((s_au64Due[i] & 0xFFFFFFUL) < 2) && ((s_u64Now & 0xFFFFFFUL) == 2)))
+    {
+        if(g_u32HostFail < 10)
+            printf("timer %u fired at %llu, due %llu\n", (unsigned)i, (unsigned long long)s_u64Now, (unsigned long long)s_au64Due[i]);
+        g_u32HostFail++;
+    }
+
+    if(s_au32Period[i])
+        s_au64Due[i] += s_au32Period[i];
+    else
+        s_au64Due[i] = NOT_DUE;
+
+    /* Restart from the callback */
+    if((s_au32Period[i] == 0) && ((rand() % 3) == 0))
+    {
+        u32Ticks = 1 + (uint32_t)rand() % 200000;
+        s_au64Due[i] = s_u64Now + u32Ticks;
+        HOST_CHECK(SWTIMER_Start(&s_asTmr[i], u32Ticks, 0, Random_Func, pvArg) == 0);
+    }
+}
+
+static uint32_t s_u32Count;
+
+static void Count_Func(void *pvArg)
+{
+    (void)pvArg;
+    s_u32Count++;
+}
+
+int main(void)
+{
+    SWTIMER_T sTmr;
+    uint32_t i, u32Ticks, u32Irqs;
+
+    HostReg_Reset();
+
+    /* TIMER0 clocked by the 12 MHz HXT, prescaler limited to 256 */
+    HOST_CHECK(SWTIMER_Open(TIMER0, 10000) == 12000000 / 256);
+    HOST_CHECK((TIMER0->TCSR & TIMER_TCSR_MODE_Msk) == TIMER_CONTINUOUS_MODE);
+    HOST_CHECK(TIMER0->TCSR & TIMER_TCSR_IE_Msk);
+    HOST_CHECK(NVIC->ISER[0] & (1UL << TMR0_IRQn));
+    HOST_CHECK(SWTIMER_GetIdleTicks() == 0xFFFFFFFFUL);
+
+    /* Range checks */
+    HOST_CHECK(SWTIMER_Start(&sTmr, SWTIMER_MAX_TICKS + 1, 0, Count_Func, NULL) == -1);
+    HOST_CHECK(SWTIMER_Start(&sTmr, 1, SWTIMER_MAX_TICKS + 1, Count_Func, NULL) == -1);
+
+    /* One-shot: fires once at its tick, costs a handful of interrupts, not one per tick */
+    HOST_CHECK(SWTIMER_Start(&sTmr, 5000, 0, Count_Func, NULL) == 0);
+    HOST_CHECK(SWTIMER_IS_ACTIVE(&sTmr));
+    HOST_CHECK(SWTIMER_GetIdleTicks() <= 5000);
+    Sim_Run(4999);
+    HOST_CHECK(s_u32Count == 0);
+    Sim_Run(1);
+    HOST_CHECK(s_u32Count == 1);
+    HOST_CHECK(!SWTIMER_IS_ACTIVE(&sTmr));
+    HOST_CHECK(s_u32Irqs <= 8);
+    HOST_CHECK(SWTIMER_GetTick() == 5000);
+
+    /* Periodic, then stopped */
+    s_u32Count = 0;
+    HOST_CHECK(SWTIMER_Start(&sTmr, 10, 100, Count_Func, NULL) == 0);
+    Sim_Run(1010);
+    HOST_CHECK(s_u32Count == 11);
+    SWTIMER_Stop(&sTmr);
+    Sim_Run(1000);
+    HOST_CHECK(s_u32Count == 11);
+    HOST_CHECK(SWTIMER_GetIdleTicks() == 0xFFFFFFFFUL);
+
+    /* Thousands of timers of all ranges, restarted and stopped at random */
+    srand(29);
+    s_u32Irqs = 0;
+    for(i = 0; i < TMR_CNT; i++)
+    {
+        u32Ticks = 1 + (uint32_t)rand() % (((i % 10) == 0) ? 8000000 : 100000);
+        s_au32Period[i] = ((i % 3) == 0) ? 1 + (uint32_t)rand() % 20000 : 0;
+        s_au64Due[i] = s_u64Now + u32Ticks;
+        HOST_CHECK(SWTIMER_Start(&s_asTmr[i], u32Ticks, s_au32Period[i], Random_Func, (void *)(uintptr_t)i) == 0);
+    }
+
+    for(u32Ticks = 0; u32Ticks < SIM_TICKS; u32Ticks++)
+    {
+        Sim_Tick();
+        if((rand() % 5000) == 0)
+        {
+            i = (uint32_t)rand() % TMR_CNT;
+            SWTIMER_Stop(&s_asTmr[i]);
+            s_au64Due[i] = NOT_DUE;
+        }
+    }
+
+    /* Nothing overdue is left behind */
+    for(i = 0; i < TMR_CNT; i++)
+        HOST_CHECK((s_au64Due[i] == NOT_DUE) || (s_au64Due[i] > s_u64Now));
+
+    u32Irqs = s_u32Irqs;
+    HOST_CHECK(u32Irqs <= s_u32Fires + SIM_TICKS / 32);
+
+    printf("test_swtimer: %u expiries, %u interrupts in %u ticks, %s\n", (unsigned)s_u32Fires, (unsigned)u32Irqs,
+           (unsigned)SIM_TICKS, (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
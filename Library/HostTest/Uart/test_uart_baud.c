@@ -0,0 +1,161 @@
+/**************************************************************************//**
+ * @file     test_uart_baud.c
+ * @version  V3.00
+ * @brief    UART baud rate planner test against an exhaustive divider search
+ *
+ * @note     For every UART clock and baud rate of the sweep, the divider chosen by UART_CalcBaud() must be as
+ *           close as any divider the three BAUD modes can produce, within the 1 ppm resolution of the
+ *           planner. The reference search uses a table of every reachable divider N. It also checks that
+ *           UART_Open() sets the nearest rate for a baud rate out of range.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "NUC1311.h"
+#include "host_reg.h"
+
+#define N_MAX           (16UL * (0xFFFF + 2))
+
+static uint8_t s_au8Valid[N_MAX + 1];       /* 1 if the UART can divide by N */
+static uint32_t s_au32Below[N_MAX + 1];     /* Largest valid divider <= N, 0 if none */
+static uint32_t s_au32Above[N_MAX + 1];     /* Smallest valid divider >= N, 0 if none */
+
+static void Ref_Init(void)
+{
+    uint32_t u32N, u32M, u32D, u32Last;
+
+    /* Mode 2: BRD + 2, BRD >= 3. Mode 0: 16 * (BRD + 2). Mode 1: (DIVIDER_X + 1) * (BRD + 2), DIVIDER_X >= 8 */
+    for(u32D = 5; u32D <= 0xFFFF + 2; u32D++)
+        s_au8Valid[u32D] = 1;
+    for(u32M = 9; u32M <= 16; u32M++)
+    {
+        for(u32D = 2; u32D <= 0xFFFF + 2; u32D++)
+            s_au8Valid[u32M * u32D] = 1;
+    }
+
+    u32Last = 0;
+    for(u32N = 0; u32N <= N_MAX; u32N++)
+    {
+        if(s_au8Valid[u32N])
+            u32Last = u32N;
+        s_au32Below[u32N] = u32Last;
+    }
+
+    u32Last = 0;
+    for(u32N = N_MAX + 1; u32N-- > 0;)
+    {
+        if(s_au8Valid[u32N])
+            u32Last = u32N;
+        s_au32Above[u32N] = u32Last;
+    }
+}
+
+/* Divider N programmed by a BAUD register value, 0 if the value is not a valid setting */
+static uint32_t Ref_Divider(uint32_t u32Baud)
+{
+    uint32_t u32D = (u32Baud & UART_BAUD_BRD_Msk) + 2;
+    uint32_t u32M;
+
+    if((u32Baud & UART_BAUD_MODE2) == UART_BAUD_MODE2)
+        return (u32D >= 5) ? u32D : 0;
+
+    if(u32Baud & UART_BAUD_DIV_X_EN_Msk)
+    {
+        u32M = ((u32Baud & UART_BAUD_DIVIDER_X_Msk) >> UART_BAUD_DIVIDER_X_Pos) + 1;
+        return (u32M >= 9) ? u32M * u32D : 0;
+    }
+
+    return 16 * u32D;
+}
+
+static double Ref_ErrPpm(uint32_t u32ClkFreq, uint32_t u32BaudRate, uint32_t u32N)
+{
+    double dErr = ((double)u32ClkFreq / u32N - u32BaudRate) / u32BaudRate * 1e6;
+
+    return (dErr < 0) ? -dErr : dErr;
+}
+
+/* Compare UART_CalcBaud() with the best reachable divider, returns 1 on a mismatch */
+static uint32_t Check_Baud(uint32_t u32ClkFreq, uint32_t u32BaudRate)
+{
+    UART_BAUD_PLAN_T sPlan;
+    uint32_t u32Ideal = u32ClkFreq / u32BaudRate;
+    uint32_t au32N[2], u32N, i;
+    double dBest = 1e18, dErr;
+    int32_t i32Ret;
+
+    /* The error only grows away from clock / baud, so the best divider is a neighbour of it */
+    au32N[0] = (u32Ideal <= N_MAX) ? s_au32Below[u32Ideal] : s_au32Below[N_MAX];
+    au32N[1] = (u32Ideal + 1 <= N_MAX) ? s_au32Above[u32Ideal + 1] : 0;
+    for(i = 0; i < 2; i++)
+    {
+        if(au32N[i] == 0)
+            continue;
+        dErr = Ref_ErrPpm(u32ClkFreq, u32BaudRate, au32N[i]);
+        if(dErr < dBest)
+            dBest = dErr;
+    }
+
+    i32Ret = UART_CalcBaud(u32ClkFreq, u32BaudRate, &sPlan);
+
+    /* Out of range: the planner refuses only if no divider lies within 1/2 of the rate */
+    if(i32Ret != 0)
+        return (dBest < 1e6) && (u32Ideal >= 5) && (u32Ideal <= N_MAX);
+
+    u32N = Ref_Divider(sPlan.u32Baud);
+    if(u32N == 0)
+        return 1;
+
+    dErr = Ref_ErrPpm(u32ClkFreq, u32BaudRate, u32N);
+    if(dErr > dBest + 1.0)
+        return 1;
+
+    if(sPlan.u32Actual != (u32ClkFreq + u32N / 2) / u32N)
+        return 1;
+
+    return ((sPlan.i32ErrPpm < 0 ? -(double)sPlan.i32ErrPpm : (double)sPlan.i32ErrPpm) > dErr + 1.0);
+}
+
+int main(void)
+{
+    static const uint32_t au32Clk[] = {__HXT, __HIRC, 11059200, 24000000, 48000000, 50000000, 72000000};
+    uint32_t u32Cases = 0, u32Bad = 0;
+    uint32_t i, u32Baud;
+
+    HostReg_Reset();
+    Ref_Init();
+
+    for(i = 0; i < sizeof(au32Clk) / sizeof(au32Clk[0]); i++)
+    {
+        /* Every rate up to 250000, then a sweep up to the fastest divider */
+        for(u32Baud = 1; u32Baud <= au32Clk[i] / 4; u32Baud += (u32Baud < 250000) ? 1 : 37)
+        {
+            u32Cases++;
+            if(Check_Baud(au32Clk[i], u32Baud))
+            {
+                if(u32Bad++ < 10)
+                    printf("clock %u baud %u: divider not the best\n", (unsigned)au32Clk[i], (unsigned)u32Baud);
+            }
+        }
+    }
+    HOST_CHECK(u32Bad == 0);
+
+    /* UART_Open() with the HXT as UART clock after reset */
+    CLK->CLKSTATUS = CLK_CLKSTATUS_XTL12M_STB_Msk;
+    UART_Open(UART0, 115200);
+    HOST_CHECK(Ref_Divider(UART0->BAUD) == 104);
+
+    /* Out of range: the nearest divider instead of the old setting */
+    UART_Open(UART0, __HXT / 2);
+    HOST_CHECK(UART0->BAUD == (UART_BAUD_MODE2 | 3));
+    UART_Open(UART0, 10);
+    HOST_CHECK(UART0->BAUD == (UART_BAUD_MODE0 | 0xFFFF));
+
+    printf("test_uart_baud: %u cases, %s\n", (unsigned)u32Cases, (g_u32HostFail == 0) ? "PASS" : "FAIL");
+    return HOST_RESULT();
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
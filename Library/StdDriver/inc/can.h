@@ -3,7 +3,10 @@
  * @version  V3.00
  * @brief    NUC1311 Series CAN Driver Header File
  *
- * @note
+ * @note     The functions that program a message interface (IF1, IF2) mask interrupts from the busy check to the
+ *           transfer request, CAN_Receive() until the message is read out of IF2. Interrupt handlers could then
+ *           use IF1, as the CAN transmit queue (can_txq.c) and the ISO-TP transport (isotp.c) do, provided they
+ *           wait for their transfer before returning. CAN_Receive() could be called from handlers as well.
  *
  * @copyright SPDX-License-Identifier: Apache-2.0
  *
@@ -79,6 +82,15 @@ typedef struct
 
 #define MSG(id)  (id)
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* CAN Interrupt Dispatch Constant Definitions                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+#define    CAN_MSG_OBJ_CNT    32        /*!< Number of message objects of a CAN module */
+#define    CAN_IIDR_STATUS    0x8000    /*!< IIDR value of the status change and error interrupt */
+
+typedef void (*CAN_MSG_FUNC_T)(CAN_T *tCAN, uint32_t u32MsgNum, void *pvArg);     /*!< Message object interrupt handler */
+typedef void (*CAN_STATUS_FUNC_T)(CAN_T *tCAN, uint32_t u32Status, void *pvArg);  /*!< Status interrupt handler, u32Status is the STATUS register read */
+
 
 /*@}*/ /* end of group CAN_EXPORTED_CONSTANTS */
 
@@ -151,6 +163,7 @@ typedef struct
 /* Define CAN functions prototype                                                                          */
 /*---------------------------------------------------------------------------------------------------------*/
 uint32_t CAN_SetBaudRate(CAN_T *tCAN, uint32_t u32BaudRate);
+uint32_t CAN_GetCANBitRate(CAN_T *tCAN);
 uint32_t CAN_Open(CAN_T *tCAN, uint32_t u32BaudRate, uint32_t u32Mode);
 void CAN_Close(CAN_T *tCAN);
 void CAN_CLR_INT_PENDING_BIT(CAN_T *tCAN, uint8_t u32MsgNum);
@@ -163,6 +176,9 @@ int32_t CAN_SetRxMsg(CAN_T *tCAN, uint32_t u32MsgNum , uint32_t u32IDType, uint3
 int32_t CAN_SetRxMsgAndMsk(CAN_T *tCAN, uint32_t u32MsgNum , uint32_t u32IDType, uint32_t u32ID, uint32_t u32IDMask);
 int32_t CAN_SetTxMsg(CAN_T *tCAN, uint32_t u32MsgNum , STR_CANMSG_T* pCanMsg);
 int32_t CAN_TriggerTxMsg(CAN_T  *tCAN, uint32_t u32MsgNum);
+void CAN_InstallMsgHandler(CAN_T *tCAN, uint32_t u32MsgNum, CAN_MSG_FUNC_T pfnFunc, void *pvArg);
+void CAN_InstallStatusHandler(CAN_T *tCAN, CAN_STATUS_FUNC_T pfnFunc, void *pvArg);
+uint32_t CAN_IRQDispatch(CAN_T *tCAN);
 
 
 /*@}*/ /* end of group CAN_EXPORTED_FUNCTIONS */
@@ -0,0 +1,137 @@
+/**************************************************************************//**
+ * @file     can_diag.h
+ * @version  V3.00
+ * @brief    NUC1311 series CAN bus health and load diagnostics header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __CAN_DIAG_H__
+#define __CAN_DIAG_H__
+
+#include "NUC1311.h"
+#include "swtimer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup CANDIAG_Driver CAN Diagnostics
+  @{
+*/
+
+/** @addtogroup CANDIAG_EXPORTED_CONSTANTS CAN Diagnostics Exported Constants
+  @{
+*/
+
+#ifndef CANDIAG_BOFF_MIN_MS
+#define CANDIAG_BOFF_MIN_MS     10      /*!< Wait before the first bus-off recovery, doubled on each bus-off that follows */
+#endif
+
+#ifndef CANDIAG_BOFF_MAX_MS
+#define CANDIAG_BOFF_MAX_MS     2000    /*!< Longest wait before a bus-off recovery */
+#endif
+
+#ifndef CANDIAG_FRAME_BITS
+#define CANDIAG_FRAME_BITS      111     /*!< Frame length assumed for the load until CANDIAG_CountFrame() is called, 11-bit ID and 8 data bytes */
+#endif
+
+#define CANDIAG_DIR_TX          0       /*!< Frame sent */
+#define CANDIAG_DIR_RX          1       /*!< Frame received */
+
+#define CANDIAG_STATE_ACTIVE    0       /*!< Error active, both error counters below 96 */
+#define CANDIAG_STATE_WARNING   1       /*!< An error counter reached the warning limit of 96 */
+#define CANDIAG_STATE_PASSIVE   2       /*!< Error passive, an error counter above 127 */
+#define CANDIAG_STATE_BUS_OFF   3       /*!< Bus-off, the controller has left the bus */
+
+#define CANDIAG_ERR_PARAM       (-1)    /*!< Invalid parameter */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Statistics, 48 bytes with no padding so it can be sent as is                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32TxFrames;                           /*!< Frames sent (TxOK) */
+    uint32_t u32RxFrames;                           /*!< Frames received (RxOK), accepted by a message object or not */
+    uint32_t u32TxBytes;                            /*!< Data bytes of the frames counted by CANDIAG_CountFrame() as sent */
+    uint32_t u32RxBytes;                            /*!< Data bytes of the frames counted by CANDIAG_CountFrame() as received */
+    uint16_t au16Lec[6];                            /*!< Bus errors by last error code: stuff, form, ACK, bit 1, bit 0 and CRC */
+    uint16_t u16Warning;                            /*!< Entries into the warning state */
+    uint16_t u16Passive;                            /*!< Entries into error passive */
+    uint16_t u16BusOff;                             /*!< Bus-off events */
+    uint16_t u16Recover;                            /*!< Bus-off recoveries started */
+    uint16_t u16Load;                               /*!< Bus load of the last window in 0.1 %, low under bursts */
+    uint16_t u16LoadMax;                            /*!< Highest bus load in 0.1 % */
+    uint8_t u8Tec;                                  /*!< Transmit error counter */
+    uint8_t u8Rec;                                  /*!< Receive error counter, 128 once receive error passive */
+    uint8_t u8TecMax;                               /*!< Highest transmit error counter */
+    uint8_t u8RecMax;                               /*!< Highest receive error counter */
+    uint8_t u8State;                                /*!< CANDIAG_STATE_ACTIVE ~ CANDIAG_STATE_BUS_OFF */
+    uint8_t u8Lec;                                  /*!< Last bus error code, 1 ~ 6, 0 if none yet */
+    uint8_t u8Backoff;                              /*!< Bus-off recoveries in a row, each doubles the wait */
+    uint8_t u8Reserved;                             /*!< Always 0 */
+} CANDIAG_STAT_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Diagnostics control block                                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    CAN_T *tCAN;                                    /*!< CAN module */
+    uint32_t u32TickFreq;                           /*!< SWTIMER tick frequency */
+    uint32_t u32WinBits;                            /*!< Bits the bus carries in one load window */
+    volatile uint32_t u32WinFrames;                 /*!< Frames seen in the current load window. Frames completed before
+                                                         the status interrupt is serviced count once, so it is low under
+                                                         bursts */
+    uint32_t u32MeanBits;                           /*!< Frame length used for the load, in bits */
+    uint32_t u32SumFrames;                          /*!< Frames counted by CANDIAG_CountFrame() in the current window */
+    uint32_t u32SumBits;                            /*!< Bits of those frames */
+    uint8_t u8BusOffSeen;                           /*!< 1 if a bus-off happened in the current window */
+    SWTIMER_T sWinTmr;                              /*!< Load window */
+    SWTIMER_T sBoffTmr;                             /*!< Bus-off recovery wait */
+    CANDIAG_STAT_T sStat;                           /*!< Statistics */
+} CANDIAG_T;
+
+/*@}*/ /* end of group CANDIAG_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup CANDIAG_EXPORTED_FUNCTIONS CAN Diagnostics Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the error state of the CAN module.
+  * @param[in]  psDiag The pointer of the diagnostics control block.
+  * @return     CANDIAG_STATE_ACTIVE, CANDIAG_STATE_WARNING, CANDIAG_STATE_PASSIVE or CANDIAG_STATE_BUS_OFF.
+  */
+#define CANDIAG_GET_STATE(psDiag)   ((psDiag)->sStat.u8State)
+
+
+int32_t CANDIAG_Open(CANDIAG_T *psDiag, CAN_T *tCAN, uint32_t u32TickFreq, uint32_t u32WindowMs);
+void CANDIAG_Close(CANDIAG_T *psDiag);
+void CANDIAG_StatusHandler(CAN_T *tCAN, uint32_t u32Status, void *pvArg);
+void CANDIAG_CountFrame(CANDIAG_T *psDiag, const STR_CANMSG_T *pCanMsg, uint32_t u32Dir);
+void CANDIAG_GetStat(CANDIAG_T *psDiag, CANDIAG_STAT_T *psStat);
+void CANDIAG_ClearStat(CANDIAG_T *psDiag);
+
+
+/*@}*/ /* end of group CANDIAG_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group CANDIAG_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__CAN_DIAG_H__
@@ -0,0 +1,140 @@
+/**************************************************************************//**
+ * @file     can_txq.h
+ * @version  V3.00
+ * @brief    NUC1311 series CAN priority transmit queue header file
+ *
+ * @note     The queue uses message interface IF1 (IF[0]) from the CAN interrupt. Code outside the CAN driver that
+ *           programs an interface must mask interrupts for the whole sequence, as the driver does.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __CAN_TXQ_H__
+#define __CAN_TXQ_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup CANTXQ_Driver CAN Transmit Queue
+  @{
+*/
+
+/** @addtogroup CANTXQ_EXPORTED_CONSTANTS CAN Transmit Queue Exported Constants
+  @{
+*/
+
+#define CANTXQ_MAX_OBJ          8       /*!< Most message objects in the transmit pool */
+
+#define CANTXQ_ERR_PARAM        (-1)    /*!< Invalid parameter */
+#define CANTXQ_ERR_FULL         (-2)    /*!< Queue is full, the frame is not queued */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Queued frame                                                                                           */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    STR_CANMSG_T sMsg;                              /*!< Frame */
+    uint32_t u32Key;                                /*!< Arbitration field, lower wins */
+    uint32_t u32Seq;                                /*!< Queue order, keeps frames of one ID in order */
+    uint32_t u32Stamp;                              /*!< TSTAMP time the frame was queued */
+} CANTXQ_ENTRY_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Latency of one identifier, from CANTXQ_Send() to the end of the transmission                           */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Id;                                 /*!< Identifier */
+    uint32_t u32IdType;                             /*!< CAN_STD_ID or CAN_EXT_ID */
+    uint32_t u32Frames;                             /*!< Frames sent, 0 marks a free entry */
+    uint32_t u32TotalUs;                            /*!< Sum of the latencies */
+    uint32_t u32MaxUs;                              /*!< Longest latency */
+} CANTXQ_LAT_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Statistics                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Queued;                             /*!< Frames accepted by CANTXQ_Send() */
+    uint32_t u32Sent;                               /*!< Frames transmitted */
+    uint32_t u32Full;                               /*!< Frames refused because the queue was full */
+    uint32_t u32QueueHigh;                          /*!< Most frames waiting in RAM */
+    uint32_t u32Untracked;                          /*!< Frames sent whose identifier did not fit in the latency table */
+} CANTXQ_STAT_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Message object of the pool                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Key;                                /*!< Arbitration field of the loaded frame */
+    uint32_t u32Id;                                 /*!< Identifier of the loaded frame */
+    uint32_t u32Stamp;                              /*!< TSTAMP time the loaded frame was queued */
+    uint8_t u8IdType;                               /*!< CAN_STD_ID or CAN_EXT_ID */
+    uint8_t u8Busy;                                 /*!< 1 while the object holds a frame waiting for transmission */
+} CANTXQ_SLOT_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Queue control block                                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    CAN_T *tCAN;                                    /*!< CAN module */
+    uint32_t u32FirstObj;                           /*!< First message object of the pool, 0 ~ 31 */
+    uint32_t u32ObjCount;                           /*!< Message objects in the pool */
+    CANTXQ_ENTRY_T *psHeap;                         /*!< Binary heap of the waiting frames, highest priority first */
+    uint32_t u32Size;                               /*!< Heap capacity */
+    volatile uint32_t u32Count;                     /*!< Frames waiting in RAM */
+    volatile uint32_t u32Loaded;                    /*!< Frames loaded in the pool */
+    uint32_t u32Seq;                                /*!< Sequence number of the next frame */
+    CANTXQ_LAT_T *psLat;                            /*!< Latency table, could be NULL */
+    uint32_t u32LatCount;                           /*!< Entries of the latency table */
+    CANTXQ_SLOT_T asSlot[CANTXQ_MAX_OBJ];           /*!< Pool state */
+    CANTXQ_STAT_T sStat;                            /*!< Statistics */
+} CANTXQ_T;
+
+/*@}*/ /* end of group CANTXQ_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup CANTXQ_EXPORTED_FUNCTIONS CAN Transmit Queue Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the number of frames not yet transmitted.
+  * @param[in]  psQ The pointer of the queue control block.
+  * @return     Frames waiting in RAM plus frames loaded in the message object pool.
+  */
+#define CANTXQ_GET_PENDING(psQ)     ((psQ)->u32Count + (psQ)->u32Loaded)
+
+
+int32_t CANTXQ_Open(CANTXQ_T *psQ, CAN_T *tCAN, uint32_t u32FirstObj, uint32_t u32ObjCount, CANTXQ_ENTRY_T *psBuf, uint32_t u32Size);
+void CANTXQ_Close(CANTXQ_T *psQ);
+void CANTXQ_SetLatencyTable(CANTXQ_T *psQ, CANTXQ_LAT_T *psLat, uint32_t u32Count);
+int32_t CANTXQ_Send(CANTXQ_T *psQ, STR_CANMSG_T *pCanMsg);
+void CANTXQ_ClearStat(CANTXQ_T *psQ);
+int32_t CANTXQ_IRQHandler(CANTXQ_T *psQ, uint32_t u32MsgNum);
+
+
+/*@}*/ /* end of group CANTXQ_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group CANTXQ_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__CAN_TXQ_H__
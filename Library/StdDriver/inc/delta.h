@@ -0,0 +1,116 @@
+/**************************************************************************//**
+ * @file     delta.h
+ * @version  V3.00
+ * @brief    NUC1311 series in-place delta firmware update header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __DELTA_H__
+#define __DELTA_H__
+
+#include "NUC1311.h"
+#include "fmc.h"
+#include "kvs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup DELTA_Driver Delta Firmware Update
+  @{
+*/
+
+/** @addtogroup DELTA_EXPORTED_CONSTANTS Delta Firmware Update Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Patch format, all values little endian                                                                 */
+/*                                                                                                         */
+/*  Header: DELTA_MAGIC, old image size, old image CRC32, new image size, new image CRC32                  */
+/*  Op:     [op] where op bit 7 set is COPY and clear is ADD. Bits 6..0 are length - 1, or 0x7F when a      */
+/*          16-bit length follows. COPY then carries a 24-bit source offset in the old image, ADD carries  */
+/*          the new bytes.                                                                                 */
+/*                                                                                                         */
+/*  Pages of the new image are written in ascending order, so a COPY source must not lie below the page    */
+/*  its destination byte belongs to.                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+#define DELTA_MAGIC             0x31544C44UL    /*!< Patch signature "DLT1" */
+#define DELTA_HDR_SIZE          20UL            /*!< Patch header size in bytes */
+#define DELTA_OP_COPY           0x80            /*!< Op flag of a COPY op */
+#define DELTA_OP_LEN_EXT        0x7F            /*!< Op length field value followed by a 16-bit length */
+
+#ifndef DELTA_KVS_KEY
+#define DELTA_KVS_KEY           0xFF00UL        /*!< Key/value store key of the progress marker */
+#endif
+
+#define DELTA_DONE              1       /*!< DELTA_Feed() result: new image written and verified */
+
+#define DELTA_ERR_PARAM         (-1)    /*!< Invalid parameter */
+#define DELTA_ERR_FORMAT        (-2)    /*!< Patch header or op not valid, or COPY source already overwritten */
+#define DELTA_ERR_OLD_IMAGE     (-3)    /*!< Flash does not hold the image the patch was made against */
+#define DELTA_ERR_NEW_IMAGE     (-4)    /*!< Patched image does not match its CRC32 */
+#define DELTA_ERR_FLASH         (-5)    /*!< Flash program or erase failed */
+#define DELTA_ERR_MARKER        (-6)    /*!< Progress marker could not be stored */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Applier control block                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    KVS_T *psKvs;                                   /*!< Store of the progress marker */
+    uint32_t u32Base;                               /*!< Flash address of the image */
+    uint32_t u32Stage;                              /*!< Data flash page staging the page being replaced */
+    uint32_t u32OldSize;                            /*!< Old image size */
+    uint32_t u32OldCrc;                             /*!< Old image CRC32 */
+    uint32_t u32NewSize;                            /*!< New image size */
+    uint32_t u32NewCrc;                             /*!< New image CRC32 */
+    uint32_t u32PatchOff;                           /*!< Patch bytes consumed */
+    uint32_t u32Out;                                /*!< New image bytes produced */
+    uint32_t u32Left;                               /*!< Bytes left in the current op */
+    uint32_t u32Src;                                /*!< Source offset of the current COPY op */
+    uint32_t u32CacheAddr;                          /*!< Old image word last read by a COPY op */
+    uint32_t u32CacheWord;                          /*!< Value of the word at u32CacheAddr */
+    uint8_t u8State;                                /*!< Parser state */
+    uint8_t u8Op;                                   /*!< Current op byte */
+    uint8_t u8HdrLen;                               /*!< Bytes collected in au8Hdr */
+    uint8_t u8HdrNeed;                              /*!< Bytes au8Hdr needs */
+    uint8_t au8Hdr[DELTA_HDR_SIZE];                 /*!< Patch header or op header being collected */
+    uint32_t u32Pages;                              /*!< Pages erased and programmed */
+    uint32_t u32Skipped;                            /*!< Pages left alone because they did not change */
+    uint32_t au32Page[FMC_FLASH_PAGE_SIZE / 4];     /*!< New page being assembled */
+} DELTA_T;
+
+/*@}*/ /* end of group DELTA_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup DELTA_EXPORTED_FUNCTIONS Delta Firmware Update Exported Functions
+  @{
+*/
+
+int32_t DELTA_Open(DELTA_T *psDelta, KVS_T *psKvs, uint32_t u32Base, uint32_t u32Stage);
+int32_t DELTA_Feed(DELTA_T *psDelta, const uint8_t *pu8Data, uint32_t u32Len);
+int32_t DELTA_Abort(DELTA_T *psDelta);
+
+
+/*@}*/ /* end of group DELTA_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group DELTA_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__DELTA_H__
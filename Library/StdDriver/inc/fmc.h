@@ -620,6 +620,7 @@ extern void FMC_EnableLDUpdate(void);
 extern void FMC_DisableLDUpdate(void);
 extern int32_t FMC_ReadConfig(uint32_t *u32Config, uint32_t u32Count);
 extern int32_t FMC_WriteConfig(uint32_t *u32Config, uint32_t u32Count);
+extern __RAMFUNC int32_t FMC_WriteMultiple(uint32_t u32Addr, const uint32_t *pu32Buf, uint32_t u32Count);
 extern void FMC_SetBootSource(int32_t i32BootSrc);
 extern int32_t FMC_GetBootSource(void);
 extern uint32_t FMC_ReadDataFlashBaseAddr(void);
@@ -0,0 +1,117 @@
+/**************************************************************************//**
+ * @file     fwslot.h
+ * @version  V3.00
+ * @brief    NUC1311 series A/B firmware slot manager header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __FWSLOT_H__
+#define __FWSLOT_H__
+
+#include "NUC1311.h"
+#include "fmc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup FWSLOT_Driver A/B Firmware Slot Manager
+  @{
+*/
+
+/** @addtogroup FWSLOT_EXPORTED_CONSTANTS A/B Firmware Slot Manager Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Slot geometry. Each image is linked at the base of its slot. The defaults split a 64 KB APROM whose    */
+/*  last 4 KB are shared data flash.                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+#ifndef FWSLOT_A_BASE
+#define FWSLOT_A_BASE           0x00000000UL    /*!< Slot A base address, page aligned */
+#endif
+#ifndef FWSLOT_SLOT_SIZE
+#define FWSLOT_SLOT_SIZE        0x7800UL        /*!< Size of each slot, multiple of FMC_FLASH_PAGE_SIZE */
+#endif
+#define FWSLOT_B_BASE           (FWSLOT_A_BASE + FWSLOT_SLOT_SIZE)  /*!< Slot B base address */
+
+#ifndef FWSLOT_REC_OFFSET
+#define FWSLOT_REC_OFFSET       0UL             /*!< Offset of the two boot record pages from the data flash base */
+#endif
+#ifndef FWSLOT_TRIAL_BOOTS
+#define FWSLOT_TRIAL_BOOTS      3UL             /*!< Boots a new image gets to call FWSLOT_Confirm() before the fall back */
+#endif
+#ifndef FWSLOT_SRAM_END
+#define FWSLOT_SRAM_END         0x20002000UL    /*!< End of SRAM, bounds the initial stack pointer of a valid image */
+#endif
+
+#define FWSLOT_A                0       /*!< Slot A */
+#define FWSLOT_B                1       /*!< Slot B */
+
+#define FWSLOT_STATE_CONFIRMED  1       /*!< Slot image confirmed by itself */
+#define FWSLOT_STATE_TRIAL      2       /*!< Slot image on trial, boots left in u8Tries */
+
+#define FWSLOT_ERR_PARAM        (-1)    /*!< Invalid parameter */
+#define FWSLOT_ERR_FLASH        (-2)    /*!< Flash program or erase failed */
+#define FWSLOT_ERR_CRC          (-3)    /*!< Written image does not match the expected CRC32 */
+#define FWSLOT_ERR_IMAGE        (-4)    /*!< Image vector table is not valid for its slot */
+#define FWSLOT_ERR_STATE        (-5)    /*!< Not in the state the call needs: nothing to confirm, or an image still on trial */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Boot record                                                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Seq;                                /*!< Record sequence number, the highest one is in effect */
+    uint8_t u8Slot;                                 /*!< Slot to boot, \ref FWSLOT_A or \ref FWSLOT_B */
+    uint8_t u8State;                                /*!< \ref FWSLOT_STATE_CONFIRMED or \ref FWSLOT_STATE_TRIAL */
+    uint8_t u8Tries;                                /*!< Trial boots left */
+    uint8_t u8Reserved;
+    uint32_t u32Size;                               /*!< Image size in bytes */
+    uint32_t u32Crc;                                /*!< Image CRC32 */
+} FWSLOT_REC_T;
+
+/*@}*/ /* end of group FWSLOT_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup FWSLOT_EXPORTED_FUNCTIONS A/B Firmware Slot Manager Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the base address of a slot.
+  * @param[in]  u32Slot \ref FWSLOT_A or \ref FWSLOT_B.
+  * @return     Slot base address.
+  */
+#define FWSLOT_GET_BASE(u32Slot)    ((u32Slot) ? FWSLOT_B_BASE : FWSLOT_A_BASE)
+
+uint32_t FWSLOT_CRC32(const void *pvData, uint32_t u32Len, uint32_t u32Crc);
+int32_t FWSLOT_ReadRecord(FWSLOT_REC_T *psRec);
+uint32_t FWSLOT_GetActive(void);
+int32_t FWSLOT_Write(uint32_t u32Offset, const uint32_t *pu32Data, uint32_t u32Len);
+int32_t FWSLOT_Commit(uint32_t u32Size, uint32_t u32Crc);
+int32_t FWSLOT_Confirm(void);
+int32_t FWSLOT_Boot(void);
+
+
+/*@}*/ /* end of group FWSLOT_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group FWSLOT_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__FWSLOT_H__
@@ -0,0 +1,126 @@
+/**************************************************************************//**
+ * @file     gpio_bus.h
+ * @version  V3.00
+ * @brief    NUC1311 series GPIO port bus and bit-bang engine header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __GPIO_BUS_H__
+#define __GPIO_BUS_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup GPIOBUS_Driver GPIO Port Bus Driver
+  @{
+*/
+
+/** @addtogroup GPIOBUS_EXPORTED_CONSTANTS GPIO Port Bus Exported Constants
+  @{
+*/
+
+#define GPIOBUS_MAX_WIDTH       16UL        /*!< Maximum number of pins in a bus */
+#define GPIOBUS_NOT_CONTIGUOUS  0xFFUL      /*!< u32Shift value of a bus whose pins are not contiguous */
+
+#ifndef GPIOBUS_LOOP_CYCLES
+#define GPIOBUS_LOOP_CYCLES     4UL         /*!< CPU cycles per iteration of the bit-bang delay loop */
+#endif
+#ifndef GPIOBUS_CALL_CYCLES
+#define GPIOBUS_CALL_CYCLES     12UL        /*!< Fixed overhead in CPU cycles of a pin write plus a delay call */
+#endif
+
+#define GPIOBUS_ERR_PARAM       (-1)        /*!< Invalid pin list */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Port bus descriptor                                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    GPIO_T   *port;                         /*!< GPIO port of the bus */
+    uint32_t u32Mask;                       /*!< Pins of the bus */
+    uint32_t u32Width;                      /*!< Number of bits, 1 ~ GPIOBUS_MAX_WIDTH */
+    uint32_t u32Shift;                      /*!< Pin of bit 0 if pins are contiguous and ascending, else GPIOBUS_NOT_CONTIGUOUS */
+    uint8_t  au8Pin[GPIOBUS_MAX_WIDTH];     /*!< Pin of each bus bit */
+    uint16_t au16Lut[GPIOBUS_MAX_WIDTH / 4][16];   /*!< Pin pattern of each value nibble */
+} GPIOBUS_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Bit-bang SPI descriptor, mode 0, MSB first                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    volatile uint32_t *pu32Sck;             /*!< Pin data alias of SCK, e.g. &PA0 */
+    volatile uint32_t *pu32Mosi;            /*!< Pin data alias of MOSI */
+    volatile uint32_t *pu32Miso;            /*!< Pin data alias of MISO, NULL for a write-only bus */
+    uint32_t u32HalfLoops;                  /*!< Delay loops per half clock period */
+} GPIOBUS_SPI_T;
+
+/*@}*/ /* end of group GPIOBUS_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup GPIOBUS_EXPORTED_FUNCTIONS GPIO Port Bus Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Write a subset of the pins of a port at the same time.
+  * @param[in]  port        GPIO port. It could be PA, PB, PC, PD, PE or PF.
+  * @param[in]  u32PinMask  Pins to update.
+  * @param[in]  u32Value    New output levels. Bits outside u32PinMask are ignored.
+  * @return     None
+  * @details    The selected pins change together with one DOUT store while DMASK protects the other pins.
+  *             The whole sequence is four register accesses: read DMASK, set DMASK, store DOUT and restore DMASK.
+  *             It is not atomic by itself, so it runs with interrupts masked by PRIMASK. An interrupt handler
+  *             changing DMASK, DOUT or a pin data alias (e.g. PA0 = 1) of the same port therefore cannot
+  *             interleave with it, and its own pin writes are not lost.
+  */
+static __INLINE void GPIOBUS_WriteMasked(GPIO_T *port, uint32_t u32PinMask, uint32_t u32Value)
+{
+    uint32_t u32PriMask, u32DMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    u32DMask = port->DMASK;
+    port->DMASK = ~u32PinMask;
+    port->DOUT = u32Value;
+    port->DMASK = u32DMask;
+    __set_PRIMASK(u32PriMask);
+}
+
+
+int32_t GPIOBUS_Init(GPIOBUS_T *bus, GPIO_T *port, const uint8_t *pu8Pins, uint32_t u32Width);
+void GPIOBUS_Write(const GPIOBUS_T *bus, uint32_t u32Value);
+uint32_t GPIOBUS_Read(const GPIOBUS_T *bus);
+void GPIOBUS_DelayCycles(uint32_t u32Cycles);
+void GPIOBUS_SpiInit(GPIOBUS_SPI_T *spi, volatile uint32_t *pu32Sck, volatile uint32_t *pu32Mosi, volatile uint32_t *pu32Miso, uint32_t u32BusClock);
+uint32_t GPIOBUS_SpiTransfer(const GPIOBUS_SPI_T *spi, uint32_t u32Data, uint32_t u32Bits);
+uint32_t GPIOBUS_OwReset(volatile uint32_t *pu32Pin);
+void GPIOBUS_OwWrite(volatile uint32_t *pu32Pin, uint32_t u32Data, uint32_t u32Bits);
+uint32_t GPIOBUS_OwRead(volatile uint32_t *pu32Pin, uint32_t u32Bits);
+void GPIOBUS_Ws2812Write(volatile uint32_t *pu32Pin, const uint8_t *pu8Grb, uint32_t u32Len);
+
+
+/*@}*/ /* end of group GPIOBUS_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group GPIOBUS_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__GPIO_BUS_H__
@@ -0,0 +1,73 @@
+/**************************************************************************//**
+ * @file     gpio_evt.h
+ * @version  V3.00
+ * @brief    NUC1311 series GPIO event dispatcher header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __GPIO_EVT_H__
+#define __GPIO_EVT_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup GPIOEVT_Driver GPIO Event Dispatcher
+  @{
+*/
+
+/** @addtogroup GPIOEVT_EXPORTED_CONSTANTS GPIO Event Dispatcher Exported Constants
+  @{
+*/
+
+#define GPIOEVT_PORT_CNT        6UL                                 /*!< Number of GPIO ports, PA to PF */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Port masks for GPIOEVT_IRQHandler()                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+#define GPIOEVT_PORT_AB         0x03UL                              /*!< Ports served by GPAB_IRQHandler, EINT0 and EINT1 */
+#define GPIOEVT_PORT_CDEF       0x3CUL                              /*!< Ports served by GPCDEF_IRQHandler */
+
+#define GPIOEVT_ERR_PARAM       (-1)                                /*!< Invalid pin, attribute or debounce window */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Event callback                                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef void (*GPIOEVT_FUNC_T)(GPIO_T *port, uint32_t u32Pin, uint32_t u32Level);   /*!< Pin event callback */
+
+/*@}*/ /* end of group GPIOEVT_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup GPIOEVT_EXPORTED_FUNCTIONS GPIO Event Dispatcher Exported Functions
+  @{
+*/
+
+void GPIOEVT_Init(void);
+int32_t GPIOEVT_Register(GPIO_T *port, uint32_t u32Pin, uint32_t u32IntAttribs, uint32_t u32DebounceTicks, GPIOEVT_FUNC_T pfnFunc);
+void GPIOEVT_Unregister(GPIO_T *port, uint32_t u32Pin);
+void GPIOEVT_IRQHandler(uint32_t u32PortMask);
+
+
+/*@}*/ /* end of group GPIOEVT_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group GPIOEVT_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__GPIO_EVT_H__
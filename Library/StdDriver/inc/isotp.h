@@ -0,0 +1,147 @@
+/**************************************************************************//**
+ * @file     isotp.h
+ * @version  V3.00
+ * @brief    NUC1311 series ISO 15765-2 (ISO-TP) CAN transport header file
+ *
+ * @note     The transport programs its message objects through IF1 (IF[0]), also from the CAN interrupt. Code outside
+ *           the CAN driver that programs a message interface must mask interrupts for the whole sequence, as the
+ *           driver does.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __ISOTP_H__
+#define __ISOTP_H__
+
+#include "NUC1311.h"
+#include "swtimer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup ISOTP_Driver ISO-TP Transport
+  @{
+*/
+
+/** @addtogroup ISOTP_EXPORTED_CONSTANTS ISO-TP Transport Exported Constants
+  @{
+*/
+
+#define ISOTP_MAX_LEN           4095    /*!< Largest message, the 12-bit length of a first frame */
+
+#ifndef ISOTP_PAD_BYTE
+#define ISOTP_PAD_BYTE          0xCC    /*!< Fill of the unused bytes, every frame is sent with 8 data bytes */
+#endif
+
+#ifndef ISOTP_TIMEOUT_MS
+#define ISOTP_TIMEOUT_MS        1000    /*!< N_As / N_Ar, N_Bs and N_Cr: wait for a frame to be sent, for a flow control
+                                             and for the next consecutive frame */
+#endif
+
+#define ISOTP_ERR_PARAM         (-1)    /*!< Invalid parameter */
+#define ISOTP_ERR_BUSY          (-2)    /*!< A message is being sent */
+#define ISOTP_ERR_TIMEOUT       (-3)    /*!< Frame not sent (N_As / N_Ar), no flow control (N_Bs) or no consecutive
+                                             frame (N_Cr) in time */
+#define ISOTP_ERR_OVERFLOW      (-4)    /*!< Message is larger than the receive buffer, or the peer's */
+#define ISOTP_ERR_SEQ           (-5)    /*!< Consecutive frame with a wrong sequence number */
+#define ISOTP_ERR_FRAME         (-6)    /*!< Flow control with an invalid flow status */
+
+struct ISOTP_S;
+
+typedef void (*ISOTP_RX_FUNC_T)(struct ISOTP_S *psLink, uint8_t *pu8Data, int32_t i32Len);
+                                                    /*!< Message received, i32Len < 0 is an ISOTP_ERR_ code */
+typedef void (*ISOTP_TX_FUNC_T)(struct ISOTP_S *psLink, int32_t i32Result);
+                                                    /*!< Message sent (0) or aborted (ISOTP_ERR_ code) */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Link control block                                                                                     */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct ISOTP_S
+{
+    CAN_T *tCAN;                                    /*!< CAN module */
+    uint32_t u32TxId;                               /*!< Identifier of the frames sent */
+    uint32_t u32RxId;                               /*!< Identifier of the frames received */
+    uint8_t u8IdType;                               /*!< CAN_STD_ID or CAN_EXT_ID */
+    uint8_t u8TxObj;                                /*!< Message object sending the frames */
+    uint8_t u8RxObj;                                /*!< Message object receiving the frames */
+    uint8_t u8BlockSize;                            /*!< Block size sent in the flow control, 0 for no limit */
+    uint8_t u8STmin;                                /*!< Separation time sent in the flow control, ISO 15765-2 coded */
+    uint32_t u32TickFreq;                           /*!< SWTIMER tick frequency */
+    uint32_t u32Timeout;                            /*!< N_As / N_Ar, N_Bs and N_Cr in SWTIMER ticks */
+    void *pvArg;                                    /*!< User data, not used by the transport */
+
+    /* Sender */
+    const uint8_t *pu8TxData;                       /*!< Message being sent, the caller's buffer */
+    uint32_t u32TxLen;                              /*!< Message length */
+    uint32_t u32TxPos;                              /*!< Bytes loaded into frames */
+    uint32_t u32TxGap;                              /*!< Peer separation time in SWTIMER ticks, 0 for none */
+    ISOTP_TX_FUNC_T pfnTxDone;                      /*!< Send completion callback */
+    SWTIMER_T sTxTmr;                               /*!< N_Bs and separation time */
+    volatile uint8_t u8TxState;                     /*!< Sender state */
+    uint8_t u8TxSn;                                 /*!< Sequence number of the next consecutive frame */
+    uint8_t u8TxBs;                                 /*!< Peer block size */
+    uint8_t u8TxBsLeft;                             /*!< Consecutive frames left in the block */
+    volatile uint8_t u8ObjBusy;                     /*!< 1 while a frame waits in the TX message object */
+    SWTIMER_T sAsTmr;                               /*!< N_As / N_Ar of the frame in the TX message object */
+    volatile uint8_t u8FcPending;                   /*!< 1 if a flow control waits for the TX message object */
+    uint8_t u8FcStatus;                             /*!< Flow status of that flow control */
+    int8_t i8TxResult;                              /*!< Result for the send completion callback */
+
+    /* Receiver */
+    uint8_t *pu8RxBuf;                              /*!< Receive buffer */
+    uint32_t u32RxSize;                             /*!< Receive buffer size */
+    uint32_t u32RxLen;                              /*!< Length of the message being received */
+    uint32_t u32RxPos;                              /*!< Bytes received */
+    ISOTP_RX_FUNC_T pfnRx;                          /*!< Receive callback */
+    SWTIMER_T sRxTmr;                               /*!< N_Cr */
+    volatile uint8_t u8RxState;                     /*!< Receiver state */
+    uint8_t u8RxSn;                                 /*!< Sequence number of the next consecutive frame */
+    uint8_t u8RxBsLeft;                             /*!< Consecutive frames left before the next flow control */
+    volatile uint8_t u8Notify;                      /*!< Callbacks due once the link is unlocked */
+    int32_t i32RxResult;                            /*!< Result for the receive callback */
+} ISOTP_T;
+
+/*@}*/ /* end of group ISOTP_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup ISOTP_EXPORTED_FUNCTIONS ISO-TP Transport Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Check whether a message is being sent.
+  * @param[in]  psLink The pointer of the link control block.
+  * @retval     0 The sender is idle, ISOTP_Send() accepts a message.
+  * @retval     1 A message is being sent.
+  */
+#define ISOTP_IS_TX_BUSY(psLink)    ((psLink)->u8TxState != 0)
+
+
+int32_t ISOTP_Open(ISOTP_T *psLink, CAN_T *tCAN, uint32_t u32TxObj, uint32_t u32RxObj, uint32_t u32IdType,
+                   uint32_t u32TxId, uint32_t u32RxId, uint32_t u32TickFreq);
+void ISOTP_Close(ISOTP_T *psLink);
+void ISOTP_SetRxBuffer(ISOTP_T *psLink, uint8_t *pu8Buf, uint32_t u32Size, ISOTP_RX_FUNC_T pfnRx);
+void ISOTP_SetFlowControl(ISOTP_T *psLink, uint32_t u32BlockSize, uint32_t u32STmin);
+int32_t ISOTP_Send(ISOTP_T *psLink, const uint8_t *pu8Data, uint32_t u32Len, ISOTP_TX_FUNC_T pfnDone);
+int32_t ISOTP_IRQHandler(ISOTP_T *psLink, uint32_t u32MsgNum);
+
+
+/*@}*/ /* end of group ISOTP_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group ISOTP_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__ISOTP_H__
@@ -0,0 +1,108 @@
+/**************************************************************************//**
+ * @file     kvs.h
+ * @version  V3.00
+ * @brief    NUC1311 series data flash key/value store header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __KVS_H__
+#define __KVS_H__
+
+#include "NUC1311.h"
+#include "fmc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup KVS_Driver Data Flash Key/Value Store
+  @{
+*/
+
+/** @addtogroup KVS_EXPORTED_CONSTANTS Data Flash Key/Value Store Exported Constants
+  @{
+*/
+
+#define KVS_PAGE_SIZE           FMC_FLASH_PAGE_SIZE     /*!< Store page size, one flash erase page */
+#define KVS_MAX_VALUE           128     /*!< Maximum value length in bytes */
+#define KVS_KEY_INVALID         0xFFFF  /*!< Reserved key, never stored */
+
+#define KVS_PAGE_MAGIC          0x3153564BUL    /*!< Page header signature "KVS1" */
+
+#define KVS_ERR_PARAM           (-1)    /*!< Invalid parameter */
+#define KVS_ERR_NOT_FOUND       (-2)    /*!< Key is not in the store */
+#define KVS_ERR_FULL            (-3)    /*!< Live records do not fit the store pages */
+#define KVS_ERR_NO_INDEX        (-4)    /*!< RAM index has no free entry for a new key */
+#define KVS_ERR_FLASH           (-5)    /*!< Flash program or erase failed */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  RAM index entry                                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint16_t u16Key;                                /*!< Key */
+    uint16_t u16Len;                                /*!< Value length in bytes */
+    uint32_t u32Addr;                               /*!< Flash address of the newest record of the key */
+} KVS_ENTRY_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Store control block                                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Base;                               /*!< Address of the first store page */
+    uint32_t u32PageNum;                            /*!< Number of store pages, 3 or more */
+    uint32_t u32Head;                               /*!< Page receiving new records */
+    uint32_t u32Tail;                               /*!< Oldest page in use */
+    uint32_t u32Used;                               /*!< Pages in use, from u32Tail to u32Head */
+    uint32_t u32Off;                                /*!< Next free byte offset in the head page */
+    uint32_t u32Seq;                                /*!< Sequence number of the head page */
+    KVS_ENTRY_T *psIndex;                           /*!< RAM index */
+    uint32_t u32IndexSize;                          /*!< Entries of psIndex */
+    uint32_t u32Keys;                               /*!< Entries of psIndex in use */
+    uint32_t u32Erases;                             /*!< Page erases since KVS_Open() */
+} KVS_T;
+
+/*@}*/ /* end of group KVS_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup KVS_EXPORTED_FUNCTIONS Data Flash Key/Value Store Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the number of erased pages left for new records.
+  * @param[in]  psKvs The pointer of the store control block.
+  * @return     Erased pages not in use. One of them is kept for compaction.
+  */
+#define KVS_GET_FREE_PAGES(psKvs)   ((psKvs)->u32PageNum - (psKvs)->u32Used)
+
+int32_t KVS_Open(KVS_T *psKvs, uint32_t u32Base, uint32_t u32PageNum, KVS_ENTRY_T *psIndex, uint32_t u32IndexSize);
+int32_t KVS_Get(KVS_T *psKvs, uint32_t u32Key, void *pvBuf, uint32_t u32Size);
+int32_t KVS_Set(KVS_T *psKvs, uint32_t u32Key, const void *pvData, uint32_t u32Len);
+int32_t KVS_Delete(KVS_T *psKvs, uint32_t u32Key);
+int32_t KVS_Maintain(KVS_T *psKvs);
+int32_t KVS_Format(KVS_T *psKvs);
+
+
+/*@}*/ /* end of group KVS_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group KVS_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__KVS_H__
@@ -0,0 +1,161 @@
+/**************************************************************************//**
+ * @file     lin.h
+ * @version  V3.00
+ * @brief    NUC1311 series LIN 2.x protocol stack header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __LIN_H__
+#define __LIN_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup LIN_Driver LIN Protocol Stack
+  @{
+*/
+
+/** @addtogroup LIN_EXPORTED_CONSTANTS LIN Protocol Stack Exported Constants
+  @{
+*/
+
+#define LIN_MAX_DATA            8       /*!< Maximum data bytes of one frame */
+#define LIN_ID_NUM              64      /*!< Number of frame identifiers */
+#define LIN_BREAK_BITS          13      /*!< Break field length sent by the master */
+
+#define LIN_FRAME_PUBLISH       0       /*!< This node sends the response */
+#define LIN_FRAME_SUBSCRIBE     1       /*!< This node receives the response */
+
+#define LIN_CHECKSUM_CLASSIC    0       /*!< Checksum over the data bytes */
+#define LIN_CHECKSUM_ENHANCED   1       /*!< Checksum over the protected ID and the data bytes. IDs 60 ~ 63 stay classic */
+
+#define LIN_SLAVE_AUTO_RESYNC   UART_LIN_CTL_LINS_ARS_EN_Msk    /*!< LIN_SlaveOpen() flag: adjust the baud rate to each sync field */
+
+#define LIN_ERR_PARAM           (-1)    /*!< Invalid parameter */
+#define LIN_ERR_NO_RESPONSE     (-2)    /*!< No response byte within the frame slot */
+#define LIN_ERR_FRAME           (-3)    /*!< Incomplete response, framing error or break inside the response */
+#define LIN_ERR_CHECKSUM        (-4)    /*!< Response checksum mismatch */
+#define LIN_ERR_BIT             (-5)    /*!< Read-back of a sent byte differs */
+#define LIN_ERR_HEADER          (-6)    /*!< Header error: break, sync or protected ID */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Frame                                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+struct LIN_S;
+struct LIN_FRAME_S;
+
+typedef void (*LIN_FRAME_FUNC_T)(struct LIN_S *psLin, struct LIN_FRAME_S *psFrame, int32_t i32Status);
+                                                    /*!< Frame done, called in interrupt context. i32Status is 0 or a LIN_ERR_ code */
+
+typedef struct LIN_FRAME_S
+{
+    uint8_t u8Id;                                   /*!< Frame identifier, 0 ~ 63 */
+    uint8_t u8Pid;                                  /*!< Protected identifier */
+    uint8_t u8Len;                                  /*!< Data length, 1 ~ 8 */
+    uint8_t u8Dir;                                  /*!< \ref LIN_FRAME_PUBLISH or \ref LIN_FRAME_SUBSCRIBE */
+    uint8_t u8Seed;                                 /*!< Checksum start value, 0 for classic or the PID for enhanced */
+    uint8_t u8Checksum;                             /*!< Checksum of au8Data, kept current by LIN_WriteFrame() */
+    volatile uint8_t u8Updated;                     /*!< 1 when au8Data changed since the last LIN_ReadFrame() */
+    uint8_t u8Reserved;
+    uint8_t au8Data[LIN_MAX_DATA];                  /*!< Frame data */
+    LIN_FRAME_FUNC_T pfnDone;                       /*!< Frame done callback. Could be NULL */
+} LIN_FRAME_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Master schedule table entry                                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    LIN_FRAME_T *psFrame;                           /*!< Frame sent in this slot, NULL for an empty slot */
+    uint32_t u32Slots;                              /*!< Slot length in time base ticks, 1 or more */
+} LIN_SCHED_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Statistics                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Frames;                             /*!< Frames completed without error */
+    uint32_t u32NoResponse;                         /*!< \ref LIN_ERR_NO_RESPONSE count */
+    uint32_t u32FrameErrors;                        /*!< \ref LIN_ERR_FRAME count */
+    uint32_t u32ChecksumErrors;                     /*!< \ref LIN_ERR_CHECKSUM count */
+    uint32_t u32BitErrors;                          /*!< \ref LIN_ERR_BIT count */
+    uint32_t u32HeaderErrors;                       /*!< \ref LIN_ERR_HEADER count */
+} LIN_STAT_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Node control block                                                                                     */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct LIN_S
+{
+    UART_T *uart;                                   /*!< UART in LIN mode, UART0 ~ UART2 */
+    TIMER_T *timer;                                 /*!< Master time base timer, NULL on a slave */
+    const LIN_SCHED_T *psSched;                     /*!< Master schedule table running */
+    uint32_t u32SchedNum;                           /*!< Entries of psSched */
+    uint32_t u32SchedIdx;                           /*!< Entry of psSched in progress */
+    const LIN_SCHED_T *psNextSched;                 /*!< Master schedule table requested by LIN_MasterSetSchedule(), NULL to stop */
+    uint32_t u32NextNum;                            /*!< Entries of psNextSched */
+    uint32_t u32SlotLeft;                           /*!< Time base ticks left in the current slot */
+    LIN_FRAME_T *psFrame;                           /*!< Frame in progress */
+    volatile uint8_t u8State;                       /*!< Frame state */
+    uint8_t u8Pos;                                  /*!< Response bytes handled */
+    uint8_t u8Last;                                 /*!< Last byte received outside a frame */
+    volatile uint8_t u8NextSet;                     /*!< 1 while psNextSched waits for the end of the current slot */
+    uint32_t u32Sum;                                /*!< Running checksum of a received response */
+    uint8_t au8Buf[LIN_MAX_DATA + 1];               /*!< Response being sent or received */
+    LIN_FRAME_T *apsFrame[LIN_ID_NUM];              /*!< Slave response table indexed by frame identifier */
+    LIN_STAT_T sStat;                               /*!< Statistics */
+} LIN_T;
+
+/*@}*/ /* end of group LIN_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup LIN_EXPORTED_FUNCTIONS LIN Protocol Stack Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the protected identifier of a frame identifier.
+  * @param[in]  u32Id Frame identifier, 0 ~ 63.
+  * @return     Protected identifier with parity bits P0 and P1.
+  */
+#define LIN_GET_PID(u32Id)      (g_au8LinPid[(u32Id) & 0x3F])
+
+extern const uint8_t g_au8LinPid[LIN_ID_NUM];
+
+int32_t LIN_InitFrame(LIN_FRAME_T *psFrame, uint32_t u32Id, uint32_t u32Len, uint32_t u32Dir, uint32_t u32Checksum, LIN_FRAME_FUNC_T pfnDone);
+void LIN_WriteFrame(LIN_FRAME_T *psFrame, const uint8_t *pu8Data);
+uint32_t LIN_ReadFrame(LIN_FRAME_T *psFrame, uint8_t *pu8Data);
+int32_t LIN_MasterOpen(LIN_T *psLin, UART_T *uart, TIMER_T *timer, uint32_t u32TickUs);
+int32_t LIN_MasterSetSchedule(LIN_T *psLin, const LIN_SCHED_T *psSched, uint32_t u32Num);
+int32_t LIN_SlaveOpen(LIN_T *psLin, UART_T *uart, uint32_t u32Flags);
+int32_t LIN_SlaveAddFrame(LIN_T *psLin, LIN_FRAME_T *psFrame);
+void LIN_Close(LIN_T *psLin);
+void LIN_TimerIRQHandler(LIN_T *psLin);
+void LIN_IRQHandler(LIN_T *psLin);
+
+
+/*@}*/ /* end of group LIN_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group LIN_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__LIN_H__
@@ -0,0 +1,92 @@
+/**************************************************************************//**
+ * @file     lzdec.h
+ * @version  V3.00
+ * @brief    NUC1311 series streaming LZ decoder header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __LZDEC_H__
+#define __LZDEC_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup LZDEC_Driver LZ Decoder
+  @{
+*/
+
+/** @addtogroup LZDEC_EXPORTED_CONSTANTS LZ Decoder Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Stream format                                                                                          */
+/*                                                                                                         */
+/*  A flag byte announces the next eight tokens, LSB first. A set flag is a literal byte. A clear flag is  */
+/*  a 16-bit little endian match: bits 9..0 are distance - 1, bits 15..10 are length - 3. The stream has   */
+/*  no header or end marker, the caller stops once it has the size it expects.                            */
+/*---------------------------------------------------------------------------------------------------------*/
+#define LZDEC_WINDOW_SIZE       1024UL  /*!< Sliding window size in bytes, the largest match distance */
+#define LZDEC_MIN_MATCH         3UL     /*!< Shortest match length */
+#define LZDEC_MAX_MATCH         66UL    /*!< Longest match length */
+
+#define LZDEC_ERR_FORMAT        (-1)    /*!< Match reaches back before the start of the stream */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Decoder control block                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32InCount;                            /*!< Compressed bytes consumed */
+    uint32_t u32OutCount;                           /*!< Decompressed bytes produced */
+    uint16_t u16Flags;                              /*!< Flags left of the current flag byte above a stop bit */
+    uint16_t u16Pos;                                /*!< Next window position */
+    uint16_t u16Dist;                               /*!< Distance of the match being copied */
+    uint8_t u8Left;                                 /*!< Bytes left in the match being copied */
+    uint8_t u8State;                                /*!< Parser state */
+    uint8_t u8Lo;                                   /*!< Low byte of the match being read */
+    uint8_t au8Window[LZDEC_WINDOW_SIZE];           /*!< Last decompressed bytes */
+} LZDEC_T;
+
+/*@}*/ /* end of group LZDEC_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup LZDEC_EXPORTED_FUNCTIONS LZ Decoder Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the compressed size in percent of the decompressed size so far.
+  * @param[in]  psLz The decoder.
+  * @return     Compression ratio in percent, 0 before the first byte is produced.
+  */
+#define LZDEC_GET_RATIO(psLz)   ((psLz)->u32OutCount ? ((psLz)->u32InCount * 100) / (psLz)->u32OutCount : 0)
+
+void LZDEC_Init(LZDEC_T *psLz);
+int32_t LZDEC_Decode(LZDEC_T *psLz, const uint8_t *pu8In, uint32_t u32InLen, uint32_t *pu32Used, uint8_t *pu8Out, uint32_t u32OutLen);
+
+
+/*@}*/ /* end of group LZDEC_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group LZDEC_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__LZDEC_H__
@@ -0,0 +1,105 @@
+/**************************************************************************//**
+ * @file     pm.h
+ * @version  V3.00
+ * @brief    NUC1311 series power manager header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __PM_H__
+#define __PM_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup PM_Driver Power Manager
+  @{
+*/
+
+/** @addtogroup PM_EXPORTED_CONSTANTS Power Manager Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Low power mode and wake-up source constant definitions                                                 */
+/*---------------------------------------------------------------------------------------------------------*/
+#define PM_MODE_IDLE            0UL         /*!< CPU clock stopped, peripherals keep running */
+#define PM_MODE_POWER_DOWN      1UL         /*!< HXT, HIRC and PLL stopped until a wake-up event */
+
+#define PM_WAKE_GPIO            0UL         /*!< Woken up by GPIO or EINT interrupt */
+#define PM_WAKE_UART            1UL         /*!< Woken up by UART interrupt */
+#define PM_WAKE_I2C             2UL         /*!< Woken up by I2C interrupt */
+#define PM_WAKE_CAN             3UL         /*!< Woken up by CAN interrupt */
+#define PM_WAKE_WDT             4UL         /*!< Woken up by WDT or WWDT interrupt */
+#define PM_WAKE_TIMER           5UL         /*!< Woken up by TIMER interrupt */
+#define PM_WAKE_OTHER           6UL         /*!< Woken up by another interrupt */
+#define PM_WAKE_SRC_CNT         7UL         /*!< Number of wake-up source classes */
+
+#define PM_NO_DEADLINE          0xFFFFFFFFUL    /*!< No timer deadline is pending */
+
+#ifndef PM_PD_MIN_US
+#define PM_PD_MIN_US            2000UL      /*!< Default shortest sleep, in microseconds, worth a power-down */
+#endif
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Suspend/resume hook                                                                                    */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct PM_DEV_S
+{
+    struct PM_DEV_S *psNext;                /*!< Next registered hook */
+    struct PM_DEV_S *psPrev;                /*!< Previous registered hook */
+    int32_t (*pfnSuspend)(void *pvArg);     /*!< Called before power-down. Return non-zero to veto it. Could be NULL */
+    void (*pfnResume)(void *pvArg);         /*!< Called after wake-up with the clock tree restored. Could be NULL */
+    void *pvArg;                            /*!< Hook argument */
+} PM_DEV_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Wake-up latency statistics of one wake-up source.                                                      */
+/*  Latencies are read from the timestamp service and stay 0 unless TSTAMP_Open() was called.              */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Count;                      /*!< Number of wake-ups */
+    uint32_t u32LatencyLast;                /*!< Latency of the last wake-up in microseconds */
+    uint32_t u32LatencyMax;                 /*!< Worst latency in microseconds */
+    uint32_t u32LatencySum;                 /*!< Sum of latencies, average is u32LatencySum / u32Count */
+} PM_STAT_T;
+
+/*@}*/ /* end of group PM_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup PM_EXPORTED_FUNCTIONS Power Manager Exported Functions
+  @{
+*/
+
+void PM_Init(uint32_t u32PdMinUs);
+void PM_Register(PM_DEV_T *psDev);
+void PM_Unregister(PM_DEV_T *psDev);
+uint32_t PM_Sleep(uint32_t u32DeadlineUs);
+void PM_GetStat(uint32_t u32Src, PM_STAT_T *psStat);
+void PM_ClearStat(void);
+
+
+/*@}*/ /* end of group PM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group PM_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__PM_H__
@@ -0,0 +1,127 @@
+/**************************************************************************//**
+ * @file     rs485.h
+ * @version  V3.00
+ * @brief    NUC1311 series RS485 multi-drop bus engine header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __RS485_H__
+#define __RS485_H__
+
+#include "NUC1311.h"
+#include "swtimer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup RS485_Driver RS485 Bus Engine
+  @{
+*/
+
+/** @addtogroup RS485_EXPORTED_CONSTANTS RS485 Bus Engine Exported Constants
+  @{
+*/
+
+#ifndef RS485_MAX_DATA
+#define RS485_MAX_DATA          64      /*!< Maximum payload bytes of one frame, 1 ~ 255 */
+#endif
+
+#define RS485_FRAME_SIZE        (RS485_MAX_DATA + 4)    /*!< Address, length, payload and CRC16 */
+
+#define RS485_OFFLINE_FAILS     3       /*!< Consecutive failed polls before a slave is treated as off-line */
+#define RS485_OFFLINE_PERIOD    8       /*!< An off-line slave is polled once every this many poll cycles */
+
+#define RS485_ERR_PARAM         (-1)    /*!< Invalid parameter */
+#define RS485_ERR_TIMEOUT       (-2)    /*!< Slave did not reply within its time-out */
+#define RS485_ERR_FRAME         (-3)    /*!< Reply had a wrong address, length, line status or overrun */
+#define RS485_ERR_CRC           (-4)    /*!< Reply CRC16 mismatch */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Master poll table entry                                                                                */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint8_t u8Addr;                                 /*!< Slave address, matched by the slave UART in AAD mode */
+    uint8_t u8TxLen;                                /*!< Request payload length, 0 ~ RS485_MAX_DATA */
+    uint8_t u8Fails;                                /*!< Consecutive failed polls */
+    uint8_t u8Skip;                                 /*!< Poll cycles left before an off-line slave is polled again */
+    uint32_t u32Timeout;                            /*!< Request and reply time-out in SWTIMER ticks */
+    const uint8_t *pu8TxData;                       /*!< Request payload. Could be changed in the reply callback */
+    uint32_t u32Polls;                              /*!< Number of polls */
+    uint32_t u32Timeouts;                           /*!< Number of polls without reply */
+    uint32_t u32Errors;                             /*!< Number of frame and CRC errors */
+} RS485_SLAVE_T;
+
+struct RS485_S;
+
+typedef void (*RS485_REPLY_FUNC_T)(struct RS485_S *psBus, RS485_SLAVE_T *psSlave, const uint8_t *pu8Data, int32_t i32Len);
+                                                    /*!< Master poll result, i32Len < 0 is an RS485_ERR_ code */
+typedef int32_t (*RS485_REQUEST_FUNC_T)(struct RS485_S *psBus, const uint8_t *pu8Req, uint32_t u32ReqLen, uint8_t *pu8Reply);
+                                                    /*!< Slave request handler, returns the reply length or < 0 for no reply */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Bus control block                                                                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct RS485_S
+{
+    UART_T *uart;                                   /*!< UART driving the bus */
+    RS485_SLAVE_T *psSlave;                         /*!< Master poll table */
+    uint32_t u32SlaveNum;                           /*!< Master poll table entries */
+    uint32_t u32Index;                              /*!< Master poll table entry being polled */
+    RS485_REPLY_FUNC_T pfnReply;                    /*!< Master poll result callback */
+    RS485_REQUEST_FUNC_T pfnRequest;                /*!< Slave request callback */
+    void *pvArg;                                    /*!< User data, not used by the engine */
+    SWTIMER_T sTmr;                                 /*!< Master reply time-out */
+    volatile uint8_t u8State;                       /*!< Engine state */
+    uint8_t u8Addr;                                 /*!< Own address on a slave */
+    uint8_t u8Fifo;                                 /*!< TX FIFO depth of the UART */
+    int8_t i8Err;                                   /*!< Error seen in the current frame */
+    uint16_t u16TxLen;                              /*!< Bytes in au8Tx */
+    uint16_t u16TxPos;                              /*!< Bytes of au8Tx written to the FIFO */
+    uint16_t u16RxPos;                              /*!< Bytes in au8Rx */
+    volatile uint8_t u8Run;                         /*!< 1 while the master poll scheduler runs */
+    uint8_t u8Reserved;
+    uint32_t u32Frames;                             /*!< Frames received with a good CRC */
+    uint32_t u32Errors;                             /*!< Frames dropped for CRC, length or line errors */
+    uint8_t au8Tx[RS485_FRAME_SIZE];                /*!< Frame being sent */
+    uint8_t au8Rx[RS485_FRAME_SIZE];                /*!< Frame being received */
+} RS485_T;
+
+/*@}*/ /* end of group RS485_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup RS485_EXPORTED_FUNCTIONS RS485 Bus Engine Exported Functions
+  @{
+*/
+
+uint32_t RS485_CRC16(const uint8_t *pu8Data, uint32_t u32Len, uint32_t u32Crc);
+int32_t RS485_MasterOpen(RS485_T *psBus, UART_T *uart, RS485_SLAVE_T *psSlave, uint32_t u32SlaveNum, RS485_REPLY_FUNC_T pfnReply);
+void RS485_MasterStart(RS485_T *psBus);
+void RS485_MasterStop(RS485_T *psBus);
+int32_t RS485_SlaveOpen(RS485_T *psBus, UART_T *uart, uint32_t u32Addr, RS485_REQUEST_FUNC_T pfnRequest);
+void RS485_Close(RS485_T *psBus);
+void RS485_IRQHandler(RS485_T *psBus);
+
+
+/*@}*/ /* end of group RS485_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group RS485_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__RS485_H__
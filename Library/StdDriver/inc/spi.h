@@ -55,6 +55,20 @@ extern "C"
 #define SPI_TX_EMPTY_MASK                (0x08)                           /*!< TX empty status mask */
 #define SPI_TX_FULL_MASK                 (0x10)                           /*!< TX full status mask */
 
+#define SPI_CLK_NEAREST                  (0x0)                            /*!< Select the bus clock closest to the target */
+#define SPI_CLK_NOT_ABOVE                (0x1)                            /*!< Select the fastest bus clock not above the target */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  SPI bus clock setting structure                                                                        */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32ClkSel;     /*!< SPI0_S setting of CLKSEL1. (CLK_CLKSEL1_SPI0_S_HCLK, CLK_CLKSEL1_SPI0_S_PLL) */
+    uint32_t u32BCn;        /*!< 1: f_spi = f_src / (DIVIDER + 1); 0: f_spi = f_src / ((DIVIDER + 1) * 2) */
+    uint32_t u32Divider;    /*!< DIVIDER setting, 0 ~ 255 */
+    uint32_t u32BusClock;   /*!< Achieved SPI bus clock in Hz */
+} SPI_CLK_PLAN_T;
+
 /*@}*/ /* end of group SPI_EXPORTED_CONSTANTS */
 
 
@@ -274,6 +288,8 @@ void SPI_ClearTxFIFO(SPI_T *spi);
 void SPI_DisableAutoSS(SPI_T *spi);
 void SPI_EnableAutoSS(SPI_T *spi, uint32_t u32SSPinMask, uint32_t u32ActiveLevel);
 uint32_t SPI_SetBusClock(SPI_T *spi, uint32_t u32BusClock);
+uint32_t SPI_PlanBusClock(uint32_t u32HclkFreq, uint32_t u32PllFreq, uint32_t u32BusClock, uint32_t u32Policy, SPI_CLK_PLAN_T *psPlan);
+void SPI_ApplyBusClock(SPI_T *spi, const SPI_CLK_PLAN_T *psPlan);
 void SPI_EnableFIFO(SPI_T *spi, uint32_t u32TxThreshold, uint32_t u32RxThreshold);
 void SPI_DisableFIFO(SPI_T *spi);
 uint32_t SPI_GetBusClock(SPI_T *spi);
@@ -0,0 +1,135 @@
+/**************************************************************************//**
+ * @file     spi_flash.h
+ * @version  V3.00
+ * @brief    NUC1311 series external SPI NOR Flash driver header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __SPI_FLASH_H__
+#define __SPI_FLASH_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup SPIFLASH_Driver SPI NOR Flash Driver
+  @{
+*/
+
+/** @addtogroup SPIFLASH_EXPORTED_CONSTANTS SPI NOR Flash Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* SPI NOR Flash Geometry Constant Definitions                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SPIFLASH_PAGE_SIZE          256UL       /*!< Page program granularity in bytes */
+#define SPIFLASH_SECTOR_SIZE        4096UL      /*!< Sector erase granularity in bytes */
+
+#ifndef SPIFLASH_CACHE_LINES
+#define SPIFLASH_CACHE_LINES        4UL         /*!< Number of read cache lines. Each line costs SPIFLASH_LINE_SIZE bytes of SRAM */
+#endif
+#define SPIFLASH_LINE_SIZE          256UL       /*!< Read cache line size in bytes */
+
+#define SPIFLASH_FIFO_DEPTH         8UL         /*!< SPI TX/RX FIFO depth used to pipeline a transfer */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* SPI NOR Flash Command Constant Definitions                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SPIFLASH_CMD_WRITE_ENABLE   0x06        /*!< Write enable */
+#define SPIFLASH_CMD_READ_STATUS    0x05        /*!< Read status register 1 */
+#define SPIFLASH_CMD_READ_JEDEC_ID  0x9F        /*!< Read JEDEC manufacturer and device ID */
+#define SPIFLASH_CMD_FAST_READ      0x0B        /*!< Fast read, 8 dummy clocks after address */
+#define SPIFLASH_CMD_PAGE_PROGRAM   0x02        /*!< Page program */
+#define SPIFLASH_CMD_SECTOR_ERASE   0x20        /*!< 4 KB sector erase */
+
+#define SPIFLASH_SR_WIP             0x01        /*!< Status register: write in progress */
+#define SPIFLASH_SR_WEL             0x02        /*!< Status register: write enable latch */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* SPI NOR Flash Operation State and Return Code Constant Definitions                                      */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SPIFLASH_STATE_IDLE         0UL         /*!< No program or erase operation in progress */
+#define SPIFLASH_STATE_PROGRAM      1UL         /*!< Page program in progress */
+#define SPIFLASH_STATE_ERASE        2UL         /*!< Sector erase in progress */
+
+#define SPIFLASH_OK                 0           /*!< Operation finished */
+#define SPIFLASH_BUSY               1           /*!< Program or erase still in progress */
+#define SPIFLASH_ERR_PARAM          (-1)        /*!< Invalid address or length */
+#define SPIFLASH_ERR_ID             (-2)        /*!< No valid JEDEC ID was read */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  SPI NOR Flash read cache line structure                                                                */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32Tag;                            /*!< Line-aligned flash address, 0xFFFFFFFF if line is invalid */
+    uint32_t u32Stamp;                          /*!< Last access stamp for LRU replacement */
+    uint8_t  au8Data[SPIFLASH_LINE_SIZE];       /*!< Cached flash content */
+} SPIFLASH_LINE_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  SPI NOR Flash device structure                                                                         */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    SPI_T    *spi;                              /*!< SPI module the flash is attached to */
+    uint32_t u32JedecId;                        /*!< Manufacturer ID [23:16], memory type [15:8], capacity [7:0] */
+    uint32_t u32Size;                           /*!< Flash size in bytes decoded from JEDEC capacity code */
+    volatile uint32_t u32State;                 /*!< SPIFLASH_STATE_IDLE, SPIFLASH_STATE_PROGRAM or SPIFLASH_STATE_ERASE */
+    uint32_t u32Stamp;                          /*!< LRU access counter */
+    uint32_t u32CacheHit;                       /*!< Number of line reads served from cache */
+    uint32_t u32CacheMiss;                      /*!< Number of line reads fetched from flash */
+    SPIFLASH_LINE_T asLine[SPIFLASH_CACHE_LINES];
+} SPIFLASH_T;
+
+/*@}*/ /* end of group SPIFLASH_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup SPIFLASH_EXPORTED_FUNCTIONS SPI NOR Flash Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Check whether a program or erase operation is in progress.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @retval     0 Flash is idle.
+  * @retval     1 A program or erase operation was started and has not been completed by SPIFLASH_Poll().
+  * @details    This macro only checks the software state. Call SPIFLASH_Poll() to update it from the WIP bit.
+  */
+#define SPIFLASH_IS_BUSY(flash)   (((flash)->u32State != SPIFLASH_STATE_IDLE) ? 1 : 0)
+
+
+int32_t SPIFLASH_Open(SPIFLASH_T *flash, SPI_T *spi, uint32_t u32BusClock);
+uint32_t SPIFLASH_ReadJedecId(SPIFLASH_T *flash);
+uint32_t SPIFLASH_ReadStatus(SPIFLASH_T *flash);
+int32_t SPIFLASH_Read(SPIFLASH_T *flash, uint32_t u32Addr, uint8_t *pu8Buf, uint32_t u32Len);
+int32_t SPIFLASH_ProgramPage(SPIFLASH_T *flash, uint32_t u32Addr, const uint8_t *pu8Buf, uint32_t u32Len);
+int32_t SPIFLASH_EraseSector(SPIFLASH_T *flash, uint32_t u32Addr);
+int32_t SPIFLASH_Poll(SPIFLASH_T *flash);
+void SPIFLASH_InvalidateCache(SPIFLASH_T *flash, uint32_t u32Addr, uint32_t u32Len);
+
+
+/*@}*/ /* end of group SPIFLASH_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group SPIFLASH_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SPI_FLASH_H__
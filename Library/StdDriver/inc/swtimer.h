@@ -0,0 +1,96 @@
+/**************************************************************************//**
+ * @file     swtimer.h
+ * @version  V3.00
+ * @brief    NUC1311 series software timer service header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __SWTIMER_H__
+#define __SWTIMER_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup SWTIMER_Driver Software Timer Driver
+  @{
+*/
+
+/** @addtogroup SWTIMER_EXPORTED_CONSTANTS Software Timer Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Timing wheel geometry                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+#define SWTIMER_LEVELS          4UL                                 /*!< Number of wheel levels */
+#define SWTIMER_SLOT_BITS       5UL                                 /*!< log2 of slots per level */
+#define SWTIMER_SLOTS           (1UL << SWTIMER_SLOT_BITS)          /*!< Slots per level */
+#define SWTIMER_MAX_TICKS       ((1UL << 23) - 1UL)                 /*!< Longest single timeout in ticks. Longer timeouts are rejected */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Software timer callback and control block                                                              */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef void (*SWTIMER_FUNC_T)(void *pvArg);                        /*!< Expiry callback, called in timer interrupt context */
+
+typedef struct SWTIMER_S
+{
+    struct SWTIMER_S *psNext;                                       /*!< Next timer in the same wheel slot */
+    struct SWTIMER_S *psPrev;                                       /*!< Previous timer in the same wheel slot */
+    uint32_t u32Expire;                                             /*!< Absolute expiry tick */
+    uint32_t u32Period;                                             /*!< Reload period in ticks, 0 for one-shot */
+    SWTIMER_FUNC_T pfnFunc;                                         /*!< Expiry callback */
+    void *pvArg;                                                    /*!< Callback argument */
+    uint8_t u8Level;                                                /*!< Wheel level the timer is linked in */
+    uint8_t u8Slot;                                                 /*!< Wheel slot the timer is linked in */
+    uint8_t u8Active;                                               /*!< 1 if the timer is linked in the wheel */
+} SWTIMER_T;
+
+/*@}*/ /* end of group SWTIMER_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup SWTIMER_EXPORTED_FUNCTIONS Software Timer Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Check whether a software timer is running.
+  * @param[in]  psTmr The pointer of the software timer.
+  * @retval     0 Timer is stopped or has expired (one-shot).
+  * @retval     1 Timer is running.
+  */
+#define SWTIMER_IS_ACTIVE(psTmr)    ((psTmr)->u8Active)
+
+
+uint32_t SWTIMER_Open(TIMER_T *timer, uint32_t u32TickFreq);
+void SWTIMER_Close(void);
+int32_t SWTIMER_Start(SWTIMER_T *psTmr, uint32_t u32Ticks, uint32_t u32Period, SWTIMER_FUNC_T pfnFunc, void *pvArg);
+void SWTIMER_Stop(SWTIMER_T *psTmr);
+uint32_t SWTIMER_GetTick(void);
+uint32_t SWTIMER_GetIdleTicks(void);
+void SWTIMER_IRQHandler(void);
+
+
+/*@}*/ /* end of group SWTIMER_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group SWTIMER_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SWTIMER_H__
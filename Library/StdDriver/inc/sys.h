@@ -1430,6 +1430,24 @@ static __INLINE void SYS_UnlockReg(void)
     }
 }
 
+/**
+  * @brief      Count trailing zero bits
+  * @param[in]  u32Val is the value to scan. It must not be 0.
+  * @return     Index of the lowest set bit, 0 ~ 31.
+  * @details    Cortex-M0 has no CLZ instruction, so the lowest set bit is isolated and looked up
+  *             with a De Bruijn multiply. Used to walk pending bit maps from the lowest bit up.
+  */
+static __INLINE uint32_t SYS_Ctz(uint32_t u32Val)
+{
+    static const uint8_t au8DeBruijn[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+
+    return au8DeBruijn[(uint32_t)((u32Val & (0UL - u32Val)) * 0x077CB531UL) >> 27];
+}
+
 
 void SYS_ClearResetSrc(uint32_t u32Src);
 uint32_t SYS_GetBODStatus(void);
@@ -0,0 +1,77 @@
+/**************************************************************************//**
+ * @file     tstamp.h
+ * @version  V3.00
+ * @brief    NUC1311 series microsecond timestamp service header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __TSTAMP_H__
+#define __TSTAMP_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup TSTAMP_Driver Timestamp Driver
+  @{
+*/
+
+/** @addtogroup TSTAMP_EXPORTED_CONSTANTS Timestamp Exported Constants
+  @{
+*/
+
+#define TSTAMP_FREQ             1000000UL                           /*!< Nominal timestamp frequency, 1 tick per microsecond */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Capture callback                                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef void (*TSTAMP_CAP_FUNC_T)(uint64_t u64Stamp);               /*!< Capture callback, called in timer interrupt context */
+
+/*@}*/ /* end of group TSTAMP_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup TSTAMP_EXPORTED_FUNCTIONS Timestamp Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the 32-bit timestamp.
+  * @param      None
+  * @return     Microseconds since TSTAMP_Open(), wraps about every 71 minutes.
+  * @details    Differences of two 32-bit timestamps are correct across the wrap when computed with unsigned arithmetic.
+  */
+#define TSTAMP_Get32()          ((uint32_t)TSTAMP_Get())
+
+
+uint32_t TSTAMP_Open(TIMER_T *timer);
+void TSTAMP_Close(void);
+uint64_t TSTAMP_Get(void);
+void TSTAMP_EnableCapture(uint32_t u32Edge, TSTAMP_CAP_FUNC_T pfnFunc);
+void TSTAMP_DisableCapture(void);
+int32_t TSTAMP_GetCapture(uint64_t *pu64Stamp);
+void TSTAMP_IRQHandler(void);
+
+
+/*@}*/ /* end of group TSTAMP_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group TSTAMP_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__TSTAMP_H__
@@ -118,9 +118,33 @@ extern "C"
 /* UART BAUDRATE MODE constants definitions                                                                */
 /*---------------------------------------------------------------------------------------------------------*/
 #define UART_BAUD_MODE0     (0) /*!< Set UART Baudrate Mode is Mode0 */
+#define UART_BAUD_MODE1     (UART_BAUD_DIV_X_EN_Msk) /*!< Set UART Baudrate Mode is Mode1 */
 #define UART_BAUD_MODE2     (UART_BAUD_DIV_X_EN_Msk | UART_BAUD_DIV_X_ONE_Msk) /*!< Set UART Baudrate Mode is Mode2 */
 
 
+/*---------------------------------------------------------------------------------------------------------*/
+/* UART baud rate planner constants definitions                                                            */
+/*---------------------------------------------------------------------------------------------------------*/
+#define UART_BAUD_PLAN_CURRENT  (0x0)   /*!< Keep the UART clock source and divider, search the baud rate divider only */
+#define UART_BAUD_PLAN_HXT      (0x1)   /*!< Consider the external crystal as UART clock source */
+#define UART_BAUD_PLAN_PLL      (0x2)   /*!< Consider the PLL as UART clock source */
+#define UART_BAUD_PLAN_HIRC     (0x8)   /*!< Consider the internal 22.1184 MHz RC as UART clock source */
+#define UART_BAUD_PLAN_ALL      (UART_BAUD_PLAN_HXT | UART_BAUD_PLAN_PLL | UART_BAUD_PLAN_HIRC) /*!< Consider all UART clock sources */
+
+/**
+  * @brief  Baud rate plan
+  */
+typedef struct
+{
+    uint32_t u32ClkSrc;     /*!< UART clock source, \ref CLK_CLKSEL1_UART_S_HXT, \ref CLK_CLKSEL1_UART_S_PLL or \ref CLK_CLKSEL1_UART_S_HIRC */
+    uint32_t u32ClkDiv;     /*!< UART clock divider (UART_N + 1), 1 ~ 16 */
+    uint32_t u32ClkFreq;    /*!< UART clock frequency after the divider */
+    uint32_t u32Baud;       /*!< UA_BAUD register value */
+    uint32_t u32Actual;     /*!< Achieved baud rate */
+    int32_t i32ErrPpm;      /*!< Baud rate error in ppm, (actual - target) / target */
+} UART_BAUD_PLAN_T;
+
+
 /*@}*/ /* end of group UART_EXPORTED_CONSTANTS */
 
 
@@ -429,6 +453,9 @@ void UART_DisableInt(UART_T*  uart, uint32_t u32InterruptFlag);
 void UART_EnableFlowCtrl(UART_T* uart);
 void UART_EnableInt(UART_T*  uart, uint32_t u32InterruptFlag);
 void UART_Open(UART_T* uart, uint32_t u32baudrate);
+int32_t UART_CalcBaud(uint32_t u32ClkFreq, uint32_t u32BaudRate, UART_BAUD_PLAN_T *psPlan);
+int32_t UART_PlanBaud(uint32_t u32BaudRate, uint32_t u32ClkMask, UART_BAUD_PLAN_T *psPlan);
+void UART_ApplyBaudPlan(UART_T* uart, const UART_BAUD_PLAN_T *psPlan);
 uint32_t UART_Read(UART_T* uart, uint8_t *pu8RxBuf, uint32_t u32ReadBytes);
 void UART_SetLine_Config(UART_T* uart, uint32_t u32baudrate, uint32_t u32data_width, uint32_t u32parity, uint32_t  u32stop_bits);
 void UART_SetTimeoutCnt(UART_T* uart, uint32_t u32TOC);
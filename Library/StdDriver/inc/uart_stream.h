@@ -0,0 +1,113 @@
+/**************************************************************************//**
+ * @file     uart_stream.h
+ * @version  V3.00
+ * @brief    NUC1311 series UART streaming with auto flow control header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __UART_STREAM_H__
+#define __UART_STREAM_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup UARTSTREAM_Driver UART Streaming
+  @{
+*/
+
+/** @addtogroup UARTSTREAM_EXPORTED_CONSTANTS UART Streaming Exported Constants
+  @{
+*/
+
+#define UARTSTREAM_ERR_PARAM    (-1)    /*!< Invalid parameter */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Statistics                                                                                             */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t u32RxBytes;                            /*!< Bytes moved from the RX FIFO to the ring */
+    uint32_t u32TxBytes;                            /*!< Bytes moved from the ring to the TX FIFO */
+    uint32_t u32RxFifoHigh;                         /*!< Highest RX FIFO level seen in the interrupt */
+    uint32_t u32RxRingHigh;                         /*!< Highest RX ring level */
+    uint32_t u32Overruns;                           /*!< RX FIFO overruns, the peer ignored RTS */
+    uint32_t u32Throttles;                          /*!< Times the RX ring filled up and RTS was left to the hardware */
+    uint32_t u32ThrottleUs;                         /*!< Total time RTS was held by a full RX ring, 0 unless TSTAMP_Open() was called */
+    uint32_t u32ThrottleMaxUs;                      /*!< Longest time RTS was held by a full RX ring, 0 unless TSTAMP_Open() was called */
+} UARTSTREAM_STAT_T;
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Stream control block                                                                                   */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    UART_T *uart;                                   /*!< UART of the stream, UART0 ~ UART2 */
+    uint8_t *pu8RxBuf;                              /*!< RX ring buffer */
+    uint8_t *pu8TxBuf;                              /*!< TX ring buffer */
+    uint32_t u32RxMask;                             /*!< RX ring size - 1 */
+    uint32_t u32TxMask;                             /*!< TX ring size - 1 */
+    volatile uint32_t u32RxHead;                    /*!< RX ring write index, free running, written by the interrupt */
+    volatile uint32_t u32RxTail;                    /*!< RX ring read index, free running */
+    volatile uint32_t u32TxHead;                    /*!< TX ring write index, free running */
+    volatile uint32_t u32TxTail;                    /*!< TX ring read index, free running, written by the interrupt */
+    uint32_t u32Resume;                             /*!< Free RX ring bytes needed to resume a throttled receiver */
+    volatile uint32_t u32Throttled;                 /*!< 1 while the receiver is throttled */
+    uint32_t u32ThrottleStart;                      /*!< TSTAMP time the receiver was throttled */
+    UARTSTREAM_STAT_T sStat;                        /*!< Statistics */
+} UARTSTREAM_T;
+
+/*@}*/ /* end of group UARTSTREAM_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup UARTSTREAM_EXPORTED_FUNCTIONS UART Streaming Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Get the number of received bytes waiting in the RX ring.
+  * @param[in]  psStream The pointer of the stream control block.
+  * @return     Bytes available to UARTSTREAM_Read().
+  */
+#define UARTSTREAM_GET_RX_COUNT(psStream)   ((psStream)->u32RxHead - (psStream)->u32RxTail)
+
+/**
+  * @brief      Get the free space of the TX ring.
+  * @param[in]  psStream The pointer of the stream control block.
+  * @return     Bytes UARTSTREAM_Write() accepts without blocking.
+  */
+#define UARTSTREAM_GET_TX_FREE(psStream)    ((psStream)->u32TxMask + 1 - ((psStream)->u32TxHead - (psStream)->u32TxTail))
+
+
+int32_t UARTSTREAM_Open(UARTSTREAM_T *psStream, UART_T *uart, uint8_t *pu8RxBuf, uint32_t u32RxSize, uint8_t *pu8TxBuf, uint32_t u32TxSize);
+void UARTSTREAM_SetThreshold(UARTSTREAM_T *psStream, uint32_t u32RxTrigger, uint32_t u32RtsTrigger, uint32_t u32TimeoutBits, uint32_t u32Resume);
+void UARTSTREAM_Close(UARTSTREAM_T *psStream);
+uint32_t UARTSTREAM_Read(UARTSTREAM_T *psStream, uint8_t *pu8Buf, uint32_t u32Len);
+uint32_t UARTSTREAM_Write(UARTSTREAM_T *psStream, const uint8_t *pu8Buf, uint32_t u32Len);
+void UARTSTREAM_ClearStat(UARTSTREAM_T *psStream);
+void UARTSTREAM_IRQHandler(UARTSTREAM_T *psStream);
+
+
+/*@}*/ /* end of group UARTSTREAM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group UARTSTREAM_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__UART_STREAM_H__
@@ -0,0 +1,82 @@
+/**************************************************************************//**
+ * @file     wdmux.h
+ * @version  V3.00
+ * @brief    NUC1311 series watchdog multiplexer header file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ *
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __WDMUX_H__
+#define __WDMUX_H__
+
+#include "NUC1311.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup WDMUX_Driver Watchdog Multiplexer
+  @{
+*/
+
+/** @addtogroup WDMUX_EXPORTED_CONSTANTS Watchdog Multiplexer Exported Constants
+  @{
+*/
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Supervised task control block                                                                          */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct WDMUX_TASK_S
+{
+    struct WDMUX_TASK_S *psNext;                    /*!< Next supervised task */
+    volatile uint32_t u32Remain;                    /*!< Supervision periods left before the task is starved */
+    uint32_t u32Periods;                            /*!< Deadline in supervision periods, reloaded by WDMUX_CheckIn() */
+    const char *pcName;                             /*!< Task name reported on starvation. Could be NULL */
+} WDMUX_TASK_T;
+
+typedef void (*WDMUX_STARVED_FUNC_T)(WDMUX_TASK_T *psTask);    /*!< Called in the WWDT interrupt before the reset */
+
+/*@}*/ /* end of group WDMUX_EXPORTED_CONSTANTS */
+
+
+/** @addtogroup WDMUX_EXPORTED_FUNCTIONS Watchdog Multiplexer Exported Functions
+  @{
+*/
+
+/**
+  * @brief      Report that a supervised task is alive.
+  * @param[in]  psTask The pointer of the supervised task.
+  * @return     None
+  * @details    A single store. WDMUX_IRQHandler() decrements the count with interrupts disabled, so a check-in
+  *             from any context, also an interrupt of higher priority than WDT, is never lost.
+  */
+#define WDMUX_CheckIn(psTask)   ((psTask)->u32Remain = (psTask)->u32Periods)
+
+
+void WDMUX_Open(uint32_t u32WdtTimeout, uint32_t u32WwdtPrescale, uint32_t u32WwdtCmp, WDMUX_STARVED_FUNC_T pfnStarved);
+void WDMUX_Register(WDMUX_TASK_T *psTask, uint32_t u32Periods, const char *pcName);
+void WDMUX_Unregister(WDMUX_TASK_T *psTask);
+WDMUX_TASK_T *WDMUX_GetStarved(void);
+void WDMUX_IRQHandler(void);
+
+
+/*@}*/ /* end of group WDMUX_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group WDMUX_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__WDMUX_H__
@@ -36,6 +36,15 @@
 
 #define RETRY_COUNTS    (0x10000000)
 
+#define CAN_MODULE_INDEX(can)   (((can) == CAN1) ? 1 : 0)
+#define CAN_IRQ_LOOP_MAX        (CAN_MSG_OBJ_CNT + 1)   /* Every message object and the status once per ISR entry */
+
+/* Interrupt dispatch tables of CAN0 and CAN1 */
+static CAN_MSG_FUNC_T s_apfnMsgFunc[2][CAN_MSG_OBJ_CNT];
+static void *s_apvMsgArg[2][CAN_MSG_OBJ_CNT];
+static CAN_STATUS_FUNC_T s_apfnStatusFunc[2];
+static void *s_apvStatusArg[2];
+
 
 
 static uint32_t GetFreeIF(CAN_T  *tCAN);
@@ -154,7 +163,7 @@ void CAN_WaitMsg(CAN_T *tCAN)
 /**
   * @brief Get current bit rate
   * @param[in] tCAN The pointer to CAN module base address.
-  * @return Current Bit-Rate (kilo bit per second)
+  * @return Current Bit-Rate (bit per second)
   * @details Return current CAN bit rate according to the user bit-timing parameter settings
   */
 uint32_t CAN_GetCANBitRate(CAN_T *tCAN)
@@ -230,9 +239,18 @@ uint32_t CAN_IsNewDataReceived(CAN_T *tCAN, uint8_t u8MsgObj)
 int32_t CAN_BasicSendMsg(CAN_T *tCAN, STR_CANMSG_T* pCanMsg)
 {
     uint32_t i = 0;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
     while(tCAN->IF[0].CREQ & CAN_IF_CREQ_BUSY_Msk)
     {
-        if(++i > CAN_TIMEOUT) return -1;
+        if(++i > CAN_TIMEOUT)
+        {
+            __set_PRIMASK(u32PriMask);
+            return -1;
+        }
     }
 
     tCAN->STATUS &= (~CAN_STATUS_TXOK_Msk);
@@ -266,12 +284,15 @@ int32_t CAN_BasicSendMsg(CAN_T *tCAN, STR_CANMSG_T* pCanMsg)
     tCAN->IF[0].CREQ &= (~CAN_IF_CREQ_BUSY_Msk);
     if(tCAN->IF[0].CREQ & CAN_IF_CREQ_BUSY_Msk)
     {
+        __set_PRIMASK(u32PriMask);
         DEBUG_PRINTF("Cannot clear busy for sending ...\n");
         return FALSE;
     }
 
     tCAN->IF[0].CREQ |= CAN_IF_CREQ_BUSY_Msk;                          // sending
 
+    __set_PRIMASK(u32PriMask);
+
     for(i = 0; i < 0xFFFFF; i++)
     {
         if((tCAN->IF[0].CREQ & CAN_IF_CREQ_BUSY_Msk) == 0)
@@ -363,9 +384,14 @@ int32_t CAN_BasicReceiveMsg(CAN_T *tCAN, STR_CANMSG_T* pCanMsg)
 int32_t CAN_SetRxMsgObjAndMsk(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8idType, uint32_t u32id, uint32_t u32idmask, uint8_t u8singleOrFifoLast)
 {
     uint8_t u8MsgIfNum;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
 
     if((u8MsgIfNum = GetFreeIF(tCAN)) == 2)                         /* Check Free Interface for configure */
     {
+        __set_PRIMASK(u32PriMask);
         return FALSE;
     }
     /* Command Setting */
@@ -401,6 +427,8 @@ int32_t CAN_SetRxMsgObjAndMsk(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8idType, u
 
     tCAN->IF[u8MsgIfNum].CREQ = 1 + u8MsgObj;
 
+    __set_PRIMASK(u32PriMask);
+
     return TRUE;
 }
 
@@ -424,9 +452,14 @@ int32_t CAN_SetRxMsgObjAndMsk(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8idType, u
 int32_t CAN_SetRxMsgObj(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8idType, uint32_t u32id, uint8_t u8singleOrFifoLast)
 {
     uint8_t u8MsgIfNum = 0;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
 
     if((u8MsgIfNum = GetFreeIF(tCAN)) == 2)                         /* Check Free Interface for configure */
     {
+        __set_PRIMASK(u32PriMask);
         return FALSE;
     }
     /* Command Setting */
@@ -458,6 +491,8 @@ int32_t CAN_SetRxMsgObj(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8idType, uint32_
 
     tCAN->IF[u8MsgIfNum].CREQ = 1 + u8MsgObj;
 
+    __set_PRIMASK(u32PriMask);
+
     return TRUE;
 }
 
@@ -478,6 +513,7 @@ int32_t CAN_SetRxMsgObj(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8idType, uint32_
 int32_t CAN_ReadMsgObj(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8Release, STR_CANMSG_T* pCanMsg)
 {
     uint32_t u32TimeOutCount = CAN_TIMEOUT<<1;
+    uint32_t u32PriMask;
     if(!CAN_IsNewDataReceived(tCAN, u8MsgObj))
     {
         return FALSE;
@@ -485,6 +521,19 @@ int32_t CAN_ReadMsgObj(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8Release, STR_CAN
 
     tCAN->STATUS &= (~CAN_STATUS_RXOK_Msk);
 
+    /* IF2 is also read from interrupt handlers, so it is held with interrupts masked */
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    while(tCAN->IF[1].CREQ & CAN_IF_CREQ_BUSY_Msk) /* Transfer of the code interrupted */
+    {
+        if(--u32TimeOutCount == 0)
+        {
+            __set_PRIMASK(u32PriMask);
+            return -1;
+        }
+    }
+
     /* read the message contents*/
     tCAN->IF[1].CMASK = CAN_IF_CMASK_MASK_Msk
                         | CAN_IF_CMASK_ARB_Msk
@@ -498,7 +547,11 @@ int32_t CAN_ReadMsgObj(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8Release, STR_CAN
 
     while(tCAN->IF[1].CREQ & CAN_IF_CREQ_BUSY_Msk) /* Wait */
     {
-        if(--u32TimeOutCount == 0) return -1;
+        if(--u32TimeOutCount == 0)
+        {
+            __set_PRIMASK(u32PriMask);
+            return -1;
+        }
     }
 
     if((tCAN->IF[1].ARB2 & CAN_IF_ARB2_XTD_Msk) == 0)
@@ -524,6 +577,8 @@ int32_t CAN_ReadMsgObj(CAN_T *tCAN, uint8_t u8MsgObj, uint8_t u8Release, STR_CAN
     pCanMsg->Data[6] = tCAN->IF[1].DAT_B2 & CAN_IF_DAT_B2_DATA6_Msk;
     pCanMsg->Data[7] = (tCAN->IF[1].DAT_B2 & CAN_IF_DAT_B2_DATA7_Msk) >> CAN_IF_DAT_B2_DATA7_Pos;
 
+    __set_PRIMASK(u32PriMask);
+
     return TRUE;
 }
 
@@ -708,12 +763,19 @@ int32_t CAN_SetTxMsg(CAN_T *tCAN, uint32_t u32MsgNum , STR_CANMSG_T* pCanMsg)
 {
     uint8_t u8MsgIfNum = 0;
     uint32_t i = 0;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
 
     while((u8MsgIfNum = GetFreeIF(tCAN)) == 2)
     {
         i++;
         if(i > 0x10000000)
+        {
+            __set_PRIMASK(u32PriMask);
             return FALSE;
+        }
     }
 
     /* update the contents needed for transmission*/
@@ -747,6 +809,8 @@ int32_t CAN_SetTxMsg(CAN_T *tCAN, uint32_t u32MsgNum , STR_CANMSG_T* pCanMsg)
     tCAN->IF[u8MsgIfNum].MCON   =  CAN_IF_MCON_NEWDAT_Msk | pCanMsg->DLC | CAN_IF_MCON_TXIE_Msk | CAN_IF_MCON_EOB_Msk;
     tCAN->IF[u8MsgIfNum].CREQ   = 1 + u32MsgNum;
 
+    __set_PRIMASK(u32PriMask);
+
     return TRUE;
 }
 
@@ -764,9 +828,13 @@ int32_t CAN_SetTxMsg(CAN_T *tCAN, uint32_t u32MsgNum , STR_CANMSG_T* pCanMsg)
 int32_t CAN_TriggerTxMsg(CAN_T  *tCAN, uint32_t u32MsgNum)
 {
     uint32_t u32TimeOutCount = CAN_TIMEOUT;
+    uint32_t u32PriMask;
 
     tCAN->STATUS &= (~CAN_STATUS_TXOK_Msk);
 
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
     /* read the message contents*/
     tCAN->IF[1].CMASK = CAN_IF_CMASK_CLRINTPND_Msk
                         | CAN_IF_CMASK_TXRQSTNEWDAT_Msk;
@@ -775,11 +843,25 @@ int32_t CAN_TriggerTxMsg(CAN_T  *tCAN, uint32_t u32MsgNum)
 
     while(tCAN->IF[1].CREQ & CAN_IF_CREQ_BUSY_Msk) /* Wait */
     {
-        if(--u32TimeOutCount == 0) return -1;
+        if(--u32TimeOutCount == 0)
+        {
+            __set_PRIMASK(u32PriMask);
+            return -1;
+        }
+    }
+    while(tCAN->IF[0].CREQ & CAN_IF_CREQ_BUSY_Msk) /* Wait */
+    {
+        if(--u32TimeOutCount == 0)
+        {
+            __set_PRIMASK(u32PriMask);
+            return -1;
+        }
     }
     tCAN->IF[0].CMASK  = CAN_IF_CMASK_WRRD_Msk | CAN_IF_CMASK_TXRQSTNEWDAT_Msk;
     tCAN->IF[0].CREQ  = 1 + u32MsgNum;
 
+    __set_PRIMASK(u32PriMask);
+
     return TRUE;
 }
 
@@ -972,6 +1054,10 @@ void CAN_CLR_INT_PENDING_BIT(CAN_T *tCAN, uint8_t u32MsgNum)
 {
     uint32_t u32MsgIfNum = 0;
     uint32_t u32IFBusyCount = 0;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
 
     while(u32IFBusyCount < RETRY_COUNTS)
     {
@@ -992,6 +1078,110 @@ void CAN_CLR_INT_PENDING_BIT(CAN_T *tCAN, uint8_t u32MsgNum)
     tCAN->IF[u32MsgIfNum].CMASK = CAN_IF_CMASK_CLRINTPND_Msk | CAN_IF_CMASK_TXRQSTNEWDAT_Msk;
     tCAN->IF[u32MsgIfNum].CREQ = 1 + u32MsgNum;
 
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief Install the interrupt handler of a message object.
+  * @param[in] tCAN The pointer to CAN module base address.
+  * @param[in] u32MsgNum Specifies the Message object number, from 0 to 31.
+  * @param[in] pfnFunc The handler, NULL to remove it.
+  * @param[in] pvArg The argument passed to the handler.
+  *
+  * @return None
+  *
+  * @details CAN_IRQDispatch() calls the handler with the message object number whenever the object interrupts.
+  *          The handler should read the object with CAN_Receive(), which clears the pending bit. If the pending
+  *          bit is still set when the handler returns, or no handler is installed, the dispatcher clears it
+  *          with CAN_CLR_INT_PENDING_BIT().
+  */
+void CAN_InstallMsgHandler(CAN_T *tCAN, uint32_t u32MsgNum, CAN_MSG_FUNC_T pfnFunc, void *pvArg)
+{
+    uint32_t u32Idx = CAN_MODULE_INDEX(tCAN);
+    uint32_t u32PriMask;
+
+    if(u32MsgNum >= CAN_MSG_OBJ_CNT)
+        return;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    s_apfnMsgFunc[u32Idx][u32MsgNum] = pfnFunc;
+    s_apvMsgArg[u32Idx][u32MsgNum] = pvArg;
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief Install the status change and error interrupt handler.
+  * @param[in] tCAN The pointer to CAN module base address.
+  * @param[in] pfnFunc The handler, NULL to remove it.
+  * @param[in] pvArg The argument passed to the handler.
+  *
+  * @return None
+  *
+  * @details CAN_IRQDispatch() calls the handler with the STATUS register read when IIDR is 0x8000.
+  *          Reading STATUS releases the interrupt, and the dispatcher clears RxOK and TxOK before the handler runs.
+  *          BOff, EWarn, EPass and LEC are passed on as read. The error counters are left in the ERR register.
+  */
+void CAN_InstallStatusHandler(CAN_T *tCAN, CAN_STATUS_FUNC_T pfnFunc, void *pvArg)
+{
+    uint32_t u32Idx = CAN_MODULE_INDEX(tCAN);
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    s_apfnStatusFunc[u32Idx] = pfnFunc;
+    s_apvStatusArg[u32Idx] = pvArg;
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief Service every pending CAN interrupt.
+  * @param[in] tCAN The pointer to CAN module base address.
+  *
+  * @return The number of interrupts serviced.
+  *
+  * @details Call it from CAN0_IRQHandler() or CAN1_IRQHandler(). IIDR is read again after each interrupt, and the
+  *          installed handlers are called until it reads 0. A burst of frames is therefore serviced in one ISR entry.
+  *          IIDR always points to the highest priority interrupt, so the status interrupt comes first and then
+  *          the message objects from 0 up. At most 33 interrupts are serviced per call. If more are still pending,
+  *          the interrupt line stays asserted and the ISR is entered again.
+  */
+uint32_t CAN_IRQDispatch(CAN_T *tCAN)
+{
+    uint32_t u32Idx = CAN_MODULE_INDEX(tCAN);
+    uint32_t u32IIDR, u32Status, u32MsgNum, u32Pend;
+    uint32_t u32Count;
+
+    for(u32Count = 0; u32Count < CAN_IRQ_LOOP_MAX; u32Count++)
+    {
+        u32IIDR = tCAN->IIDR & CAN_IIDR_INTID_Msk;
+
+        if(u32IIDR == CAN_IIDR_STATUS)
+        {
+            u32Status = tCAN->STATUS;   /* Reading STATUS releases the status interrupt */
+            tCAN->STATUS = u32Status & ~(CAN_STATUS_RXOK_Msk | CAN_STATUS_TXOK_Msk);
+
+            if(s_apfnStatusFunc[u32Idx] != NULL)
+                s_apfnStatusFunc[u32Idx](tCAN, u32Status, s_apvStatusArg[u32Idx]);
+        }
+        else if((u32IIDR >= 1) && (u32IIDR <= CAN_MSG_OBJ_CNT))
+        {
+            u32MsgNum = u32IIDR - 1;
+
+            if(s_apfnMsgFunc[u32Idx][u32MsgNum] != NULL)
+                s_apfnMsgFunc[u32Idx][u32MsgNum](tCAN, u32MsgNum, s_apvMsgArg[u32Idx][u32MsgNum]);
+
+            u32Pend = (u32MsgNum < 16) ? (tCAN->IPND1 >> u32MsgNum) : (tCAN->IPND2 >> (u32MsgNum - 16));
+            if(u32Pend & 1)
+                CAN_CLR_INT_PENDING_BIT(tCAN, u32MsgNum);
+        }
+        else
+        {
+            break;  /* No interrupt pending */
+        }
+    }
+
+    return u32Count;
 }
 
 
@@ -0,0 +1,362 @@
+/**************************************************************************//**
+ * @file     can_diag.c
+ * @version  V3.00
+ * @brief    NUC1311 series CAN bus health and load diagnostics source file
+ *
+ * @note     The status interrupt, passed on by CAN_IRQDispatch(), samples the error counters, the last error code and
+ *           the error state, and counts the frames completed on the bus. The bus load of each window is the number of
+ *           frames times their mean length over the bits the bit timing allows in the window. The mean length comes
+ *           from the frames the application counts with CANDIAG_CountFrame(); stuff bits are not included, so the
+ *           load reads a few percent low. RxOK and TxOK are single flags: frames that complete before the status
+ *           interrupt is serviced are merged into one, so under bursts of back to back frames the load is
+ *           underestimated. After a bus-off the controller is put back on the bus from the software
+ *           timer service (swtimer.c), and each bus-off that follows within a window doubles the wait.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include <string.h>
+#include "NUC1311.h"
+#include "can_diag.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup CANDIAG_Driver CAN Diagnostics
+  @{
+*/
+
+/** @addtogroup CANDIAG_EXPORTED_FUNCTIONS CAN Diagnostics Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define CANDIAG_LEC_MSK         0x7UL   /* CAN_STATUS_LEC_Msk covers only 2 of the 3 bits */
+#define CANDIAG_LEC_UNUSED      0x7UL   /* Never written by the controller, marks the code as consumed */
+
+#define CANDIAG_STD_BITS        47      /* SOF, ID, RTR, IDE, r0, DLC, CRC, delimiters, ACK, EOF and IFS */
+#define CANDIAG_EXT_BITS        67      /* The same with SRR and the 18-bit ID extension */
+
+static uint32_t CANDIAG_MsToTicks(CANDIAG_T *psDiag, uint32_t u32Ms)
+{
+    uint32_t u32Ticks = (u32Ms * psDiag->u32TickFreq + 999) / 1000;
+
+    if(u32Ticks == 0)
+        u32Ticks = 1;
+    if(u32Ticks > SWTIMER_MAX_TICKS)
+        u32Ticks = SWTIMER_MAX_TICKS;
+
+    return u32Ticks;
+}
+
+static void CANDIAG_Inc16(uint16_t *pu16Count)
+{
+    if(*pu16Count != 0xFFFF)
+        (*pu16Count)++;
+}
+
+/* Error counters into the statistics. Must be called with interrupts disabled. */
+static void CANDIAG_SampleErr(CANDIAG_T *psDiag)
+{
+    uint32_t u32Err = psDiag->tCAN->ERR;
+    uint8_t u8Tec, u8Rec;
+
+    u8Tec = (uint8_t)((u32Err & CAN_ERR_TEC_Msk) >> CAN_ERR_TEC_Pos);
+    u8Rec = (u32Err & CAN_ERR_RP_Msk) ? 128 : (uint8_t)((u32Err & CAN_ERR_REC_Msk) >> CAN_ERR_REC_Pos);
+
+    psDiag->sStat.u8Tec = u8Tec;
+    psDiag->sStat.u8Rec = u8Rec;
+    if(u8Tec > psDiag->sStat.u8TecMax)
+        psDiag->sStat.u8TecMax = u8Tec;
+    if(u8Rec > psDiag->sStat.u8RecMax)
+        psDiag->sStat.u8RecMax = u8Rec;
+}
+
+/* Put the controller back on the bus. It rejoins after 128 occurrences of 11 recessive bits. */
+static void CANDIAG_Recover(void *pvArg)
+{
+    CANDIAG_T *psDiag = (CANDIAG_T *)pvArg;
+
+    psDiag->tCAN->CON &= ~(CAN_CON_INIT_Msk | CAN_CON_CCE_Msk);
+    CANDIAG_Inc16(&psDiag->sStat.u16Recover);
+}
+
+/* Close the load window */
+static void CANDIAG_Window(void *pvArg)
+{
+    CANDIAG_T *psDiag = (CANDIAG_T *)pvArg;
+    uint32_t u32PriMask, u32Frames, u32Load, u32Status;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    u32Frames = psDiag->u32WinFrames;
+    psDiag->u32WinFrames = 0;
+
+    if(psDiag->u32SumFrames != 0)
+    {
+        psDiag->u32MeanBits = psDiag->u32SumBits / psDiag->u32SumFrames;
+        psDiag->u32SumFrames = 0;
+        psDiag->u32SumBits = 0;
+    }
+
+    /* The controller may rejoin the bus without another status interrupt, so poll the state. The read releases
+       a pending status interrupt, so the status is passed on as CAN_IRQDispatch() does. */
+    if(psDiag->sStat.u8State == CANDIAG_STATE_BUS_OFF)
+    {
+        u32Status = psDiag->tCAN->STATUS;
+        psDiag->tCAN->STATUS = u32Status & ~(CAN_STATUS_RXOK_Msk | CAN_STATUS_TXOK_Msk);
+        CANDIAG_StatusHandler(psDiag->tCAN, u32Status, psDiag);
+    }
+
+    /* A window without bus-off ends a run of recoveries */
+    if(!psDiag->u8BusOffSeen && (psDiag->sStat.u8State != CANDIAG_STATE_BUS_OFF))
+        psDiag->sStat.u8Backoff = 0;
+    psDiag->u8BusOffSeen = 0;
+
+    __set_PRIMASK(u32PriMask);
+
+    u32Load = (uint32_t)(((uint64_t)u32Frames * psDiag->u32MeanBits * 1000) / psDiag->u32WinBits);
+    if(u32Load > 1000)
+        u32Load = 1000;
+
+    psDiag->sStat.u16Load = (uint16_t)u32Load;
+    if(u32Load > psDiag->sStat.u16LoadMax)
+        psDiag->sStat.u16LoadMax = (uint16_t)u32Load;
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Start the diagnostics of a CAN module.
+  * @param[in]  psDiag       Diagnostics control block. It must stay valid until CANDIAG_Close().
+  * @param[in]  tCAN         The pointer to CAN module base address. It must be opened with CAN_Open().
+  * @param[in]  u32TickFreq  Tick frequency returned by SWTIMER_Open().
+  * @param[in]  u32WindowMs  Bus load window in ms.
+  * @retval     0                   Success
+  * @retval     CANDIAG_ERR_PARAM   Invalid parameter
+  * @details    The software timer service must be open. CANDIAG_StatusHandler() is installed with
+  *             CAN_InstallStatusHandler(), so CAN_IRQDispatch() must be called from the CAN interrupt handler with the
+  *             module, status change and error interrupts enabled (CAN_CON_IE_Msk, CAN_CON_SIE_Msk, CAN_CON_EIE_Msk).
+  *             An application with its own status handler can install that instead and call CANDIAG_StatusHandler()
+  *             from it.
+  */
+int32_t CANDIAG_Open(CANDIAG_T *psDiag, CAN_T *tCAN, uint32_t u32TickFreq, uint32_t u32WindowMs)
+{
+    uint32_t u32BitRate, u32Ticks;
+
+    if((u32TickFreq == 0) || (u32WindowMs == 0))
+        return CANDIAG_ERR_PARAM;
+
+    u32BitRate = CAN_GetCANBitRate(tCAN);
+    if(u32BitRate == 0)
+        return CANDIAG_ERR_PARAM;
+
+    psDiag->tCAN = tCAN;
+    psDiag->u32TickFreq = u32TickFreq;
+    psDiag->u32WinBits = (uint32_t)(((uint64_t)u32BitRate * u32WindowMs) / 1000);
+    if(psDiag->u32WinBits == 0)
+        return CANDIAG_ERR_PARAM;
+
+    psDiag->u32WinFrames = 0;
+    psDiag->u32MeanBits = CANDIAG_FRAME_BITS;
+    psDiag->u32SumFrames = 0;
+    psDiag->u32SumBits = 0;
+    psDiag->u8BusOffSeen = 0;
+    psDiag->sBoffTmr.u8Active = 0;
+    psDiag->sWinTmr.u8Active = 0;
+    memset(&psDiag->sStat, 0, sizeof(psDiag->sStat));
+
+    CAN_InstallStatusHandler(tCAN, CANDIAG_StatusHandler, psDiag);
+
+    u32Ticks = CANDIAG_MsToTicks(psDiag, u32WindowMs);
+    SWTIMER_Start(&psDiag->sWinTmr, u32Ticks, u32Ticks, CANDIAG_Window, psDiag);
+
+    return 0;
+}
+
+/**
+  * @brief      Stop the diagnostics.
+  * @param[in]  psDiag  Diagnostics opened by CANDIAG_Open().
+  * @return     None
+  * @details    The status handler is removed. A bus-off recovery still waiting is dropped, and the controller stays off
+  *             the bus until the application clears CAN_CON_INIT_Msk.
+  */
+void CANDIAG_Close(CANDIAG_T *psDiag)
+{
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    SWTIMER_Stop(&psDiag->sWinTmr);
+    SWTIMER_Stop(&psDiag->sBoffTmr);
+    CAN_InstallStatusHandler(psDiag->tCAN, NULL, NULL);
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Record a status interrupt.
+  * @param[in]  tCAN       The pointer to CAN module base address.
+  * @param[in]  u32Status  STATUS register read by CAN_IRQDispatch().
+  * @param[in]  pvArg      Diagnostics control block.
+  * @return     None
+  * @details    Called from the CAN interrupt. RxOK and TxOK count one frame each; frames that complete before the
+  *             interrupt is serviced are counted once. A last error code from 1 to 6 counts one bus error and is then
+  *             overwritten with 7, so that a later status interrupt does not count it again. On entering bus-off the
+  *             recovery is scheduled after CANDIAG_BOFF_MIN_MS, doubled for every bus-off since the last window
+  *             without one, up to CANDIAG_BOFF_MAX_MS.
+  */
+void CANDIAG_StatusHandler(CAN_T *tCAN, uint32_t u32Status, void *pvArg)
+{
+    CANDIAG_T *psDiag = (CANDIAG_T *)pvArg;
+    CANDIAG_STAT_T *psStat = &psDiag->sStat;
+    uint32_t u32PriMask, u32Lec, u32State, u32Ms;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    if(u32Status & CAN_STATUS_TXOK_Msk)
+    {
+        psStat->u32TxFrames++;
+        psDiag->u32WinFrames++;
+    }
+    if(u32Status & CAN_STATUS_RXOK_Msk)
+    {
+        psStat->u32RxFrames++;
+        psDiag->u32WinFrames++;
+    }
+
+    u32Lec = u32Status & CANDIAG_LEC_MSK;
+    if((u32Lec != 0) && (u32Lec != CANDIAG_LEC_UNUSED))
+    {
+        CANDIAG_Inc16(&psStat->au16Lec[u32Lec - 1]);
+        psStat->u8Lec = (uint8_t)u32Lec;
+        tCAN->STATUS = (tCAN->STATUS & (CAN_STATUS_RXOK_Msk | CAN_STATUS_TXOK_Msk)) | CANDIAG_LEC_UNUSED;
+    }
+
+    CANDIAG_SampleErr(psDiag);
+
+    if(u32Status & CAN_STATUS_BOFF_Msk)
+        u32State = CANDIAG_STATE_BUS_OFF;
+    else if(u32Status & CAN_STATUS_EPASS_Msk)
+        u32State = CANDIAG_STATE_PASSIVE;
+    else if(u32Status & CAN_STATUS_EWARN_Msk)
+        u32State = CANDIAG_STATE_WARNING;
+    else
+        u32State = CANDIAG_STATE_ACTIVE;
+
+    if(u32State > psStat->u8State)
+    {
+        if((u32State >= CANDIAG_STATE_WARNING) && (psStat->u8State < CANDIAG_STATE_WARNING))
+            CANDIAG_Inc16(&psStat->u16Warning);
+        if((u32State >= CANDIAG_STATE_PASSIVE) && (psStat->u8State < CANDIAG_STATE_PASSIVE))
+            CANDIAG_Inc16(&psStat->u16Passive);
+
+        if(u32State == CANDIAG_STATE_BUS_OFF)
+        {
+            CANDIAG_Inc16(&psStat->u16BusOff);
+            psDiag->u8BusOffSeen = 1;
+
+            u32Ms = CANDIAG_BOFF_MIN_MS << psStat->u8Backoff;
+            if((u32Ms >= CANDIAG_BOFF_MAX_MS) || (psStat->u8Backoff >= 16))
+                u32Ms = CANDIAG_BOFF_MAX_MS;
+            else
+                psStat->u8Backoff++;
+
+            SWTIMER_Start(&psDiag->sBoffTmr, CANDIAG_MsToTicks(psDiag, u32Ms), 0, CANDIAG_Recover, psDiag);
+        }
+    }
+    psStat->u8State = (uint8_t)u32State;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Count the data bytes of a frame.
+  * @param[in]  psDiag   Diagnostics opened by CANDIAG_Open().
+  * @param[in]  pCanMsg  Frame sent or received.
+  * @param[in]  u32Dir   CANDIAG_DIR_TX or CANDIAG_DIR_RX.
+  * @return     None
+  * @details    Call it for the frames the application transfers, e.g. after CAN_Receive() in a message object
+  *             handler and after CAN_Transmit(). The frames themselves are counted from the status interrupt, which
+  *             also sees frames filtered out by the message objects. The length of these frames also sets the mean
+  *             frame length used for the bus load of the window.
+  */
+void CANDIAG_CountFrame(CANDIAG_T *psDiag, const STR_CANMSG_T *pCanMsg, uint32_t u32Dir)
+{
+    uint32_t u32PriMask, u32Len, u32Bits;
+
+    u32Len = (pCanMsg->FrameType == CAN_REMOTE_FRAME) ? 0 : pCanMsg->DLC;
+    if(u32Len > 8)
+        u32Len = 8;
+    u32Bits = ((pCanMsg->IdType == CAN_EXT_ID) ? CANDIAG_EXT_BITS : CANDIAG_STD_BITS) + u32Len * 8;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    if(u32Dir == CANDIAG_DIR_TX)
+        psDiag->sStat.u32TxBytes += u32Len;
+    else
+        psDiag->sStat.u32RxBytes += u32Len;
+    psDiag->u32SumFrames++;
+    psDiag->u32SumBits += u32Bits;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Copy the statistics.
+  * @param[in]  psDiag  Diagnostics opened by CANDIAG_Open().
+  * @param[out] psStat  Copy of the statistics, ready to be sent.
+  * @return     None
+  * @details    The error counters are sampled again, and the copy is taken with interrupts disabled so that it is
+  *             consistent.
+  */
+void CANDIAG_GetStat(CANDIAG_T *psDiag, CANDIAG_STAT_T *psStat)
+{
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    CANDIAG_SampleErr(psDiag);
+    *psStat = psDiag->sStat;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Clear the statistics.
+  * @param[in]  psDiag  Diagnostics opened by CANDIAG_Open().
+  * @return     None
+  * @details    The counters and the highest values restart from 0. The error state and the bus-off backoff are kept.
+  */
+void CANDIAG_ClearStat(CANDIAG_T *psDiag)
+{
+    uint32_t u32PriMask;
+    uint8_t u8State, u8Backoff;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    u8State = psDiag->sStat.u8State;
+    u8Backoff = psDiag->sStat.u8Backoff;
+    memset(&psDiag->sStat, 0, sizeof(psDiag->sStat));
+    psDiag->sStat.u8State = u8State;
+    psDiag->sStat.u8Backoff = u8Backoff;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/*@}*/ /* end of group CANDIAG_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group CANDIAG_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,448 @@
+/**************************************************************************//**
+ * @file     can_txq.c
+ * @version  V3.00
+ * @brief    NUC1311 series CAN priority transmit queue source file
+ *
+ * @note     Frames wait in a binary heap ordered by their arbitration field, so the frame that would win bus
+ *           arbitration is always at the top, and frames of one identifier keep their order. A pool of message
+ *           objects is kept loaded with the top frames; each object is refilled from its transmit interrupt. The
+ *           controller sends the lowest numbered pending object first, so a frame is only loaded into a free object
+ *           numbered below every loaded frame it must not overtake: frames of its own identifier and frames that win
+ *           arbitration against it. Frames already loaded are not taken back, a new urgent frame waits for at most
+ *           the frames in the pool. Latencies are measured with the timestamp service (tstamp.c) and read 0 if it is
+ *           not open.
+ *
+ *           Message interface IF1 (IF[0]) is written from the interrupt handler. Each transfer is waited for before
+ *           the handler returns, and the CAN driver masks interrupts while it uses an interface, so the two never
+ *           meet. Other code programming the interface registers must do the same.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "can_txq.h"
+#include "tstamp.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup CANTXQ_Driver CAN Transmit Queue
+  @{
+*/
+
+/** @addtogroup CANTXQ_EXPORTED_FUNCTIONS CAN Transmit Queue Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+/* Arbitration field as a number, lower wins: 11-bit base ID, RTR or SRR, IDE, 18-bit ID extension, RTR */
+static uint32_t CANTXQ_Key(STR_CANMSG_T *pCanMsg)
+{
+    uint32_t u32Rtr = (pCanMsg->FrameType == CAN_REMOTE_FRAME) ? 1 : 0;
+
+    if(pCanMsg->IdType == CAN_STD_ID)
+        return ((pCanMsg->Id & 0x7FF) << 21) | (u32Rtr << 20);
+
+    return (((pCanMsg->Id >> 18) & 0x7FF) << 21) | (1ul << 20) | (1ul << 19) | ((pCanMsg->Id & 0x3FFFF) << 1) | u32Rtr;
+}
+
+static int32_t CANTXQ_Before(CANTXQ_ENTRY_T *psA, CANTXQ_ENTRY_T *psB)
+{
+    if(psA->u32Key != psB->u32Key)
+        return (psA->u32Key < psB->u32Key);
+
+    return ((int32_t)(psA->u32Seq - psB->u32Seq) < 0);
+}
+
+static void CANTXQ_Push(CANTXQ_T *psQ, CANTXQ_ENTRY_T *psEntry)
+{
+    CANTXQ_ENTRY_T *psHeap = psQ->psHeap;
+    uint32_t i = psQ->u32Count++, u32Parent;
+
+    while(i > 0)
+    {
+        u32Parent = (i - 1) >> 1;
+        if(!CANTXQ_Before(psEntry, &psHeap[u32Parent]))
+            break;
+        psHeap[i] = psHeap[u32Parent];
+        i = u32Parent;
+    }
+    psHeap[i] = *psEntry;
+}
+
+static void CANTXQ_Pop(CANTXQ_T *psQ, CANTXQ_ENTRY_T *psEntry)
+{
+    CANTXQ_ENTRY_T *psHeap = psQ->psHeap;
+    CANTXQ_ENTRY_T *psLast;
+    uint32_t u32Count = --psQ->u32Count, i = 0, u32Child;
+
+    *psEntry = psHeap[0];
+    psLast = &psHeap[u32Count];
+
+    while((u32Child = 2 * i + 1) < u32Count)
+    {
+        if((u32Child + 1 < u32Count) && CANTXQ_Before(&psHeap[u32Child + 1], &psHeap[u32Child]))
+            u32Child++;
+        if(!CANTXQ_Before(&psHeap[u32Child], psLast))
+            break;
+        psHeap[i] = psHeap[u32Child];
+        i = u32Child;
+    }
+    psHeap[i] = *psLast;
+}
+
+/* Wait for the interface transfer in progress, one is started only on an idle interface and waited for again */
+static void CANTXQ_WaitIF(CAN_T *tCAN)
+{
+    uint32_t u32TimeOutCount = CAN_TIMEOUT;
+
+    while(tCAN->IF[0].CREQ & CAN_IF_CREQ_BUSY_Msk)
+        if(--u32TimeOutCount == 0) break;
+}
+
+/* Write the frame to a message object and request its transmission in one interface transfer */
+static void CANTXQ_Load(CAN_T *tCAN, uint32_t u32MsgNum, STR_CANMSG_T *pCanMsg)
+{
+    CANTXQ_WaitIF(tCAN);
+
+    tCAN->IF[0].CMASK = CAN_IF_CMASK_WRRD_Msk | CAN_IF_CMASK_ARB_Msk | CAN_IF_CMASK_CONTROL_Msk |
+                        CAN_IF_CMASK_DATAA_Msk | CAN_IF_CMASK_DATAB_Msk;
+
+    if(pCanMsg->IdType == CAN_STD_ID)
+    {
+        tCAN->IF[0].ARB1 = 0;
+        tCAN->IF[0].ARB2 = ((pCanMsg->Id & 0x7FF) << 2) | CAN_IF_ARB2_MSGVAL_Msk;
+    }
+    else
+    {
+        tCAN->IF[0].ARB1 = pCanMsg->Id & 0xFFFF;
+        tCAN->IF[0].ARB2 = ((pCanMsg->Id & 0x1FFF0000) >> 16) | CAN_IF_ARB2_XTD_Msk | CAN_IF_ARB2_MSGVAL_Msk;
+    }
+
+    /* A transmit object with DIR cleared sends a remote frame */
+    if(pCanMsg->FrameType)
+        tCAN->IF[0].ARB2 |= CAN_IF_ARB2_DIR_Msk;
+
+    tCAN->IF[0].DAT_A1 = ((uint16_t)pCanMsg->Data[1] << 8) | pCanMsg->Data[0];
+    tCAN->IF[0].DAT_A2 = ((uint16_t)pCanMsg->Data[3] << 8) | pCanMsg->Data[2];
+    tCAN->IF[0].DAT_B1 = ((uint16_t)pCanMsg->Data[5] << 8) | pCanMsg->Data[4];
+    tCAN->IF[0].DAT_B2 = ((uint16_t)pCanMsg->Data[7] << 8) | pCanMsg->Data[6];
+
+    tCAN->IF[0].MCON = CAN_IF_MCON_NEWDAT_Msk | CAN_IF_MCON_TXRQST_Msk | CAN_IF_MCON_TXIE_Msk | CAN_IF_MCON_EOB_Msk |
+                       (pCanMsg->DLC & CAN_IF_MCON_DLC_Msk);
+    tCAN->IF[0].CREQ = 1 + u32MsgNum;
+
+    CANTXQ_WaitIF(tCAN);
+}
+
+static void CANTXQ_Invalidate(CAN_T *tCAN, uint32_t u32MsgNum)
+{
+    CANTXQ_WaitIF(tCAN);
+
+    tCAN->IF[0].CMASK = CAN_IF_CMASK_WRRD_Msk | CAN_IF_CMASK_ARB_Msk | CAN_IF_CMASK_CONTROL_Msk;
+    tCAN->IF[0].ARB1 = 0;
+    tCAN->IF[0].ARB2 = 0;
+    tCAN->IF[0].MCON = 0;
+    tCAN->IF[0].CREQ = 1 + u32MsgNum;
+
+    CANTXQ_WaitIF(tCAN);
+}
+
+/* 1 if a frame with key u32Key loaded into object u32Slot would go out before a loaded frame it must follow */
+static int32_t CANTXQ_Overtakes(CANTXQ_T *psQ, uint32_t u32Slot, uint32_t u32Key)
+{
+    uint32_t i;
+
+    for(i = u32Slot + 1; i < psQ->u32ObjCount; i++)
+    {
+        if(psQ->asSlot[i].u8Busy && (psQ->asSlot[i].u32Key <= u32Key))
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Load the top frames into the free objects of the pool in ascending object order. Frames leave the heap in
+ * transmission order, so a free object that the top frame cannot take is skipped, not filled by a later frame.
+ */
+static void CANTXQ_Refill(CANTXQ_T *psQ)
+{
+    CANTXQ_ENTRY_T sEntry;
+    CANTXQ_SLOT_T *psSlot;
+    uint32_t i;
+
+    for(i = 0; (i < psQ->u32ObjCount) && (psQ->u32Count > 0); i++)
+    {
+        psSlot = &psQ->asSlot[i];
+        if(psSlot->u8Busy || CANTXQ_Overtakes(psQ, i, psQ->psHeap[0].u32Key))
+            continue;
+
+        CANTXQ_Pop(psQ, &sEntry);
+        psSlot->u32Key = sEntry.u32Key;
+        psSlot->u32Id = sEntry.sMsg.Id;
+        psSlot->u8IdType = (uint8_t)sEntry.sMsg.IdType;
+        psSlot->u32Stamp = sEntry.u32Stamp;
+        psSlot->u8Busy = 1;
+        psQ->u32Loaded++;
+
+        CANTXQ_Load(psQ->tCAN, psQ->u32FirstObj + i, &sEntry.sMsg);
+    }
+}
+
+static void CANTXQ_Record(CANTXQ_T *psQ, CANTXQ_SLOT_T *psSlot)
+{
+    CANTXQ_LAT_T *psLat = NULL, *psFree = NULL;
+    uint32_t u32Elapsed = TSTAMP_Get32() - psSlot->u32Stamp;
+    uint32_t i;
+
+    for(i = 0; i < psQ->u32LatCount; i++)
+    {
+        if(psQ->psLat[i].u32Frames == 0)
+        {
+            if(psFree == NULL)
+                psFree = &psQ->psLat[i];
+        }
+        else if((psQ->psLat[i].u32Id == psSlot->u32Id) && (psQ->psLat[i].u32IdType == psSlot->u8IdType))
+        {
+            psLat = &psQ->psLat[i];
+            break;
+        }
+    }
+
+    if(psLat == NULL)
+    {
+        if(psFree == NULL)
+        {
+            psQ->sStat.u32Untracked++;
+            return;
+        }
+
+        psLat = psFree;
+        psLat->u32Id = psSlot->u32Id;
+        psLat->u32IdType = psSlot->u8IdType;
+        psLat->u32TotalUs = 0;
+        psLat->u32MaxUs = 0;
+    }
+
+    psLat->u32Frames++;
+    psLat->u32TotalUs += u32Elapsed;
+    if(u32Elapsed > psLat->u32MaxUs)
+        psLat->u32MaxUs = u32Elapsed;
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Open a CAN transmit queue.
+  * @param[in]  psQ          Queue control block. It must stay valid while the queue is open.
+  * @param[in]  tCAN         The pointer to CAN module base address. It must be opened with CAN_Open() in normal mode.
+  * @param[in]  u32FirstObj  First message object of the pool, from 0 to 31.
+  * @param[in]  u32ObjCount  Message objects in the pool, 1 ~ \ref CANTXQ_MAX_OBJ. More objects keep the bus busier,
+  *                          fewer bound the wait of an urgent frame behind frames already loaded.
+  * @param[in]  psBuf        Storage of the waiting frames.
+  * @param[in]  u32Size      Number of entries in psBuf.
+  * @retval     0                   Success
+  * @retval     CANTXQ_ERR_PARAM    Invalid parameter
+  * @details    The pool objects are invalidated. The application must not use them for anything else, and should put
+  *             its receive objects after the pool, as lower numbered objects are served first. CANTXQ_IRQHandler()
+  *             must be called from the CAN interrupt handler with the module interrupt (CAN_CON_IE_Msk) enabled.
+  */
+int32_t CANTXQ_Open(CANTXQ_T *psQ, CAN_T *tCAN, uint32_t u32FirstObj, uint32_t u32ObjCount, CANTXQ_ENTRY_T *psBuf, uint32_t u32Size)
+{
+    uint32_t u32PriMask, i;
+
+    if((u32ObjCount == 0) || (u32ObjCount > CANTXQ_MAX_OBJ) || (u32FirstObj + u32ObjCount > 32) ||
+            (psBuf == NULL) || (u32Size == 0))
+        return CANTXQ_ERR_PARAM;
+
+    psQ->tCAN = tCAN;
+    psQ->u32FirstObj = u32FirstObj;
+    psQ->u32ObjCount = u32ObjCount;
+    psQ->psHeap = psBuf;
+    psQ->u32Size = u32Size;
+    psQ->u32Count = 0;
+    psQ->u32Loaded = 0;
+    psQ->u32Seq = 0;
+    psQ->psLat = NULL;
+    psQ->u32LatCount = 0;
+    CANTXQ_ClearStat(psQ);
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    for(i = 0; i < u32ObjCount; i++)
+    {
+        psQ->asSlot[i].u8Busy = 0;
+        CANTXQ_Invalidate(tCAN, u32FirstObj + i);
+    }
+    __set_PRIMASK(u32PriMask);
+
+    return 0;
+}
+
+/**
+  * @brief      Close a CAN transmit queue.
+  * @param[in]  psQ  Queue opened by CANTXQ_Open().
+  * @return     None
+  * @details    Waiting frames are dropped and the pool objects are invalidated, a frame already on the bus is
+  *             finished by the controller.
+  */
+void CANTXQ_Close(CANTXQ_T *psQ)
+{
+    uint32_t u32PriMask, i;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    for(i = 0; i < psQ->u32ObjCount; i++)
+    {
+        psQ->asSlot[i].u8Busy = 0;
+        CANTXQ_Invalidate(psQ->tCAN, psQ->u32FirstObj + i);
+    }
+    psQ->u32Count = 0;
+    psQ->u32Loaded = 0;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Set the table of the per identifier latency statistics.
+  * @param[in]  psQ       Queue opened by CANTXQ_Open().
+  * @param[in]  psLat     Latency table, NULL to stop the latency statistics.
+  * @param[in]  u32Count  Number of entries in psLat.
+  * @return     None
+  * @details    The table is cleared. Each identifier takes the first free entry when its first frame is sent;
+  *             frames of identifiers that find no free entry are counted in u32Untracked. The table is searched
+  *             in the interrupt handler, keep it short.
+  */
+void CANTXQ_SetLatencyTable(CANTXQ_T *psQ, CANTXQ_LAT_T *psLat, uint32_t u32Count)
+{
+    uint32_t u32PriMask, i;
+
+    for(i = 0; i < u32Count; i++)
+        psLat[i].u32Frames = 0;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    psQ->psLat = psLat;
+    psQ->u32LatCount = (psLat == NULL) ? 0 : u32Count;
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Queue a frame for transmission.
+  * @param[in]  psQ      Queue opened by CANTXQ_Open().
+  * @param[in]  pCanMsg  Frame to send, copied into the queue.
+  * @retval     0                   The frame is queued
+  * @retval     CANTXQ_ERR_FULL     The queue is full
+  * @details    The frame goes out after every queued frame that would win arbitration against it, and after the
+  *             frames of the same identifier queued before it. The function does not block and could be called
+  *             from an interrupt handler.
+  */
+int32_t CANTXQ_Send(CANTXQ_T *psQ, STR_CANMSG_T *pCanMsg)
+{
+    CANTXQ_ENTRY_T sEntry;
+    uint32_t u32PriMask;
+
+    sEntry.sMsg = *pCanMsg;
+    sEntry.u32Key = CANTXQ_Key(pCanMsg);
+    sEntry.u32Stamp = TSTAMP_Get32();
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    if(psQ->u32Count >= psQ->u32Size)
+    {
+        psQ->sStat.u32Full++;
+        __set_PRIMASK(u32PriMask);
+        return CANTXQ_ERR_FULL;
+    }
+
+    sEntry.u32Seq = psQ->u32Seq++;
+    CANTXQ_Push(psQ, &sEntry);
+    psQ->sStat.u32Queued++;
+    if(psQ->u32Count > psQ->sStat.u32QueueHigh)
+        psQ->sStat.u32QueueHigh = psQ->u32Count;
+
+    CANTXQ_Refill(psQ);
+
+    __set_PRIMASK(u32PriMask);
+
+    return 0;
+}
+
+/**
+  * @brief      Clear the queue statistics and the latency table.
+  * @param[in]  psQ  Queue opened by CANTXQ_Open().
+  * @return     None
+  */
+void CANTXQ_ClearStat(CANTXQ_T *psQ)
+{
+    uint32_t u32PriMask, i;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    psQ->sStat.u32Queued = 0;
+    psQ->sStat.u32Sent = 0;
+    psQ->sStat.u32Full = 0;
+    psQ->sStat.u32QueueHigh = psQ->u32Count;
+    psQ->sStat.u32Untracked = 0;
+
+    for(i = 0; i < psQ->u32LatCount; i++)
+        psQ->psLat[i].u32Frames = 0;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      CAN transmit queue interrupt handler.
+  * @param[in]  psQ        Queue opened by CANTXQ_Open().
+  * @param[in]  u32MsgNum  Message object of the interrupt, from 0 to 31, that is CAN_IIDR - 1.
+  * @retval     1   The object belongs to the pool, its interrupt is cleared and it is refilled
+  * @retval     0   The object is not in the pool, the caller handles it
+  * @details    Must be called from the CAN interrupt handler for each message object interrupt.
+  */
+int32_t CANTXQ_IRQHandler(CANTXQ_T *psQ, uint32_t u32MsgNum)
+{
+    CANTXQ_SLOT_T *psSlot;
+    uint32_t u32Slot = u32MsgNum - psQ->u32FirstObj;
+    uint32_t u32PriMask;
+
+    if(u32Slot >= psQ->u32ObjCount)
+        return 0;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    CANTXQ_WaitIF(psQ->tCAN);
+    psQ->tCAN->IF[0].CMASK = CAN_IF_CMASK_CLRINTPND_Msk;
+    psQ->tCAN->IF[0].CREQ = 1 + u32MsgNum;
+    CANTXQ_WaitIF(psQ->tCAN);
+
+    psSlot = &psQ->asSlot[u32Slot];
+    if(psSlot->u8Busy)
+    {
+        psSlot->u8Busy = 0;
+        psQ->u32Loaded--;
+        psQ->sStat.u32Sent++;
+        CANTXQ_Record(psQ, psSlot);
+    }
+
+    CANTXQ_Refill(psQ);
+
+    __set_PRIMASK(u32PriMask);
+
+    return 1;
+}
+
+/*@}*/ /* end of group CANTXQ_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group CANTXQ_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
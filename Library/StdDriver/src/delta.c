@@ -0,0 +1,422 @@
+/**************************************************************************//**
+ * @file     delta.c
+ * @version  V3.00
+ * @brief    NUC1311 series in-place delta firmware update source file
+ *
+ * @note     A patch is a list of COPY ops taking bytes from the image already in flash and ADD ops carrying
+ *           new bytes. DELTA_Feed() assembles each new page in a 512-byte buffer and replaces the flash page
+ *           only if it changed. The page is first staged in a data flash page and a progress marker is kept
+ *           in a key/value store, so an update interrupted by a power failure resumes at the page it was
+ *           writing: DELTA_Open() returns the patch offset to send next.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include <string.h>
+#include "NUC1311.h"
+#include "delta.h"
+#include "fwslot.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup DELTA_Driver Delta Firmware Update
+  @{
+*/
+
+/** @addtogroup DELTA_EXPORTED_FUNCTIONS Delta Firmware Update Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define DELTA_PAGE_MSK          (FMC_FLASH_PAGE_SIZE - 1UL)
+
+#define DELTA_ST_HEADER         0       /* Collecting the patch header */
+#define DELTA_ST_OP             1       /* Waiting for an op byte */
+#define DELTA_ST_OP_ARG         2       /* Collecting the length and source of an op */
+#define DELTA_ST_DATA           3       /* Producing the bytes of an op */
+#define DELTA_ST_DONE           4       /* New image complete */
+
+/* All bytes of the new image produced. The sizes are only known once the header is in. */
+#define DELTA_COMPLETE(psDelta) (((psDelta)->u8State != DELTA_ST_HEADER) && ((psDelta)->u32Out == (psDelta)->u32NewSize))
+
+#define DELTA_MARK_STAGED       1       /* Page in the stage page, flash page may be partly written */
+#define DELTA_MARK_WRITTEN      2       /* Page written */
+
+/* Progress marker, the parser state after the last byte of the page */
+typedef struct
+{
+    uint32_t u32Mark;
+    uint32_t u32OldSize;
+    uint32_t u32OldCrc;
+    uint32_t u32NewSize;
+    uint32_t u32NewCrc;
+    uint32_t u32PatchOff;
+    uint32_t u32Out;
+    uint32_t u32Left;
+    uint32_t u32Src;
+    uint32_t u32Op;
+} DELTA_MARK_T;
+
+static uint32_t DELTA_Get32(const uint8_t *pu8Buf)
+{
+    return pu8Buf[0] | ((uint32_t)pu8Buf[1] << 8) | ((uint32_t)pu8Buf[2] << 16) | ((uint32_t)pu8Buf[3] << 24);
+}
+
+/* CRC32 of flash read by ISP, page 0 may be remapped by VECMAP */
+static uint32_t DELTA_FlashCrc(uint32_t u32Addr, uint32_t u32Size)
+{
+    uint32_t u32Crc = 0, u32Word, i;
+
+    for(i = 0; i < u32Size; i += 4)
+    {
+        u32Word = FMC_Read(u32Addr + i);
+        u32Crc = FWSLOT_CRC32(&u32Word, ((u32Size - i) < 4) ? (u32Size - i) : 4, u32Crc);
+    }
+
+    return u32Crc;
+}
+
+static int32_t DELTA_SaveMark(DELTA_T *psDelta, uint32_t u32Mark)
+{
+    DELTA_MARK_T sMark;
+
+    sMark.u32Mark = u32Mark;
+    sMark.u32OldSize = psDelta->u32OldSize;
+    sMark.u32OldCrc = psDelta->u32OldCrc;
+    sMark.u32NewSize = psDelta->u32NewSize;
+    sMark.u32NewCrc = psDelta->u32NewCrc;
+    sMark.u32PatchOff = psDelta->u32PatchOff;
+    sMark.u32Out = psDelta->u32Out;
+    sMark.u32Left = psDelta->u32Left;
+    sMark.u32Src = psDelta->u32Src;
+    sMark.u32Op = psDelta->u8Op;
+
+    return (KVS_Set(psDelta->psKvs, DELTA_KVS_KEY, &sMark, sizeof(sMark)) == 0) ? 0 : DELTA_ERR_MARKER;
+}
+
+static int32_t DELTA_ProgramPage(uint32_t u32Addr, const uint32_t *pu32Page)
+{
+    if(FMC_Erase(u32Addr) != 0)
+        return DELTA_ERR_FLASH;
+
+    return (FMC_WriteMultiple(u32Addr, pu32Page, FMC_FLASH_PAGE_SIZE / 4) == 0) ? 0 : DELTA_ERR_FLASH;
+}
+
+/* Replace the flash page holding the last byte produced */
+static int32_t DELTA_CommitPage(DELTA_T *psDelta)
+{
+    uint32_t u32Addr = psDelta->u32Base + ((psDelta->u32Out - 1) & ~DELTA_PAGE_MSK);
+    uint32_t u32Fill = psDelta->u32Out & DELTA_PAGE_MSK;
+    uint32_t i;
+    int32_t i32Ret;
+
+    /* Tail of the last page stays erased */
+    if(u32Fill)
+        memset((uint8_t *)psDelta->au32Page + u32Fill, 0xFF, FMC_FLASH_PAGE_SIZE - u32Fill);
+
+    psDelta->u32CacheAddr = 0xFFFFFFFF;
+
+    for(i = 0; i < FMC_FLASH_PAGE_SIZE / 4; i++)
+    {
+        if(FMC_Read(u32Addr + i * 4) != psDelta->au32Page[i])
+            break;
+    }
+
+    /* Unchanged page: nothing to write and no marker, replaying it after a reset finds it unchanged again */
+    if(i == FMC_FLASH_PAGE_SIZE / 4)
+    {
+        psDelta->u32Skipped++;
+        return 0;
+    }
+
+    i32Ret = DELTA_ProgramPage(psDelta->u32Stage, psDelta->au32Page);
+    if(i32Ret != 0)
+        return i32Ret;
+
+    i32Ret = DELTA_SaveMark(psDelta, DELTA_MARK_STAGED);
+    if(i32Ret != 0)
+        return i32Ret;
+
+    i32Ret = DELTA_ProgramPage(u32Addr, psDelta->au32Page);
+    if(i32Ret != 0)
+        return i32Ret;
+
+    psDelta->u32Pages++;
+
+    return DELTA_SaveMark(psDelta, DELTA_MARK_WRITTEN);
+}
+
+/* Store one new byte, committing the page when it is full or the image is complete */
+static int32_t DELTA_Put(DELTA_T *psDelta, uint32_t u32Byte)
+{
+    ((uint8_t *)psDelta->au32Page)[psDelta->u32Out & DELTA_PAGE_MSK] = (uint8_t)u32Byte;
+    psDelta->u32Out++;
+
+    if(psDelta->u32Left == 0)
+        psDelta->u8State = DELTA_ST_OP;
+
+    if(((psDelta->u32Out & DELTA_PAGE_MSK) == 0) || (psDelta->u32Out == psDelta->u32NewSize))
+        return DELTA_CommitPage(psDelta);
+
+    return 0;
+}
+
+/* Check the new image and drop the progress marker */
+static int32_t DELTA_Finish(DELTA_T *psDelta)
+{
+    psDelta->u8State = DELTA_ST_DONE;
+
+    if(DELTA_FlashCrc(psDelta->u32Base, psDelta->u32NewSize) != psDelta->u32NewCrc)
+        return DELTA_ERR_NEW_IMAGE;
+
+    KVS_Delete(psDelta->psKvs, DELTA_KVS_KEY);
+
+    return DELTA_DONE;
+}
+
+static int32_t DELTA_StartOp(DELTA_T *psDelta)
+{
+    const uint8_t *pu8Arg = psDelta->au8Hdr;
+    uint32_t u32Len = psDelta->u8Op & DELTA_OP_LEN_EXT;
+
+    if(u32Len == DELTA_OP_LEN_EXT)
+    {
+        u32Len = pu8Arg[0] | ((uint32_t)pu8Arg[1] << 8);
+        pu8Arg += 2;
+    }
+    else
+    {
+        u32Len++;
+    }
+
+    if((u32Len == 0) || (psDelta->u32Out + u32Len > psDelta->u32NewSize))
+        return DELTA_ERR_FORMAT;
+
+    if(psDelta->u8Op & DELTA_OP_COPY)
+    {
+        psDelta->u32Src = pu8Arg[0] | ((uint32_t)pu8Arg[1] << 8) | ((uint32_t)pu8Arg[2] << 16);
+        if(psDelta->u32Src + u32Len > psDelta->u32OldSize)
+            return DELTA_ERR_FORMAT;
+    }
+
+    psDelta->u32Left = u32Len;
+    psDelta->u8State = DELTA_ST_DATA;
+
+    return 0;
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Open the delta applier and resume an interrupted update.
+  * @param[out] psDelta The pointer of the applier control block.
+  * @param[in]  psKvs Opened key/value store keeping the progress marker under \ref DELTA_KVS_KEY.
+  * @param[in]  u32Base Flash address of the image, e.g. FMC_APROM_BASE.
+  * @param[in]  u32Stage Page aligned data flash address of a page not used by psKvs.
+  * @return     Patch offset to continue from, 0 for a new update, or a negative DELTA_ERR_ code.
+  * @details    If a page was being replaced at the power failure, it is written again from the stage page.
+  *             The patch header is not sent again when the returned offset is not 0.
+  * @note       ISP and APROM update must be enabled by FMC_Open() and FMC_EnableAPUpdate(). Run this code from
+  *             LDROM or SRAM, not from the image being patched.
+  */
+int32_t DELTA_Open(DELTA_T *psDelta, KVS_T *psKvs, uint32_t u32Base, uint32_t u32Stage)
+{
+    DELTA_MARK_T sMark;
+    uint32_t i;
+    int32_t i32Ret;
+
+    if((psDelta == NULL) || (psKvs == NULL) || (u32Base & DELTA_PAGE_MSK) || (u32Stage & DELTA_PAGE_MSK))
+        return DELTA_ERR_PARAM;
+
+    memset(psDelta, 0, sizeof(DELTA_T));
+    psDelta->psKvs = psKvs;
+    psDelta->u32Base = u32Base;
+    psDelta->u32Stage = u32Stage;
+    psDelta->u32CacheAddr = 0xFFFFFFFF;
+    psDelta->u8HdrNeed = DELTA_HDR_SIZE;
+
+    if(KVS_Get(psKvs, DELTA_KVS_KEY, &sMark, sizeof(sMark)) != sizeof(sMark))
+        return 0;
+
+    psDelta->u32OldSize = sMark.u32OldSize;
+    psDelta->u32OldCrc = sMark.u32OldCrc;
+    psDelta->u32NewSize = sMark.u32NewSize;
+    psDelta->u32NewCrc = sMark.u32NewCrc;
+    psDelta->u32PatchOff = sMark.u32PatchOff;
+    psDelta->u32Out = sMark.u32Out;
+    psDelta->u32Left = sMark.u32Left;
+    psDelta->u32Src = sMark.u32Src;
+    psDelta->u8Op = (uint8_t)sMark.u32Op;
+    psDelta->u8State = (sMark.u32Left != 0) ? DELTA_ST_DATA : DELTA_ST_OP;
+
+    if(sMark.u32Mark == DELTA_MARK_STAGED)
+    {
+        for(i = 0; i < FMC_FLASH_PAGE_SIZE / 4; i++)
+            psDelta->au32Page[i] = FMC_Read(u32Stage + i * 4);
+
+        i32Ret = DELTA_ProgramPage(u32Base + ((sMark.u32Out - 1) & ~DELTA_PAGE_MSK), psDelta->au32Page);
+        if(i32Ret == 0)
+            i32Ret = DELTA_SaveMark(psDelta, DELTA_MARK_WRITTEN);
+        if(i32Ret != 0)
+            return i32Ret;
+    }
+
+    if(psDelta->u32Out == psDelta->u32NewSize)
+    {
+        i32Ret = DELTA_Finish(psDelta);
+        if(i32Ret < 0)
+            return i32Ret;
+    }
+
+    return (int32_t)psDelta->u32PatchOff;
+}
+
+/**
+  * @brief      Apply the next part of a patch.
+  * @param[in]  psDelta The pointer of the applier control block.
+  * @param[in]  pu8Data Patch bytes following the ones consumed so far.
+  * @param[in]  u32Len Number of bytes, any split of the patch is accepted.
+  * @retval     0 More patch bytes are needed
+  * @retval     DELTA_DONE The new image is written and its CRC32 matches
+  * @retval     <0 A DELTA_ERR_ code. The update can only be resumed from the offset DELTA_Open() returns.
+  * @details    The old image CRC32 is checked once the header arrives, before any page is touched. Each
+  *             changed page costs one erase of the stage page and one of the image page.
+  */
+int32_t DELTA_Feed(DELTA_T *psDelta, const uint8_t *pu8Data, uint32_t u32Len)
+{
+    uint32_t u32Word, u32Byte, u32Need;
+    int32_t i32Ret;
+
+    while(psDelta->u8State != DELTA_ST_DONE)
+    {
+        if((psDelta->u8State == DELTA_ST_DATA) && (psDelta->u8Op & DELTA_OP_COPY))
+        {
+            /* Source bytes below the page being assembled are overwritten already */
+            if(psDelta->u32Src < (psDelta->u32Out & ~DELTA_PAGE_MSK))
+                return DELTA_ERR_FORMAT;
+
+            u32Word = psDelta->u32Base + (psDelta->u32Src & ~3UL);
+            if(psDelta->u32CacheAddr != u32Word)
+            {
+                psDelta->u32CacheWord = FMC_Read(u32Word);
+                psDelta->u32CacheAddr = u32Word;
+            }
+            u32Byte = psDelta->u32CacheWord >> ((psDelta->u32Src & 3) * 8);
+
+            psDelta->u32Src++;
+            psDelta->u32Left--;
+            i32Ret = DELTA_Put(psDelta, u32Byte);
+            if(i32Ret != 0)
+                return i32Ret;
+            if(DELTA_COMPLETE(psDelta))
+                break;
+            continue;
+        }
+
+        if(u32Len == 0)
+            break;
+
+        u32Byte = *pu8Data++;
+        u32Len--;
+        psDelta->u32PatchOff++;
+
+        switch(psDelta->u8State)
+        {
+            case DELTA_ST_HEADER:
+                psDelta->au8Hdr[psDelta->u8HdrLen++] = (uint8_t)u32Byte;
+                if(psDelta->u8HdrLen < DELTA_HDR_SIZE)
+                    break;
+
+                if(DELTA_Get32(&psDelta->au8Hdr[0]) != DELTA_MAGIC)
+                    return DELTA_ERR_FORMAT;
+                psDelta->u32OldSize = DELTA_Get32(&psDelta->au8Hdr[4]);
+                psDelta->u32OldCrc = DELTA_Get32(&psDelta->au8Hdr[8]);
+                psDelta->u32NewSize = DELTA_Get32(&psDelta->au8Hdr[12]);
+                psDelta->u32NewCrc = DELTA_Get32(&psDelta->au8Hdr[16]);
+                if(psDelta->u32NewSize == 0)
+                    return DELTA_ERR_FORMAT;
+
+                if(DELTA_FlashCrc(psDelta->u32Base, psDelta->u32OldSize) != psDelta->u32OldCrc)
+                    return DELTA_ERR_OLD_IMAGE;
+
+                psDelta->u8State = DELTA_ST_OP;
+                break;
+
+            case DELTA_ST_OP:
+                psDelta->u8Op = (uint8_t)u32Byte;
+                u32Need = (psDelta->u8Op & DELTA_OP_COPY) ? 3 : 0;
+                if((psDelta->u8Op & DELTA_OP_LEN_EXT) == DELTA_OP_LEN_EXT)
+                    u32Need += 2;
+
+                psDelta->u8HdrLen = 0;
+                psDelta->u8HdrNeed = (uint8_t)u32Need;
+                psDelta->u8State = DELTA_ST_OP_ARG;
+                if(u32Need == 0)
+                {
+                    i32Ret = DELTA_StartOp(psDelta);
+                    if(i32Ret != 0)
+                        return i32Ret;
+                }
+                break;
+
+            case DELTA_ST_OP_ARG:
+                psDelta->au8Hdr[psDelta->u8HdrLen++] = (uint8_t)u32Byte;
+                if(psDelta->u8HdrLen == psDelta->u8HdrNeed)
+                {
+                    i32Ret = DELTA_StartOp(psDelta);
+                    if(i32Ret != 0)
+                        return i32Ret;
+                }
+                break;
+
+            default:    /* ADD data */
+                psDelta->u32Left--;
+                i32Ret = DELTA_Put(psDelta, u32Byte);
+                if(i32Ret != 0)
+                    return i32Ret;
+                break;
+        }
+
+        if(DELTA_COMPLETE(psDelta))
+            break;
+    }
+
+    if(DELTA_COMPLETE(psDelta))
+        return (psDelta->u8State == DELTA_ST_DONE) ? DELTA_DONE : DELTA_Finish(psDelta);
+
+    return 0;
+}
+
+/**
+  * @brief      Abandon an update.
+  * @param[in]  psDelta The pointer of the applier control block.
+  * @retval     0 Success
+  * @retval     DELTA_ERR_MARKER The progress marker could not be removed
+  * @details    The progress marker is removed. If pages were replaced already, the image in flash is neither
+  *             the old nor the new one and has to be restored with a full image.
+  */
+int32_t DELTA_Abort(DELTA_T *psDelta)
+{
+    int32_t i32Ret = KVS_Delete(psDelta->psKvs, DELTA_KVS_KEY);
+
+    psDelta->u8State = DELTA_ST_HEADER;
+    psDelta->u8HdrLen = 0;
+    psDelta->u8HdrNeed = DELTA_HDR_SIZE;
+    psDelta->u32PatchOff = 0;
+    psDelta->u32Out = 0;
+
+    return ((i32Ret == 0) || (i32Ret == KVS_ERR_NOT_FOUND)) ? 0 : DELTA_ERR_MARKER;
+}
+
+
+/*@}*/ /* end of group DELTA_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group DELTA_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
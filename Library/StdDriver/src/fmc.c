@@ -285,6 +285,53 @@ int32_t FMC_WriteConfig(uint32_t *u32Config, uint32_t u32Count)
     return 0;
 }
 
+/**
+  * @brief      Program a block of words from SRAM
+  *
+  * @param[in]  u32Addr   Start address to program. It must be word aligned.
+  * @param[in]  pu32Buf   The word buffer to program.
+  * @param[in]  u32Count  The word count to program.
+  *
+  * @retval     0 Success
+  * @retval    -1 Program failed or time-out
+  *
+  * @details    The programming loop is placed in SRAM by __RAMFUNC and calls nothing in flash, so it does not
+  *             fetch instructions from flash while ISP operations are in progress. The prototype carries
+  *             __RAMFUNC too, so callers in flash reach it with a long call. The target area must be erased and
+  *             its update enabled.
+  *
+  * @note     Global error code g_FMC_i32ErrCode
+  *           -1  Program failed or time-out
+  */
+__RAMFUNC int32_t FMC_WriteMultiple(uint32_t u32Addr, const uint32_t *pu32Buf, uint32_t u32Count)
+{
+    uint32_t i, u32TimeOutCnt;
+
+    g_FMC_i32ErrCode = 0;
+
+    /* FMC_Write() is open-coded, an inline function is not guaranteed to be inlined into this SRAM loop */
+    FMC->ISPCMD = FMC_ISPCMD_PROGRAM;
+    for(i = 0; i < u32Count; i++)
+    {
+        FMC->ISPADR = u32Addr + i * 4;
+        FMC->ISPDAT = pu32Buf[i];
+        FMC->ISPTRG = 0x1;
+        __ISB();
+
+        u32TimeOutCnt = FMC_TIMEOUT_WRITE;
+        while(FMC->ISPTRG)
+        {
+            if(--u32TimeOutCnt == 0)
+            {
+                g_FMC_i32ErrCode = -1;
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
 
 /*@}*/ /* end of group FMC_EXPORTED_FUNCTIONS */
 
@@ -0,0 +1,406 @@
+/**************************************************************************//**
+ * @file     fwslot.c
+ * @version  V3.00
+ * @brief    NUC1311 series A/B firmware slot manager source file
+ *
+ * @note     The running image writes the other slot with FWSLOT_Write(), then FWSLOT_Commit() checks its CRC32
+ *           and appends a trial boot record to data flash. At reset, FWSLOT_Boot() in LDROM reads the newest
+ *           record, remaps VECMAP to the selected slot and resets into it. A trial image that does not call
+ *           FWSLOT_Confirm() within FWSLOT_TRIAL_BOOTS boots is dropped for the previous slot.
+ *
+ *           Boot records are 8 words appended to one of two data flash pages. The last word is a CRC32 of the
+ *           record and is programmed last. The other page is erased only when the current page is full, so
+ *           the newest record always survives a power failure.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "fwslot.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup FWSLOT_Driver A/B Firmware Slot Manager
+  @{
+*/
+
+/** @addtogroup FWSLOT_EXPORTED_FUNCTIONS A/B Firmware Slot Manager Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define FWSLOT_REC_SIZE         32UL
+#define FWSLOT_REC_TAG          0xB5UL
+
+/* First page of the boot record pair */
+#define FWSLOT_REC_BASE()       (FMC_ReadDataFlashBaseAddr() + FWSLOT_REC_OFFSET)
+
+static uint32_t FWSLOT_CRC32Byte(uint32_t u32Crc, uint32_t u32Data)
+{
+    static const uint32_t au32Crc[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    u32Crc ^= u32Data & 0xFF;
+    u32Crc = (u32Crc >> 4) ^ au32Crc[u32Crc & 0xF];
+    u32Crc = (u32Crc >> 4) ^ au32Crc[u32Crc & 0xF];
+
+    return u32Crc;
+}
+
+/* Commit word of a record. Never 0xFFFFFFFF, so an unprogrammed word is never taken as committed. */
+static uint32_t FWSLOT_RecCommit(const uint32_t *pu32Rec)
+{
+    uint32_t u32Crc = FWSLOT_CRC32(pu32Rec, 16, 0);
+
+    return (u32Crc == 0xFFFFFFFF) ? 0 : u32Crc;
+}
+
+/* Find the newest committed record. Returns its address, or 0 if there is none. */
+static uint32_t FWSLOT_FindRecord(uint32_t *pu32Seq)
+{
+    uint32_t u32Base = FWSLOT_REC_BASE();
+    uint32_t u32Addr, u32Found = 0;
+    uint32_t au32Rec[4];
+
+    for(u32Addr = u32Base; u32Addr < u32Base + 2 * FMC_FLASH_PAGE_SIZE; u32Addr += FWSLOT_REC_SIZE)
+    {
+        au32Rec[0] = M32(u32Addr);
+        au32Rec[1] = M32(u32Addr + 4);
+        au32Rec[2] = M32(u32Addr + 8);
+        au32Rec[3] = M32(u32Addr + 12);
+
+        if(((au32Rec[1] >> 24) != FWSLOT_REC_TAG) || (M32(u32Addr + FWSLOT_REC_SIZE - 4) != FWSLOT_RecCommit(au32Rec)))
+            continue;
+
+        if(!u32Found || (au32Rec[0] > *pu32Seq))
+        {
+            *pu32Seq = au32Rec[0];
+            u32Found = u32Addr;
+        }
+    }
+
+    return u32Found;
+}
+
+/* Append a record after the newest one, switching to the other page when the current one is full */
+static int32_t FWSLOT_AppendRecord(FWSLOT_REC_T *psRec)
+{
+    uint32_t u32Base = FWSLOT_REC_BASE();
+    uint32_t u32Seq = 0, u32Addr, u32Page, i;
+    uint32_t au32Rec[FWSLOT_REC_SIZE / 4];
+
+    u32Addr = FWSLOT_FindRecord(&u32Seq);
+    u32Page = (u32Addr == 0) ? u32Base : (u32Addr & ~(FMC_FLASH_PAGE_SIZE - 1));
+
+    /* First blank slot after the newest record. Slots of interrupted appends are skipped. */
+    for(u32Addr = (u32Addr == 0) ? u32Page : u32Addr + FWSLOT_REC_SIZE; u32Addr < u32Page + FMC_FLASH_PAGE_SIZE; u32Addr += FWSLOT_REC_SIZE)
+    {
+        for(i = 0; i < FWSLOT_REC_SIZE; i += 4)
+        {
+            if(M32(u32Addr + i) != 0xFFFFFFFF)
+                break;
+        }
+        if(i == FWSLOT_REC_SIZE)
+            break;
+    }
+
+    if(u32Addr >= u32Page + FMC_FLASH_PAGE_SIZE)
+    {
+        u32Addr = (u32Page == u32Base) ? u32Base + FMC_FLASH_PAGE_SIZE : u32Base;
+        if(FMC_Erase(u32Addr) != 0)
+            return FWSLOT_ERR_FLASH;
+    }
+
+    psRec->u32Seq = u32Seq + 1;
+
+    au32Rec[0] = psRec->u32Seq;
+    au32Rec[1] = psRec->u8Slot | ((uint32_t)psRec->u8State << 8) | ((uint32_t)psRec->u8Tries << 16) | (FWSLOT_REC_TAG << 24);
+    au32Rec[2] = psRec->u32Size;
+    au32Rec[3] = psRec->u32Crc;
+    for(i = 4; i < FWSLOT_REC_SIZE / 4; i++)
+        au32Rec[i] = 0xFFFFFFFF;
+    au32Rec[FWSLOT_REC_SIZE / 4 - 1] = FWSLOT_RecCommit(au32Rec);
+
+    if(FMC_WriteMultiple(u32Addr, au32Rec, FWSLOT_REC_SIZE / 4) != 0)
+        return FWSLOT_ERR_FLASH;
+
+    return 0;
+}
+
+/* Check the vector table of a slot. APROM is read by ISP, page 0 may be remapped by VECMAP. */
+static int32_t FWSLOT_CheckImage(uint32_t u32Slot)
+{
+    uint32_t u32Base = FWSLOT_GET_BASE(u32Slot);
+    uint32_t u32Sp = FMC_Read(u32Base);
+    uint32_t u32Pc = FMC_Read(u32Base + 4);
+
+    if((u32Sp <= 0x20000000) || (u32Sp > FWSLOT_SRAM_END) || (u32Sp & 3))
+        return FWSLOT_ERR_IMAGE;
+
+    if(((u32Pc & 1) == 0) || ((u32Pc & ~1UL) < u32Base) || ((u32Pc & ~1UL) >= u32Base + FWSLOT_SLOT_SIZE))
+        return FWSLOT_ERR_IMAGE;
+
+    return 0;
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Calculate CRC32 (IEEE 802.3, as zlib crc32()).
+  * @param[in]  pvData Data.
+  * @param[in]  u32Len Data length in bytes.
+  * @param[in]  u32Crc CRC32 of the preceding data, 0 to start.
+  * @return     CRC32 of the preceding data and pvData.
+  */
+uint32_t FWSLOT_CRC32(const void *pvData, uint32_t u32Len, uint32_t u32Crc)
+{
+    const uint8_t *pu8Data = (const uint8_t *)pvData;
+
+    u32Crc = ~u32Crc;
+    while(u32Len--)
+        u32Crc = FWSLOT_CRC32Byte(u32Crc, *pu8Data++);
+
+    return ~u32Crc;
+}
+
+/**
+  * @brief      Read the boot record in effect.
+  * @param[out] psRec The pointer of the record.
+  * @retval     0 Success
+  * @retval     FWSLOT_ERR_PARAM psRec is NULL
+  * @details    Without any record, slot A confirmed is returned with u32Seq 0.
+  */
+int32_t FWSLOT_ReadRecord(FWSLOT_REC_T *psRec)
+{
+    uint32_t u32Seq = 0, u32Addr, u32Info;
+
+    if(psRec == NULL)
+        return FWSLOT_ERR_PARAM;
+
+    u32Addr = FWSLOT_FindRecord(&u32Seq);
+    if(u32Addr == 0)
+    {
+        psRec->u32Seq = 0;
+        psRec->u8Slot = FWSLOT_A;
+        psRec->u8State = FWSLOT_STATE_CONFIRMED;
+        psRec->u8Tries = 0;
+        psRec->u32Size = 0;
+        psRec->u32Crc = 0;
+        return 0;
+    }
+
+    u32Info = M32(u32Addr + 4);
+    psRec->u32Seq = u32Seq;
+    psRec->u8Slot = (uint8_t)(u32Info & 1);
+    psRec->u8State = (uint8_t)(u32Info >> 8);
+    psRec->u8Tries = (uint8_t)(u32Info >> 16);
+    psRec->u8Reserved = 0;
+    psRec->u32Size = M32(u32Addr + 8);
+    psRec->u32Crc = M32(u32Addr + 12);
+
+    return 0;
+}
+
+/**
+  * @brief      Get the slot the running image was booted from.
+  * @return     \ref FWSLOT_A or \ref FWSLOT_B.
+  * @details    The running slot is the page VECMAP maps to address 0.
+  */
+uint32_t FWSLOT_GetActive(void)
+{
+    return (FMC_GetVECMAP() == FWSLOT_B_BASE) ? FWSLOT_B : FWSLOT_A;
+}
+
+/**
+  * @brief      Write image data to the inactive slot.
+  * @param[in]  u32Offset Byte offset in the slot, word aligned.
+  * @param[in]  pu32Data Image words.
+  * @param[in]  u32Len Length in bytes, multiple of 4.
+  * @retval     0 Success
+  * @retval     FWSLOT_ERR_PARAM Unaligned or beyond the slot
+  * @retval     FWSLOT_ERR_STATE The boot record is on trial, the other slot holds the fall back image
+  * @retval     FWSLOT_ERR_FLASH Flash program or erase failed
+  * @details    A page is erased when the data reaches its first word, so the image must be written in
+  *             ascending order starting at offset 0. The running slot is never touched, nor is the other
+  *             slot before the running image is confirmed by FWSLOT_Confirm().
+  * @note       ISP and APROM update must be enabled by FMC_Open() and FMC_EnableAPUpdate().
+  */
+int32_t FWSLOT_Write(uint32_t u32Offset, const uint32_t *pu32Data, uint32_t u32Len)
+{
+    uint32_t u32Base = FWSLOT_GET_BASE(FWSLOT_GetActive() ^ 1);
+    uint32_t u32Page, u32Cnt;
+    FWSLOT_REC_T sRec;
+
+    if((u32Offset & 3) || (u32Len & 3) || (u32Offset + u32Len > FWSLOT_SLOT_SIZE) || (u32Offset + u32Len < u32Offset))
+        return FWSLOT_ERR_PARAM;
+
+    FWSLOT_ReadRecord(&sRec);
+    if(sRec.u8State == FWSLOT_STATE_TRIAL)
+        return FWSLOT_ERR_STATE;
+
+    while(u32Len)
+    {
+        if((u32Offset & (FMC_FLASH_PAGE_SIZE - 1)) == 0)
+        {
+            if(FMC_Erase(u32Base + u32Offset) != 0)
+                return FWSLOT_ERR_FLASH;
+        }
+
+        /* Program up to the end of the page */
+        u32Page = FMC_FLASH_PAGE_SIZE - (u32Offset & (FMC_FLASH_PAGE_SIZE - 1));
+        u32Cnt = (u32Len < u32Page) ? u32Len : u32Page;
+
+        if(FMC_WriteMultiple(u32Base + u32Offset, pu32Data, u32Cnt / 4) != 0)
+            return FWSLOT_ERR_FLASH;
+
+        pu32Data += u32Cnt / 4;
+        u32Offset += u32Cnt;
+        u32Len -= u32Cnt;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief      Verify the inactive slot and select it for a trial boot.
+  * @param[in]  u32Size Image size in bytes.
+  * @param[in]  u32Crc Expected CRC32 of the image, see FWSLOT_CRC32().
+  * @retval     0 Success, the new image runs after the next reset
+  * @retval     FWSLOT_ERR_PARAM Invalid size
+  * @retval     FWSLOT_ERR_STATE The boot record is on trial, see FWSLOT_Write()
+  * @retval     FWSLOT_ERR_CRC CRC32 mismatch
+  * @retval     FWSLOT_ERR_IMAGE Vector table not valid for the slot
+  * @retval     FWSLOT_ERR_FLASH Boot record could not be written
+  * @details    The slot is read back by ISP and checked against u32Crc. Then a trial record with
+  *             FWSLOT_TRIAL_BOOTS boots is appended. The current image stays in effect until that record is
+  *             committed by its last word.
+  */
+int32_t FWSLOT_Commit(uint32_t u32Size, uint32_t u32Crc)
+{
+    uint32_t u32Slot = FWSLOT_GetActive() ^ 1;
+    uint32_t u32Base = FWSLOT_GET_BASE(u32Slot);
+    uint32_t u32Calc = 0xFFFFFFFF, u32Word, i, j;
+    FWSLOT_REC_T sRec;
+
+    if((u32Size == 0) || (u32Size > FWSLOT_SLOT_SIZE))
+        return FWSLOT_ERR_PARAM;
+
+    FWSLOT_ReadRecord(&sRec);
+    if(sRec.u8State == FWSLOT_STATE_TRIAL)
+        return FWSLOT_ERR_STATE;
+
+    for(i = 0; i < u32Size; i += 4)
+    {
+        u32Word = FMC_Read(u32Base + i);
+        for(j = 0; (j < 4) && (i + j < u32Size); j++)
+            u32Calc = FWSLOT_CRC32Byte(u32Calc, u32Word >> (j * 8));
+    }
+
+    if(~u32Calc != u32Crc)
+        return FWSLOT_ERR_CRC;
+
+    if(FWSLOT_CheckImage(u32Slot) != 0)
+        return FWSLOT_ERR_IMAGE;
+
+    sRec.u8Slot = (uint8_t)u32Slot;
+    sRec.u8State = FWSLOT_STATE_TRIAL;
+    sRec.u8Tries = FWSLOT_TRIAL_BOOTS;
+    sRec.u8Reserved = 0;
+    sRec.u32Size = u32Size;
+    sRec.u32Crc = u32Crc;
+
+    return FWSLOT_AppendRecord(&sRec);
+}
+
+/**
+  * @brief      Confirm the running image.
+  * @retval     0 Success, or the running image is confirmed already
+  * @retval     FWSLOT_ERR_STATE The running slot is not the slot of the boot record
+  * @retval     FWSLOT_ERR_FLASH Boot record could not be written
+  * @details    A new image calls this function once it has checked itself, e.g. after its peripherals and
+  *             communication are up. Until then the LDROM selector counts its boots down and falls back.
+  */
+int32_t FWSLOT_Confirm(void)
+{
+    FWSLOT_REC_T sRec;
+
+    FWSLOT_ReadRecord(&sRec);
+
+    if(sRec.u8Slot != FWSLOT_GetActive())
+        return FWSLOT_ERR_STATE;
+
+    if(sRec.u8State == FWSLOT_STATE_CONFIRMED)
+        return 0;
+
+    sRec.u8State = FWSLOT_STATE_CONFIRMED;
+    sRec.u8Tries = 0;
+
+    return FWSLOT_AppendRecord(&sRec);
+}
+
+/**
+  * @brief      Boot the selected slot. Called by the LDROM selector at reset.
+  * @retval     FWSLOT_ERR_IMAGE Neither slot holds a valid image. On success the function does not return.
+  * @details    A confirmed record costs one VECMAP command and a reset. A trial record is counted down by one
+  *             appended record per boot. When no trial boots are left, the other slot is recorded as
+  *             confirmed and booted. A slot whose vector table is not valid is never booted.
+  * @note       ISP must be enabled by FMC_Open() with the protected registers unlocked.
+  *             Enable the watchdog before a trial boot so that a hanging image also comes back here.
+  */
+int32_t FWSLOT_Boot(void)
+{
+    FWSLOT_REC_T sRec;
+    uint32_t u32Slot;
+
+    FWSLOT_ReadRecord(&sRec);
+    u32Slot = sRec.u8Slot;
+
+    if(sRec.u8State == FWSLOT_STATE_TRIAL)
+    {
+        if(sRec.u8Tries == 0)
+        {
+            u32Slot ^= 1;
+            sRec.u8Slot = (uint8_t)u32Slot;
+            sRec.u8State = FWSLOT_STATE_CONFIRMED;
+            sRec.u32Size = 0;
+            sRec.u32Crc = 0;
+        }
+        else
+        {
+            sRec.u8Tries--;
+        }
+
+        /* Boot anyway if the record cannot be written, the image check below still applies */
+        FWSLOT_AppendRecord(&sRec);
+    }
+
+    if(FWSLOT_CheckImage(u32Slot) != 0)
+    {
+        u32Slot ^= 1;
+        if(FWSLOT_CheckImage(u32Slot) != 0)
+            return FWSLOT_ERR_IMAGE;
+    }
+
+    /* Mask all interrupts before changing VECMAP to avoid a wrong interrupt handler being fetched */
+    __set_PRIMASK(1);
+    FMC_SetVectorPageAddr(FWSLOT_GET_BASE(u32Slot));
+    NVIC_SystemReset();
+
+    return 0;
+}
+
+
+/*@}*/ /* end of group FWSLOT_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group FWSLOT_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,388 @@
+/**************************************************************************//**
+ * @file     gpio_bus.c
+ * @version  V3.00
+ * @brief    NUC1311 series GPIO port bus and bit-bang engine source file
+ *
+ * @note     A port bus maps a value onto an arbitrary set of pins of one port. The pin pattern is looked up
+ *           nibble by nibble in tables built once by GPIOBUS_Init(), and written with one DOUT store under DMASK
+ *           with interrupts masked.
+ *           The bit-bang protocols use the pin data alias registers and a cycle counted delay loop, with timing
+ *           derived from SystemCoreClock.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "gpio_bus.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup GPIOBUS_Driver GPIO Port Bus Driver
+  @{
+*/
+
+/** @addtogroup GPIOBUS_EXPORTED_FUNCTIONS GPIO Port Bus Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+/* Busy loop of exactly GPIOBUS_LOOP_CYCLES per iteration. u32Loops must not be 0. */
+#if defined (__CC_ARM)
+static __asm void GPIOBUS_Loop(uint32_t u32Loops)
+{
+GPIOBUS_Loop_1
+    SUBS    r0, r0, #1
+    BNE     GPIOBUS_Loop_1
+    BX      lr
+}
+#elif defined (__arm__) || defined (__ICCARM__)
+static void GPIOBUS_Loop(uint32_t u32Loops)
+{
+    __ASM volatile(
+        "1:                 \n"
+        "   subs %0, %0, #1 \n"
+        "   bne  1b         \n"
+        : "+l"(u32Loops) : : "cc");
+}
+#else
+/* Host build, no cycle count */
+static void GPIOBUS_Loop(uint32_t u32Loops)
+{
+    volatile uint32_t u32Cnt = u32Loops;
+
+    while(--u32Cnt);
+}
+#endif
+
+static uint32_t GPIOBUS_NsToLoops(uint32_t u32Ns)
+{
+    uint32_t u32Cycles = (SystemCoreClock / 1000000UL) * u32Ns / 1000UL;
+
+    if(u32Cycles < GPIOBUS_CALL_CYCLES + GPIOBUS_LOOP_CYCLES)
+        return 0;
+
+    return (u32Cycles - GPIOBUS_CALL_CYCLES) / GPIOBUS_LOOP_CYCLES;
+}
+
+static void GPIOBUS_DelayLoops(uint32_t u32Loops)
+{
+    if(u32Loops)
+        GPIOBUS_Loop(u32Loops);
+}
+
+#define GPIOBUS_DelayNs(ns)     GPIOBUS_DelayLoops(GPIOBUS_NsToLoops(ns))
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Build a port bus descriptor.
+  * @param[out] bus       The bus descriptor to fill.
+  * @param[in]  port      GPIO port. It could be PA, PB, PC, PD, PE or PF.
+  * @param[in]  pu8Pins   Pin number of each bus bit, bit 0 first.
+  * @param[in]  u32Width  Number of bus bits, 1 ~ GPIOBUS_MAX_WIDTH.
+  * @retval     0                 Success.
+  * @retval     GPIOBUS_ERR_PARAM Invalid width, pin number or duplicated pin.
+  * @details    The pins must be configured as outputs by GPIO_SetMode() for GPIOBUS_Write(),
+  *             or as inputs for GPIOBUS_Read().
+  */
+int32_t GPIOBUS_Init(GPIOBUS_T *bus, GPIO_T *port, const uint8_t *pu8Pins, uint32_t u32Width)
+{
+    uint32_t i, u32Nibble, u32Val, u32Bit, u32Pattern;
+
+    if((u32Width == 0) || (u32Width > GPIOBUS_MAX_WIDTH))
+        return GPIOBUS_ERR_PARAM;
+
+    bus->port = port;
+    bus->u32Mask = 0;
+    bus->u32Width = u32Width;
+    bus->u32Shift = pu8Pins[0];
+
+    for(i = 0; i < u32Width; i++)
+    {
+        if((pu8Pins[i] >= GPIO_PIN_MAX) || (bus->u32Mask & (1UL << pu8Pins[i])))
+            return GPIOBUS_ERR_PARAM;
+
+        bus->au8Pin[i] = pu8Pins[i];
+        bus->u32Mask |= (1UL << pu8Pins[i]);
+
+        if(pu8Pins[i] != pu8Pins[0] + i)
+            bus->u32Shift = GPIOBUS_NOT_CONTIGUOUS;
+    }
+
+    for(u32Nibble = 0; u32Nibble < GPIOBUS_MAX_WIDTH / 4; u32Nibble++)
+    {
+        for(u32Val = 0; u32Val < 16; u32Val++)
+        {
+            u32Pattern = 0;
+            for(u32Bit = 0; u32Bit < 4; u32Bit++)
+            {
+                i = u32Nibble * 4 + u32Bit;
+                if((u32Val & (1UL << u32Bit)) && (i < u32Width))
+                    u32Pattern |= (1UL << bus->au8Pin[i]);
+            }
+            bus->au16Lut[u32Nibble][u32Val] = (uint16_t)u32Pattern;
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief      Output a value on a port bus.
+  * @param[in]  bus       The bus descriptor.
+  * @param[in]  u32Value  Value to output. Bits above the bus width are ignored.
+  * @return     None
+  * @details    All bus pins change with one DOUT store. Other pins of the port are not affected.
+  *             Interrupts are masked for the four register accesses of GPIOBUS_WriteMasked().
+  */
+void GPIOBUS_Write(const GPIOBUS_T *bus, uint32_t u32Value)
+{
+    uint32_t u32Pattern, u32Nibble;
+
+    if(bus->u32Shift != GPIOBUS_NOT_CONTIGUOUS)
+    {
+        u32Pattern = u32Value << bus->u32Shift;
+    }
+    else
+    {
+        u32Pattern = 0;
+        for(u32Nibble = 0; u32Nibble * 4 < bus->u32Width; u32Nibble++)
+        {
+            u32Pattern |= bus->au16Lut[u32Nibble][u32Value & 0xF];
+            u32Value >>= 4;
+        }
+    }
+
+    GPIOBUS_WriteMasked(bus->port, bus->u32Mask, u32Pattern);
+}
+
+/**
+  * @brief      Sample a port bus.
+  * @param[in]  bus       The bus descriptor.
+  * @return     Bus value. All pins are sampled with one PIN read.
+  */
+uint32_t GPIOBUS_Read(const GPIOBUS_T *bus)
+{
+    uint32_t u32Pin = bus->port->PIN;
+    uint32_t i, u32Value = 0;
+
+    if(bus->u32Shift != GPIOBUS_NOT_CONTIGUOUS)
+        return (u32Pin & bus->u32Mask) >> bus->u32Shift;
+
+    for(i = 0; i < bus->u32Width; i++)
+    {
+        if(u32Pin & (1UL << bus->au8Pin[i]))
+            u32Value |= (1UL << i);
+    }
+
+    return u32Value;
+}
+
+/**
+  * @brief      Busy wait for a number of CPU cycles.
+  * @param[in]  u32Cycles  CPU cycles to wait, including the call overhead.
+  * @return     None
+  * @details    The resolution is GPIOBUS_LOOP_CYCLES. Delays shorter than GPIOBUS_CALL_CYCLES return immediately.
+  *             Flash wait states lengthen the loop; override GPIOBUS_LOOP_CYCLES if the code runs with wait states.
+  */
+void GPIOBUS_DelayCycles(uint32_t u32Cycles)
+{
+    if(u32Cycles >= GPIOBUS_CALL_CYCLES + GPIOBUS_LOOP_CYCLES)
+        GPIOBUS_Loop((u32Cycles - GPIOBUS_CALL_CYCLES) / GPIOBUS_LOOP_CYCLES);
+}
+
+/**
+  * @brief      Set up a bit-bang SPI bus.
+  * @param[out] spi          The bit-bang SPI descriptor to fill.
+  * @param[in]  pu32Sck      Pin data alias of SCK, e.g. &PA0. Must be an output driven low.
+  * @param[in]  pu32Mosi     Pin data alias of MOSI. Must be an output.
+  * @param[in]  pu32Miso     Pin data alias of MISO, or NULL if the bus is write-only.
+  * @param[in]  u32BusClock  Expected SCK frequency in Hz. The actual clock is not above it.
+  * @return     None
+  */
+void GPIOBUS_SpiInit(GPIOBUS_SPI_T *spi, volatile uint32_t *pu32Sck, volatile uint32_t *pu32Mosi, volatile uint32_t *pu32Miso, uint32_t u32BusClock)
+{
+    uint32_t u32HalfCycles = (u32BusClock == 0) ? 0xFFFFFFFFUL : (SystemCoreClock + 2 * u32BusClock - 1) / (2 * u32BusClock);
+
+    spi->pu32Sck = pu32Sck;
+    spi->pu32Mosi = pu32Mosi;
+    spi->pu32Miso = pu32Miso;
+    spi->u32HalfLoops = (u32HalfCycles < GPIOBUS_CALL_CYCLES + GPIOBUS_LOOP_CYCLES) ? 0 :
+                        (u32HalfCycles - GPIOBUS_CALL_CYCLES + GPIOBUS_LOOP_CYCLES - 1) / GPIOBUS_LOOP_CYCLES;
+}
+
+/**
+  * @brief      Exchange a word on a bit-bang SPI bus in mode 0, MSB first.
+  * @param[in]  spi       The bit-bang SPI descriptor.
+  * @param[in]  u32Data   Data to send.
+  * @param[in]  u32Bits   Word length, 1 ~ 32.
+  * @return     Received data, 0 if the bus has no MISO.
+  * @details    Slave select is controlled by the caller.
+  */
+uint32_t GPIOBUS_SpiTransfer(const GPIOBUS_SPI_T *spi, uint32_t u32Data, uint32_t u32Bits)
+{
+    uint32_t u32Bit, u32Rx = 0;
+
+    if((u32Bits == 0) || (u32Bits > 32))
+        return 0;
+
+    for(u32Bit = 1UL << (u32Bits - 1); u32Bit; u32Bit >>= 1)
+    {
+        *spi->pu32Mosi = (u32Data & u32Bit) ? 1 : 0;
+        GPIOBUS_DelayLoops(spi->u32HalfLoops);
+        *spi->pu32Sck = 1;
+        if((spi->pu32Miso != NULL) && *spi->pu32Miso)
+            u32Rx |= u32Bit;
+        GPIOBUS_DelayLoops(spi->u32HalfLoops);
+        *spi->pu32Sck = 0;
+    }
+
+    return u32Rx;
+}
+
+/**
+  * @brief      Issue a 1-Wire reset pulse.
+  * @param[in]  pu32Pin   Pin data alias of the 1-Wire line. The pin must be in open-drain mode with a pull-up.
+  * @retval     0 No device answered.
+  * @retval     1 A presence pulse was detected.
+  * @details    Interrupts are masked only around the presence sampling point.
+  */
+uint32_t GPIOBUS_OwReset(volatile uint32_t *pu32Pin)
+{
+    uint32_t u32PriMask, u32Presence;
+
+    *pu32Pin = 0;
+    GPIOBUS_DelayNs(480000);
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    *pu32Pin = 1;
+    GPIOBUS_DelayNs(70000);
+    u32Presence = (*pu32Pin == 0) ? 1 : 0;
+    __set_PRIMASK(u32PriMask);
+
+    GPIOBUS_DelayNs(410000);
+
+    return u32Presence;
+}
+
+/**
+  * @brief      Write bits on a 1-Wire line, LSB first.
+  * @param[in]  pu32Pin   Pin data alias of the 1-Wire line.
+  * @param[in]  u32Data   Data to write.
+  * @param[in]  u32Bits   Number of bits, 1 ~ 32.
+  * @return     None
+  * @details    Interrupts are masked for the 70 us of each time slot and served between slots.
+  */
+void GPIOBUS_OwWrite(volatile uint32_t *pu32Pin, uint32_t u32Data, uint32_t u32Bits)
+{
+    uint32_t u32PriMask, i;
+    uint32_t u32Short = GPIOBUS_NsToLoops(6000), u32Long = GPIOBUS_NsToLoops(60000);
+    uint32_t u32Rest1 = GPIOBUS_NsToLoops(64000), u32Rest0 = GPIOBUS_NsToLoops(10000);
+
+    u32PriMask = __get_PRIMASK();
+
+    for(i = 0; i < u32Bits; i++)
+    {
+        __disable_irq();
+        *pu32Pin = 0;
+        if(u32Data & 1)
+        {
+            GPIOBUS_DelayLoops(u32Short);
+            *pu32Pin = 1;
+            GPIOBUS_DelayLoops(u32Rest1);
+        }
+        else
+        {
+            GPIOBUS_DelayLoops(u32Long);
+            *pu32Pin = 1;
+            GPIOBUS_DelayLoops(u32Rest0);
+        }
+        __set_PRIMASK(u32PriMask);
+        u32Data >>= 1;
+    }
+}
+
+/**
+  * @brief      Read bits from a 1-Wire line, LSB first.
+  * @param[in]  pu32Pin   Pin data alias of the 1-Wire line.
+  * @param[in]  u32Bits   Number of bits, 1 ~ 32.
+  * @return     Received data.
+  */
+uint32_t GPIOBUS_OwRead(volatile uint32_t *pu32Pin, uint32_t u32Bits)
+{
+    uint32_t u32PriMask, i, u32Data = 0;
+    uint32_t u32Low = GPIOBUS_NsToLoops(6000), u32Sample = GPIOBUS_NsToLoops(9000), u32Rest = GPIOBUS_NsToLoops(55000);
+
+    u32PriMask = __get_PRIMASK();
+
+    for(i = 0; i < u32Bits; i++)
+    {
+        __disable_irq();
+        *pu32Pin = 0;
+        GPIOBUS_DelayLoops(u32Low);
+        *pu32Pin = 1;
+        GPIOBUS_DelayLoops(u32Sample);
+        if(*pu32Pin)
+            u32Data |= (1UL << i);
+        __set_PRIMASK(u32PriMask);
+        GPIOBUS_DelayLoops(u32Rest);
+    }
+
+    return u32Data;
+}
+
+/**
+  * @brief      Send a WS2812 LED frame.
+  * @param[in]  pu32Pin   Pin data alias of the data line. Must be a push-pull output driven low.
+  * @param[in]  pu8Grb    LED data, 3 bytes per LED in G, R, B order.
+  * @param[in]  u32Len    Number of bytes.
+  * @return     None
+  * @details    Interrupts are masked for the whole frame, 30 us per LED. The LEDs latch the data when the line
+  *             stays low for 50 us after the call. HCLK of 32 MHz or more is needed to meet the 0-bit high time.
+  */
+void GPIOBUS_Ws2812Write(volatile uint32_t *pu32Pin, const uint8_t *pu8Grb, uint32_t u32Len)
+{
+    uint32_t u32PriMask, i, u32Byte, u32Bit;
+    uint32_t u32T0H = GPIOBUS_NsToLoops(400), u32T0L = GPIOBUS_NsToLoops(850);
+    uint32_t u32T1H = GPIOBUS_NsToLoops(800), u32T1L = GPIOBUS_NsToLoops(450);
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    for(i = 0; i < u32Len; i++)
+    {
+        u32Byte = pu8Grb[i];
+        for(u32Bit = 0x80; u32Bit; u32Bit >>= 1)
+        {
+            if(u32Byte & u32Bit)
+            {
+                *pu32Pin = 1;
+                GPIOBUS_DelayLoops(u32T1H);
+                *pu32Pin = 0;
+                GPIOBUS_DelayLoops(u32T1L);
+            }
+            else
+            {
+                *pu32Pin = 1;
+                GPIOBUS_DelayLoops(u32T0H);
+                *pu32Pin = 0;
+                GPIOBUS_DelayLoops(u32T0L);
+            }
+        }
+    }
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/*@}*/ /* end of group GPIOBUS_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group GPIOBUS_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
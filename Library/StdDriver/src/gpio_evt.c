@@ -0,0 +1,274 @@
+/**************************************************************************//**
+ * @file     gpio_evt.c
+ * @version  V3.00
+ * @brief    NUC1311 series GPIO event dispatcher source file
+ *
+ * @note     GPIO interrupts are dispatched to per-pin callbacks. The interrupt handler visits only the pins whose
+ *           ISRC bit is set. Pins registered with a debounce window are reported from the software timer service
+ *           (swtimer.c) once their input has been quiet for the whole window, which must be opened first.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "gpio_evt.h"
+#include "swtimer.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup GPIOEVT_Driver GPIO Event Dispatcher
+  @{
+*/
+
+/** @addtogroup GPIOEVT_EXPORTED_FUNCTIONS GPIO Event Dispatcher Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define GPIOEVT_PORT(idx)       ((GPIO_T *)(PA_BASE + ((idx) << 6)))
+#define GPIOEVT_INDEX(port)     (((uint32_t)(port) - PA_BASE) >> 6)
+
+static GPIOEVT_FUNC_T s_apfnFunc[GPIOEVT_PORT_CNT * GPIO_PIN_MAX];
+static uint16_t s_au16Window[GPIOEVT_PORT_CNT * GPIO_PIN_MAX];      /* Debounce window in ticks, 0 if not debounced */
+static uint32_t s_au32Deadline[GPIOEVT_PORT_CNT * GPIO_PIN_MAX];    /* Tick at which a pending pin is settled */
+static uint16_t s_au16Pend[GPIOEVT_PORT_CNT];                       /* Pins waiting for their debounce window */
+static uint16_t s_au16Stable[GPIOEVT_PORT_CNT];                     /* Last reported level of debounced pins */
+static SWTIMER_T s_sDebounceTmr;
+static uint32_t s_u32DebounceExpire;
+
+static void GPIOEVT_DebounceExpire(void *pvArg);
+
+/* Make sure the debounce timer fires no later than u32Deadline. Must be called with interrupts disabled. */
+static void GPIOEVT_ArmDebounce(uint32_t u32Now, uint32_t u32Deadline)
+{
+    if(SWTIMER_IS_ACTIVE(&s_sDebounceTmr) && ((int32_t)(u32Deadline - s_u32DebounceExpire) >= 0))
+        return;
+
+    s_u32DebounceExpire = u32Deadline;
+    SWTIMER_Start(&s_sDebounceTmr, u32Deadline - u32Now, 0, GPIOEVT_DebounceExpire, NULL);
+}
+
+/* Report debounced pins whose window has elapsed, then re-arm for the earliest one still pending */
+static void GPIOEVT_DebounceExpire(void *pvArg)
+{
+    GPIO_T *port;
+    GPIOEVT_FUNC_T pfnFunc;
+    uint32_t u32Now, u32Port, u32Pin, u32Idx, u32Pend, u32Bit, u32Level, u32Edge;
+    uint32_t u32Next = 0, u32HasNext = 0;
+
+    u32Now = SWTIMER_GetTick();
+
+    for(u32Port = 0; u32Port < GPIOEVT_PORT_CNT; u32Port++)
+    {
+        port = GPIOEVT_PORT(u32Port);
+        u32Pend = s_au16Pend[u32Port];
+
+        while(u32Pend)
+        {
+            u32Pin = SYS_Ctz(u32Pend);
+            u32Bit = 1UL << u32Pin;
+            u32Pend &= ~u32Bit;
+            u32Idx = u32Port * GPIO_PIN_MAX + u32Pin;
+            pfnFunc = NULL;
+
+            __disable_irq();
+            if((int32_t)(s_au32Deadline[u32Idx] - u32Now) > 0)
+            {
+                /* A bounce restarted the window after this scan began */
+                if(!u32HasNext || ((int32_t)(s_au32Deadline[u32Idx] - u32Next) < 0))
+                    u32Next = s_au32Deadline[u32Idx];
+                u32HasNext = 1;
+            }
+            else if(s_au16Pend[u32Port] & u32Bit)
+            {
+                s_au16Pend[u32Port] &= ~u32Bit;
+                u32Level = (port->PIN & u32Bit) ? 1 : 0;
+                if(((s_au16Stable[u32Port] & u32Bit) ? 1 : 0) != u32Level)
+                {
+                    s_au16Stable[u32Port] ^= u32Bit;
+                    /* Only report the edges enabled at registration */
+                    u32Edge = u32Level ? (u32Bit << GPIO_IEN_IR_EN_Pos) : u32Bit;
+                    if(port->IEN & u32Edge)
+                        pfnFunc = s_apfnFunc[u32Idx];
+                }
+            }
+            __enable_irq();
+
+            if(pfnFunc != NULL)
+                pfnFunc(port, u32Pin, u32Level);
+        }
+    }
+
+    if(u32HasNext)
+    {
+        __disable_irq();
+        GPIOEVT_ArmDebounce(SWTIMER_GetTick(), u32Next);
+        __enable_irq();
+    }
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Clear the callback table.
+  * @param      None
+  * @return     None
+  * @details    Pin interrupts that are already enabled are not touched; their events are cleared and dropped
+  *             until a callback is registered.
+  */
+void GPIOEVT_Init(void)
+{
+    uint32_t i;
+
+    SWTIMER_Stop(&s_sDebounceTmr);
+
+    for(i = 0; i < GPIOEVT_PORT_CNT * GPIO_PIN_MAX; i++)
+    {
+        s_apfnFunc[i] = NULL;
+        s_au16Window[i] = 0;
+    }
+
+    for(i = 0; i < GPIOEVT_PORT_CNT; i++)
+    {
+        s_au16Pend[i] = 0;
+        s_au16Stable[i] = 0;
+    }
+}
+
+/**
+  * @brief      Register a pin event callback and enable the pin interrupt.
+  * @param[in]  port             GPIO port. It could be PA, PB, PC, PD, PE or PF.
+  * @param[in]  u32Pin           The pin of specified GPIO port, 0 ~ 15.
+  * @param[in]  u32IntAttribs    The interrupt attribute of specified GPIO pin. Could be
+  *                              - \ref GPIO_INT_RISING
+  *                              - \ref GPIO_INT_FALLING
+  *                              - \ref GPIO_INT_BOTH_EDGE
+  *                              - \ref GPIO_INT_HIGH
+  *                              - \ref GPIO_INT_LOW
+  * @param[in]  u32DebounceTicks Software debounce window in software timer ticks, 1 ~ 65535. 0 disables debounce.
+  * @param[in]  pfnFunc          Callback receiving the port, the pin and the pin level.
+  * @retval     0                Success.
+  * @retval     GPIOEVT_ERR_PARAM Invalid parameter.
+  * @details    Without debounce the callback runs in the GPIO interrupt with the level sampled there.
+  *             With debounce every edge restarts the window, and the callback runs in the software timer
+  *             interrupt once the level has been stable for the window and differs from the last reported one.
+  *             Debounced pins should use GPIO_INT_BOTH_EDGE so that both transitions restart the window;
+  *             with a single edge attribute only settled levels matching that edge are reported.
+  *             Level triggered pins cannot be debounced, and their callback must remove the interrupt cause.
+  */
+int32_t GPIOEVT_Register(GPIO_T *port, uint32_t u32Pin, uint32_t u32IntAttribs, uint32_t u32DebounceTicks, GPIOEVT_FUNC_T pfnFunc)
+{
+    uint32_t u32Port = GPIOEVT_INDEX(port);
+    uint32_t u32Idx = u32Port * GPIO_PIN_MAX + u32Pin;
+    uint32_t u32PriMask;
+
+    if((u32Port >= GPIOEVT_PORT_CNT) || (u32Pin >= GPIO_PIN_MAX) || (u32DebounceTicks > 0xFFFF))
+        return GPIOEVT_ERR_PARAM;
+
+    if(u32DebounceTicks && ((u32IntAttribs >> 24) & GPIO_IMD_LEVEL))
+        return GPIOEVT_ERR_PARAM;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    s_apfnFunc[u32Idx] = pfnFunc;
+    s_au16Window[u32Idx] = (uint16_t)u32DebounceTicks;
+    s_au16Pend[u32Port] &= ~(1UL << u32Pin);
+    s_au16Stable[u32Port] = (s_au16Stable[u32Port] & ~(1UL << u32Pin)) | (port->PIN & (1UL << u32Pin));
+    GPIO_CLR_INT_FLAG(port, 1UL << u32Pin);
+    GPIO_EnableInt(port, u32Pin, u32IntAttribs);
+
+    __set_PRIMASK(u32PriMask);
+
+    return 0;
+}
+
+/**
+  * @brief      Disable a pin interrupt and remove its callback.
+  * @param[in]  port    GPIO port. It could be PA, PB, PC, PD, PE or PF.
+  * @param[in]  u32Pin  The pin of specified GPIO port, 0 ~ 15.
+  * @return     None
+  */
+void GPIOEVT_Unregister(GPIO_T *port, uint32_t u32Pin)
+{
+    uint32_t u32Port = GPIOEVT_INDEX(port);
+    uint32_t u32PriMask;
+
+    if((u32Port >= GPIOEVT_PORT_CNT) || (u32Pin >= GPIO_PIN_MAX))
+        return;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    GPIO_DisableInt(port, u32Pin);
+    GPIO_CLR_INT_FLAG(port, 1UL << u32Pin);
+    s_au16Pend[u32Port] &= ~(1UL << u32Pin);
+    s_apfnFunc[u32Port * GPIO_PIN_MAX + u32Pin] = NULL;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Dispatch pending GPIO interrupts.
+  * @param[in]  u32PortMask Ports to service, bit 0 for PA to bit 5 for PF.
+  *                         Use \ref GPIOEVT_PORT_AB from GPAB_IRQHandler, EINT0_IRQHandler and EINT1_IRQHandler,
+  *                         and \ref GPIOEVT_PORT_CDEF from GPCDEF_IRQHandler.
+  * @return     None
+  * @details    Interrupt flags are cleared before the callbacks run, so an edge arriving during a callback
+  *             raises the interrupt again. The cost is proportional to the number of flagged pins.
+  */
+void GPIOEVT_IRQHandler(uint32_t u32PortMask)
+{
+    GPIO_T *port;
+    GPIOEVT_FUNC_T pfnFunc;
+    uint32_t u32Port, u32Isrc, u32Pin, u32Idx, u32Now = 0, u32HasNow = 0;
+
+    while(u32PortMask)
+    {
+        u32Port = SYS_Ctz(u32PortMask);
+        u32PortMask &= u32PortMask - 1;
+        port = GPIOEVT_PORT(u32Port);
+
+        u32Isrc = port->ISRC;
+        port->ISRC = u32Isrc;
+
+        while(u32Isrc)
+        {
+            u32Pin = SYS_Ctz(u32Isrc);
+            u32Isrc &= u32Isrc - 1;
+            u32Idx = u32Port * GPIO_PIN_MAX + u32Pin;
+
+            if(s_au16Window[u32Idx] == 0)
+            {
+                pfnFunc = s_apfnFunc[u32Idx];
+                if(pfnFunc != NULL)
+                    pfnFunc(port, u32Pin, (port->PIN >> u32Pin) & 1UL);
+            }
+            else
+            {
+                __disable_irq();
+                if(!u32HasNow)
+                {
+                    u32Now = SWTIMER_GetTick();
+                    u32HasNow = 1;
+                }
+                s_au32Deadline[u32Idx] = u32Now + s_au16Window[u32Idx];
+                s_au16Pend[u32Port] |= (uint16_t)(1UL << u32Pin);
+                GPIOEVT_ArmDebounce(u32Now, s_au32Deadline[u32Idx]);
+                __enable_irq();
+            }
+        }
+    }
+}
+
+/*@}*/ /* end of group GPIOEVT_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group GPIOEVT_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
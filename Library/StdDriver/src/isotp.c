@@ -0,0 +1,728 @@
+/**************************************************************************//**
+ * @file     isotp.c
+ * @version  V3.00
+ * @brief    NUC1311 series ISO 15765-2 (ISO-TP) CAN transport source file
+ *
+ * @note     A link uses one message object to send and one to receive, both driven from the CAN interrupt. Messages up
+ *           to 7 bytes go in a single frame; longer ones as a first frame and consecutive frames paced by the flow
+ *           control of the receiver. The sender loads each frame straight from the caller's buffer when the previous
+ *           one has left the message object, so consecutive frames follow each other back to back unless the peer
+ *           asks for a separation time. Separation times and the N_Bs / N_Cr time-outs run on the software timer
+ *           service (swtimer.c). Flow controls of the receiver share the TX message object and go before the next
+ *           frame of the sender. A frame that stays in the TX message object for the time-out, as on a bus without
+ *           another node or in bus off, is withdrawn (N_As / N_Ar) and both transfers of the link end.
+ *           The message objects are programmed through IF1 (IF[0]) with interrupts masked, also from the CAN
+ *           interrupt, and each transfer is waited for before the IF is left to other code.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "isotp.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup ISOTP_Driver ISO-TP Transport
+  @{
+*/
+
+/** @addtogroup ISOTP_EXPORTED_FUNCTIONS ISO-TP Transport Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define ISOTP_PCI_SF            0x00    /* Single frame, length in the low nibble */
+#define ISOTP_PCI_FF            0x10    /* First frame, 12-bit length */
+#define ISOTP_PCI_CF            0x20    /* Consecutive frame, sequence number in the low nibble */
+#define ISOTP_PCI_FC            0x30    /* Flow control, flow status in the low nibble */
+
+#define ISOTP_FS_CTS            0       /* Continue to send */
+#define ISOTP_FS_WAIT           1       /* Wait for the next flow control */
+#define ISOTP_FS_OVFLW          2       /* Message too large, abort */
+
+#define ISOTP_TX_IDLE           0
+#define ISOTP_TX_SEND           1       /* Next frame is loaded once the TX message object is free */
+#define ISOTP_TX_GAP            2       /* Consecutive frame in the TX message object, separation time follows */
+#define ISOTP_TX_STMIN          3       /* Waiting out the separation time */
+#define ISOTP_TX_WAIT_FC        4       /* Waiting for a flow control */
+#define ISOTP_TX_LAST           5       /* Last frame in the TX message object */
+
+#define ISOTP_RX_IDLE           0
+#define ISOTP_RX_CF             1       /* Waiting for consecutive frames */
+
+#define ISOTP_NOTIFY_TX         0x01
+#define ISOTP_NOTIFY_RX         0x02
+
+/* Wait for the IF1 transfer. Called before and after each transfer: the CAN interrupt uses IF1 while code it interrupted
+   could have a transfer of can.c in flight, and must leave IF1 idle when it returns. */
+static void ISOTP_WaitIF(CAN_T *tCAN)
+{
+    uint32_t u32TimeOutCount = CAN_TIMEOUT;
+
+    while(tCAN->IF[0].CREQ & CAN_IF_CREQ_BUSY_Msk)
+        if(--u32TimeOutCount == 0) break;
+}
+
+static void ISOTP_SetArb(ISOTP_T *psLink, uint32_t u32Id, uint32_t u32Dir)
+{
+    CAN_T *tCAN = psLink->tCAN;
+
+    if(psLink->u8IdType == CAN_STD_ID)
+    {
+        tCAN->IF[0].ARB1 = 0;
+        tCAN->IF[0].ARB2 = ((u32Id & 0x7FF) << 2) | u32Dir | CAN_IF_ARB2_MSGVAL_Msk;
+    }
+    else
+    {
+        tCAN->IF[0].ARB1 = u32Id & 0xFFFF;
+        tCAN->IF[0].ARB2 = ((u32Id & 0x1FFF0000) >> 16) | u32Dir | CAN_IF_ARB2_XTD_Msk | CAN_IF_ARB2_MSGVAL_Msk;
+    }
+}
+
+/* Receive object accepting exactly the receive identifier */
+static void ISOTP_SetRxObj(ISOTP_T *psLink)
+{
+    CAN_T *tCAN = psLink->tCAN;
+
+    ISOTP_WaitIF(tCAN);
+
+    tCAN->IF[0].CMASK = CAN_IF_CMASK_WRRD_Msk | CAN_IF_CMASK_MASK_Msk | CAN_IF_CMASK_ARB_Msk | CAN_IF_CMASK_CONTROL_Msk;
+    ISOTP_SetArb(psLink, psLink->u32RxId, 0);
+
+    if(psLink->u8IdType == CAN_STD_ID)
+    {
+        tCAN->IF[0].MASK1 = 0;
+        tCAN->IF[0].MASK2 = CAN_IF_MASK2_MXTD_Msk | CAN_IF_MASK2_MDIR_Msk | (0x7FF << 2);
+    }
+    else
+    {
+        tCAN->IF[0].MASK1 = 0xFFFF;
+        tCAN->IF[0].MASK2 = CAN_IF_MASK2_MXTD_Msk | CAN_IF_MASK2_MDIR_Msk | 0x1FFF;
+    }
+
+    tCAN->IF[0].MCON = CAN_IF_MCON_UMASK_Msk | CAN_IF_MCON_RXIE_Msk | CAN_IF_MCON_EOB_Msk;
+    tCAN->IF[0].CREQ = 1 + psLink->u8RxObj;
+
+    ISOTP_WaitIF(tCAN);
+}
+
+static void ISOTP_Invalidate(CAN_T *tCAN, uint32_t u32MsgNum)
+{
+    ISOTP_WaitIF(tCAN);
+
+    tCAN->IF[0].CMASK = CAN_IF_CMASK_WRRD_Msk | CAN_IF_CMASK_ARB_Msk | CAN_IF_CMASK_CONTROL_Msk;
+    tCAN->IF[0].ARB1 = 0;
+    tCAN->IF[0].ARB2 = 0;
+    tCAN->IF[0].MCON = 0;
+    tCAN->IF[0].CREQ = 1 + u32MsgNum;
+
+    ISOTP_WaitIF(tCAN);
+}
+
+static void ISOTP_AsTimer(void *pvArg);
+
+/* Load a frame of PCI bytes and payload into the TX message object and request its transmission.
+   N_As (N_Ar for a flow control) runs until the frame is sent. */
+static void ISOTP_Load(ISOTP_T *psLink, const uint8_t *pu8Pci, uint32_t u32PciLen, const uint8_t *pu8Data, uint32_t u32Len)
+{
+    CAN_T *tCAN = psLink->tCAN;
+    uint8_t au8Frame[8];
+    uint32_t i;
+
+    for(i = 0; i < u32PciLen; i++)
+        au8Frame[i] = pu8Pci[i];
+    for(; i < u32PciLen + u32Len; i++)
+        au8Frame[i] = *pu8Data++;
+    for(; i < 8; i++)
+        au8Frame[i] = ISOTP_PAD_BYTE;
+
+    ISOTP_WaitIF(tCAN);
+
+    tCAN->IF[0].CMASK = CAN_IF_CMASK_WRRD_Msk | CAN_IF_CMASK_ARB_Msk | CAN_IF_CMASK_CONTROL_Msk |
+                        CAN_IF_CMASK_DATAA_Msk | CAN_IF_CMASK_DATAB_Msk;
+    ISOTP_SetArb(psLink, psLink->u32TxId, CAN_IF_ARB2_DIR_Msk);
+    tCAN->IF[0].DAT_A1 = ((uint16_t)au8Frame[1] << 8) | au8Frame[0];
+    tCAN->IF[0].DAT_A2 = ((uint16_t)au8Frame[3] << 8) | au8Frame[2];
+    tCAN->IF[0].DAT_B1 = ((uint16_t)au8Frame[5] << 8) | au8Frame[4];
+    tCAN->IF[0].DAT_B2 = ((uint16_t)au8Frame[7] << 8) | au8Frame[6];
+    tCAN->IF[0].MCON = CAN_IF_MCON_NEWDAT_Msk | CAN_IF_MCON_TXRQST_Msk | CAN_IF_MCON_TXIE_Msk | CAN_IF_MCON_EOB_Msk | 8;
+    tCAN->IF[0].CREQ = 1 + psLink->u8TxObj;
+
+    ISOTP_WaitIF(tCAN);
+
+    psLink->u8ObjBusy = 1;
+    SWTIMER_Start(&psLink->sAsTmr, psLink->u32Timeout, 0, ISOTP_AsTimer, psLink);
+}
+
+/* Separation time in ticks. The first tick could be short, so one tick is added to never undercut it. */
+static uint32_t ISOTP_GapTicks(ISOTP_T *psLink, uint32_t u32STmin)
+{
+    uint32_t u32Freq = psLink->u32TickFreq;
+
+    if(u32STmin == 0)
+        return 0;
+
+    /* 0xF1 ~ 0xF9: 100 ~ 900 us */
+    if((u32STmin >= 0xF1) && (u32STmin <= 0xF9))
+        return ((u32STmin - 0xF0) * u32Freq + 9999) / 10000 + 1;
+
+    /* 0x01 ~ 0x7F: 1 ~ 127 ms, reserved values are taken as the longest */
+    if(u32STmin > 0x7F)
+        u32STmin = 0x7F;
+
+    return (u32STmin * u32Freq + 999) / 1000 + 1;
+}
+
+static void ISOTP_TxTimer(void *pvArg);
+
+static void ISOTP_TxFinish(ISOTP_T *psLink, int32_t i32Result)
+{
+    SWTIMER_Stop(&psLink->sTxTmr);
+    psLink->u8TxState = ISOTP_TX_IDLE;
+    psLink->i8TxResult = (int8_t)i32Result;
+    psLink->u8Notify |= ISOTP_NOTIFY_TX;
+}
+
+static void ISOTP_RxFinish(ISOTP_T *psLink, int32_t i32Result)
+{
+    SWTIMER_Stop(&psLink->sRxTmr);
+    psLink->u8RxState = ISOTP_RX_IDLE;
+    psLink->i32RxResult = i32Result;
+    psLink->u8Notify |= ISOTP_NOTIFY_RX;
+}
+
+/* Load the next frame when the TX message object is free: a waiting flow control first, then the sender's frame */
+static void ISOTP_Kick(ISOTP_T *psLink)
+{
+    uint8_t au8Pci[3];
+    uint32_t u32Len;
+
+    if(psLink->u8ObjBusy)
+        return;
+
+    if(psLink->u8FcPending)
+    {
+        psLink->u8FcPending = 0;
+        au8Pci[0] = ISOTP_PCI_FC | psLink->u8FcStatus;
+        au8Pci[1] = psLink->u8BlockSize;
+        au8Pci[2] = psLink->u8STmin;
+        ISOTP_Load(psLink, au8Pci, 3, NULL, 0);
+        return;
+    }
+
+    if(psLink->u8TxState != ISOTP_TX_SEND)
+        return;
+
+    u32Len = psLink->u32TxLen;
+
+    if(psLink->u32TxPos == 0)
+    {
+        if(u32Len <= 7)
+        {
+            au8Pci[0] = ISOTP_PCI_SF | u32Len;
+            ISOTP_Load(psLink, au8Pci, 1, psLink->pu8TxData, u32Len);
+            psLink->u32TxPos = u32Len;
+            psLink->u8TxState = ISOTP_TX_LAST;
+        }
+        else
+        {
+            au8Pci[0] = ISOTP_PCI_FF | (u32Len >> 8);
+            au8Pci[1] = (uint8_t)u32Len;
+            ISOTP_Load(psLink, au8Pci, 2, psLink->pu8TxData, 6);
+            psLink->u32TxPos = 6;
+            psLink->u8TxSn = 1;
+            psLink->u8TxState = ISOTP_TX_WAIT_FC;
+            SWTIMER_Start(&psLink->sTxTmr, psLink->u32Timeout, 0, ISOTP_TxTimer, psLink);
+        }
+        return;
+    }
+
+    u32Len -= psLink->u32TxPos;
+    if(u32Len > 7)
+        u32Len = 7;
+
+    au8Pci[0] = ISOTP_PCI_CF | psLink->u8TxSn;
+    psLink->u8TxSn = (psLink->u8TxSn + 1) & 0xF;
+    ISOTP_Load(psLink, au8Pci, 1, psLink->pu8TxData + psLink->u32TxPos, u32Len);
+    psLink->u32TxPos += u32Len;
+
+    if(psLink->u32TxPos == psLink->u32TxLen)
+    {
+        psLink->u8TxState = ISOTP_TX_LAST;
+    }
+    else if(psLink->u8TxBs && (--psLink->u8TxBsLeft == 0))
+    {
+        psLink->u8TxState = ISOTP_TX_WAIT_FC;
+        SWTIMER_Start(&psLink->sTxTmr, psLink->u32Timeout, 0, ISOTP_TxTimer, psLink);
+    }
+    else
+    {
+        psLink->u8TxState = psLink->u32TxGap ? ISOTP_TX_GAP : ISOTP_TX_SEND;
+    }
+}
+
+/* The frame in the TX message object has been sent */
+static void ISOTP_TxDone(ISOTP_T *psLink)
+{
+    SWTIMER_Stop(&psLink->sAsTmr);
+    psLink->u8ObjBusy = 0;
+
+    if(psLink->u8TxState == ISOTP_TX_LAST)
+    {
+        ISOTP_TxFinish(psLink, 0);
+    }
+    else if(psLink->u8TxState == ISOTP_TX_GAP)
+    {
+        psLink->u8TxState = ISOTP_TX_STMIN;
+        SWTIMER_Start(&psLink->sTxTmr, psLink->u32TxGap, 0, ISOTP_TxTimer, psLink);
+    }
+
+    ISOTP_Kick(psLink);
+}
+
+static void ISOTP_FlowControl(ISOTP_T *psLink, uint8_t *pu8Data, uint32_t u32Dlc)
+{
+    if((psLink->u8TxState != ISOTP_TX_WAIT_FC) || (u32Dlc < 3))
+        return;
+
+    switch(pu8Data[0] & 0xF)
+    {
+        case ISOTP_FS_CTS:
+            SWTIMER_Stop(&psLink->sTxTmr);
+            psLink->u8TxBs = pu8Data[1];
+            psLink->u8TxBsLeft = pu8Data[1];
+            psLink->u32TxGap = ISOTP_GapTicks(psLink, pu8Data[2]);
+
+            /* The separation time also goes before the first consecutive frame of a block */
+            if(psLink->u32TxGap)
+            {
+                psLink->u8TxState = ISOTP_TX_STMIN;
+                SWTIMER_Start(&psLink->sTxTmr, psLink->u32TxGap, 0, ISOTP_TxTimer, psLink);
+            }
+            else
+            {
+                psLink->u8TxState = ISOTP_TX_SEND;
+                ISOTP_Kick(psLink);
+            }
+            break;
+
+        case ISOTP_FS_WAIT:
+            SWTIMER_Start(&psLink->sTxTmr, psLink->u32Timeout, 0, ISOTP_TxTimer, psLink);
+            break;
+
+        case ISOTP_FS_OVFLW:
+            ISOTP_TxFinish(psLink, ISOTP_ERR_OVERFLOW);
+            break;
+
+        default:
+            ISOTP_TxFinish(psLink, ISOTP_ERR_FRAME);
+            break;
+    }
+}
+
+static void ISOTP_SendFc(ISOTP_T *psLink, uint32_t u32Status)
+{
+    psLink->u8FcStatus = (uint8_t)u32Status;
+    psLink->u8FcPending = 1;
+    ISOTP_Kick(psLink);
+}
+
+static void ISOTP_RxTimer(void *pvArg);
+
+static void ISOTP_RxFrame(ISOTP_T *psLink, STR_CANMSG_T *pCanMsg)
+{
+    uint8_t *pu8Data = pCanMsg->Data;
+    uint32_t u32Dlc = (pCanMsg->DLC > 8) ? 8 : pCanMsg->DLC;
+    uint32_t u32Len, i;
+
+    if(u32Dlc == 0)
+        return;
+
+    switch(pu8Data[0] & 0xF0)
+    {
+        case ISOTP_PCI_SF:
+            u32Len = pu8Data[0] & 0xF;
+            if((u32Len == 0) || (u32Len > u32Dlc - 1))
+                return;
+
+            /* A new message ends the one being received */
+            if(u32Len > psLink->u32RxSize)
+            {
+                ISOTP_RxFinish(psLink, ISOTP_ERR_OVERFLOW);
+                return;
+            }
+            for(i = 0; i < u32Len; i++)
+                psLink->pu8RxBuf[i] = pu8Data[1 + i];
+            ISOTP_RxFinish(psLink, (int32_t)u32Len);
+            break;
+
+        case ISOTP_PCI_FF:
+            u32Len = ((uint32_t)(pu8Data[0] & 0xF) << 8) | pu8Data[1];
+            if((u32Dlc < 8) || (u32Len < 8))
+                return;
+
+            if(u32Len > psLink->u32RxSize)
+            {
+                ISOTP_SendFc(psLink, ISOTP_FS_OVFLW);
+                ISOTP_RxFinish(psLink, ISOTP_ERR_OVERFLOW);
+                return;
+            }
+            for(i = 0; i < 6; i++)
+                psLink->pu8RxBuf[i] = pu8Data[2 + i];
+            psLink->u32RxLen = u32Len;
+            psLink->u32RxPos = 6;
+            psLink->u8RxSn = 1;
+            psLink->u8RxBsLeft = psLink->u8BlockSize;
+            psLink->u8RxState = ISOTP_RX_CF;
+            ISOTP_SendFc(psLink, ISOTP_FS_CTS);
+            SWTIMER_Start(&psLink->sRxTmr, psLink->u32Timeout, 0, ISOTP_RxTimer, psLink);
+            break;
+
+        case ISOTP_PCI_CF:
+            if(psLink->u8RxState != ISOTP_RX_CF)
+                return;
+
+            if((pu8Data[0] & 0xF) != psLink->u8RxSn)
+            {
+                ISOTP_RxFinish(psLink, ISOTP_ERR_SEQ);
+                return;
+            }
+            psLink->u8RxSn = (psLink->u8RxSn + 1) & 0xF;
+
+            u32Len = psLink->u32RxLen - psLink->u32RxPos;
+            if(u32Len > u32Dlc - 1)
+                u32Len = u32Dlc - 1;
+            for(i = 0; i < u32Len; i++)
+                psLink->pu8RxBuf[psLink->u32RxPos++] = pu8Data[1 + i];
+
+            if(psLink->u32RxPos == psLink->u32RxLen)
+            {
+                ISOTP_RxFinish(psLink, (int32_t)psLink->u32RxLen);
+                return;
+            }
+
+            if(psLink->u8BlockSize && (--psLink->u8RxBsLeft == 0))
+            {
+                psLink->u8RxBsLeft = psLink->u8BlockSize;
+                ISOTP_SendFc(psLink, ISOTP_FS_CTS);
+            }
+            SWTIMER_Start(&psLink->sRxTmr, psLink->u32Timeout, 0, ISOTP_RxTimer, psLink);
+            break;
+
+        case ISOTP_PCI_FC:
+            ISOTP_FlowControl(psLink, pu8Data, u32Dlc);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Run the callbacks outside the critical section */
+static void ISOTP_Notify(ISOTP_T *psLink)
+{
+    ISOTP_TX_FUNC_T pfnTxDone;
+    uint32_t u32PriMask, u32Notify;
+    int32_t i32TxResult, i32RxResult;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    u32Notify = psLink->u8Notify;
+    psLink->u8Notify = 0;
+    pfnTxDone = psLink->pfnTxDone;
+    i32TxResult = psLink->i8TxResult;
+    i32RxResult = psLink->i32RxResult;
+    __set_PRIMASK(u32PriMask);
+
+    if((u32Notify & ISOTP_NOTIFY_TX) && (pfnTxDone != NULL))
+        pfnTxDone(psLink, i32TxResult);
+
+    if((u32Notify & ISOTP_NOTIFY_RX) && (psLink->pfnRx != NULL))
+        psLink->pfnRx(psLink, (i32RxResult >= 0) ? psLink->pu8RxBuf : NULL, i32RxResult);
+}
+
+static void ISOTP_TxTimer(void *pvArg)
+{
+    ISOTP_T *psLink = (ISOTP_T *)pvArg;
+    uint32_t u32PriMask;
+
+    /* The CAN interrupt could have moved on already */
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    if(psLink->u8TxState == ISOTP_TX_STMIN)
+    {
+        psLink->u8TxState = ISOTP_TX_SEND;
+        ISOTP_Kick(psLink);
+    }
+    else if(psLink->u8TxState == ISOTP_TX_WAIT_FC)
+    {
+        ISOTP_TxFinish(psLink, ISOTP_ERR_TIMEOUT);
+    }
+    __set_PRIMASK(u32PriMask);
+
+    ISOTP_Notify(psLink);
+}
+
+static void ISOTP_RxTimer(void *pvArg)
+{
+    ISOTP_T *psLink = (ISOTP_T *)pvArg;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    if(psLink->u8RxState == ISOTP_RX_CF)
+        ISOTP_RxFinish(psLink, ISOTP_ERR_TIMEOUT);
+    __set_PRIMASK(u32PriMask);
+
+    ISOTP_Notify(psLink);
+}
+
+/* N_As / N_Ar: the frame was not sent in time. The TX message object is invalidated, which also drops a late
+   interrupt of the frame, and the transfers of the link end: neither can go on without the object. */
+static void ISOTP_AsTimer(void *pvArg)
+{
+    ISOTP_T *psLink = (ISOTP_T *)pvArg;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    if(psLink->u8ObjBusy)
+    {
+        ISOTP_Invalidate(psLink->tCAN, psLink->u8TxObj);
+        psLink->u8ObjBusy = 0;
+        psLink->u8FcPending = 0;
+        if(psLink->u8TxState != ISOTP_TX_IDLE)
+            ISOTP_TxFinish(psLink, ISOTP_ERR_TIMEOUT);
+        if(psLink->u8RxState != ISOTP_RX_IDLE)
+            ISOTP_RxFinish(psLink, ISOTP_ERR_TIMEOUT);
+    }
+    __set_PRIMASK(u32PriMask);
+
+    ISOTP_Notify(psLink);
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Open an ISO-TP link.
+  * @param[in]  psLink       Link control block. It must stay valid while the link is open.
+  * @param[in]  tCAN         The pointer to CAN module base address. It must be opened with CAN_Open() in normal mode.
+  * @param[in]  u32TxObj     Message object sending the frames, from 0 to 31.
+  * @param[in]  u32RxObj     Message object receiving the frames, from 0 to 31.
+  * @param[in]  u32IdType    CAN_STD_ID or CAN_EXT_ID.
+  * @param[in]  u32TxId      Identifier of the frames sent.
+  * @param[in]  u32RxId      Identifier of the frames received.
+  * @param[in]  u32TickFreq  Tick frequency returned by SWTIMER_Open().
+  * @retval     0                   Success
+  * @retval     ISOTP_ERR_PARAM     Invalid parameter
+  * @details    The software timer service must be open. Messages are received once ISOTP_SetRxBuffer() is called.
+  *             The link advertises block size 0 and separation time 0 until ISOTP_SetFlowControl() is called.
+  *             ISOTP_IRQHandler() must be called from the CAN interrupt handler with the module interrupt
+  *             (CAN_CON_IE_Msk) enabled. The transport uses IF1 from the CAN interrupt, see isotp.h.
+  */
+int32_t ISOTP_Open(ISOTP_T *psLink, CAN_T *tCAN, uint32_t u32TxObj, uint32_t u32RxObj, uint32_t u32IdType,
+                   uint32_t u32TxId, uint32_t u32RxId, uint32_t u32TickFreq)
+{
+    uint32_t u32PriMask;
+
+    if((u32TxObj > 31) || (u32RxObj > 31) || (u32TxObj == u32RxObj) || (u32TickFreq == 0) ||
+            ((u32IdType != CAN_STD_ID) && (u32IdType != CAN_EXT_ID)))
+        return ISOTP_ERR_PARAM;
+
+    psLink->tCAN = tCAN;
+    psLink->u32TxId = u32TxId;
+    psLink->u32RxId = u32RxId;
+    psLink->u8IdType = (uint8_t)u32IdType;
+    psLink->u8TxObj = (uint8_t)u32TxObj;
+    psLink->u8RxObj = (uint8_t)u32RxObj;
+    psLink->u8BlockSize = 0;
+    psLink->u8STmin = 0;
+    psLink->u32TickFreq = u32TickFreq;
+    psLink->u32Timeout = (ISOTP_TIMEOUT_MS * u32TickFreq + 999) / 1000;
+    if(psLink->u32Timeout > SWTIMER_MAX_TICKS)
+        psLink->u32Timeout = SWTIMER_MAX_TICKS;
+
+    psLink->u8TxState = ISOTP_TX_IDLE;
+    psLink->u8ObjBusy = 0;
+    psLink->u8FcPending = 0;
+    psLink->pfnTxDone = NULL;
+    psLink->sTxTmr.u8Active = 0;
+    psLink->sAsTmr.u8Active = 0;
+
+    psLink->pu8RxBuf = NULL;
+    psLink->u32RxSize = 0;
+    psLink->pfnRx = NULL;
+    psLink->u8RxState = ISOTP_RX_IDLE;
+    psLink->sRxTmr.u8Active = 0;
+    psLink->u8Notify = 0;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    ISOTP_Invalidate(tCAN, u32TxObj);
+    ISOTP_SetRxObj(psLink);
+    __set_PRIMASK(u32PriMask);
+
+    return 0;
+}
+
+/**
+  * @brief      Close an ISO-TP link.
+  * @param[in]  psLink  Link opened by ISOTP_Open().
+  * @return     None
+  * @details    Transfers in progress are dropped without callback and both message objects are invalidated.
+  */
+void ISOTP_Close(ISOTP_T *psLink)
+{
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    SWTIMER_Stop(&psLink->sTxTmr);
+    SWTIMER_Stop(&psLink->sRxTmr);
+    SWTIMER_Stop(&psLink->sAsTmr);
+    psLink->u8TxState = ISOTP_TX_IDLE;
+    psLink->u8RxState = ISOTP_RX_IDLE;
+    psLink->u8ObjBusy = 0;
+    psLink->u8FcPending = 0;
+    psLink->u8Notify = 0;
+    ISOTP_Invalidate(psLink->tCAN, psLink->u8TxObj);
+    ISOTP_Invalidate(psLink->tCAN, psLink->u8RxObj);
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Set the receive buffer.
+  * @param[in]  psLink   Link opened by ISOTP_Open().
+  * @param[in]  pu8Buf   Receive buffer.
+  * @param[in]  u32Size  Buffer size, larger messages are refused with a flow control overflow.
+  * @param[in]  pfnRx    Called from the CAN interrupt with each received message, or from the software timer interrupt
+  *                      with ISOTP_ERR_TIMEOUT (N_Cr, or N_Ar of a flow control). The buffer is reused for the next message once it returns.
+  * @return     None
+  * @details    A message being received is dropped.
+  */
+void ISOTP_SetRxBuffer(ISOTP_T *psLink, uint8_t *pu8Buf, uint32_t u32Size, ISOTP_RX_FUNC_T pfnRx)
+{
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    SWTIMER_Stop(&psLink->sRxTmr);
+    psLink->u8RxState = ISOTP_RX_IDLE;
+    psLink->pu8RxBuf = pu8Buf;
+    psLink->u32RxSize = (pu8Buf == NULL) ? 0 : u32Size;
+    psLink->pfnRx = pfnRx;
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Set the flow control parameters sent to the peer.
+  * @param[in]  psLink        Link opened by ISOTP_Open().
+  * @param[in]  u32BlockSize  Consecutive frames between flow controls, 0 ~ 255. 0 lets the peer send without pause.
+  * @param[in]  u32STmin      Minimum separation time between consecutive frames, ISO 15765-2 coded:
+  *                           0x00 ~ 0x7F for 0 ~ 127 ms, 0xF1 ~ 0xF9 for 100 ~ 900 us.
+  * @return     None
+  * @details    Takes effect with the next first frame received.
+  */
+void ISOTP_SetFlowControl(ISOTP_T *psLink, uint32_t u32BlockSize, uint32_t u32STmin)
+{
+    psLink->u8BlockSize = (uint8_t)u32BlockSize;
+    psLink->u8STmin = (uint8_t)u32STmin;
+}
+
+/**
+  * @brief      Send a message.
+  * @param[in]  psLink   Link opened by ISOTP_Open().
+  * @param[in]  pu8Data  Message. The frames are loaded from this buffer, it must stay unchanged until pfnDone is called.
+  * @param[in]  u32Len   Message length, 1 ~ \ref ISOTP_MAX_LEN.
+  * @param[in]  pfnDone  Called from interrupt context when the message is sent or aborted. Could be NULL.
+  * @retval     0                   The message is being sent
+  * @retval     ISOTP_ERR_PARAM     Invalid parameter
+  * @retval     ISOTP_ERR_BUSY      The previous message is still being sent
+  * @details    The function does not block. The rest of the message is sent from the CAN interrupt as fast as the
+  *             flow control of the peer allows.
+  */
+int32_t ISOTP_Send(ISOTP_T *psLink, const uint8_t *pu8Data, uint32_t u32Len, ISOTP_TX_FUNC_T pfnDone)
+{
+    uint32_t u32PriMask;
+
+    if((pu8Data == NULL) || (u32Len == 0) || (u32Len > ISOTP_MAX_LEN))
+        return ISOTP_ERR_PARAM;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    if(psLink->u8TxState != ISOTP_TX_IDLE)
+    {
+        __set_PRIMASK(u32PriMask);
+        return ISOTP_ERR_BUSY;
+    }
+
+    psLink->pu8TxData = pu8Data;
+    psLink->u32TxLen = u32Len;
+    psLink->u32TxPos = 0;
+    psLink->pfnTxDone = pfnDone;
+    psLink->u8TxState = ISOTP_TX_SEND;
+    ISOTP_Kick(psLink);
+
+    __set_PRIMASK(u32PriMask);
+
+    return 0;
+}
+
+/**
+  * @brief      ISO-TP interrupt handler.
+  * @param[in]  psLink     Link opened by ISOTP_Open().
+  * @param[in]  u32MsgNum  Message object of the interrupt, from 0 to 31, that is CAN_IIDR - 1.
+  * @retval     1   The object belongs to the link and is served
+  * @retval     0   The object is not used by the link, the caller handles it
+  * @details    Must be called from the CAN interrupt handler for each message object interrupt.
+  */
+int32_t ISOTP_IRQHandler(ISOTP_T *psLink, uint32_t u32MsgNum)
+{
+    STR_CANMSG_T sMsg;
+    uint32_t u32PriMask;
+
+    if((u32MsgNum != psLink->u8RxObj) && (u32MsgNum != psLink->u8TxObj))
+        return 0;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    if(u32MsgNum == psLink->u8RxObj)
+    {
+        if(CAN_Receive(psLink->tCAN, u32MsgNum, &sMsg) == TRUE)
+            ISOTP_RxFrame(psLink, &sMsg);
+        else
+            CAN_CLR_INT_PENDING_BIT(psLink->tCAN, (uint8_t)u32MsgNum);
+    }
+    else
+    {
+        ISOTP_WaitIF(psLink->tCAN);
+        psLink->tCAN->IF[0].CMASK = CAN_IF_CMASK_CLRINTPND_Msk;
+        psLink->tCAN->IF[0].CREQ = 1 + u32MsgNum;
+        ISOTP_WaitIF(psLink->tCAN);
+        ISOTP_TxDone(psLink);
+    }
+
+    __set_PRIMASK(u32PriMask);
+
+    ISOTP_Notify(psLink);
+
+    return 1;
+}
+
+/*@}*/ /* end of group ISOTP_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group ISOTP_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
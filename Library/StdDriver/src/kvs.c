@@ -0,0 +1,622 @@
+/**************************************************************************//**
+ * @file     kvs.c
+ * @version  V3.00
+ * @brief    NUC1311 series data flash key/value store source file
+ *
+ * @note     Records are appended to a ring of data flash pages and never rewritten in place. A RAM index
+ *           built at KVS_Open() points to the newest record of each key. When the erased pages run low,
+ *           live records of the oldest page are copied to the head and the oldest page is erased, so an
+ *           update only programs words and page erases are spread evenly over the ring.
+ *
+ *           Page layout:   [KVS_PAGE_MAGIC][sequence][~sequence][record]...
+ *           Record layout: [key | length << 16 | tag << 24][value, padded with 0xFF to a word][CRC16 | ~CRC16 << 16]
+ *
+ *           The commit word is programmed last. A record interrupted by a power failure fails its CRC and
+ *           is skipped at the next KVS_Open(), so the previous value of the key stays in effect.
+ *           A delete record that hides an older record in its own page is copied along with the live
+ *           records, so an interrupted erase of that page cannot bring the key back.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include <string.h>
+#include "NUC1311.h"
+#include "kvs.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup KVS_Driver Data Flash Key/Value Store
+  @{
+*/
+
+/** @addtogroup KVS_EXPORTED_FUNCTIONS Data Flash Key/Value Store Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define KVS_HDR_SIZE            12UL    /* Page header: magic, sequence and inverted sequence */
+#define KVS_TAG_VALUE           0x5AUL
+#define KVS_TAG_DELETE          0x3CUL
+#define KVS_REC_SIZE(u32Len)    (8UL + (((u32Len) + 3UL) & ~3UL))
+#define KVS_PAGE_ADDR(psKvs, u32Page)   ((psKvs)->u32Base + (u32Page) * KVS_PAGE_SIZE)
+
+#define KVS_REC_VALID           0       /* Committed record */
+#define KVS_REC_TORN            1       /* Header readable but not committed, skipped */
+#define KVS_REC_END             2       /* Erased space or unreadable header, end of the page log */
+
+/* CRC-16/CCITT, 4 bits at a time */
+static uint32_t KVS_Crc(uint32_t u32Crc, const uint8_t *pu8Data, uint32_t u32Len)
+{
+    static const uint16_t au16Crc[16] =
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+
+    while(u32Len--)
+    {
+        u32Crc ^= (uint32_t)(*pu8Data++) << 8;
+        u32Crc = ((u32Crc << 4) ^ au16Crc[(u32Crc >> 12) & 0xF]) & 0xFFFF;
+        u32Crc = ((u32Crc << 4) ^ au16Crc[(u32Crc >> 12) & 0xF]) & 0xFFFF;
+    }
+
+    return u32Crc;
+}
+
+/* Commit word of a record. Never 0xFFFFFFFF, so an unprogrammed word is never taken as committed. */
+static uint32_t KVS_Commit(uint32_t u32Hdr, const uint8_t *pu8Data, uint32_t u32Len)
+{
+    uint8_t au8Hdr[4];
+    uint32_t u32Crc;
+
+    au8Hdr[0] = (uint8_t)u32Hdr;
+    au8Hdr[1] = (uint8_t)(u32Hdr >> 8);
+    au8Hdr[2] = (uint8_t)(u32Hdr >> 16);
+    au8Hdr[3] = (uint8_t)(u32Hdr >> 24);
+
+    u32Crc = KVS_Crc(0xFFFF, au8Hdr, 4);
+    u32Crc = KVS_Crc(u32Crc, pu8Data, u32Len);
+
+    return u32Crc | ((~u32Crc & 0xFFFF) << 16);
+}
+
+/* 1 if the page carries a complete header. A partly erased header fails the sequence check. */
+static uint32_t KVS_PageValid(KVS_T *psKvs, uint32_t u32Page)
+{
+    uint32_t u32Addr = KVS_PAGE_ADDR(psKvs, u32Page);
+
+    return (M32(u32Addr) == KVS_PAGE_MAGIC) && (M32(u32Addr + 4) == ~M32(u32Addr + 8));
+}
+
+/* Check the record at u32Addr, data flash is read through the memory map */
+static uint32_t KVS_Record(uint32_t u32Addr, uint32_t u32End, uint32_t *pu32Hdr)
+{
+    uint32_t u32Hdr, u32Len, u32Tag, u32Size;
+
+    if(u32Addr + 8 > u32End)
+        return KVS_REC_END;
+
+    u32Hdr = M32(u32Addr);
+    u32Len = (u32Hdr >> 16) & 0xFF;
+    u32Tag = u32Hdr >> 24;
+    u32Size = KVS_REC_SIZE(u32Len);
+
+    if((u32Hdr == 0xFFFFFFFF) || ((u32Hdr & 0xFFFF) == KVS_KEY_INVALID) || (u32Len > KVS_MAX_VALUE) ||
+            ((u32Tag != KVS_TAG_VALUE) && (u32Tag != KVS_TAG_DELETE)) || (u32Addr + u32Size > u32End))
+        return KVS_REC_END;
+
+    *pu32Hdr = u32Hdr;
+
+    if(M32(u32Addr + u32Size - 4) != KVS_Commit(u32Hdr, (const uint8_t *)(u32Addr + 4), u32Len))
+        return KVS_REC_TORN;
+
+    return KVS_REC_VALID;
+}
+
+static KVS_ENTRY_T *KVS_Find(KVS_T *psKvs, uint32_t u32Key)
+{
+    uint32_t i;
+
+    for(i = 0; i < psKvs->u32Keys; i++)
+    {
+        if(psKvs->psIndex[i].u16Key == u32Key)
+            return &psKvs->psIndex[i];
+    }
+
+    return NULL;
+}
+
+static void KVS_Remove(KVS_T *psKvs, KVS_ENTRY_T *psEntry)
+{
+    *psEntry = psKvs->psIndex[--psKvs->u32Keys];
+}
+
+/* Apply one committed record to the RAM index */
+static int32_t KVS_Apply(KVS_T *psKvs, uint32_t u32Addr, uint32_t u32Hdr)
+{
+    KVS_ENTRY_T *psEntry = KVS_Find(psKvs, u32Hdr & 0xFFFF);
+
+    if((u32Hdr >> 24) == KVS_TAG_DELETE)
+    {
+        if(psEntry != NULL)
+            KVS_Remove(psKvs, psEntry);
+        return 0;
+    }
+
+    if(psEntry == NULL)
+    {
+        if(psKvs->u32Keys >= psKvs->u32IndexSize)
+            return KVS_ERR_NO_INDEX;
+        psEntry = &psKvs->psIndex[psKvs->u32Keys++];
+        psEntry->u16Key = (uint16_t)(u32Hdr & 0xFFFF);
+    }
+
+    psEntry->u16Len = (uint16_t)((u32Hdr >> 16) & 0xFF);
+    psEntry->u32Addr = u32Addr;
+
+    return 0;
+}
+
+/* Erase a page unless it is blank already */
+static int32_t KVS_ErasePage(KVS_T *psKvs, uint32_t u32Page)
+{
+    uint32_t u32Addr = KVS_PAGE_ADDR(psKvs, u32Page);
+    uint32_t i;
+
+    for(i = 0; i < KVS_PAGE_SIZE; i += 4)
+    {
+        if(M32(u32Addr + i) != 0xFFFFFFFF)
+            break;
+    }
+
+    if(i == KVS_PAGE_SIZE)
+        return 0;
+
+    psKvs->u32Erases++;
+
+    return (FMC_Erase(u32Addr) == 0) ? 0 : KVS_ERR_FLASH;
+}
+
+/* Start the page after the head. Sequence words go first, the magic word commits the header. */
+static int32_t KVS_NewPage(KVS_T *psKvs)
+{
+    uint32_t u32Page = (psKvs->u32Used == 0) ? psKvs->u32Head : (psKvs->u32Head + 1) % psKvs->u32PageNum;
+    uint32_t u32Addr = KVS_PAGE_ADDR(psKvs, u32Page);
+    uint32_t u32Seq = psKvs->u32Seq + 1;
+
+    if(KVS_ErasePage(psKvs, u32Page) != 0)
+        return KVS_ERR_FLASH;
+
+    if((FMC_Write(u32Addr + 4, u32Seq) != 0) || (FMC_Write(u32Addr + 8, ~u32Seq) != 0) ||
+            (FMC_Write(u32Addr, KVS_PAGE_MAGIC) != 0))
+        return KVS_ERR_FLASH;
+
+    if(psKvs->u32Used == 0)
+        psKvs->u32Tail = u32Page;
+    psKvs->u32Head = u32Page;
+    psKvs->u32Used++;
+    psKvs->u32Off = KVS_HDR_SIZE;
+    psKvs->u32Seq = u32Seq;
+
+    return 0;
+}
+
+/* Reserve u32Size bytes in the head page, keeping u32Spare erased pages for compaction */
+static int32_t KVS_Alloc(KVS_T *psKvs, uint32_t u32Size, uint32_t u32Spare, uint32_t *pu32Addr)
+{
+    int32_t i32Ret;
+
+    if(psKvs->u32Off + u32Size > KVS_PAGE_SIZE)
+    {
+        if(KVS_GET_FREE_PAGES(psKvs) <= u32Spare)
+            return KVS_ERR_FULL;
+
+        i32Ret = KVS_NewPage(psKvs);
+        if(i32Ret != 0)
+            return i32Ret;
+    }
+
+    *pu32Addr = KVS_PAGE_ADDR(psKvs, psKvs->u32Head) + psKvs->u32Off;
+    psKvs->u32Off += u32Size;
+
+    return 0;
+}
+
+/* 1 if compacting the oldest page reclaims space: it holds a stale, torn or delete record or no valid header */
+static uint32_t KVS_TailReclaimable(KVS_T *psKvs)
+{
+    uint32_t u32Addr = KVS_PAGE_ADDR(psKvs, psKvs->u32Tail) + KVS_HDR_SIZE;
+    uint32_t u32End = KVS_PAGE_ADDR(psKvs, psKvs->u32Tail) + KVS_PAGE_SIZE;
+    uint32_t u32Hdr = 0, u32State;
+    KVS_ENTRY_T *psEntry;
+
+    if(!KVS_PageValid(psKvs, psKvs->u32Tail))
+        return 1;
+
+    while((u32State = KVS_Record(u32Addr, u32End, &u32Hdr)) != KVS_REC_END)
+    {
+        psEntry = KVS_Find(psKvs, u32Hdr & 0xFFFF);
+        if((u32State != KVS_REC_VALID) || (psEntry == NULL) || (psEntry->u32Addr != u32Addr))
+            return 1;
+        u32Addr += KVS_REC_SIZE((u32Hdr >> 16) & 0xFF);
+    }
+
+    return 0;
+}
+
+/* 1 if the page holds a committed record of the key between u32Addr and u32End */
+static uint32_t KVS_KeyInPage(uint32_t u32Addr, uint32_t u32End, uint32_t u32Key)
+{
+    uint32_t u32Hdr = 0, u32State;
+
+    while((u32State = KVS_Record(u32Addr, u32End, &u32Hdr)) != KVS_REC_END)
+    {
+        if((u32State == KVS_REC_VALID) && ((u32Hdr & 0xFFFF) == u32Key))
+            return 1;
+        u32Addr += KVS_REC_SIZE((u32Hdr >> 16) & 0xFF);
+    }
+
+    return 0;
+}
+
+/* Copy the live records of the oldest page to the head, then erase it */
+static int32_t KVS_CompactTail(KVS_T *psKvs)
+{
+    uint32_t u32Page = psKvs->u32Tail;
+    uint32_t u32Addr = KVS_PAGE_ADDR(psKvs, u32Page) + KVS_HDR_SIZE;
+    uint32_t u32End = KVS_PAGE_ADDR(psKvs, u32Page) + KVS_PAGE_SIZE;
+    uint32_t u32Hdr = 0, u32Size, u32Dst, u32Copy, i;
+    uint32_t u32State;
+    KVS_ENTRY_T *psEntry;
+    int32_t i32Ret;
+
+    /* Never copy into the page being compacted */
+    if(psKvs->u32Head == u32Page)
+    {
+        if(KVS_GET_FREE_PAGES(psKvs) == 0)
+            return KVS_ERR_FULL;
+        i32Ret = KVS_NewPage(psKvs);
+        if(i32Ret != 0)
+            return i32Ret;
+    }
+
+    if(KVS_PageValid(psKvs, u32Page))
+    {
+        while((u32State = KVS_Record(u32Addr, u32End, &u32Hdr)) != KVS_REC_END)
+        {
+            u32Size = KVS_REC_SIZE((u32Hdr >> 16) & 0xFF);
+            psEntry = KVS_Find(psKvs, u32Hdr & 0xFFFF);
+
+            if(u32State != KVS_REC_VALID)
+                u32Copy = 0;
+            else if((u32Hdr >> 24) == KVS_TAG_DELETE)
+            {
+                /* Kept while the page holds an older record of the key, which a partly erased page could
+                   bring back. The copy hides nothing older, so the next compaction drops it. */
+                u32Copy = (psEntry == NULL) &&
+                          KVS_KeyInPage(KVS_PAGE_ADDR(psKvs, u32Page) + KVS_HDR_SIZE, u32Addr, u32Hdr & 0xFFFF);
+            }
+            else
+                u32Copy = (psEntry != NULL) && (psEntry->u32Addr == u32Addr);
+
+            if(u32Copy)
+            {
+                i32Ret = KVS_Alloc(psKvs, u32Size, 0, &u32Dst);
+                if(i32Ret != 0)
+                    return i32Ret;
+
+                /* The copy is committed by its last word like any other record */
+                for(i = 0; i < u32Size; i += 4)
+                {
+                    if(FMC_Write(u32Dst + i, M32(u32Addr + i)) != 0)
+                        return KVS_ERR_FLASH;
+                }
+                if(psEntry != NULL)
+                    psEntry->u32Addr = u32Dst;
+            }
+
+            u32Addr += u32Size;
+        }
+    }
+
+    /* Every live record and needed delete record has a newer copy now. An interrupted erase leaves only
+       stale records behind. */
+    psKvs->u32Erases++;
+    if(FMC_Erase(KVS_PAGE_ADDR(psKvs, u32Page)) != 0)
+        return KVS_ERR_FLASH;
+
+    psKvs->u32Tail = (u32Page + 1) % psKvs->u32PageNum;
+    psKvs->u32Used--;
+
+    return 0;
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Open a key/value store and build its RAM index.
+  * @param[out] psKvs The pointer of the store control block.
+  * @param[in]  u32Base Address of the first store page, page aligned in data flash. See FMC_ReadDataFlashBaseAddr().
+  * @param[in]  u32PageNum Number of consecutive store pages, 3 or more.
+  * @param[in]  psIndex RAM index, one entry per key.
+  * @param[in]  u32IndexSize Entries of psIndex.
+  * @retval     0 Success
+  * @retval     KVS_ERR_PARAM Invalid parameter
+  * @retval     KVS_ERR_NO_INDEX The store holds more keys than psIndex
+  * @retval     KVS_ERR_FLASH An empty store could not be started
+  * @details    Pages are replayed once from the oldest to the newest. A later record of a key overrides an earlier
+  *             one and a delete record removes the key. A record without a valid commit word is skipped.
+  *             An area holding no store page is started with an empty head page.
+  * @note       ISP must be enabled by FMC_Open() with the protected registers unlocked. Store functions use
+  *             FMC ISP commands and must not be called from interrupt handlers.
+  */
+int32_t KVS_Open(KVS_T *psKvs, uint32_t u32Base, uint32_t u32PageNum, KVS_ENTRY_T *psIndex, uint32_t u32IndexSize)
+{
+    uint32_t u32Page, u32Seq, u32Addr, u32End, u32Hdr = 0, u32State;
+    uint32_t u32Found = 0;
+    int32_t i32Ret;
+
+    if((psKvs == NULL) || (psIndex == NULL) || (u32IndexSize == 0) || (u32PageNum < 3) || (u32Base & (KVS_PAGE_SIZE - 1)))
+        return KVS_ERR_PARAM;
+
+    memset(psKvs, 0, sizeof(KVS_T));
+    psKvs->u32Base = u32Base;
+    psKvs->u32PageNum = u32PageNum;
+    psKvs->psIndex = psIndex;
+    psKvs->u32IndexSize = u32IndexSize;
+
+    /* The oldest and newest headers bound the ring of pages in use */
+    for(u32Page = 0; u32Page < u32PageNum; u32Page++)
+    {
+        if(!KVS_PageValid(psKvs, u32Page))
+            continue;
+
+        u32Seq = M32(KVS_PAGE_ADDR(psKvs, u32Page) + 4);
+        if(!u32Found || (u32Seq > psKvs->u32Seq))
+        {
+            psKvs->u32Seq = u32Seq;
+            psKvs->u32Head = u32Page;
+        }
+        if(!u32Found || (u32Seq < M32(KVS_PAGE_ADDR(psKvs, psKvs->u32Tail) + 4)))
+            psKvs->u32Tail = u32Page;
+        u32Found = 1;
+    }
+
+    if(!u32Found)
+        return KVS_NewPage(psKvs);
+
+    psKvs->u32Used = (psKvs->u32Head + u32PageNum - psKvs->u32Tail) % u32PageNum + 1;
+
+    u32Page = psKvs->u32Tail;
+    while(1)
+    {
+        u32Addr = KVS_PAGE_ADDR(psKvs, u32Page) + KVS_HDR_SIZE;
+        u32End = KVS_PAGE_ADDR(psKvs, u32Page) + KVS_PAGE_SIZE;
+
+        if(KVS_PageValid(psKvs, u32Page))
+        {
+            while((u32State = KVS_Record(u32Addr, u32End, &u32Hdr)) != KVS_REC_END)
+            {
+                if(u32State == KVS_REC_VALID)
+                {
+                    i32Ret = KVS_Apply(psKvs, u32Addr, u32Hdr);
+                    if(i32Ret != 0)
+                        return i32Ret;
+                }
+                u32Addr += KVS_REC_SIZE((u32Hdr >> 16) & 0xFF);
+            }
+        }
+
+        if(u32Page == psKvs->u32Head)
+            break;
+        u32Page = (u32Page + 1) % u32PageNum;
+    }
+
+    /* Append after the last record. Past an unreadable header the rest of the head page is given up. */
+    psKvs->u32Off = ((u32Addr < u32End) && (M32(u32Addr) != 0xFFFFFFFF)) ? KVS_PAGE_SIZE : (u32Addr - (u32End - KVS_PAGE_SIZE));
+
+    return 0;
+}
+
+/**
+  * @brief      Read the value of a key.
+  * @param[in]  psKvs The pointer of the store control block.
+  * @param[in]  u32Key Key, 0 ~ 0xFFFE.
+  * @param[out] pvBuf Buffer for the value.
+  * @param[in]  u32Size Size of pvBuf. A longer value is truncated.
+  * @return     Value length in bytes, or KVS_ERR_NOT_FOUND if the key is not stored.
+  * @details    The value is read from data flash through the RAM index without an ISP command.
+  */
+int32_t KVS_Get(KVS_T *psKvs, uint32_t u32Key, void *pvBuf, uint32_t u32Size)
+{
+    KVS_ENTRY_T *psEntry = KVS_Find(psKvs, u32Key);
+
+    if(psEntry == NULL)
+        return KVS_ERR_NOT_FOUND;
+
+    if(u32Size > psEntry->u16Len)
+        u32Size = psEntry->u16Len;
+    memcpy(pvBuf, (const void *)(psEntry->u32Addr + 4), u32Size);
+
+    return psEntry->u16Len;
+}
+
+/**
+  * @brief      Store the value of a key.
+  * @param[in]  psKvs The pointer of the store control block.
+  * @param[in]  u32Key Key, 0 ~ 0xFFFE.
+  * @param[in]  pvData Value.
+  * @param[in]  u32Len Value length, 0 ~ \ref KVS_MAX_VALUE.
+  * @retval     0 Success
+  * @retval     KVS_ERR_PARAM Invalid parameter
+  * @retval     KVS_ERR_NO_INDEX New key and the RAM index is full
+  * @retval     KVS_ERR_FULL Live records do not fit the store
+  * @retval     KVS_ERR_FLASH Flash program or erase failed, the previous value stays in effect
+  * @details    The value is appended as a new record and nothing is written if it equals the stored value.
+  *             A page is erased only when the erased pages run out, which KVS_Maintain() normally prevents.
+  */
+int32_t KVS_Set(KVS_T *psKvs, uint32_t u32Key, const void *pvData, uint32_t u32Len)
+{
+    const uint8_t *pu8Data = (const uint8_t *)pvData;
+    KVS_ENTRY_T *psEntry;
+    uint32_t u32Hdr, u32Commit, u32Size, u32Addr, u32Word, i, j;
+    uint32_t u32Tries;
+    int32_t i32Ret;
+
+    if((u32Key >= KVS_KEY_INVALID) || (u32Len > KVS_MAX_VALUE) || ((pvData == NULL) && (u32Len != 0)))
+        return KVS_ERR_PARAM;
+
+    psEntry = KVS_Find(psKvs, u32Key);
+    if(psEntry == NULL)
+    {
+        if(psKvs->u32Keys >= psKvs->u32IndexSize)
+            return KVS_ERR_NO_INDEX;
+    }
+    else if((psEntry->u16Len == u32Len) && (memcmp((const void *)(psEntry->u32Addr + 4), pu8Data, u32Len) == 0))
+    {
+        return 0;
+    }
+
+    u32Hdr = u32Key | (u32Len << 16) | (KVS_TAG_VALUE << 24);
+    u32Commit = KVS_Commit(u32Hdr, pu8Data, u32Len);
+    u32Size = KVS_REC_SIZE(u32Len);
+
+    /* Out of erased pages: compact in the foreground, at most once per page in use */
+    u32Tries = psKvs->u32Used;
+    while((i32Ret = KVS_Alloc(psKvs, u32Size, 1, &u32Addr)) == KVS_ERR_FULL)
+    {
+        if(u32Tries-- == 0)
+            return KVS_ERR_FULL;
+        i32Ret = KVS_CompactTail(psKvs);
+        if(i32Ret != 0)
+            return i32Ret;
+    }
+    if(i32Ret != 0)
+        return i32Ret;
+
+    if(FMC_Write(u32Addr, u32Hdr) != 0)
+        return KVS_ERR_FLASH;
+
+    for(i = 0; i < u32Len; i += 4)
+    {
+        u32Word = 0xFFFFFFFF;
+        for(j = 0; (j < 4) && (i + j < u32Len); j++)
+            u32Word = (u32Word & ~(0xFFUL << (j * 8))) | ((uint32_t)pu8Data[i + j] << (j * 8));
+
+        if(FMC_Write(u32Addr + 4 + i, u32Word) != 0)
+            return KVS_ERR_FLASH;
+    }
+
+    if(FMC_Write(u32Addr + u32Size - 4, u32Commit) != 0)
+        return KVS_ERR_FLASH;
+
+    return KVS_Apply(psKvs, u32Addr, u32Hdr);
+}
+
+/**
+  * @brief      Delete a key.
+  * @param[in]  psKvs The pointer of the store control block.
+  * @param[in]  u32Key Key, 0 ~ 0xFFFE.
+  * @retval     0 Success
+  * @retval     KVS_ERR_NOT_FOUND The key is not stored
+  * @retval     KVS_ERR_FULL No room for the delete record
+  * @retval     KVS_ERR_FLASH Flash program or erase failed, the key stays stored
+  * @details    A delete record is appended. It is copied forward when its page is compacted while that page
+  *             holds an older record of the key, and dropped when the page of the copy is compacted.
+  */
+int32_t KVS_Delete(KVS_T *psKvs, uint32_t u32Key)
+{
+    uint32_t u32Hdr, u32Addr, u32Tries;
+    int32_t i32Ret;
+
+    if(KVS_Find(psKvs, u32Key) == NULL)
+        return KVS_ERR_NOT_FOUND;
+
+    u32Hdr = u32Key | (KVS_TAG_DELETE << 24);
+
+    u32Tries = psKvs->u32Used;
+    while((i32Ret = KVS_Alloc(psKvs, KVS_REC_SIZE(0), 1, &u32Addr)) == KVS_ERR_FULL)
+    {
+        if(u32Tries-- == 0)
+            return KVS_ERR_FULL;
+        i32Ret = KVS_CompactTail(psKvs);
+        if(i32Ret != 0)
+            return i32Ret;
+    }
+    if(i32Ret != 0)
+        return i32Ret;
+
+    if((FMC_Write(u32Addr, u32Hdr) != 0) || (FMC_Write(u32Addr + 4, KVS_Commit(u32Hdr, NULL, 0)) != 0))
+        return KVS_ERR_FLASH;
+
+    return KVS_Apply(psKvs, u32Addr, u32Hdr);
+}
+
+/**
+  * @brief      Do background store work.
+  * @param[in]  psKvs The pointer of the store control block.
+  * @retval     1 A page was compacted or erased
+  * @retval     0 Nothing to do
+  * @retval     <0 KVS_ERR_FULL or KVS_ERR_FLASH
+  * @details    Call this function from the idle loop. When only the compaction spare page is left erased,
+  *             the oldest page is compacted if it holds reclaimable space. Otherwise the page after the head is erased ahead of time if it
+  *             is not blank, e.g. after a power failure. Each call does at most one page erase.
+  */
+int32_t KVS_Maintain(KVS_T *psKvs)
+{
+    uint32_t u32Next = (psKvs->u32Head + 1) % psKvs->u32PageNum;
+    uint32_t u32Erases = psKvs->u32Erases;
+    int32_t i32Ret;
+
+    /* A fully live oldest page is left alone, moving it would only add wear */
+    if((KVS_GET_FREE_PAGES(psKvs) <= 1) && (psKvs->u32Used >= 2) && KVS_TailReclaimable(psKvs))
+    {
+        i32Ret = KVS_CompactTail(psKvs);
+        return (i32Ret != 0) ? i32Ret : 1;
+    }
+
+    if(KVS_GET_FREE_PAGES(psKvs) != 0)
+    {
+        i32Ret = KVS_ErasePage(psKvs, u32Next);
+        if(i32Ret != 0)
+            return i32Ret;
+    }
+
+    return (psKvs->u32Erases != u32Erases) ? 1 : 0;
+}
+
+/**
+  * @brief      Erase all store pages and clear the RAM index.
+  * @param[in]  psKvs The pointer of the store control block opened by KVS_Open().
+  * @retval     0 Success
+  * @retval     KVS_ERR_FLASH Flash erase or program failed
+  */
+int32_t KVS_Format(KVS_T *psKvs)
+{
+    uint32_t u32Page;
+
+    for(u32Page = 0; u32Page < psKvs->u32PageNum; u32Page++)
+    {
+        if(KVS_ErasePage(psKvs, u32Page) != 0)
+            return KVS_ERR_FLASH;
+    }
+
+    psKvs->u32Keys = 0;
+    psKvs->u32Used = 0;
+    psKvs->u32Head = 0;
+
+    return KVS_NewPage(psKvs);
+}
+
+
+/*@}*/ /* end of group KVS_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group KVS_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
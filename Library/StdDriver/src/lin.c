@@ -0,0 +1,642 @@
+/**************************************************************************//**
+ * @file     lin.c
+ * @version  V3.00
+ * @brief    NUC1311 series LIN 2.x protocol stack source file
+ *
+ * @note     Everything runs from interrupts. The master time base TIMER interrupt ends the current slot and
+ *           starts the next header in hardware (break, sync and protected ID by LIN_SHD) as its first action,
+ *           so the schedule jitter is the interrupt latency. The UART interrupt follows the read-back of the
+ *           header on the bus, then queues a published response in the TX FIFO or collects a subscribed one.
+ *           Slaves use hardware header detection with ID parity check and look the frame up by identifier.
+ *           Published checksums are computed when the data is written; received checksums are summed per byte.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "lin.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup LIN_Driver LIN Protocol Stack
+  @{
+*/
+
+/** @addtogroup LIN_EXPORTED_FUNCTIONS LIN Protocol Stack Exported Functions
+  @{
+*/
+
+/** Protected identifier of each frame identifier */
+const uint8_t g_au8LinPid[LIN_ID_NUM] =
+{
+    0x80, 0xC1, 0x42, 0x03, 0xC4, 0x85, 0x06, 0x47,
+    0x08, 0x49, 0xCA, 0x8B, 0x4C, 0x0D, 0x8E, 0xCF,
+    0x50, 0x11, 0x92, 0xD3, 0x14, 0x55, 0xD6, 0x97,
+    0xD8, 0x99, 0x1A, 0x5B, 0x9C, 0xDD, 0x5E, 0x1F,
+    0x20, 0x61, 0xE2, 0xA3, 0x64, 0x25, 0xA6, 0xE7,
+    0xA8, 0xE9, 0x6A, 0x2B, 0xEC, 0xAD, 0x2E, 0x6F,
+    0xF0, 0xB1, 0x32, 0x73, 0xB4, 0xF5, 0x76, 0x37,
+    0x78, 0x39, 0xBA, 0xFB, 0x3C, 0x7D, 0xFE, 0xBF,
+};
+
+/// @cond HIDDEN_SYMBOLS
+
+#define LIN_STATE_IDLE      0   /* No frame in progress */
+#define LIN_STATE_SYNC      1   /* Master: waiting for the read-back of the sync field */
+#define LIN_STATE_PID       2   /* Master: waiting for the read-back of the protected ID */
+#define LIN_STATE_RESP      3   /* Response in progress */
+
+#define LIN_SR_ALL          (UART_LIN_SR_BIT_ERR_F_Msk | UART_LIN_SR_LINS_BKDET_F_Msk | UART_LIN_SR_LINS_IDPERR_F_Msk | \
+                             UART_LIN_SR_LINS_HERR_F_Msk | UART_LIN_SR_LINS_HDET_F_Msk)
+
+static IRQn_Type LIN_GetUartIRQn(UART_T *uart)
+{
+    return (uart == UART1) ? UART1_IRQn : UART02_IRQn;
+}
+
+static IRQn_Type LIN_GetTimerIRQn(TIMER_T *timer)
+{
+    if(timer == TIMER0)
+        return TMR0_IRQn;
+    if(timer == TIMER1)
+        return TMR1_IRQn;
+    if(timer == TIMER2)
+        return TMR2_IRQn;
+    return TMR3_IRQn;
+}
+
+/* One's complement sum with end-around carry, as used by the LIN checksum */
+static uint32_t LIN_Sum(uint32_t u32Sum, const uint8_t *pu8Data, uint32_t u32Len)
+{
+    while(u32Len--)
+    {
+        u32Sum += *pu8Data++;
+        if(u32Sum >= 256)
+            u32Sum -= 255;
+    }
+    return u32Sum;
+}
+
+static void LIN_OpenUart(LIN_T *psLin, UART_T *uart, uint32_t u32LinCtl)
+{
+    uint32_t i;
+
+    psLin->uart = uart;
+    psLin->timer = NULL;
+    psLin->psSched = NULL;
+    psLin->psNextSched = NULL;
+    psLin->u8NextSet = 0;
+    psLin->psFrame = NULL;
+    psLin->u8State = LIN_STATE_IDLE;
+    for(i = 0; i < LIN_ID_NUM; i++)
+        psLin->apsFrame[i] = NULL;
+    psLin->sStat.u32Frames = 0;
+    psLin->sStat.u32NoResponse = 0;
+    psLin->sStat.u32FrameErrors = 0;
+    psLin->sStat.u32ChecksumErrors = 0;
+    psLin->sStat.u32BitErrors = 0;
+    psLin->sStat.u32HeaderErrors = 0;
+
+    uart->IER = 0;
+    uart->FUN_SEL = UART_FUNC_SEL_LIN;
+    uart->ALT_CSR &= ~(UART_ALT_CSR_LIN_TX_EN_Msk | UART_ALT_CSR_LIN_RX_EN_Msk);
+    uart->LCR = UART_WORD_LEN_8 | UART_PARITY_NONE | UART_STOP_BIT_1;
+    uart->FCR = (uart->FCR & ~(UART_FCR_RFITL_Msk | UART_FCR_RX_DIS_Msk)) | UART_FCR_RFITL_1BYTE |
+                UART_FCR_RFR_Msk | UART_FCR_TFR_Msk;
+    uart->LIN_CTL = u32LinCtl;
+    uart->LIN_SR = LIN_SR_ALL;
+    UART_ClearIntFlag(uart, UART_ISR_RLS_INT_Msk | UART_ISR_BUF_ERR_INT_Msk);
+    UART_ENABLE_INT(uart, UART_IER_RDA_IEN_Msk | UART_IER_RLS_IEN_Msk | UART_IER_LIN_IEN_Msk | UART_IER_BUF_ERR_IEN_Msk);
+
+    NVIC_EnableIRQ(LIN_GetUartIRQn(uart));
+}
+
+static void LIN_Report(LIN_T *psLin, LIN_FRAME_T *psFrame, int32_t i32Status)
+{
+    switch(i32Status)
+    {
+        case 0:
+            psLin->sStat.u32Frames++;
+            break;
+        case LIN_ERR_NO_RESPONSE:
+            psLin->sStat.u32NoResponse++;
+            break;
+        case LIN_ERR_FRAME:
+            psLin->sStat.u32FrameErrors++;
+            break;
+        case LIN_ERR_CHECKSUM:
+            psLin->sStat.u32ChecksumErrors++;
+            break;
+        case LIN_ERR_BIT:
+            psLin->sStat.u32BitErrors++;
+            break;
+        default:
+            psLin->sStat.u32HeaderErrors++;
+            break;
+    }
+
+    if((psFrame != NULL) && (psFrame->pfnDone != NULL))
+        psFrame->pfnDone(psLin, psFrame, i32Status);
+}
+
+static void LIN_Done(LIN_T *psLin, int32_t i32Status)
+{
+    LIN_FRAME_T *psFrame = psLin->psFrame;
+
+    psLin->u8State = LIN_STATE_IDLE;
+    psLin->psFrame = NULL;
+    LIN_Report(psLin, psFrame, i32Status);
+}
+
+/* Error status of a frame that did not complete */
+static int32_t LIN_OpenStatus(LIN_T *psLin, int32_t i32Status)
+{
+    if(psLin->u8State != LIN_STATE_RESP)
+        return LIN_ERR_HEADER;
+    if((i32Status == LIN_ERR_FRAME) && (psLin->u8Pos == 0))
+        return LIN_ERR_NO_RESPONSE;
+    return i32Status;
+}
+
+/* Header done on the bus: queue or expect the response */
+static void LIN_StartResponse(LIN_T *psLin)
+{
+    LIN_FRAME_T *psFrame = psLin->psFrame;
+    UART_T *uart = psLin->uart;
+    uint32_t i;
+
+    psLin->u8Pos = 0;
+    psLin->u32Sum = psFrame->u8Seed;
+    psLin->u8State = LIN_STATE_RESP;
+
+    if(psFrame->u8Dir == LIN_FRAME_PUBLISH)
+    {
+        /* Snapshot for the read-back, the application could update the frame meanwhile */
+        for(i = 0; i < psFrame->u8Len; i++)
+            psLin->au8Buf[i] = psFrame->au8Data[i];
+        psLin->au8Buf[i] = psFrame->u8Checksum;
+
+        for(i = 0; i <= psFrame->u8Len; i++)
+            uart->THR = psLin->au8Buf[i];
+    }
+}
+
+static void LIN_ResponseByte(LIN_T *psLin, uint32_t u32Data)
+{
+    LIN_FRAME_T *psFrame = psLin->psFrame;
+    uint32_t u32Pos = psLin->u8Pos;
+    uint32_t i;
+
+    if(psFrame->u8Dir == LIN_FRAME_PUBLISH)
+    {
+        if(psLin->au8Buf[u32Pos] != u32Data)
+        {
+            LIN_Done(psLin, LIN_ERR_BIT);
+            return;
+        }
+    }
+    else
+    {
+        psLin->au8Buf[u32Pos] = (uint8_t)u32Data;
+        if(u32Pos < psFrame->u8Len)
+        {
+            psLin->u32Sum += u32Data;
+            if(psLin->u32Sum >= 256)
+                psLin->u32Sum -= 255;
+        }
+    }
+
+    psLin->u8Pos = (uint8_t)++u32Pos;
+    if(u32Pos <= psFrame->u8Len)
+        return;
+
+    if(psFrame->u8Dir == LIN_FRAME_SUBSCRIBE)
+    {
+        if(psLin->u32Sum + u32Data != 0xFF)
+        {
+            LIN_Done(psLin, LIN_ERR_CHECKSUM);
+            return;
+        }
+
+        for(i = 0; i < psFrame->u8Len; i++)
+            psFrame->au8Data[i] = psLin->au8Buf[i];
+        psFrame->u8Checksum = (uint8_t)u32Data;
+        psFrame->u8Updated = 1;
+    }
+
+    LIN_Done(psLin, 0);
+}
+
+/* Abort a frame in progress, e.g. on a new header */
+static void LIN_Abort(LIN_T *psLin, int32_t i32Status)
+{
+    if(psLin->u8State != LIN_STATE_IDLE)
+        LIN_Done(psLin, LIN_OpenStatus(psLin, i32Status));
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Initialize a frame.
+  * @param[in]  psFrame      Frame to initialize. It must stay valid while it is in a schedule or slave table.
+  * @param[in]  u32Id        Frame identifier, 0 ~ 63.
+  * @param[in]  u32Len       Data length, 1 ~ 8.
+  * @param[in]  u32Dir       \ref LIN_FRAME_PUBLISH or \ref LIN_FRAME_SUBSCRIBE, seen from this node.
+  * @param[in]  u32Checksum  \ref LIN_CHECKSUM_CLASSIC or \ref LIN_CHECKSUM_ENHANCED.
+  * @param[in]  pfnDone      Called in interrupt context after each transfer of the frame. Could be NULL.
+  * @retval     0               Success
+  * @retval     LIN_ERR_PARAM   Invalid parameter
+  * @details    The data is cleared. The PID and the checksum start value are computed once here.
+  */
+int32_t LIN_InitFrame(LIN_FRAME_T *psFrame, uint32_t u32Id, uint32_t u32Len, uint32_t u32Dir, uint32_t u32Checksum, LIN_FRAME_FUNC_T pfnDone)
+{
+    uint32_t i;
+
+    if((u32Id >= LIN_ID_NUM) || (u32Len == 0) || (u32Len > LIN_MAX_DATA) || (u32Dir > LIN_FRAME_SUBSCRIBE))
+        return LIN_ERR_PARAM;
+
+    psFrame->u8Id = (uint8_t)u32Id;
+    psFrame->u8Pid = LIN_GET_PID(u32Id);
+    psFrame->u8Len = (uint8_t)u32Len;
+    psFrame->u8Dir = (uint8_t)u32Dir;
+
+    /* Diagnostic frames always use the classic checksum */
+    psFrame->u8Seed = ((u32Checksum == LIN_CHECKSUM_ENHANCED) && (u32Id < 60)) ? psFrame->u8Pid : 0;
+
+    for(i = 0; i < LIN_MAX_DATA; i++)
+        psFrame->au8Data[i] = 0;
+    psFrame->u8Checksum = (uint8_t)(0xFF - LIN_Sum(psFrame->u8Seed, psFrame->au8Data, u32Len));
+    psFrame->u8Updated = 0;
+    psFrame->pfnDone = pfnDone;
+
+    return 0;
+}
+
+/**
+  * @brief      Update the data of a published frame.
+  * @param[in]  psFrame  Frame initialized by LIN_InitFrame().
+  * @param[in]  pu8Data  New data, u8Len bytes.
+  * @return     None
+  * @details    The checksum is computed here, outside the interrupt. The next transfer sends either the old or the
+  *             new data, never a mix.
+  */
+void LIN_WriteFrame(LIN_FRAME_T *psFrame, const uint8_t *pu8Data)
+{
+    uint32_t u32Checksum, u32PriMask, i;
+
+    u32Checksum = 0xFF - LIN_Sum(psFrame->u8Seed, pu8Data, psFrame->u8Len);
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    for(i = 0; i < psFrame->u8Len; i++)
+        psFrame->au8Data[i] = pu8Data[i];
+    psFrame->u8Checksum = (uint8_t)u32Checksum;
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Read the data of a subscribed frame.
+  * @param[in]  psFrame  Frame initialized by LIN_InitFrame().
+  * @param[out] pu8Data  Buffer for u8Len bytes.
+  * @return     1 if the frame was received since the last call, otherwise 0.
+  */
+uint32_t LIN_ReadFrame(LIN_FRAME_T *psFrame, uint8_t *pu8Data)
+{
+    uint32_t u32Updated, u32PriMask, i;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    for(i = 0; i < psFrame->u8Len; i++)
+        pu8Data[i] = psFrame->au8Data[i];
+    u32Updated = psFrame->u8Updated;
+    psFrame->u8Updated = 0;
+    __set_PRIMASK(u32PriMask);
+
+    return u32Updated;
+}
+
+/**
+  * @brief      Open a LIN master node.
+  * @param[in]  psLin      Node control block. It must stay valid while the node is open.
+  * @param[in]  uart       The pointer of the specified UART module, UART0 ~ UART2. It must be opened with UART_Open()
+  *                        at the bus baud rate.
+  * @param[in]  timer      The pointer of the Timer module dedicated to the schedule time base. Its clock source must be
+  *                        selected and enabled.
+  * @param[in]  u32TickUs  Time base in microseconds, typically 1000 or 5000.
+  * @retval     0               Success
+  * @retval     LIN_ERR_PARAM   Invalid parameter
+  * @details    The schedule starts with LIN_MasterSetSchedule(). LIN_IRQHandler() must be called from the UART
+  *             interrupt handler and LIN_TimerIRQHandler() from the TIMER interrupt handler. Give the TIMER interrupt
+  *             the highest priority so the headers start on time.
+  */
+int32_t LIN_MasterOpen(LIN_T *psLin, UART_T *uart, TIMER_T *timer, uint32_t u32TickUs)
+{
+    if((uart == UART3) || (timer == NULL) || (u32TickUs == 0) || (u32TickUs > 1000000))
+        return LIN_ERR_PARAM;
+
+    LIN_OpenUart(psLin, uart, UART_LIN_CTL_BIT_ERR_EN_Msk);
+
+    psLin->timer = timer;
+    psLin->u32SchedNum = 0;
+    psLin->u32SchedIdx = 0;
+    psLin->u32SlotLeft = 1;
+
+    TIMER_Open(timer, TIMER_PERIODIC_MODE, 1000000 / u32TickUs);
+    TIMER_EnableInt(timer);
+    NVIC_EnableIRQ(LIN_GetTimerIRQn(timer));
+
+    return 0;
+}
+
+/**
+  * @brief      Select the master schedule table.
+  * @param[in]  psLin     Node opened by LIN_MasterOpen().
+  * @param[in]  psSched   Schedule table. It must stay valid while it runs. NULL stops the schedule at the end of the slot.
+  * @param[in]  u32Num    Number of entries.
+  * @retval     0               Success
+  * @retval     LIN_ERR_PARAM   Invalid parameter
+  * @details    The new table starts with its first entry when the current slot ends. The table is started over after
+  *             its last entry. Each slot must be long enough for its frame, 1.4 times the nominal frame time.
+  */
+int32_t LIN_MasterSetSchedule(LIN_T *psLin, const LIN_SCHED_T *psSched, uint32_t u32Num)
+{
+    uint32_t u32PriMask, i;
+
+    if((psSched != NULL) && (u32Num == 0))
+        return LIN_ERR_PARAM;
+
+    for(i = 0; (psSched != NULL) && (i < u32Num); i++)
+    {
+        if(psSched[i].u32Slots == 0)
+            return LIN_ERR_PARAM;
+    }
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    psLin->psNextSched = psSched;
+    psLin->u32NextNum = (psSched != NULL) ? u32Num : 0;
+    if(psLin->psSched == NULL)
+    {
+        /* Idle, start with the next tick */
+        psLin->psSched = psSched;
+        psLin->u32SchedNum = psLin->u32NextNum;
+        psLin->u32SchedIdx = u32Num - 1;
+        psLin->u32SlotLeft = 1;
+        psLin->psNextSched = NULL;
+        psLin->u8NextSet = 0;
+    }
+    else
+    {
+        /* Taken by LIN_TimerIRQHandler() at the end of the slot, NULL as well */
+        psLin->u8NextSet = 1;
+    }
+    __set_PRIMASK(u32PriMask);
+
+    return 0;
+}
+
+/**
+  * @brief      Open a LIN slave node.
+  * @param[in]  psLin     Node control block. It must stay valid while the node is open.
+  * @param[in]  uart      The pointer of the specified UART module, UART0 ~ UART2. It must be opened with UART_Open()
+  *                       at the bus baud rate.
+  * @param[in]  u32Flags  0 or \ref LIN_SLAVE_AUTO_RESYNC.
+  * @retval     0               Success
+  * @retval     LIN_ERR_PARAM   Invalid parameter
+  * @details    Frames are added with LIN_SlaveAddFrame(). LIN_IRQHandler() must be called from the UART interrupt handler.
+  */
+int32_t LIN_SlaveOpen(LIN_T *psLin, UART_T *uart, uint32_t u32Flags)
+{
+    uint32_t u32LinCtl;
+
+    if(uart == UART3)
+        return LIN_ERR_PARAM;
+
+    u32LinCtl = UART_LIN_CTL_LINS_EN_Msk | UART_LIN_CTL_LINS_HDET_EN_Msk | UART_LIN_CTL_LIN_BKDET_EN_Msk |
+                UART_LIN_CTL_LIN_IDPEN_Msk | UART_LIN_CTL_BIT_ERR_EN_Msk;
+    if(u32Flags & LIN_SLAVE_AUTO_RESYNC)
+        u32LinCtl |= UART_LIN_CTL_LINS_ARS_EN_Msk | UART_LIN_CTL_LINS_DUM_EN_Msk;
+
+    LIN_OpenUart(psLin, uart, u32LinCtl);
+
+    return 0;
+}
+
+/**
+  * @brief      Add a frame to the slave response table.
+  * @param[in]  psLin    Node opened by LIN_SlaveOpen().
+  * @param[in]  psFrame  Frame initialized by LIN_InitFrame(). It replaces a frame with the same identifier.
+  * @retval     0               Success
+  * @retval     LIN_ERR_PARAM   Invalid parameter
+  */
+int32_t LIN_SlaveAddFrame(LIN_T *psLin, LIN_FRAME_T *psFrame)
+{
+    if(psFrame->u8Id >= LIN_ID_NUM)
+        return LIN_ERR_PARAM;
+
+    psLin->apsFrame[psFrame->u8Id] = psFrame;
+
+    return 0;
+}
+
+/**
+  * @brief      Close a LIN node.
+  * @param[in]  psLin  Node control block.
+  * @return     None
+  */
+void LIN_Close(LIN_T *psLin)
+{
+    if(psLin->timer != NULL)
+    {
+        NVIC_DisableIRQ(LIN_GetTimerIRQn(psLin->timer));
+        TIMER_Close(psLin->timer);
+        psLin->timer = NULL;
+    }
+
+    NVIC_DisableIRQ(LIN_GetUartIRQn(psLin->uart));
+    UART_Close(psLin->uart);
+    psLin->uart->LIN_CTL = 0;
+    psLin->uart->FUN_SEL = UART_FUNC_SEL_UART;
+    psLin->psSched = NULL;
+    psLin->u8NextSet = 0;
+    psLin->u8State = LIN_STATE_IDLE;
+}
+
+/**
+  * @brief      LIN master time base interrupt handler.
+  * @param[in]  psLin  Node opened by LIN_MasterOpen().
+  * @return     None
+  * @details    Must be called from the interrupt handler of the TIMER passed to LIN_MasterOpen().
+  */
+void LIN_TimerIRQHandler(LIN_T *psLin)
+{
+    UART_T *uart = psLin->uart;
+    LIN_FRAME_T *psFrame;
+    LIN_FRAME_T *psLate;
+    int32_t i32Status = 0;
+
+    TIMER_ClearIntFlag(psLin->timer);
+
+    if(--psLin->u32SlotLeft != 0)
+        return;
+
+    if(psLin->u8NextSet)
+    {
+        psLin->psSched = psLin->psNextSched;
+        psLin->u32SchedNum = psLin->u32NextNum;
+        psLin->u32SchedIdx = psLin->u32NextNum - 1;
+        psLin->psNextSched = NULL;
+        psLin->u8NextSet = 0;
+    }
+
+    if(psLin->psSched == NULL)
+    {
+        /* Stopped, only a frame of the last slot is left to close */
+        psLin->u32SlotLeft = 1;
+        if(psLin->psFrame == NULL)
+            return;
+        psFrame = NULL;
+    }
+    else
+    {
+        if(++psLin->u32SchedIdx >= psLin->u32SchedNum)
+            psLin->u32SchedIdx = 0;
+
+        psLin->u32SlotLeft = psLin->psSched[psLin->u32SchedIdx].u32Slots;
+        psFrame = psLin->psSched[psLin->u32SchedIdx].psFrame;
+    }
+
+    /* A frame of the last slot still open is reported after the new header is on its way */
+    psLate = psLin->psFrame;
+    if(psLin->u8State != LIN_STATE_IDLE)
+        i32Status = LIN_OpenStatus(psLin, LIN_ERR_FRAME);
+
+    psLin->psFrame = psFrame;
+    psLin->u8State = (psFrame != NULL) ? LIN_STATE_SYNC : LIN_STATE_IDLE;
+
+    if(psFrame != NULL)
+    {
+        uart->FCR |= UART_FCR_RFR_Msk;
+        uart->LIN_CTL = UART_LIN_CTL_LIN_LIN_PID(psFrame->u8Pid) | UART_LIN_CTL_LIN_HEAD_SEL_BREAK_SYNC_ID |
+                        UART_LIN_CTL_LIN_BS_LEN(1) | UART_LIN_CTL_LIN_BKFL(LIN_BREAK_BITS) |
+                        UART_LIN_CTL_BIT_ERR_EN_Msk | UART_LIN_CTL_LIN_SHD_Msk;
+    }
+
+    if(psLate != NULL)
+        LIN_Report(psLin, psLate, i32Status);
+}
+
+/**
+  * @brief      LIN interrupt handler.
+  * @param[in]  psLin  Node control block.
+  * @return     None
+  * @details    Must be called from the interrupt handler of the LIN UART. UART0 and UART2 share one handler, which
+  *             calls this function for each open node.
+  */
+void LIN_IRQHandler(LIN_T *psLin)
+{
+    UART_T *uart = psLin->uart;
+    uint32_t u32Isr = uart->ISR;
+    uint32_t u32Sr, u32Fsr, u32Data;
+    LIN_FRAME_T *psFrame;
+
+    if(u32Isr & UART_ISR_BUF_ERR_INT_Msk)
+    {
+        UART_ClearIntFlag(uart, UART_ISR_BUF_ERR_INT_Msk);
+        LIN_Abort(psLin, LIN_ERR_FRAME);
+    }
+
+    if(u32Isr & UART_ISR_LIN_INT_Msk)
+    {
+        u32Sr = uart->LIN_SR;
+        uart->LIN_SR = u32Sr & LIN_SR_ALL;
+        uart->ISR = UART_ISR_LIN_IF_Msk;
+
+        if(u32Sr & UART_LIN_SR_BIT_ERR_F_Msk)
+            LIN_Abort(psLin, LIN_ERR_BIT);
+
+        if(u32Sr & UART_LIN_SR_LINS_HERR_F_Msk)
+        {
+            /* Restart the header search */
+            uart->LIN_SR = UART_LIN_SR_LINS_SYNC_F_Msk;
+            LIN_Abort(psLin, LIN_ERR_FRAME);
+            psLin->sStat.u32HeaderErrors++;
+        }
+        else if(u32Sr & UART_LIN_SR_LINS_HDET_F_Msk)
+        {
+            /* A new header ends any response still open */
+            LIN_Abort(psLin, LIN_ERR_FRAME);
+
+            if(u32Sr & UART_LIN_SR_LINS_IDPERR_F_Msk)
+                psLin->sStat.u32HeaderErrors++;
+            else
+            {
+                /* The protected ID is the last byte received */
+                while((uart->FSR & UART_FSR_RX_EMPTY_Msk) == 0)
+                    psLin->u8Last = (uint8_t)uart->RBR;
+
+                psFrame = psLin->apsFrame[psLin->u8Last & 0x3F];
+                if(psFrame != NULL)
+                {
+                    psLin->psFrame = psFrame;
+                    LIN_StartResponse(psLin);
+                }
+            }
+        }
+        else if((u32Sr & UART_LIN_SR_LINS_BKDET_F_Msk) && (psLin->timer == NULL))
+            LIN_Abort(psLin, LIN_ERR_FRAME);
+    }
+
+    if(u32Isr & UART_ISR_RLS_INT_Msk)
+    {
+        u32Fsr = uart->FSR;
+        uart->FSR = UART_FSR_BIF_Msk | UART_FSR_FEF_Msk | UART_FSR_PEF_Msk;
+
+        /* The break of a header reads back as a framing error */
+        if((psLin->u8State == LIN_STATE_RESP) && (u32Fsr & (UART_FSR_BIF_Msk | UART_FSR_FEF_Msk)))
+            LIN_Abort(psLin, LIN_ERR_FRAME);
+    }
+
+    if(u32Isr & UART_ISR_RDA_INT_Msk)
+    {
+        while((uart->FSR & UART_FSR_RX_EMPTY_Msk) == 0)
+        {
+            u32Data = uart->RBR;
+
+            switch(psLin->u8State)
+            {
+                case LIN_STATE_SYNC:
+                    /* Skip the break character */
+                    if(u32Data == 0x55)
+                        psLin->u8State = LIN_STATE_PID;
+                    break;
+
+                case LIN_STATE_PID:
+                    if(u32Data == psLin->psFrame->u8Pid)
+                        LIN_StartResponse(psLin);
+                    else
+                        LIN_Done(psLin, LIN_ERR_HEADER);
+                    break;
+
+                case LIN_STATE_RESP:
+                    LIN_ResponseByte(psLin, u32Data);
+                    break;
+
+                default:
+                    psLin->u8Last = (uint8_t)u32Data;
+                    break;
+            }
+        }
+    }
+}
+
+/*@}*/ /* end of group LIN_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group LIN_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,150 @@
+/**************************************************************************//**
+ * @file     lzdec.c
+ * @version  V3.00
+ * @brief    NUC1311 series streaming LZ decoder source file
+ *
+ * @note     LZSS with a 1 KB window, sized for an LDROM ISP. The input may be split at any byte, the decoder
+ *           keeps its position in the token stream between calls, so each received packet is decompressed
+ *           straight into the caller's page buffer. Tool/LzPack/lz_pack.py writes the stream.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "lzdec.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup LZDEC_Driver LZ Decoder
+  @{
+*/
+
+/** @addtogroup LZDEC_EXPORTED_FUNCTIONS LZ Decoder Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define LZDEC_ST_TOKEN          0       /* Next byte is a flag byte */
+#define LZDEC_ST_LITERAL        1       /* Next byte is a literal */
+#define LZDEC_ST_MATCH_LO       2       /* Next byte is the low byte of a match */
+#define LZDEC_ST_MATCH_HI       3       /* Next byte is the high byte of a match */
+
+#define LZDEC_WINDOW_MSK        (LZDEC_WINDOW_SIZE - 1)
+#define LZDEC_DIST_MSK          0x3FFUL
+#define LZDEC_LEN_POS           10
+
+/// @endcond HIDDEN_SYMBOLS
+
+/**
+  * @brief      Start a new stream.
+  * @param[in]  psLz The decoder.
+  * @return     None
+  */
+void LZDEC_Init(LZDEC_T *psLz)
+{
+    psLz->u32InCount = 0;
+    psLz->u32OutCount = 0;
+    psLz->u16Flags = 1;
+    psLz->u16Pos = 0;
+    psLz->u16Dist = 0;
+    psLz->u8Left = 0;
+    psLz->u8State = LZDEC_ST_TOKEN;
+    psLz->u8Lo = 0;
+}
+
+/**
+  * @brief      Decompress the next part of a stream.
+  * @param[in]  psLz The decoder.
+  * @param[in]  pu8In Compressed bytes.
+  * @param[in]  u32InLen Number of compressed bytes.
+  * @param[out] pu32Used Number of compressed bytes consumed, the rest is left for the next call.
+  * @param[out] pu8Out Buffer of the decompressed bytes.
+  * @param[in]  u32OutLen Size of pu8Out.
+  * @return     Number of decompressed bytes in pu8Out, or \ref LZDEC_ERR_FORMAT.
+  * @details    Stops when pu8Out is full or the input is used up. A match cut off by a full pu8Out goes on
+  *             at the next call.
+  */
+int32_t LZDEC_Decode(LZDEC_T *psLz, const uint8_t *pu8In, uint32_t u32InLen, uint32_t *pu32Used, uint8_t *pu8Out, uint32_t u32OutLen)
+{
+    uint32_t u32In = 0, u32Out = 0, u32Token;
+    uint8_t u8Byte;
+
+    for(;;)
+    {
+        /* Copy the match in progress */
+        while(psLz->u8Left && (u32Out < u32OutLen))
+        {
+            u8Byte = psLz->au8Window[(psLz->u16Pos - psLz->u16Dist) & LZDEC_WINDOW_MSK];
+            psLz->au8Window[psLz->u16Pos] = u8Byte;
+            psLz->u16Pos = (psLz->u16Pos + 1) & LZDEC_WINDOW_MSK;
+            pu8Out[u32Out++] = u8Byte;
+            psLz->u8Left--;
+        }
+
+        /* Take the next flag when one is left */
+        if((psLz->u8Left == 0) && (psLz->u8State == LZDEC_ST_TOKEN) && (psLz->u16Flags != 1))
+        {
+            psLz->u8State = (psLz->u16Flags & 1) ? LZDEC_ST_LITERAL : LZDEC_ST_MATCH_LO;
+            psLz->u16Flags >>= 1;
+        }
+
+        if((u32Out == u32OutLen) || (u32In == u32InLen))
+            break;
+
+        u8Byte = pu8In[u32In++];
+
+        switch(psLz->u8State)
+        {
+            case LZDEC_ST_TOKEN:
+                /* Eight flags above a stop bit */
+                psLz->u16Flags = (uint16_t)(u8Byte | 0x100);
+                break;
+
+            case LZDEC_ST_LITERAL:
+                psLz->au8Window[psLz->u16Pos] = u8Byte;
+                psLz->u16Pos = (psLz->u16Pos + 1) & LZDEC_WINDOW_MSK;
+                pu8Out[u32Out++] = u8Byte;
+                psLz->u8State = LZDEC_ST_TOKEN;
+                break;
+
+            case LZDEC_ST_MATCH_LO:
+                psLz->u8Lo = u8Byte;
+                psLz->u8State = LZDEC_ST_MATCH_HI;
+                break;
+
+            default:
+                u32Token = psLz->u8Lo | ((uint32_t)u8Byte << 8);
+                psLz->u16Dist = (uint16_t)((u32Token & LZDEC_DIST_MSK) + 1);
+                psLz->u8Left = (uint8_t)((u32Token >> LZDEC_LEN_POS) + LZDEC_MIN_MATCH);
+                psLz->u8State = LZDEC_ST_TOKEN;
+
+                if(psLz->u16Dist > psLz->u32OutCount + u32Out)
+                {
+                    psLz->u8Left = 0;
+                    psLz->u32InCount += u32In;
+                    psLz->u32OutCount += u32Out;
+                    *pu32Used = u32In;
+                    return LZDEC_ERR_FORMAT;
+                }
+                break;
+        }
+    }
+
+    psLz->u32InCount += u32In;
+    psLz->u32OutCount += u32Out;
+    *pu32Used = u32In;
+
+    return (int32_t)u32Out;
+}
+
+
+/*@}*/ /* end of group LZDEC_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group LZDEC_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
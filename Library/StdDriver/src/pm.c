@@ -0,0 +1,314 @@
+/**************************************************************************//**
+ * @file     pm.c
+ * @version  V3.00
+ * @brief    NUC1311 series power manager source file
+ *
+ * @note     The manager chooses between idle and power-down mode from the time left to the next timer deadline.
+ *           Before power-down it calls the registered suspend hooks and moves HCLK to HIRC with the PLL stopped,
+ *           so the CPU resumes without waiting for the PLL. After wake-up it restores the PLL and HCLK settings,
+ *           calls the resume hooks and accounts the time this took to the wake-up source.
+ *           Latency is measured with the timestamp service (tstamp.c), whose TIMER must be clocked from HXT or HIRC.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "pm.h"
+#include "tstamp.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup PM_Driver Power Manager
+  @{
+*/
+
+/** @addtogroup PM_EXPORTED_FUNCTIONS Power Manager Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define PM_IRQ_GPIO     ((1UL << EINT0_IRQn) | (1UL << EINT1_IRQn) | (1UL << GPAB_IRQn) | (1UL << GPCDEF_IRQn))
+#define PM_IRQ_UART     ((1UL << UART02_IRQn) | (1UL << UART1_IRQn) | (1UL << UART3_IRQn))
+#define PM_IRQ_I2C      (1UL << I2C0_IRQn)
+#define PM_IRQ_CAN      ((1UL << CAN0_IRQn) | (1UL << CAN1_IRQn))
+#define PM_IRQ_WDT      (1UL << WDT_IRQn)
+#define PM_IRQ_TIMER    ((1UL << TMR0_IRQn) | (1UL << TMR1_IRQn) | (1UL << TMR2_IRQn) | (1UL << TMR3_IRQn))
+
+static PM_DEV_T *s_psHead = NULL;
+static PM_DEV_T *s_psTail = NULL;
+static uint32_t s_u32PdMinUs = PM_PD_MIN_US;
+static uint32_t s_u32LatencyWorst;
+static PM_STAT_T s_asStat[PM_WAKE_SRC_CNT];
+
+/* Saved clock tree */
+static uint32_t s_u32PllCon;
+static uint32_t s_u32HclkSel;
+static uint32_t s_u32HclkDiv;
+static uint32_t s_u32HircEn;
+
+static uint32_t PM_GetWakeSrc(uint32_t u32Pending)
+{
+    if(u32Pending & PM_IRQ_GPIO)
+        return PM_WAKE_GPIO;
+    if(u32Pending & PM_IRQ_UART)
+        return PM_WAKE_UART;
+    if(u32Pending & PM_IRQ_I2C)
+        return PM_WAKE_I2C;
+    if(u32Pending & PM_IRQ_CAN)
+        return PM_WAKE_CAN;
+    if(u32Pending & PM_IRQ_WDT)
+        return PM_WAKE_WDT;
+    if(u32Pending & PM_IRQ_TIMER)
+        return PM_WAKE_TIMER;
+    return PM_WAKE_OTHER;
+}
+
+/* Run HCLK from HIRC and stop the PLL. Register write-protection must be disabled. */
+static void PM_SaveClock(void)
+{
+    s_u32PllCon = CLK->PLLCON;
+    s_u32HclkSel = CLK->CLKSEL0 & CLK_CLKSEL0_HCLK_S_Msk;
+    s_u32HclkDiv = CLK->CLKDIV & CLK_CLKDIV_HCLK_N_Msk;
+    s_u32HircEn = CLK->PWRCON & CLK_PWRCON_OSC22M_EN_Msk;
+
+    CLK->PWRCON |= CLK_PWRCON_OSC22M_EN_Msk;
+    CLK_WaitClockReady(CLK_CLKSTATUS_OSC22M_STB_Msk);
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & ~CLK_CLKSEL0_HCLK_S_Msk) | CLK_CLKSEL0_HCLK_S_HIRC;
+    CLK->CLKDIV &= ~CLK_CLKDIV_HCLK_N_Msk;
+    CLK->PLLCON |= CLK_PLLCON_PD_Msk;
+    SystemCoreClockUpdate();
+}
+
+/* Restart the PLL and the HCLK source saved by PM_SaveClock(). Register write-protection must be disabled. */
+static void PM_RestoreClock(void)
+{
+    CLK->PLLCON = s_u32PllCon;
+    if((s_u32PllCon & CLK_PLLCON_PD_Msk) == 0)
+        CLK_WaitClockReady(CLK_CLKSTATUS_PLL_STB_Msk);
+
+    if(s_u32HclkSel == CLK_CLKSEL0_HCLK_S_HXT)
+        CLK_WaitClockReady(CLK_CLKSTATUS_XTL12M_STB_Msk);
+
+    /* Set the divider first so HCLK never runs faster than configured */
+    CLK->CLKDIV = (CLK->CLKDIV & ~CLK_CLKDIV_HCLK_N_Msk) | s_u32HclkDiv;
+    CLK->CLKSEL0 = (CLK->CLKSEL0 & ~CLK_CLKSEL0_HCLK_S_Msk) | s_u32HclkSel;
+
+    if((s_u32HircEn == 0) && (s_u32HclkSel != CLK_CLKSEL0_HCLK_S_HIRC))
+        CLK->PWRCON &= ~CLK_PWRCON_OSC22M_EN_Msk;
+
+    SystemCoreClockUpdate();
+}
+
+/* Call suspend hooks, last registered first. Resume the suspended ones and return non-zero on a veto. */
+static int32_t PM_Suspend(void)
+{
+    PM_DEV_T *psDev, *psVeto;
+
+    for(psDev = s_psTail; psDev != NULL; psDev = psDev->psPrev)
+    {
+        if((psDev->pfnSuspend != NULL) && psDev->pfnSuspend(psDev->pvArg))
+            break;
+    }
+
+    if(psDev == NULL)
+        return 0;
+
+    psVeto = psDev;
+    for(psDev = psVeto->psNext; psDev != NULL; psDev = psDev->psNext)
+    {
+        if(psDev->pfnResume != NULL)
+            psDev->pfnResume(psDev->pvArg);
+    }
+
+    return -1;
+}
+
+/* Call resume hooks, first registered first */
+static void PM_Resume(void)
+{
+    PM_DEV_T *psDev;
+
+    for(psDev = s_psHead; psDev != NULL; psDev = psDev->psNext)
+    {
+        if(psDev->pfnResume != NULL)
+            psDev->pfnResume(psDev->pvArg);
+    }
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Initialize the power manager.
+  * @param[in]  u32PdMinUs  Shortest time to the next deadline, in microseconds, for which power-down is used.
+  *                         0 selects PM_PD_MIN_US. The worst measured wake-up latency is added to it.
+  * @return     None
+  * @details    Registered hooks and statistics are cleared.
+  */
+void PM_Init(uint32_t u32PdMinUs)
+{
+    s_psHead = NULL;
+    s_psTail = NULL;
+    s_u32PdMinUs = (u32PdMinUs == 0) ? PM_PD_MIN_US : u32PdMinUs;
+    PM_ClearStat();
+}
+
+/**
+  * @brief      Register suspend/resume hooks of a driver.
+  * @param[in]  psDev  Hook descriptor. It must stay valid until PM_Unregister() is called.
+  * @return     None
+  * @details    Suspend hooks are called in reverse registration order and resume hooks in registration order,
+  *             so a driver registered after the drivers it depends on is suspended before them.
+  */
+void PM_Register(PM_DEV_T *psDev)
+{
+    psDev->psNext = NULL;
+    psDev->psPrev = s_psTail;
+
+    if(s_psTail != NULL)
+        s_psTail->psNext = psDev;
+    else
+        s_psHead = psDev;
+    s_psTail = psDev;
+}
+
+/**
+  * @brief      Remove suspend/resume hooks of a driver.
+  * @param[in]  psDev  Hook descriptor passed to PM_Register().
+  * @return     None
+  */
+void PM_Unregister(PM_DEV_T *psDev)
+{
+    if(psDev->psPrev != NULL)
+        psDev->psPrev->psNext = psDev->psNext;
+    else if(s_psHead == psDev)
+        s_psHead = psDev->psNext;
+
+    if(psDev->psNext != NULL)
+        psDev->psNext->psPrev = psDev->psPrev;
+    else if(s_psTail == psDev)
+        s_psTail = psDev->psPrev;
+
+    psDev->psNext = NULL;
+    psDev->psPrev = NULL;
+}
+
+/**
+  * @brief      Enter the deepest low power mode that meets the next deadline.
+  * @param[in]  u32DeadlineUs  Time to the next timer deadline in microseconds, or PM_NO_DEADLINE.
+  *                            With the software timer service it is SWTIMER_GetIdleTicks() converted to microseconds.
+  * @retval     PM_MODE_IDLE        Idle mode was used.
+  * @retval     PM_MODE_POWER_DOWN  Power-down mode was used.
+  * @details    Power-down is used when the deadline is at least the configured minimum plus the worst wake-up
+  *             latency measured so far, and no suspend hook vetoes it. The latency is measured only while the
+  *             timestamp service is open; without TSTAMP_Open() it stays 0 and the minimum alone must cover the
+  *             wake-up time. The timer that owns the deadline must be able to wake the chip, e.g. a TIMER clocked
+  *             from LIRC with TIMER_EnableWakeup().
+  *             Interrupts are masked from the mode decision until the clock tree and the drivers are restored,
+  *             so the wake-up interrupt is served after this function has done its work.
+  */
+uint32_t PM_Sleep(uint32_t u32DeadlineUs)
+{
+    uint32_t u32PriMask, u32Locked, u32Mode, u32Start, u32Latency, u32Src;
+    PM_STAT_T *psStat;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    u32Locked = SYS_IsRegLocked();
+    if(u32Locked)
+        SYS_UnlockReg();
+
+    u32Mode = PM_MODE_IDLE;
+    if((u32DeadlineUs >= s_u32PdMinUs) && (u32DeadlineUs - s_u32PdMinUs >= s_u32LatencyWorst) && (PM_Suspend() == 0))
+        u32Mode = PM_MODE_POWER_DOWN;
+
+    if(u32Mode == PM_MODE_IDLE)
+    {
+        CLK_Idle();
+    }
+    else
+    {
+        PM_SaveClock();
+        CLK_PowerDown();
+
+        /* Pending interrupts are not served yet, so they tell which source woke the chip up */
+        u32Start = TSTAMP_Get32();
+        u32Src = PM_GetWakeSrc(NVIC->ISPR[0]);
+
+        PM_RestoreClock();
+        PM_Resume();
+
+        u32Latency = TSTAMP_Get32() - u32Start;
+        psStat = &s_asStat[u32Src];
+        psStat->u32Count++;
+        psStat->u32LatencyLast = u32Latency;
+        psStat->u32LatencySum += u32Latency;
+        if(u32Latency > psStat->u32LatencyMax)
+            psStat->u32LatencyMax = u32Latency;
+        if(u32Latency > s_u32LatencyWorst)
+            s_u32LatencyWorst = u32Latency;
+    }
+
+    /* Leave the next WFI in thread mode as a plain sleep */
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    if(u32Locked)
+        SYS_LockReg();
+
+    __set_PRIMASK(u32PriMask);
+
+    return u32Mode;
+}
+
+/**
+  * @brief      Read the wake-up latency statistics of a wake-up source.
+  * @param[in]  u32Src   Wake-up source, PM_WAKE_GPIO ~ PM_WAKE_OTHER.
+  * @param[out] psStat   Statistics of the source.
+  * @return     None
+  * @details    Latency is the time from the CPU leaving power-down until the clock tree and all resume hooks
+  *             are restored. The hardware wake-up delay before the CPU runs is not included.
+  */
+void PM_GetStat(uint32_t u32Src, PM_STAT_T *psStat)
+{
+    uint32_t u32PriMask;
+
+    if(u32Src >= PM_WAKE_SRC_CNT)
+        return;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    *psStat = s_asStat[u32Src];
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Clear the wake-up latency statistics.
+  * @param      None
+  * @return     None
+  * @details    The worst latency used by the power-down decision is cleared too.
+  */
+void PM_ClearStat(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < PM_WAKE_SRC_CNT; i++)
+    {
+        s_asStat[i].u32Count = 0;
+        s_asStat[i].u32LatencyLast = 0;
+        s_asStat[i].u32LatencyMax = 0;
+        s_asStat[i].u32LatencySum = 0;
+    }
+    s_u32LatencyWorst = 0;
+}
+
+/*@}*/ /* end of group PM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group PM_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
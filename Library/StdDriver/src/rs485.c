@@ -0,0 +1,527 @@
+/**************************************************************************//**
+ * @file     rs485.c
+ * @version  V3.00
+ * @brief    NUC1311 series RS485 multi-drop bus engine source file
+ *
+ * @note     A frame is address, length, payload and CRC-16/MODBUS (low byte first) over all preceding bytes.
+ *           The master sends the address byte with the parity bit set and everything else with it cleared.
+ *           Slaves run in AAD mode, so the UART drops frames for other addresses without interrupting the CPU.
+ *           Slaves reply with the same frame layout, all bytes with the parity bit cleared.
+ *           The master polls its table round-robin from interrupt context: the reply or the SWTIMER time-out of
+ *           one poll starts the next. Slaves that failed RS485_OFFLINE_FAILS times in a row are only polled
+ *           once every RS485_OFFLINE_PERIOD cycles, so dead drops cost little bus time.
+ *           RTS drives the transceiver direction in AUD mode. DE and /RE must be tied together so that a node
+ *           does not receive its own transmission.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "rs485.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup RS485_Driver RS485 Bus Engine
+  @{
+*/
+
+/** @addtogroup RS485_EXPORTED_FUNCTIONS RS485 Bus Engine Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define RS485_STATE_IDLE    0   /* Master: no poll. Slave: waiting for an address byte */
+#define RS485_STATE_RX      1   /* Master: poll in progress. Slave: receiving an addressed frame */
+#define RS485_STATE_TX      2   /* Slave: sending a reply */
+
+#define RS485_LCR_ADDR      (UART_WORD_LEN_8 | UART_PARITY_MARK | UART_STOP_BIT_1)
+#define RS485_LCR_DATA      (UART_WORD_LEN_8 | UART_PARITY_SPACE | UART_STOP_BIT_1)
+
+#define RS485_RX_TOIC       20  /* RX time-out in bit times, drains a FIFO below its trigger level */
+
+#define RS485_RX_MORE       (-16)   /* Frame incomplete */
+
+static const uint16_t s_au16Crc16[256] =
+{
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040,
+};
+
+static IRQn_Type RS485_GetIRQn(UART_T *uart)
+{
+    if(uart == UART1)
+        return UART1_IRQn;
+    if(uart == UART3)
+        return UART3_IRQn;
+    return UART02_IRQn;
+}
+
+static void RS485_Config(RS485_T *psBus, UART_T *uart, uint32_t u32Mode, uint32_t u32Addr)
+{
+    psBus->uart = uart;
+    psBus->u8State = RS485_STATE_IDLE;
+    psBus->u8Run = 0;
+    psBus->u8Addr = (uint8_t)u32Addr;
+    psBus->u8Fifo = (uart == UART3) ? UART3_FIFO_SIZE : UART0_FIFO_SIZE;
+    psBus->u16RxPos = 0;
+    psBus->u32Frames = 0;
+    psBus->u32Errors = 0;
+
+    uart->IER = 0;
+    uart->LCR = RS485_LCR_DATA;
+    uart->FCR = (uart->FCR & ~(UART_FCR_RFITL_Msk | UART_FCR_RX_DIS_Msk)) |
+                ((psBus->u8Fifo > 1) ? UART_FCR_RFITL_8BYTES : UART_FCR_RFITL_1BYTE) |
+                UART_FCR_RFR_Msk | UART_FCR_TFR_Msk;
+
+    UART_SelectRS485Mode(uart, u32Mode | UART_ALT_CSR_RS485_AUD_Msk, u32Addr);
+    UART_ClearIntFlag(uart, UART_ISR_RLS_INT_Msk | UART_ISR_BUF_ERR_INT_Msk);
+    UART_SetTimeoutCnt(uart, RS485_RX_TOIC);
+    UART_ENABLE_INT(uart, UART_IER_RDA_IEN_Msk | UART_IER_TOUT_IEN_Msk | UART_IER_RLS_IEN_Msk | UART_IER_BUF_ERR_IEN_Msk);
+
+    NVIC_EnableIRQ(RS485_GetIRQn(uart));
+}
+
+static uint32_t RS485_BuildFrame(uint8_t *pu8Frame, uint32_t u32Addr, uint32_t u32Len)
+{
+    uint32_t u32Crc;
+
+    pu8Frame[0] = (uint8_t)u32Addr;
+    pu8Frame[1] = (uint8_t)u32Len;
+    u32Crc = RS485_CRC16(pu8Frame, u32Len + 2, 0xFFFF);
+    pu8Frame[u32Len + 2] = (uint8_t)u32Crc;
+    pu8Frame[u32Len + 3] = (uint8_t)(u32Crc >> 8);
+
+    return u32Len + 4;
+}
+
+/* Called with the TX FIFO empty */
+static void RS485_FillFifo(RS485_T *psBus)
+{
+    UART_T *uart = psBus->uart;
+    uint32_t u32Pos = psBus->u16TxPos;
+    uint32_t u32End = u32Pos + psBus->u8Fifo;
+
+    if(u32End > psBus->u16TxLen)
+        u32End = psBus->u16TxLen;
+
+    while(u32Pos < u32End)
+        uart->THR = psBus->au8Tx[u32Pos++];
+
+    psBus->u16TxPos = (uint16_t)u32Pos;
+
+    if(u32Pos < psBus->u16TxLen)
+        uart->IER |= UART_IER_THRE_IEN_Msk;
+    else
+        uart->IER &= ~UART_IER_THRE_IEN_Msk;
+}
+
+/* Returns the payload length of a complete frame in au8Rx, RS485_RX_MORE or an RS485_ERR_ code */
+static int32_t RS485_CheckFrame(RS485_T *psBus, uint32_t u32Addr)
+{
+    uint32_t u32Len;
+
+    if(psBus->u16RxPos < 2)
+        return RS485_RX_MORE;
+
+    u32Len = psBus->au8Rx[1];
+    if((psBus->au8Rx[0] != u32Addr) || (u32Len > RS485_MAX_DATA))
+        return RS485_ERR_FRAME;
+
+    if(psBus->u16RxPos < u32Len + 4)
+        return RS485_RX_MORE;
+
+    /* The CRC over a frame including its own CRC is 0 */
+    if(RS485_CRC16(psBus->au8Rx, u32Len + 4, 0xFFFF) != 0)
+        return RS485_ERR_CRC;
+
+    return (int32_t)u32Len;
+}
+
+static void RS485_MasterTimeout(void *pvArg);
+
+static void RS485_MasterPoll(RS485_T *psBus)
+{
+    UART_T *uart = psBus->uart;
+    RS485_SLAVE_T *psSlave;
+    uint32_t i;
+
+    /* Next slave that is on-line or due for a retry */
+    for(;;)
+    {
+        if(++psBus->u32Index >= psBus->u32SlaveNum)
+            psBus->u32Index = 0;
+
+        psSlave = &psBus->psSlave[psBus->u32Index];
+        if(psSlave->u8Skip == 0)
+            break;
+        psSlave->u8Skip--;
+    }
+
+    psSlave->u32Polls++;
+    psBus->i8Err = 0;
+    psBus->u16RxPos = 0;
+    for(i = 0; i < psSlave->u8TxLen; i++)
+        psBus->au8Tx[2 + i] = psSlave->pu8TxData[i];
+    psBus->u16TxLen = (uint16_t)RS485_BuildFrame(psBus->au8Tx, psSlave->u8Addr, psSlave->u8TxLen);
+    psBus->u8State = RS485_STATE_RX;
+
+    SWTIMER_Start(&psBus->sTmr, psSlave->u32Timeout, 0, RS485_MasterTimeout, psBus);
+
+    /* Drop anything left over from the last poll */
+    uart->FCR |= UART_FCR_RFR_Msk;
+
+    /* The address byte goes out alone with mark parity. The THRE interrupt reports that it moved to the
+       shift register, and RS485_IRQHandler() then switches to space parity and queues the rest. */
+    uart->LCR = RS485_LCR_ADDR;
+    uart->THR = psBus->au8Tx[0];
+    psBus->u16TxPos = 1;
+    uart->IER |= UART_IER_THRE_IEN_Msk;
+}
+
+static void RS485_MasterDone(RS485_T *psBus, int32_t i32Len)
+{
+    RS485_SLAVE_T *psSlave;
+    uint32_t u32PriMask;
+
+    /* The reply and the time-out could race from different interrupt priorities */
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    if(psBus->u8State != RS485_STATE_RX)
+    {
+        __set_PRIMASK(u32PriMask);
+        return;
+    }
+    psBus->u8State = RS485_STATE_IDLE;
+    __set_PRIMASK(u32PriMask);
+
+    SWTIMER_Stop(&psBus->sTmr);
+
+    psSlave = &psBus->psSlave[psBus->u32Index];
+    if(i32Len >= 0)
+    {
+        psSlave->u8Fails = 0;
+        psBus->u32Frames++;
+    }
+    else
+    {
+        if(i32Len == RS485_ERR_TIMEOUT)
+            psSlave->u32Timeouts++;
+        else
+        {
+            psSlave->u32Errors++;
+            psBus->u32Errors++;
+        }
+
+        if(psSlave->u8Fails < 0xFF)
+            psSlave->u8Fails++;
+        if(psSlave->u8Fails >= RS485_OFFLINE_FAILS)
+            psSlave->u8Skip = RS485_OFFLINE_PERIOD - 1;
+    }
+
+    if(psBus->pfnReply != NULL)
+        psBus->pfnReply(psBus, psSlave, &psBus->au8Rx[2], i32Len);
+
+    if(psBus->u8Run)
+        RS485_MasterPoll(psBus);
+}
+
+static void RS485_MasterTimeout(void *pvArg)
+{
+    RS485_T *psBus = (RS485_T *)pvArg;
+
+    /* A bad reply is reported once the bus has been quiet until the time-out */
+    RS485_MasterDone(psBus, (psBus->i8Err != 0) ? psBus->i8Err : RS485_ERR_TIMEOUT);
+}
+
+static void RS485_SlaveFrame(RS485_T *psBus, int32_t i32Len)
+{
+    int32_t i32ReplyLen = -1;
+
+    psBus->u8State = RS485_STATE_IDLE;
+
+    if(i32Len < 0)
+    {
+        psBus->u32Errors++;
+        return;
+    }
+
+    psBus->u32Frames++;
+
+    if(psBus->pfnRequest != NULL)
+        i32ReplyLen = psBus->pfnRequest(psBus, &psBus->au8Rx[2], (uint32_t)i32Len, &psBus->au8Tx[2]);
+
+    if((i32ReplyLen < 0) || (i32ReplyLen > RS485_MAX_DATA))
+        return;
+
+    psBus->u16TxLen = (uint16_t)RS485_BuildFrame(psBus->au8Tx, psBus->u8Addr, (uint32_t)i32ReplyLen);
+    psBus->u16TxPos = 0;
+    psBus->u8State = RS485_STATE_TX;
+    RS485_FillFifo(psBus);
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Calculate CRC-16/MODBUS.
+  * @param[in]  pu8Data  The pointer of the data.
+  * @param[in]  u32Len   Data length in bytes.
+  * @param[in]  u32Crc   Initial value, 0xFFFF for a new frame or the previous result to continue.
+  * @return     CRC value. It is sent low byte first.
+  */
+uint32_t RS485_CRC16(const uint8_t *pu8Data, uint32_t u32Len, uint32_t u32Crc)
+{
+    while(u32Len--)
+        u32Crc = (u32Crc >> 8) ^ s_au16Crc16[(u32Crc ^ *pu8Data++) & 0xFF];
+
+    return u32Crc;
+}
+
+/**
+  * @brief      Open an RS485 bus as master.
+  * @param[in]  psBus        Bus control block. It must stay valid while the bus is open.
+  * @param[in]  uart         The pointer of the specified UART module. It must be opened with UART_Open() and its
+  *                          RTS pin set up for the transceiver direction.
+  * @param[in]  psSlave      Poll table, 1 ~ 255 entries. u8Addr, u8TxLen, pu8TxData and u32Timeout must be set,
+  *                          the other members are cleared by this function.
+  * @param[in]  u32SlaveNum  Number of poll table entries.
+  * @param[in]  pfnReply     Called in interrupt context with each poll result. Could be NULL.
+  * @retval     0                 Success
+  * @retval     RS485_ERR_PARAM   Invalid parameter
+  * @details    The reply time-outs run on the software timer service, which must be opened with SWTIMER_Open().
+  *             RS485_IRQHandler() must be called from the UART interrupt handler.
+  */
+int32_t RS485_MasterOpen(RS485_T *psBus, UART_T *uart, RS485_SLAVE_T *psSlave, uint32_t u32SlaveNum, RS485_REPLY_FUNC_T pfnReply)
+{
+    uint32_t i;
+
+    if((psSlave == NULL) || (u32SlaveNum == 0) || (u32SlaveNum > 0xFF))
+        return RS485_ERR_PARAM;
+
+    for(i = 0; i < u32SlaveNum; i++)
+    {
+        if(psSlave[i].u8TxLen > RS485_MAX_DATA)
+            return RS485_ERR_PARAM;
+
+        psSlave[i].u8Fails = 0;
+        psSlave[i].u8Skip = 0;
+        psSlave[i].u32Polls = 0;
+        psSlave[i].u32Timeouts = 0;
+        psSlave[i].u32Errors = 0;
+    }
+
+    psBus->psSlave = psSlave;
+    psBus->u32SlaveNum = u32SlaveNum;
+    psBus->u32Index = u32SlaveNum - 1;
+    psBus->pfnReply = pfnReply;
+    psBus->pfnRequest = NULL;
+
+    /* Normal mode: the master receives every reply */
+    RS485_Config(psBus, uart, 0, 0);
+
+    return 0;
+}
+
+/**
+  * @brief      Start the master poll scheduler.
+  * @param[in]  psBus  Bus control block opened by RS485_MasterOpen().
+  * @return     None
+  * @details    Polling runs from interrupt context until RS485_MasterStop() is called.
+  */
+void RS485_MasterStart(RS485_T *psBus)
+{
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    psBus->u8Run = 1;
+    if(psBus->u8State == RS485_STATE_IDLE)
+        RS485_MasterPoll(psBus);
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Stop the master poll scheduler.
+  * @param[in]  psBus  Bus control block opened by RS485_MasterOpen().
+  * @return     None
+  * @details    A poll in progress completes and is reported.
+  */
+void RS485_MasterStop(RS485_T *psBus)
+{
+    psBus->u8Run = 0;
+}
+
+/**
+  * @brief      Open an RS485 bus as slave.
+  * @param[in]  psBus       Bus control block. It must stay valid while the bus is open.
+  * @param[in]  uart        The pointer of the specified UART module. It must be opened with UART_Open() and its
+  *                         RTS pin set up for the transceiver direction.
+  * @param[in]  u32Addr     Own address, 0x00 ~ 0xFF.
+  * @param[in]  pfnRequest  Called in interrupt context with each request addressed to this slave. It writes up to
+  *                         RS485_MAX_DATA bytes to pu8Reply and returns their number, or returns < 0 to stay silent.
+  * @retval     0                 Success
+  * @retval     RS485_ERR_PARAM   Invalid parameter
+  * @details    RS485_IRQHandler() must be called from the UART interrupt handler.
+  */
+int32_t RS485_SlaveOpen(RS485_T *psBus, UART_T *uart, uint32_t u32Addr, RS485_REQUEST_FUNC_T pfnRequest)
+{
+    if(u32Addr > 0xFF)
+        return RS485_ERR_PARAM;
+
+    psBus->psSlave = NULL;
+    psBus->u32SlaveNum = 0;
+    psBus->pfnReply = NULL;
+    psBus->pfnRequest = pfnRequest;
+
+    /* The UART compares the address bytes and drops the frames for other slaves */
+    RS485_Config(psBus, uart, UART_ALT_CSR_RS485_AAD_Msk, u32Addr);
+    uart->ALT_CSR |= UART_ALT_CSR_RS485_ADD_EN_Msk;
+
+    return 0;
+}
+
+/**
+  * @brief      Close an RS485 bus.
+  * @param[in]  psBus  Bus control block.
+  * @return     None
+  */
+void RS485_Close(RS485_T *psBus)
+{
+    psBus->u8Run = 0;
+    SWTIMER_Stop(&psBus->sTmr);
+    NVIC_DisableIRQ(RS485_GetIRQn(psBus->uart));
+    UART_Close(psBus->uart);
+    psBus->uart->FUN_SEL = UART_FUNC_SEL_UART;
+    psBus->uart->ALT_CSR &= ~(UART_ALT_CSR_RS485_NMM_Msk | UART_ALT_CSR_RS485_AUD_Msk | UART_ALT_CSR_RS485_AAD_Msk |
+                              UART_ALT_CSR_RS485_ADD_EN_Msk);
+    psBus->u8State = RS485_STATE_IDLE;
+}
+
+/**
+  * @brief      RS485 bus interrupt handler.
+  * @param[in]  psBus  Bus control block.
+  * @return     None
+  * @details    Must be called from the interrupt handler of the bus UART. UART0 and UART2 share one handler, which
+  *             calls this function for each open bus.
+  */
+void RS485_IRQHandler(RS485_T *psBus)
+{
+    UART_T *uart = psBus->uart;
+    uint32_t u32Isr = uart->ISR;
+    uint32_t u32Fsr;
+    uint32_t u32Addr;
+    uint32_t u32Data;
+    int32_t i32Len;
+
+    if(u32Isr & UART_ISR_BUF_ERR_INT_Msk)
+    {
+        UART_ClearIntFlag(uart, UART_ISR_BUF_ERR_INT_Msk);
+        psBus->i8Err = RS485_ERR_FRAME;
+    }
+
+    if(u32Isr & UART_ISR_RLS_INT_Msk)
+    {
+        u32Fsr = uart->FSR;
+
+        /* Parity carries the address flag, so only break and framing errors count */
+        if(u32Fsr & (UART_FSR_BIF_Msk | UART_FSR_FEF_Msk))
+            psBus->i8Err = RS485_ERR_FRAME;
+        uart->FSR = UART_FSR_BIF_Msk | UART_FSR_FEF_Msk | UART_FSR_PEF_Msk;
+
+        if((psBus->psSlave == NULL) && (u32Fsr & UART_FSR_RS485_ADD_DETF_Msk))
+        {
+            /* Matched address byte, start of a request */
+            u32Addr = uart->RBR;
+            UART_RS485_CLEAR_ADDR_FLAG(uart);
+
+            psBus->au8Rx[0] = (uint8_t)u32Addr;
+            psBus->u16RxPos = 1;
+            psBus->i8Err = 0;
+            psBus->u8State = RS485_STATE_RX;
+        }
+    }
+
+    if(u32Isr & (UART_ISR_RDA_INT_Msk | UART_ISR_TOUT_INT_Msk))
+    {
+        while((uart->FSR & UART_FSR_RX_EMPTY_Msk) == 0)
+        {
+            u32Data = uart->RBR;
+            if((psBus->u8State == RS485_STATE_RX) && (psBus->u16RxPos < RS485_FRAME_SIZE))
+                psBus->au8Rx[psBus->u16RxPos++] = (uint8_t)u32Data;
+        }
+
+        if(psBus->u8State == RS485_STATE_RX)
+        {
+            if(psBus->psSlave != NULL)
+            {
+                i32Len = RS485_CheckFrame(psBus, psBus->psSlave[psBus->u32Index].u8Addr);
+                if(psBus->i8Err != 0)
+                    ;   /* Wait for the time-out so the rest of a bad reply cannot collide with the next poll */
+                else if(i32Len == RS485_ERR_FRAME)
+                    psBus->i8Err = RS485_ERR_FRAME;
+                else if(i32Len != RS485_RX_MORE)
+                    RS485_MasterDone(psBus, i32Len);
+            }
+            else
+            {
+                i32Len = RS485_CheckFrame(psBus, psBus->u8Addr);
+                if(psBus->i8Err != 0)
+                    RS485_SlaveFrame(psBus, psBus->i8Err);
+                else if(i32Len != RS485_RX_MORE)
+                    RS485_SlaveFrame(psBus, i32Len);
+            }
+        }
+    }
+
+    if((u32Isr & UART_ISR_THRE_INT_Msk) && (uart->IER & UART_IER_THRE_IEN_Msk))
+    {
+        /* Master: the address byte is in the shift register, the rest of the request has space parity */
+        if(uart->LCR != RS485_LCR_DATA)
+            uart->LCR = RS485_LCR_DATA;
+
+        RS485_FillFifo(psBus);
+        if((psBus->psSlave == NULL) && (psBus->u16TxPos >= psBus->u16TxLen))
+            psBus->u8State = RS485_STATE_IDLE;
+    }
+}
+
+/*@}*/ /* end of group RS485_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group RS485_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
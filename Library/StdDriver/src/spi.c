@@ -48,7 +48,7 @@ uint32_t SPI_Open(SPI_T *spi,
                   uint32_t u32DataWidth,
                   uint32_t u32BusClock)
 {
-    uint32_t u32ClkSrc = 0, u32Div, u32HCLKFreq;
+    uint32_t u32HCLKFreq;
 
     if(u32DataWidth == 32)
         u32DataWidth = 0;
@@ -56,73 +56,20 @@ uint32_t SPI_Open(SPI_T *spi,
     /* Default setting: MSB first, disable unit transfer interrupt, SP_CYCLE = 0. */
     spi->CNTRL = u32MasterSlave | (u32DataWidth << SPI_CNTRL_TX_BIT_LEN_Pos) | (u32SPIMode);
 
-    /* Set BCn = 1: f_spi = f_spi_clk_src / (DIVIDER + 1) */
-    spi->CNTRL2 |= SPI_CNTRL2_BCn_Msk;
-    /* Get system clock frequency */
-    u32HCLKFreq = CLK_GetHCLKFreq();
-
     if(u32MasterSlave == SPI_MASTER)
     {
         /* Default setting: slave select signal is active low; disable automatic slave select function. */
         spi->SSR = SPI_SS_ACTIVE_LOW;
 
-        /* Check clock source of SPI */
-        if((CLK->CLKSEL1 & CLK_CLKSEL1_SPI0_S_Msk) == CLK_CLKSEL1_SPI0_S_HCLK)
-            u32ClkSrc = u32HCLKFreq;
-        else
-            u32ClkSrc = CLK_GetPLLClockFreq();
-
-        if(u32BusClock >= u32HCLKFreq)
-        {
-            /* Select HCLK as the clock source of SPI */
-            CLK->CLKSEL1 = (CLK->CLKSEL1 & (~CLK_CLKSEL1_SPI0_S_Msk)) | CLK_CLKSEL1_SPI0_S_HCLK;
-
-            /* Set DIVIDER = 0 */
-            spi->DIVIDER = 0;
-            /* Return master peripheral clock rate */
-            return u32HCLKFreq;
-        }
-        else if(u32BusClock >= u32ClkSrc)
-        {
-            /* Set DIVIDER = 0 */
-            spi->DIVIDER = 0;
-            /* Return master peripheral clock rate */
-            return u32ClkSrc;
-        }
-        else if(u32BusClock == 0)
-        {
-            /* Set BCn = 0: f_spi = f_spi_clk_src / ((DIVIDER + 1) * 2) */
-            spi->CNTRL2 &= (~SPI_CNTRL2_BCn_Msk);
-            /* Set DIVIDER to the maximum value 0xFF */
-            spi->DIVIDER = (spi->DIVIDER & (~SPI_DIVIDER_DIVIDER_Msk)) | (0xFF << SPI_DIVIDER_DIVIDER_Pos);
-            /* Return master peripheral clock rate */
-            return (u32ClkSrc / ((0xFF + 1) * 2));
-        }
-        else
-        {
-            u32Div = (((u32ClkSrc * 10) / u32BusClock + 5) / 10) - 1; /* Round to the nearest integer */
-            if(u32Div > 0xFF)
-            {
-                /* Set BCn = 0: f_spi = f_spi_clk_src / ((DIVIDER + 1) * 2) */
-                spi->CNTRL2 &= (~SPI_CNTRL2_BCn_Msk);
-                u32Div = (((u32ClkSrc * 10) / (u32BusClock * 2) + 5) / 10) - 1; /* Round to the nearest integer */
-                if(u32Div > 0xFF)
-                    u32Div = 0xFF;
-                spi->DIVIDER = (spi->DIVIDER & (~SPI_DIVIDER_DIVIDER_Msk)) | (u32Div << SPI_DIVIDER_DIVIDER_Pos);
-                /* Return master peripheral clock rate */
-                return (u32ClkSrc / ((u32Div + 1) * 2));
-            }
-            else
-            {
-                spi->DIVIDER = (spi->DIVIDER & (~SPI_DIVIDER_DIVIDER_Msk)) | (u32Div << SPI_DIVIDER_DIVIDER_Pos);
-                /* Return master peripheral clock rate */
-                return (u32ClkSrc / (u32Div + 1));
-            }
-        }
-
+        return SPI_SetBusClock(spi, u32BusClock);
     }
     else     /* For slave mode, force the SPI peripheral clock rate to system clock rate. */
     {
+        /* Set BCn = 1: f_spi = f_spi_clk_src / (DIVIDER + 1) */
+        spi->CNTRL2 |= SPI_CNTRL2_BCn_Msk;
+        /* Get system clock frequency */
+        u32HCLKFreq = CLK_GetHCLKFreq();
+
         /* Default setting: slave select signal is low level active. */
         spi->SSR = SPI_SSR_SS_LTRIG_Msk;
 
@@ -207,72 +154,135 @@ void SPI_EnableAutoSS(SPI_T *spi, uint32_t u32SSPinMask, uint32_t u32ActiveLevel
   * @details This function is only available in Master mode. The actual clock rate may be different from the target SPI bus clock rate.
   *          For example, if the SPI source clock rate is 12 MHz and the target SPI bus clock rate is 7 MHz, the actual SPI bus clock
   *          rate will be 6 MHz.
-  * @note   If u32BusClock = 0, DIVIDER setting will be set to the maximum value.
-  * @note   If u32BusClock >= system clock frequency, SPI peripheral clock source setting in CLKSEL1 register will be set to select
-  *         HCLK. The DIVIDER (SPI_DIVIDER[7:0]) will be set to 0.
+  * @note   If u32BusClock = 0, the slowest possible bus clock is selected.
+  * @note   The SPI peripheral clock source setting in CLKSEL1 register may be switched between HCLK and PLL
+  *         to get closer to u32BusClock. See SPI_PlanBusClock() for details.
   */
 uint32_t SPI_SetBusClock(SPI_T *spi, uint32_t u32BusClock)
 {
-    uint32_t u32ClkSrc, u32HCLKFreq;
-    uint32_t u32Div;
+    SPI_CLK_PLAN_T sPlan;
 
-    /* Set BCn = 1: f_spi = f_spi_clk_src / (DIVIDER + 1) */
-    spi->CNTRL2 |= SPI_CNTRL2_BCn_Msk;
-    /* Get system clock frequency */
-    u32HCLKFreq = CLK_GetHCLKFreq();
+    SPI_PlanBusClock(CLK_GetHCLKFreq(), CLK_GetPLLClockFreq(), u32BusClock, SPI_CLK_NEAREST, &sPlan);
+    SPI_ApplyBusClock(spi, &sPlan);
 
-    /* Check clock source of SPI */
-    if((CLK->CLKSEL1 & CLK_CLKSEL1_SPI0_S_Msk) == CLK_CLKSEL1_SPI0_S_HCLK)
-        u32ClkSrc = u32HCLKFreq;
-    else
-        u32ClkSrc = CLK_GetPLLClockFreq();
+    return sPlan.u32BusClock;
+}
 
-    if(u32BusClock >= u32HCLKFreq)
-    {
-        /* Select HCLK as the clock source of SPI */
-        CLK->CLKSEL1 = (CLK->CLKSEL1 & (~CLK_CLKSEL1_SPI0_S_Msk)) | CLK_CLKSEL1_SPI0_S_HCLK;
-        /* Set DIVIDER = 0 */
-        spi->DIVIDER = 0;
-        /* Return master peripheral clock rate */
-        return u32HCLKFreq;
-    }
-    else if(u32BusClock >= u32ClkSrc)
-    {
-        /* Set DIVIDER = 0 */
-        spi->DIVIDER = 0;
-        /* Return master peripheral clock rate */
-        return u32ClkSrc;
-    }
-    else if(u32BusClock == 0)
-    {
-        /* Set BCn = 0: f_spi = f_spi_clk_src / ((DIVIDER + 1) * 2) */
-        spi->CNTRL2 &= (~SPI_CNTRL2_BCn_Msk);
-        /* Set DIVIDER to the maximum value 0xFF */
-        spi->DIVIDER = (spi->DIVIDER & (~SPI_DIVIDER_DIVIDER_Msk)) | (0xFF << SPI_DIVIDER_DIVIDER_Pos);
-        /* Return master peripheral clock rate */
-        return (u32ClkSrc / ((0xFF + 1) * 2));
-    }
-    else
+/**
+  * @brief  Calculate the SPI bus clock setting closest to a target rate.
+  * @param[in]  u32HclkFreq HCLK frequency in Hz.
+  * @param[in]  u32PllFreq PLL output frequency in Hz. 0 if PLL is not running.
+  * @param[in]  u32BusClock The expected frequency of SPI bus clock in Hz. 0 selects the slowest possible rate.
+  * @param[in]  u32Policy Selection policy. (SPI_CLK_NEAREST, SPI_CLK_NOT_ABOVE)
+  * @param[out] psPlan Selected clock source, BCn mode, DIVIDER and the achieved bus clock.
+  * @return Achieved SPI bus clock in Hz.
+  * @details Both SPI clock sources (HCLK and PLL) and both BCn modes are evaluated. For each of the four
+  *          combinations the two dividers bracketing the target are checked, which is sufficient because the
+  *          bus clock falls monotonically with DIVIDER. The bus clock never exceeds HCLK.
+  *          With SPI_CLK_NOT_ABOVE the fastest rate not above u32BusClock is chosen; if even the slowest rate is
+  *          above u32BusClock, the slowest rate is chosen. On a tie HCLK and BCn = 1 are preferred.
+  *          This function does not access any register, so it can also be used to evaluate a clock tree.
+  */
+uint32_t SPI_PlanBusClock(uint32_t u32HclkFreq, uint32_t u32PllFreq, uint32_t u32BusClock, uint32_t u32Policy, SPI_CLK_PLAN_T *psPlan)
+{
+    const uint32_t au32ClkSel[2] = {CLK_CLKSEL1_SPI0_S_HCLK, CLK_CLKSEL1_SPI0_S_PLL};
+    uint32_t au32Src[2];
+    uint32_t i, j, k, u32Mul, u32Div, u32Quot, u32Clk, u32Err, u32BestErr = 0;
+    int32_t i32HasBest = 0, i32BestAbove = 0, i32Above;
+
+    au32Src[0] = u32HclkFreq;
+    au32Src[1] = u32PllFreq;
+
+    psPlan->u32ClkSel = CLK_CLKSEL1_SPI0_S_HCLK;
+    psPlan->u32BCn = 1;
+    psPlan->u32Divider = 0;
+    psPlan->u32BusClock = u32HclkFreq;
+
+    for(i = 0; i < 2; i++)
     {
-        u32Div = (((u32ClkSrc * 10) / u32BusClock + 5) / 10) - 1; /* Round to the nearest integer */
-        if(u32Div > 0xFF)
-        {
-            /* Set BCn = 0: f_spi = f_spi_clk_src / ((DIVIDER + 1) * 2) */
-            spi->CNTRL2 &= (~SPI_CNTRL2_BCn_Msk);
-            u32Div = (((u32ClkSrc * 10) / (u32BusClock * 2) + 5) / 10) - 1; /* Round to the nearest integer */
-            if(u32Div > 0xFF)
-                u32Div = 0xFF;
-            spi->DIVIDER = (spi->DIVIDER & (~SPI_DIVIDER_DIVIDER_Msk)) | (u32Div << SPI_DIVIDER_DIVIDER_Pos);
-            /* Return master peripheral clock rate */
-            return (u32ClkSrc / ((u32Div + 1) * 2));
-        }
-        else
+        if(au32Src[i] == 0)
+            continue;
+
+        for(j = 0; j < 2; j++)
         {
-            spi->DIVIDER = (spi->DIVIDER & (~SPI_DIVIDER_DIVIDER_Msk)) | (u32Div << SPI_DIVIDER_DIVIDER_Pos);
-            /* Return master peripheral clock rate */
-            return (u32ClkSrc / (u32Div + 1));
+            /* BCn = 1: f_spi = f_src / (DIVIDER + 1); BCn = 0: f_spi = f_src / ((DIVIDER + 1) * 2) */
+            u32Mul = (j == 0) ? 1 : 2;
+
+            /* Largest divisor (DIVIDER + 1) whose rate is still >= target, then its slower neighbour */
+            u32Quot = (u32BusClock == 0) ? 256 : (au32Src[i] / u32BusClock) / u32Mul;
+            if(u32Quot > 256)
+                u32Quot = 256;
+
+            for(k = 0; k < 2; k++)
+            {
+                u32Div = u32Quot + k;
+                if(u32Div < 1)
+                    u32Div = 1;
+                if(u32Div > 256)
+                    u32Div = 256;
+
+                u32Clk = au32Src[i] / (u32Mul * u32Div);
+                if(u32Clk > u32HclkFreq)
+                    continue;
+
+                /* Exact comparison of f_src / (u32Mul * u32Div) against target, without truncation error */
+                i32Above = ((uint64_t)u32BusClock * u32Mul * u32Div < au32Src[i]) ? 1 : 0;
+                u32Err = (u32Clk > u32BusClock) ? (u32Clk - u32BusClock) : (u32BusClock - u32Clk);
+
+                if(i32HasBest)
+                {
+                    if(u32Policy == SPI_CLK_NOT_ABOVE)
+                    {
+                        /* A rate not above target always beats a rate above it. Among rates above target the slowest wins. */
+                        if(i32Above != i32BestAbove)
+                        {
+                            if(i32Above)
+                                continue;
+                        }
+                        else if(i32Above ? (u32Clk >= psPlan->u32BusClock) : (u32Err >= u32BestErr))
+                        {
+                            continue;
+                        }
+                    }
+                    else if(u32Err >= u32BestErr)
+                    {
+                        continue;
+                    }
+                }
+
+                i32HasBest = 1;
+                u32BestErr = u32Err;
+                i32BestAbove = i32Above;
+                psPlan->u32ClkSel = au32ClkSel[i];
+                psPlan->u32BCn = (j == 0) ? 1 : 0;
+                psPlan->u32Divider = u32Div - 1;
+                psPlan->u32BusClock = u32Clk;
+            }
         }
     }
+
+    return psPlan->u32BusClock;
+}
+
+/**
+  * @brief  Program a bus clock setting calculated by SPI_PlanBusClock().
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @param[in]  psPlan Clock setting to apply.
+  * @return None
+  * @details Updates the SPI0_S field of CLKSEL1, the BCn bit of SPI_CNTRL2 and the DIVIDER field of SPI_DIVIDER.
+  *          CLKSEL1 is only written if the clock source changes.
+  */
+void SPI_ApplyBusClock(SPI_T *spi, const SPI_CLK_PLAN_T *psPlan)
+{
+    if((CLK->CLKSEL1 & CLK_CLKSEL1_SPI0_S_Msk) != psPlan->u32ClkSel)
+        CLK->CLKSEL1 = (CLK->CLKSEL1 & (~CLK_CLKSEL1_SPI0_S_Msk)) | psPlan->u32ClkSel;
+
+    if(psPlan->u32BCn)
+        spi->CNTRL2 |= SPI_CNTRL2_BCn_Msk;
+    else
+        spi->CNTRL2 &= (~SPI_CNTRL2_BCn_Msk);
+
+    spi->DIVIDER = (spi->DIVIDER & (~SPI_DIVIDER_DIVIDER_Msk)) | (psPlan->u32Divider << SPI_DIVIDER_DIVIDER_Pos);
 }
 
 /**
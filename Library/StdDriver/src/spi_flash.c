@@ -0,0 +1,365 @@
+/**************************************************************************//**
+ * @file     spi_flash.c
+ * @version  V3.00
+ * @brief    NUC1311 series external SPI NOR Flash driver source file
+ *
+ * @note
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "spi_flash.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup SPIFLASH_Driver SPI NOR Flash Driver
+  @{
+*/
+
+/** @addtogroup SPIFLASH_EXPORTED_FUNCTIONS SPI NOR Flash Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define SPIFLASH_INVALID_TAG    0xFFFFFFFFUL
+
+/**
+  * @brief Shift bytes through the SPI FIFO.
+  * @param[in]  spi The pointer of the specified SPI module.
+  * @param[in]  pu8Tx Bytes to send. If NULL, 0xFF is sent.
+  * @param[out] pu8Rx Buffer for received bytes. If NULL, received bytes are discarded.
+  * @param[in]  u32Len Number of bytes to shift.
+  * @return None
+  * @details Keeps up to SPIFLASH_FIFO_DEPTH bytes in flight so the bus clock runs back to back.
+  *          Returns after the last byte has been received, so the caller may deassert SS right away.
+  */
+static void SPIFLASH_Xfer(SPI_T *spi, const uint8_t *pu8Tx, uint8_t *pu8Rx, uint32_t u32Len)
+{
+    uint32_t u32TxCnt = 0, u32RxCnt = 0;
+    uint8_t u8Data;
+
+    while(u32RxCnt < u32Len)
+    {
+        if((u32TxCnt < u32Len) && ((u32TxCnt - u32RxCnt) < SPIFLASH_FIFO_DEPTH) && !SPI_GET_TX_FIFO_FULL_FLAG(spi))
+        {
+            SPI_WRITE_TX(spi, (pu8Tx != NULL) ? pu8Tx[u32TxCnt] : 0xFF);
+            u32TxCnt++;
+        }
+
+        if(!SPI_GET_RX_FIFO_EMPTY_FLAG(spi))
+        {
+            u8Data = (uint8_t)SPI_READ_RX(spi);
+            if(pu8Rx != NULL)
+                pu8Rx[u32RxCnt] = u8Data;
+            u32RxCnt++;
+        }
+    }
+}
+
+/**
+  * @brief Issue a command with an optional 24-bit address and dummy byte, then shift the data phase.
+  */
+static void SPIFLASH_Command(SPI_T *spi, uint8_t u8Cmd, uint32_t u32Addr, uint32_t u32HdrLen,
+                             const uint8_t *pu8Tx, uint8_t *pu8Rx, uint32_t u32Len)
+{
+    uint8_t au8Hdr[5];
+
+    au8Hdr[0] = u8Cmd;
+    au8Hdr[1] = (uint8_t)(u32Addr >> 16);
+    au8Hdr[2] = (uint8_t)(u32Addr >> 8);
+    au8Hdr[3] = (uint8_t)u32Addr;
+    au8Hdr[4] = 0xFF; /* Dummy byte, 8 dummy clocks for fast read */
+
+    SPI_SET_SS0_LOW(spi);
+    SPIFLASH_Xfer(spi, au8Hdr, NULL, u32HdrLen);
+    if(u32Len)
+        SPIFLASH_Xfer(spi, pu8Tx, pu8Rx, u32Len);
+    SPI_SET_SS0_HIGH(spi);
+}
+
+static void SPIFLASH_WriteEnable(SPI_T *spi)
+{
+    SPIFLASH_Command(spi, SPIFLASH_CMD_WRITE_ENABLE, 0, 1, NULL, NULL, 0);
+}
+
+/**
+  * @brief Return the cache line holding u32Tag. On a miss the least recently used line is refilled.
+  */
+static SPIFLASH_LINE_T *SPIFLASH_GetLine(SPIFLASH_T *flash, uint32_t u32Tag)
+{
+    SPIFLASH_LINE_T *psLine, *psVictim;
+    uint32_t i;
+
+    psVictim = &flash->asLine[0];
+    for(i = 0; i < SPIFLASH_CACHE_LINES; i++)
+    {
+        psLine = &flash->asLine[i];
+        if(psLine->u32Tag == u32Tag)
+        {
+            psLine->u32Stamp = ++flash->u32Stamp;
+            flash->u32CacheHit++;
+            return psLine;
+        }
+
+        /* Invalid lines carry stamp 0 and are therefore picked first */
+        if(psLine->u32Stamp < psVictim->u32Stamp)
+            psVictim = psLine;
+    }
+
+    SPIFLASH_Command(flash->spi, SPIFLASH_CMD_FAST_READ, u32Tag, 5, NULL, psVictim->au8Data, SPIFLASH_LINE_SIZE);
+    psVictim->u32Tag = u32Tag;
+    psVictim->u32Stamp = ++flash->u32Stamp;
+    flash->u32CacheMiss++;
+
+    return psVictim;
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Open the SPI NOR Flash device.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @param[in]  spi The pointer of the SPI module the flash is attached to.
+  * @param[in]  u32BusClock The expected frequency of SPI bus clock in Hz.
+  * @retval     SPIFLASH_OK Device found.
+  * @retval     SPIFLASH_ERR_ID No device answered the JEDEC ID command.
+  * @details    SPI is configured as master, SPI mode 0, 8-bit transaction, FIFO mode and manual slave select.
+  *             The SPI clock and multi-function pins must be set up before calling this function.
+  *             The read cache is cleared and the device size is decoded from the JEDEC capacity code.
+  */
+int32_t SPIFLASH_Open(SPIFLASH_T *flash, SPI_T *spi, uint32_t u32BusClock)
+{
+    uint32_t u32Capacity, i;
+
+    flash->spi = spi;
+    flash->u32State = SPIFLASH_STATE_IDLE;
+    flash->u32Stamp = 0;
+    flash->u32CacheHit = 0;
+    flash->u32CacheMiss = 0;
+    for(i = 0; i < SPIFLASH_CACHE_LINES; i++)
+    {
+        flash->asLine[i].u32Tag = SPIFLASH_INVALID_TAG;
+        flash->asLine[i].u32Stamp = 0;
+    }
+
+    SPI_Open(spi, SPI_MASTER, SPI_MODE_0, 8, u32BusClock);
+    SPI_DisableAutoSS(spi);
+    SPI_SET_SS0_HIGH(spi);
+    SPI_EnableFIFO(spi, 4, 4);
+    SPI_ClearRxFIFO(spi);
+    SPI_ClearTxFIFO(spi);
+
+    flash->u32JedecId = SPIFLASH_ReadJedecId(flash);
+    if((flash->u32JedecId == 0) || (flash->u32JedecId == 0xFFFFFFUL))
+        return SPIFLASH_ERR_ID;
+
+    /* Most vendors encode capacity as log2(size in bytes) */
+    u32Capacity = flash->u32JedecId & 0xFF;
+    if((u32Capacity >= 16) && (u32Capacity <= 24))
+        flash->u32Size = 1UL << u32Capacity;
+    else
+        flash->u32Size = 1UL << 24; /* 24-bit addressing limit */
+
+    return SPIFLASH_OK;
+}
+
+/**
+  * @brief      Read the JEDEC ID.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @return     Manufacturer ID [23:16], memory type [15:8] and capacity [7:0].
+  */
+uint32_t SPIFLASH_ReadJedecId(SPIFLASH_T *flash)
+{
+    uint8_t au8Id[3];
+
+    SPIFLASH_Command(flash->spi, SPIFLASH_CMD_READ_JEDEC_ID, 0, 1, NULL, au8Id, 3);
+
+    return ((uint32_t)au8Id[0] << 16) | ((uint32_t)au8Id[1] << 8) | au8Id[2];
+}
+
+/**
+  * @brief      Read status register 1.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @return     Status register value.
+  */
+uint32_t SPIFLASH_ReadStatus(SPIFLASH_T *flash)
+{
+    uint8_t u8Status;
+
+    SPIFLASH_Command(flash->spi, SPIFLASH_CMD_READ_STATUS, 0, 1, NULL, &u8Status, 1);
+
+    return u8Status;
+}
+
+/**
+  * @brief      Read data through the read cache.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @param[in]  u32Addr Flash address to read from.
+  * @param[out] pu8Buf Destination buffer.
+  * @param[in]  u32Len Number of bytes to read.
+  * @retval     SPIFLASH_OK Data read.
+  * @retval     SPIFLASH_BUSY A program or erase operation is in progress. Nothing was read.
+  * @retval     SPIFLASH_ERR_PARAM Range exceeds the device size.
+  * @details    Partial lines are served from the LRU cache. Whole, line-aligned lines are read with fast read
+  *             directly into pu8Buf without evicting the cache, so large sequential reads do not thrash it.
+  */
+int32_t SPIFLASH_Read(SPIFLASH_T *flash, uint32_t u32Addr, uint8_t *pu8Buf, uint32_t u32Len)
+{
+    SPIFLASH_LINE_T *psLine;
+    uint32_t u32Offset, u32Chunk, u32Direct, i;
+
+    if((u32Addr >= flash->u32Size) || (u32Len > flash->u32Size - u32Addr))
+        return SPIFLASH_ERR_PARAM;
+
+    if(SPIFLASH_Poll(flash) != SPIFLASH_OK)
+        return SPIFLASH_BUSY;
+
+    while(u32Len)
+    {
+        u32Offset = u32Addr & (SPIFLASH_LINE_SIZE - 1);
+
+        if((u32Offset == 0) && (u32Len >= SPIFLASH_LINE_SIZE))
+        {
+            /* Stream all whole lines in one fast read command */
+            u32Direct = u32Len & ~(SPIFLASH_LINE_SIZE - 1);
+            SPIFLASH_Command(flash->spi, SPIFLASH_CMD_FAST_READ, u32Addr, 5, NULL, pu8Buf, u32Direct);
+            u32Addr += u32Direct;
+            pu8Buf += u32Direct;
+            u32Len -= u32Direct;
+            continue;
+        }
+
+        u32Chunk = SPIFLASH_LINE_SIZE - u32Offset;
+        if(u32Chunk > u32Len)
+            u32Chunk = u32Len;
+
+        psLine = SPIFLASH_GetLine(flash, u32Addr - u32Offset);
+        for(i = 0; i < u32Chunk; i++)
+            pu8Buf[i] = psLine->au8Data[u32Offset + i];
+
+        u32Addr += u32Chunk;
+        pu8Buf += u32Chunk;
+        u32Len -= u32Chunk;
+    }
+
+    return SPIFLASH_OK;
+}
+
+/**
+  * @brief      Start programming data within one page.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @param[in]  u32Addr Flash address to program.
+  * @param[in]  pu8Buf Source data.
+  * @param[in]  u32Len Number of bytes. The range must not cross a SPIFLASH_PAGE_SIZE boundary.
+  * @retval     SPIFLASH_OK Page program started.
+  * @retval     SPIFLASH_BUSY A previous operation is still in progress. Nothing was started.
+  * @retval     SPIFLASH_ERR_PARAM Invalid range.
+  * @details    This function returns as soon as the data has been shifted out. The flash then programs
+  *             the page internally. Call SPIFLASH_Poll() until it returns SPIFLASH_OK before the next access.
+  */
+int32_t SPIFLASH_ProgramPage(SPIFLASH_T *flash, uint32_t u32Addr, const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    if((u32Len == 0) || (u32Addr >= flash->u32Size) || (u32Len > flash->u32Size - u32Addr) ||
+            ((u32Addr & (SPIFLASH_PAGE_SIZE - 1)) + u32Len > SPIFLASH_PAGE_SIZE))
+        return SPIFLASH_ERR_PARAM;
+
+    if(SPIFLASH_Poll(flash) != SPIFLASH_OK)
+        return SPIFLASH_BUSY;
+
+    SPIFLASH_InvalidateCache(flash, u32Addr, u32Len);
+
+    SPIFLASH_WriteEnable(flash->spi);
+    SPIFLASH_Command(flash->spi, SPIFLASH_CMD_PAGE_PROGRAM, u32Addr, 4, pu8Buf, NULL, u32Len);
+    flash->u32State = SPIFLASH_STATE_PROGRAM;
+
+    return SPIFLASH_OK;
+}
+
+/**
+  * @brief      Start erasing one sector.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @param[in]  u32Addr Any address within the sector.
+  * @retval     SPIFLASH_OK Sector erase started.
+  * @retval     SPIFLASH_BUSY A previous operation is still in progress. Nothing was started.
+  * @retval     SPIFLASH_ERR_PARAM Address exceeds the device size.
+  * @details    This function does not wait for the erase to complete. Call SPIFLASH_Poll() until it returns SPIFLASH_OK.
+  */
+int32_t SPIFLASH_EraseSector(SPIFLASH_T *flash, uint32_t u32Addr)
+{
+    if(u32Addr >= flash->u32Size)
+        return SPIFLASH_ERR_PARAM;
+
+    if(SPIFLASH_Poll(flash) != SPIFLASH_OK)
+        return SPIFLASH_BUSY;
+
+    u32Addr &= ~(SPIFLASH_SECTOR_SIZE - 1);
+    SPIFLASH_InvalidateCache(flash, u32Addr, SPIFLASH_SECTOR_SIZE);
+
+    SPIFLASH_WriteEnable(flash->spi);
+    SPIFLASH_Command(flash->spi, SPIFLASH_CMD_SECTOR_ERASE, u32Addr, 4, NULL, NULL, 0);
+    flash->u32State = SPIFLASH_STATE_ERASE;
+
+    return SPIFLASH_OK;
+}
+
+/**
+  * @brief      Advance the program/erase state machine.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @retval     SPIFLASH_OK No operation in progress.
+  * @retval     SPIFLASH_BUSY The flash is still programming or erasing.
+  * @details    Reads the WIP bit once and returns immediately. It costs a 2-byte SPI transfer while busy
+  *             and nothing when idle, so it can be called from the main loop or a periodic timer.
+  */
+int32_t SPIFLASH_Poll(SPIFLASH_T *flash)
+{
+    if(flash->u32State == SPIFLASH_STATE_IDLE)
+        return SPIFLASH_OK;
+
+    if(SPIFLASH_ReadStatus(flash) & SPIFLASH_SR_WIP)
+        return SPIFLASH_BUSY;
+
+    flash->u32State = SPIFLASH_STATE_IDLE;
+
+    return SPIFLASH_OK;
+}
+
+/**
+  * @brief      Invalidate cache lines overlapping an address range.
+  * @param[in]  flash The pointer of the SPI NOR Flash device.
+  * @param[in]  u32Addr Start address of the range.
+  * @param[in]  u32Len Length of the range in bytes.
+  * @return     None
+  * @details    Called internally before program and erase. Use it if the flash is modified by another master.
+  */
+void SPIFLASH_InvalidateCache(SPIFLASH_T *flash, uint32_t u32Addr, uint32_t u32Len)
+{
+    SPIFLASH_LINE_T *psLine;
+    uint32_t i;
+
+    for(i = 0; i < SPIFLASH_CACHE_LINES; i++)
+    {
+        psLine = &flash->asLine[i];
+        if(psLine->u32Tag == SPIFLASH_INVALID_TAG)
+            continue;
+
+        /* Overlap test written to avoid 32-bit overflow of u32Addr + u32Len */
+        if((psLine->u32Tag < u32Addr) ? (psLine->u32Tag + SPIFLASH_LINE_SIZE > u32Addr) : (psLine->u32Tag - u32Addr < u32Len))
+        {
+            psLine->u32Tag = SPIFLASH_INVALID_TAG;
+            psLine->u32Stamp = 0;
+        }
+    }
+}
+
+/*@}*/ /* end of group SPIFLASH_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group SPIFLASH_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,445 @@
+/**************************************************************************//**
+ * @file     swtimer.c
+ * @version  V3.00
+ * @brief    NUC1311 series software timer service source file
+ *
+ * @note     Any number of software timers are multiplexed on one TIMER channel by a hierarchical timing wheel.
+ *           The TIMER runs in continuous counting mode and its compare register is programmed to the next
+ *           expiry only, so there is no periodic tick interrupt while timers are idle.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "swtimer.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup SWTIMER_Driver Software Timer Driver
+  @{
+*/
+
+/** @addtogroup SWTIMER_EXPORTED_FUNCTIONS Software Timer Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define SWTIMER_SLOT_MSK        (SWTIMER_SLOTS - 1UL)
+#define SWTIMER_RANGE           (1UL << (SWTIMER_LEVELS * SWTIMER_SLOT_BITS))   /* Ticks covered by the wheel */
+#define SWTIMER_HW_MSK          0xFFFFFFUL                                      /* 24-bit TDR */
+#define SWTIMER_HW_MAX_SLEEP    (1UL << 22)                                     /* Longest compare distance, well inside one TDR wrap */
+#define SWTIMER_NO_EVENT        0xFFFFFFFFUL
+
+static TIMER_T *s_timer = NULL;
+static IRQn_Type s_eIRQn;
+static SWTIMER_T *s_apsSlot[SWTIMER_LEVELS][SWTIMER_SLOTS];
+static uint32_t s_au32Bitmap[SWTIMER_LEVELS];   /* Bit n set if slot n of the level is not empty */
+static uint32_t s_u32Wheel;                     /* Next tick whose level 0 slot has to be processed */
+static uint32_t s_u32Now;                       /* 32-bit tick extended from TDR */
+static uint32_t s_u32HwLast;                    /* TDR value s_u32Now corresponds to */
+
+/* Must be called with interrupts disabled */
+static uint32_t SWTIMER_UpdateNow(void)
+{
+    uint32_t u32Hw = s_timer->TDR & SWTIMER_HW_MSK;
+
+    s_u32Now += (u32Hw - s_u32HwLast) & SWTIMER_HW_MSK;
+    s_u32HwLast = u32Hw;
+
+    return s_u32Now;
+}
+
+static void SWTIMER_Link(SWTIMER_T *psTmr)
+{
+    uint32_t u32Delta = psTmr->u32Expire - s_u32Wheel;
+    uint32_t u32Level, u32Slot;
+
+    if(u32Delta >= SWTIMER_RANGE)
+    {
+        /* Beyond the wheel: park in the top level slot cascaded last, it is re-linked from there */
+        u32Level = SWTIMER_LEVELS - 1;
+        u32Slot = ((s_u32Wheel >> (u32Level * SWTIMER_SLOT_BITS)) + SWTIMER_SLOT_MSK) & SWTIMER_SLOT_MSK;
+    }
+    else
+    {
+        for(u32Level = 0; u32Level < SWTIMER_LEVELS - 1; u32Level++)
+        {
+            if(u32Delta < (1UL << ((u32Level + 1) * SWTIMER_SLOT_BITS)))
+                break;
+        }
+        u32Slot = (psTmr->u32Expire >> (u32Level * SWTIMER_SLOT_BITS)) & SWTIMER_SLOT_MSK;
+    }
+
+    psTmr->u8Level = (uint8_t)u32Level;
+    psTmr->u8Slot = (uint8_t)u32Slot;
+    psTmr->psPrev = NULL;
+    psTmr->psNext = s_apsSlot[u32Level][u32Slot];
+    if(psTmr->psNext != NULL)
+        psTmr->psNext->psPrev = psTmr;
+    s_apsSlot[u32Level][u32Slot] = psTmr;
+    s_au32Bitmap[u32Level] |= (1UL << u32Slot);
+    psTmr->u8Active = 1;
+}
+
+static void SWTIMER_Unlink(SWTIMER_T *psTmr)
+{
+    if(psTmr->psPrev != NULL)
+        psTmr->psPrev->psNext = psTmr->psNext;
+    else
+        s_apsSlot[psTmr->u8Level][psTmr->u8Slot] = psTmr->psNext;
+
+    if(psTmr->psNext != NULL)
+        psTmr->psNext->psPrev = psTmr->psPrev;
+
+    if(s_apsSlot[psTmr->u8Level][psTmr->u8Slot] == NULL)
+        s_au32Bitmap[psTmr->u8Level] &= ~(1UL << psTmr->u8Slot);
+
+    psTmr->u8Active = 0;
+}
+
+/* Move all timers of a higher level slot down the wheel */
+static void SWTIMER_Cascade(uint32_t u32Level, uint32_t u32Slot)
+{
+    SWTIMER_T *psTmr, *psNext;
+
+    psTmr = s_apsSlot[u32Level][u32Slot];
+    s_apsSlot[u32Level][u32Slot] = NULL;
+    s_au32Bitmap[u32Level] &= ~(1UL << u32Slot);
+
+    while(psTmr != NULL)
+    {
+        psNext = psTmr->psNext;
+        SWTIMER_Link(psTmr);
+        psTmr = psNext;
+    }
+}
+
+/* First tick at or after u32Tick at which the wheel has work to do: an expiry or a non-empty cascade */
+static uint32_t SWTIMER_NextEvent(uint32_t u32Tick)
+{
+    uint32_t u32Level, u32Shift, u32Idx, u32Map, u32Dist, u32Cand;
+    uint32_t u32Next = SWTIMER_NO_EVENT, u32NextDist = 0xFFFFFFFFUL;
+
+    for(u32Level = 0; u32Level < SWTIMER_LEVELS; u32Level++)
+    {
+        u32Map = s_au32Bitmap[u32Level];
+        if(u32Map == 0)
+            continue;
+
+        u32Shift = u32Level * SWTIMER_SLOT_BITS;
+        u32Idx = (u32Tick >> u32Shift) & SWTIMER_SLOT_MSK;
+
+        /* Rotate so that bit n is the slot n positions ahead of the current one */
+        if(u32Idx)
+            u32Map = (u32Map >> u32Idx) | (u32Map << (SWTIMER_SLOTS - u32Idx));
+
+        if(u32Level == 0)
+        {
+            u32Cand = u32Tick + SYS_Ctz(u32Map);
+        }
+        else
+        {
+            /* The current slot is still pending only if u32Tick is exactly its cascade boundary.
+               Otherwise it has been cascaded already and is next due one full turn later. */
+            u32Dist = SWTIMER_SLOTS;
+            if((u32Tick & ((1UL << u32Shift) - 1UL)) != 0)
+                u32Map &= ~1UL;
+            if(u32Map)
+                u32Dist = SYS_Ctz(u32Map);
+            u32Cand = ((u32Tick >> u32Shift) + u32Dist) << u32Shift;
+        }
+
+        if(u32Cand - u32Tick < u32NextDist)
+        {
+            u32NextDist = u32Cand - u32Tick;
+            u32Next = u32Cand;
+        }
+    }
+
+    return u32Next;
+}
+
+/* Program the compare register for the next event. Must be called with interrupts disabled. */
+static void SWTIMER_Schedule(void)
+{
+    uint32_t u32Now, u32Next, u32Cmp;
+
+    u32Now = SWTIMER_UpdateNow();
+    u32Next = SWTIMER_NextEvent(s_u32Wheel);
+
+    if((u32Next == SWTIMER_NO_EVENT) || ((int32_t)(u32Next - u32Now) > (int32_t)SWTIMER_HW_MAX_SLEEP))
+        u32Next = u32Now + SWTIMER_HW_MAX_SLEEP;
+
+    if((int32_t)(u32Next - u32Now) <= 0)
+    {
+        /* Already due, the compare match would only come after a full TDR wrap */
+        NVIC_SetPendingIRQ(s_eIRQn);
+        return;
+    }
+
+    u32Cmp = (s_u32HwLast + (u32Next - u32Now)) & SWTIMER_HW_MSK;
+    if(u32Cmp < 2)
+        u32Cmp = 2; /* 0 and 1 are not allowed in TCMPR */
+    s_timer->TCMPR = u32Cmp;
+
+    /* The counter may have passed the compare value while it was written */
+    if((int32_t)(u32Next - SWTIMER_UpdateNow()) <= 0)
+        NVIC_SetPendingIRQ(s_eIRQn);
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Start the software timer service on a TIMER channel.
+  * @param[in]  timer The pointer of the Timer module dedicated to the service. It could be TIMER0, TIMER1, TIMER2, TIMER3.
+  * @param[in]  u32TickFreq Target tick frequency in Hz.
+  * @return     Actual tick frequency.
+  * @details    The timer clock source must be selected and enabled before calling this function. The tick is the timer clock
+  *             divided by the 8-bit prescaler, so for a 1 kHz tick use LIRC (10 kHz) as the timer clock, which also keeps
+  *             the service running in power-down mode.
+  *             The user must call SWTIMER_IRQHandler() from the interrupt handler of the selected TIMER.
+  */
+uint32_t SWTIMER_Open(TIMER_T *timer, uint32_t u32TickFreq)
+{
+    uint32_t u32Clk = TIMER_GetModuleClock(timer);
+    uint32_t u32Prescale, i, j;
+
+    u32Prescale = (u32TickFreq == 0) ? 0xFF : (u32Clk / u32TickFreq);
+    if(u32Prescale > 0)
+        u32Prescale--;
+    if(u32Prescale > 0xFF)
+        u32Prescale = 0xFF;
+
+    if(timer == TIMER0)
+        s_eIRQn = TMR0_IRQn;
+    else if(timer == TIMER1)
+        s_eIRQn = TMR1_IRQn;
+    else if(timer == TIMER2)
+        s_eIRQn = TMR2_IRQn;
+    else
+        s_eIRQn = TMR3_IRQn;
+
+    for(i = 0; i < SWTIMER_LEVELS; i++)
+    {
+        s_au32Bitmap[i] = 0;
+        for(j = 0; j < SWTIMER_SLOTS; j++)
+            s_apsSlot[i][j] = NULL;
+    }
+
+    s_timer = timer;
+    s_u32Wheel = 0;
+    s_u32Now = 0;
+    s_u32HwLast = 0;
+
+    timer->TCSR = TIMER_TCSR_CRST_Msk;
+    timer->TEXCON = 0;
+    timer->TCMPR = SWTIMER_HW_MSK;
+    TIMER_ClearIntFlag(timer);
+    timer->TCSR = TIMER_TCSR_CEN_Msk | TIMER_TCSR_IE_Msk | TIMER_TCSR_TDR_EN_Msk | TIMER_CONTINUOUS_MODE | u32Prescale;
+
+    NVIC_EnableIRQ(s_eIRQn);
+
+    return u32Clk / (u32Prescale + 1);
+}
+
+/**
+  * @brief      Stop the software timer service.
+  * @param      None
+  * @return     None
+  * @details    The TIMER is stopped. Running software timers stay linked but will not expire until SWTIMER_Open() is called,
+  *             which discards them.
+  */
+void SWTIMER_Close(void)
+{
+    if(s_timer == NULL)
+        return;
+
+    NVIC_DisableIRQ(s_eIRQn);
+    TIMER_Close(s_timer);
+    s_timer = NULL;
+}
+
+/**
+  * @brief      Start or restart a software timer.
+  * @param[in]  psTmr The pointer of the software timer control block. It must stay valid while the timer is running.
+  * @param[in]  u32Ticks Ticks until the first expiry, 1 ~ SWTIMER_MAX_TICKS. 0 is treated as 1.
+  * @param[in]  u32Period Reload period in ticks for a periodic timer, 0 for a one-shot timer.
+  * @param[in]  pfnFunc Callback called in interrupt context on each expiry.
+  * @param[in]  pvArg Argument passed to pfnFunc.
+  * @retval     0 Timer started.
+  * @retval     -1 u32Ticks or u32Period out of range.
+  * @details    Linking a timer into the wheel is O(1). It may be called from any context, including a timer callback.
+  *             The callback runs at the expiry tick, except when that tick falls on TDR value 0 or 1: TCMPR cannot
+  *             hold 0 or 1, so it runs at TDR value 2, up to 2 ticks late.
+  */
+int32_t SWTIMER_Start(SWTIMER_T *psTmr, uint32_t u32Ticks, uint32_t u32Period, SWTIMER_FUNC_T pfnFunc, void *pvArg)
+{
+    uint32_t u32PriMask;
+
+    if((u32Ticks > SWTIMER_MAX_TICKS) || (u32Period > SWTIMER_MAX_TICKS))
+        return -1;
+
+    if(u32Ticks == 0)
+        u32Ticks = 1;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    if(psTmr->u8Active)
+        SWTIMER_Unlink(psTmr);
+
+    psTmr->pfnFunc = pfnFunc;
+    psTmr->pvArg = pvArg;
+    psTmr->u32Period = u32Period;
+    psTmr->u32Expire = SWTIMER_UpdateNow() + u32Ticks;
+    SWTIMER_Link(psTmr);
+    SWTIMER_Schedule();
+
+    __set_PRIMASK(u32PriMask);
+
+    return 0;
+}
+
+/**
+  * @brief      Stop a software timer.
+  * @param[in]  psTmr The pointer of the software timer control block.
+  * @return     None
+  * @details    Unlinking is O(1). Stopping a timer that is not running has no effect.
+  *             The hardware compare is left as it is; an early compare match just finds nothing to do.
+  */
+void SWTIMER_Stop(SWTIMER_T *psTmr)
+{
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    if(psTmr->u8Active)
+        SWTIMER_Unlink(psTmr);
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Get the number of ticks the service can leave the CPU alone.
+  * @param      None
+  * @return     Ticks until the next expiry or wheel cascade, 0 if one is already due,
+  *             0xFFFFFFFF if no software timer is running.
+  * @details    Used to choose a low power mode. The value may be earlier than the next expiry
+  *             because cascades of higher wheel levels are counted as events.
+  */
+uint32_t SWTIMER_GetIdleTicks(void)
+{
+    uint32_t u32PriMask, u32Now, u32Next, u32Idle;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    u32Now = SWTIMER_UpdateNow();
+    u32Next = SWTIMER_NextEvent(s_u32Wheel);
+
+    if(u32Next == SWTIMER_NO_EVENT)
+        u32Idle = 0xFFFFFFFFUL;
+    else if((int32_t)(u32Next - u32Now) <= 0)
+        u32Idle = 0;
+    else
+        u32Idle = u32Next - u32Now;
+
+    __set_PRIMASK(u32PriMask);
+
+    return u32Idle;
+}
+
+/**
+  * @brief      Get the current tick count.
+  * @param      None
+  * @return     32-bit tick counter extended from the 24-bit TIMER counter.
+  */
+uint32_t SWTIMER_GetTick(void)
+{
+    uint32_t u32PriMask, u32Now;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    u32Now = SWTIMER_UpdateNow();
+    __set_PRIMASK(u32PriMask);
+
+    return u32Now;
+}
+
+/**
+  * @brief      Software timer interrupt service.
+  * @param      None
+  * @return     None
+  * @details    Must be called from the interrupt handler of the TIMER passed to SWTIMER_Open().
+  *             All ticks up to now are processed. Empty stretches of the wheel are skipped using the slot bitmaps,
+  *             so the cost depends on the number of expiring and cascading timers, not on the elapsed time.
+  */
+void SWTIMER_IRQHandler(void)
+{
+    SWTIMER_T *psTmr;
+    uint32_t u32Now, u32Tick, u32Next, u32Slot;
+
+    TIMER_ClearIntFlag(s_timer);
+
+    __disable_irq();
+    u32Now = SWTIMER_UpdateNow();
+
+    while((int32_t)(u32Now - s_u32Wheel) >= 0)
+    {
+        u32Tick = s_u32Wheel;
+
+        if((u32Tick & SWTIMER_SLOT_MSK) == 0)
+        {
+            u32Slot = (u32Tick >> SWTIMER_SLOT_BITS) & SWTIMER_SLOT_MSK;
+            SWTIMER_Cascade(1, u32Slot);
+            if(u32Slot == 0)
+            {
+                u32Slot = (u32Tick >> (2 * SWTIMER_SLOT_BITS)) & SWTIMER_SLOT_MSK;
+                SWTIMER_Cascade(2, u32Slot);
+                if(u32Slot == 0)
+                    SWTIMER_Cascade(3, (u32Tick >> (3 * SWTIMER_SLOT_BITS)) & SWTIMER_SLOT_MSK);
+            }
+        }
+
+        /* Every timer in a level 0 slot expires exactly at this tick */
+        u32Slot = u32Tick & SWTIMER_SLOT_MSK;
+        while((psTmr = s_apsSlot[0][u32Slot]) != NULL)
+        {
+            SWTIMER_Unlink(psTmr);
+
+            if(psTmr->u32Period)
+            {
+                psTmr->u32Expire += psTmr->u32Period;
+                if((int32_t)(psTmr->u32Expire - u32Tick) <= 0)
+                    psTmr->u32Expire = u32Tick + psTmr->u32Period; /* Late: skip missed periods */
+                SWTIMER_Link(psTmr);
+            }
+
+            /* Callbacks may start and stop timers, so run them with interrupts enabled and the wheel consistent */
+            __enable_irq();
+            psTmr->pfnFunc(psTmr->pvArg);
+            __disable_irq();
+        }
+
+        /* Jump to the next tick with work, but never beyond now */
+        u32Next = SWTIMER_NextEvent(u32Tick + 1);
+        if((u32Next == SWTIMER_NO_EVENT) || ((int32_t)(u32Next - (u32Now + 1)) > 0))
+            u32Next = u32Now + 1;
+        s_u32Wheel = u32Next;
+    }
+
+    SWTIMER_Schedule();
+    __enable_irq();
+}
+
+/*@}*/ /* end of group SWTIMER_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group SWTIMER_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
@@ -0,0 +1,243 @@
+/**************************************************************************//**
+ * @file     tstamp.c
+ * @version  V3.00
+ * @brief    NUC1311 series microsecond timestamp service source file
+ *
+ * @note     One TIMER channel runs in continuous counting mode at 1 MHz. The 24-bit counter is extended to 64 bits
+ *           by the timer interrupt, which is raised every half counter period. Capture events of the same TIMER are
+ *           extended against the same time base, so all timestamps are directly comparable.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "tstamp.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup TSTAMP_Driver Timestamp Driver
+  @{
+*/
+
+/** @addtogroup TSTAMP_EXPORTED_FUNCTIONS Timestamp Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define TSTAMP_HW_MSK           0xFFFFFFUL                          /* 24-bit TDR */
+#define TSTAMP_HW_HALF          0x800000UL
+
+static TIMER_T *s_timer = NULL;
+static IRQn_Type s_eIRQn;
+static volatile uint64_t s_u64Base;                                 /* Timestamp at TDR value s_u32HwLast */
+static volatile uint32_t s_u32HwLast;
+static volatile uint64_t s_u64Cap;                                  /* Last captured timestamp */
+static volatile uint8_t s_u8CapNew;
+static TSTAMP_CAP_FUNC_T s_pfnCapFunc = NULL;
+
+/* Must be called with interrupts disabled */
+static uint64_t TSTAMP_Extend(uint32_t u32Hw)
+{
+    return s_u64Base + ((u32Hw - s_u32HwLast) & TSTAMP_HW_MSK);
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Start the timestamp service.
+  * @param[in]  timer The pointer of the Timer module used as time base. It could be TIMER0, TIMER1, TIMER2, TIMER3.
+  * @return     Actual timestamp frequency in Hz.
+  * @details    The TIMER clock source must be selected and enabled before calling this function. Timestamps count
+  *             microseconds exactly when the TIMER clock is an integer multiple of 1 MHz up to 256 MHz, otherwise
+  *             the returned frequency differs from TSTAMP_FREQ and can be used to scale them.
+  *             The TIMER interrupt is enabled; TSTAMP_IRQHandler() must be called from its handler.
+  */
+uint32_t TSTAMP_Open(TIMER_T *timer)
+{
+    uint32_t u32Clk = TIMER_GetModuleClock(timer);
+    uint32_t u32Prescale;
+
+    u32Prescale = u32Clk / TSTAMP_FREQ;
+    if(u32Prescale > 0)
+        u32Prescale--;
+    if(u32Prescale > 0xFF)
+        u32Prescale = 0xFF;
+
+    if(timer == TIMER0)
+        s_eIRQn = TMR0_IRQn;
+    else if(timer == TIMER1)
+        s_eIRQn = TMR1_IRQn;
+    else if(timer == TIMER2)
+        s_eIRQn = TMR2_IRQn;
+    else
+        s_eIRQn = TMR3_IRQn;
+
+    s_timer = timer;
+    s_u64Base = 0;
+    s_u32HwLast = 0;
+    s_u8CapNew = 0;
+    s_pfnCapFunc = NULL;
+
+    timer->TCSR = TIMER_TCSR_CRST_Msk;
+    timer->TEXCON = 0;
+    timer->TCMPR = TSTAMP_HW_HALF;
+    TIMER_ClearIntFlag(timer);
+    TIMER_ClearCaptureIntFlag(timer);
+    timer->TCSR = TIMER_TCSR_CEN_Msk | TIMER_TCSR_IE_Msk | TIMER_TCSR_TDR_EN_Msk | TIMER_CONTINUOUS_MODE | u32Prescale;
+
+    NVIC_EnableIRQ(s_eIRQn);
+
+    return u32Clk / (u32Prescale + 1);
+}
+
+/**
+  * @brief      Stop the timestamp service.
+  * @param      None
+  * @return     None
+  * @details    The TIMER and its capture function are stopped. TSTAMP_Get() keeps returning the last value.
+  */
+void TSTAMP_Close(void)
+{
+    if(s_timer == NULL)
+        return;
+
+    NVIC_DisableIRQ(s_eIRQn);
+    TIMER_Close(s_timer);
+    s_timer = NULL;
+}
+
+/**
+  * @brief      Get the 64-bit timestamp.
+  * @param      None
+  * @return     Microseconds since TSTAMP_Open().
+  * @details    Can be called from thread mode and from any interrupt priority. The value is consistent even if the
+  *             counter wrapped and the timer interrupt is still pending, as long as interrupts are not held
+  *             disabled for more than half a counter period (about 8 seconds at 1 MHz).
+  */
+uint64_t TSTAMP_Get(void)
+{
+    uint32_t u32Primask;
+    uint64_t u64Stamp;
+
+    if(s_timer == NULL)
+        return s_u64Base;
+
+    u32Primask = __get_PRIMASK();
+    __disable_irq();
+    u64Stamp = TSTAMP_Extend(s_timer->TDR & TSTAMP_HW_MSK);
+    __set_PRIMASK(u32Primask);
+
+    return u64Stamp;
+}
+
+/**
+  * @brief      Timestamp capture events of the TIMER external pin.
+  * @param[in]  u32Edge Detection edge of the TxEX pin. Valid values are
+  *                     - \ref TIMER_CAPTURE_FALLING_EDGE
+  *                     - \ref TIMER_CAPTURE_RISING_EDGE
+  *                     - \ref TIMER_CAPTURE_FALLING_AND_RISING_EDGE
+  * @param[in]  pfnFunc Called from TSTAMP_IRQHandler() with the timestamp of each capture. Could be NULL.
+  * @return     None
+  * @details    The counter keeps running freely; captured values are latched and read with TSTAMP_GetCapture().
+  *             The TxEX pin multi-function must be configured by the application.
+  */
+void TSTAMP_EnableCapture(uint32_t u32Edge, TSTAMP_CAP_FUNC_T pfnFunc)
+{
+    s_pfnCapFunc = pfnFunc;
+    s_u8CapNew = 0;
+    TIMER_ClearCaptureIntFlag(s_timer);
+    TIMER_EnableCapture(s_timer, TIMER_CAPTURE_FREE_COUNTING_MODE, u32Edge);
+    TIMER_EnableCaptureInt(s_timer);
+}
+
+/**
+  * @brief      Stop timestamping capture events.
+  * @param      None
+  * @return     None
+  */
+void TSTAMP_DisableCapture(void)
+{
+    TIMER_DisableCaptureInt(s_timer);
+    TIMER_DisableCapture(s_timer);
+    s_pfnCapFunc = NULL;
+}
+
+/**
+  * @brief      Read the latched capture timestamp.
+  * @param[out] pu64Stamp Timestamp of the most recent capture event.
+  * @retval     0 No capture since the last call, *pu64Stamp holds the previous capture.
+  * @retval     1 A new capture was latched. Earlier captures not read in time are overwritten.
+  */
+int32_t TSTAMP_GetCapture(uint64_t *pu64Stamp)
+{
+    uint32_t u32Primask;
+    int32_t i32New;
+
+    u32Primask = __get_PRIMASK();
+    __disable_irq();
+    *pu64Stamp = s_u64Cap;
+    i32New = s_u8CapNew;
+    s_u8CapNew = 0;
+    __set_PRIMASK(u32Primask);
+
+    return i32New;
+}
+
+/**
+  * @brief      Timestamp service interrupt handler.
+  * @param      None
+  * @return     None
+  * @details    Must be called from the interrupt handler of the TIMER passed to TSTAMP_Open().
+  *             The compare register alternates between the middle and the end of the counter range, so the 64-bit
+  *             base is advanced twice per counter period.
+  */
+void TSTAMP_IRQHandler(void)
+{
+    uint32_t u32Hw, u32Cap;
+    uint64_t u64Cap;
+
+    __disable_irq();
+
+    u32Hw = s_timer->TDR & TSTAMP_HW_MSK;
+
+    if(TIMER_GetCaptureIntFlag(s_timer))
+    {
+        /* TCAP was latched before u32Hw, so the distance back from u32Hw is less than one counter period */
+        TIMER_ClearCaptureIntFlag(s_timer);
+        u32Cap = TIMER_GetCaptureData(s_timer) & TSTAMP_HW_MSK;
+        u64Cap = TSTAMP_Extend(u32Hw) - ((u32Hw - u32Cap) & TSTAMP_HW_MSK);
+        s_u64Cap = u64Cap;
+        s_u8CapNew = 1;
+
+        if(s_pfnCapFunc != NULL)
+        {
+            __enable_irq();
+            s_pfnCapFunc(u64Cap);
+            __disable_irq();
+            u32Hw = s_timer->TDR & TSTAMP_HW_MSK;
+        }
+    }
+
+    if(TIMER_GetIntFlag(s_timer))
+    {
+        TIMER_ClearIntFlag(s_timer);
+        s_timer->TCMPR = (s_timer->TCMPR == TSTAMP_HW_HALF) ? TSTAMP_HW_MSK : TSTAMP_HW_HALF;
+    }
+
+    s_u64Base = TSTAMP_Extend(u32Hw);
+    s_u32HwLast = u32Hw;
+
+    __enable_irq();
+}
+
+/*@}*/ /* end of group TSTAMP_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group TSTAMP_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
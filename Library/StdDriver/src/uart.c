@@ -24,6 +24,55 @@
   @{
 */
 
+/// @cond HIDDEN_SYMBOLS
+
+#define UART_CLK_SRC_SEL()  (CLK->CLKSEL1 & CLK_CLKSEL1_UART_S_Msk)
+#define UART_CLK_DIV()      (((CLK->CLKDIV & CLK_CLKDIV_UART_N_Msk) >> CLK_CLKDIV_UART_N_Pos) + 1)
+
+/* UART clock frequency of a clock source selection and divider */
+static uint32_t UART_GetClockFreq(uint32_t u32ClkSrc, uint32_t u32ClkDiv)
+{
+    if(u32ClkSrc == CLK_CLKSEL1_UART_S_HXT)
+        return __HXT / u32ClkDiv;
+    if(u32ClkSrc == CLK_CLKSEL1_UART_S_PLL)
+        return CLK_GetPLLClockFreq() / u32ClkDiv;
+    return __HIRC / u32ClkDiv;
+}
+
+/* Keep the better of the current plan and the divider M * D, with D = BRD + 2 */
+static void UART_TryDivider(uint32_t u32ClkFreq, uint32_t u32BaudRate, uint32_t u32M, uint32_t u32D, uint32_t u32Mode, UART_BAUD_PLAN_T *psPlan)
+{
+    uint32_t u32N = u32M * u32D;
+    int32_t i32Err;
+
+    /* (clock / N - baud) / baud */
+    i32Err = (int32_t)(((int64_t)u32ClkFreq - (int64_t)u32BaudRate * u32N) * 1000000 / ((int64_t)u32BaudRate * u32N));
+
+    if((i32Err < 0 ? -i32Err : i32Err) < (psPlan->i32ErrPpm < 0 ? -psPlan->i32ErrPpm : psPlan->i32ErrPpm))
+    {
+        psPlan->u32Baud = u32Mode | (u32D - 2);
+        if(u32Mode == UART_BAUD_MODE1)
+            psPlan->u32Baud |= (u32M - 1) << UART_BAUD_DIVIDER_X_Pos;
+        psPlan->u32Actual = (u32ClkFreq + u32N / 2) / u32N;
+        psPlan->i32ErrPpm = i32Err;
+    }
+}
+
+/* Set the baud rate with the current UART clock, or the nearest rate the dividers reach */
+static void UART_SetBaudRate(UART_T* uart, uint32_t u32BaudRate)
+{
+    UART_BAUD_PLAN_T sPlan;
+
+    if(UART_PlanBaud(u32BaudRate, UART_BAUD_PLAN_CURRENT, &sPlan) == 0)
+        uart->BAUD = sPlan.u32Baud;
+    else if(sPlan.u32ClkFreq / 5 < u32BaudRate)
+        uart->BAUD = UART_BAUD_MODE2 | 3;           /* Too fast, the smallest divider */
+    else
+        uart->BAUD = UART_BAUD_MODE0 | 0xFFFF;      /* Too slow, the largest divider */
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
 /**
  *    @brief        Clear UART specified interrupt flag
  *
@@ -190,19 +239,10 @@ void UART_EnableInt(UART_T*  uart, uint32_t u32InterruptFlag)
  *    @return       None
  *
  *    @details      This function use to enable UART function and set baud-rate.
+ *                  A baud rate out of the divider range is set to the nearest rate the UART clock reaches.
  */
 void UART_Open(UART_T* uart, uint32_t u32baudrate)
 {
-    uint8_t u8UartClkSrcSel, u8UartClkDivNum;
-    uint32_t au32ClkTbl[4] = {__HXT, 0, 0, __HIRC};
-    uint32_t u32Baud_Div = 0;
-
-    /* Get UART clock source selection */
-    u8UartClkSrcSel = (CLK->CLKSEL1 & CLK_CLKSEL1_UART_S_Msk) >> CLK_CLKSEL1_UART_S_Pos;
-
-    /* Get UART clock divider number */
-    u8UartClkDivNum = (CLK->CLKDIV & CLK_CLKDIV_UART_N_Msk) >> CLK_CLKDIV_UART_N_Pos;
-
     /* Select UART function */
     uart->FUN_SEL = UART_FUNC_SEL_UART;
 
@@ -212,20 +252,137 @@ void UART_Open(UART_T* uart, uint32_t u32baudrate)
     /* Set UART Rx and RTS trigger level */
     uart->FCR &= ~(UART_FCR_RFITL_Msk | UART_FCR_RTS_TRI_LEV_Msk);
 
-    /* Get PLL clock frequency if UART clock source selection is PLL */
-    if(u8UartClkSrcSel == 1)
-        au32ClkTbl[u8UartClkSrcSel] = CLK_GetPLLClockFreq();
-
     /* Set UART baud rate */
     if(u32baudrate != 0)
+        UART_SetBaudRate(uart, u32baudrate);
+}
+
+
+/**
+ *    @brief        Find the best baud rate divider for a UART clock
+ *
+ *    @param[in]    u32ClkFreq      UART clock frequency after the UART_N divider.
+ *    @param[in]    u32BaudRate     Target baud rate.
+ *    @param[out]   psPlan          u32Baud, u32Actual and i32ErrPpm of the best divider. u32ClkFreq is set,
+ *                                  u32ClkSrc and u32ClkDiv are not changed.
+ *
+ *    @retval       0   Success
+ *    @retval       -1  The baud rate can not be reached with this clock
+ *
+ *    @details      All BRD values of mode 2 (divider BRD + 2, BRD >= 3), mode 0 (16 * (BRD + 2)) and mode 1
+ *                  ((DIVIDER_X + 1) * (BRD + 2), DIVIDER_X >= 8) around the target are compared. On equal error
+ *                  mode 2 is preferred, then mode 0. The function does not access registers.
+ */
+int32_t UART_CalcBaud(uint32_t u32ClkFreq, uint32_t u32BaudRate, UART_BAUD_PLAN_T *psPlan)
+{
+    uint32_t u32M, u32D;
+
+    psPlan->u32ClkFreq = u32ClkFreq;
+    psPlan->u32Actual = 0;
+    psPlan->i32ErrPpm = 0x7FFFFFFF;
+
+    if((u32ClkFreq == 0) || (u32BaudRate == 0))
+        return -1;
+
+    /* Mode 2, the divider on both sides of the target */
+    u32D = u32ClkFreq / u32BaudRate;
+    if((u32D >= 5) && (u32D <= 0xFFFF + 2))
+        UART_TryDivider(u32ClkFreq, u32BaudRate, 1, u32D, UART_BAUD_MODE2, psPlan);
+    if((u32D + 1 >= 5) && (u32D + 1 <= 0xFFFF + 2))
+        UART_TryDivider(u32ClkFreq, u32BaudRate, 1, u32D + 1, UART_BAUD_MODE2, psPlan);
+
+    /* Mode 0 and mode 1 */
+    for(u32M = 16; u32M >= 9; u32M--)
     {
-        u32Baud_Div = UART_BAUD_MODE2_DIVIDER((au32ClkTbl[u8UartClkSrcSel]) / (u8UartClkDivNum + 1), u32baudrate);
+        u32D = u32ClkFreq / (u32BaudRate * u32M);
+        if((u32D >= 2) && (u32D <= 0xFFFF + 2))
+            UART_TryDivider(u32ClkFreq, u32BaudRate, u32M, u32D, (u32M == 16) ? UART_BAUD_MODE0 : UART_BAUD_MODE1, psPlan);
+        if((u32D + 1 >= 2) && (u32D + 1 <= 0xFFFF + 2))
+            UART_TryDivider(u32ClkFreq, u32BaudRate, u32M, u32D + 1, (u32M == 16) ? UART_BAUD_MODE0 : UART_BAUD_MODE1, psPlan);
+    }
+
+    return (psPlan->u32Actual != 0) ? 0 : -1;
+}
+
 
-        if(u32Baud_Div > 0xFFFF)
-            uart->BAUD = (UART_BAUD_MODE0 | UART_BAUD_MODE0_DIVIDER((au32ClkTbl[u8UartClkSrcSel]) / (u8UartClkDivNum + 1), u32baudrate));
-        else
-            uart->BAUD = (UART_BAUD_MODE2 | u32Baud_Div);
+/**
+ *    @brief        Plan the UART clock and baud rate divider for a baud rate
+ *
+ *    @param[in]    u32BaudRate     Target baud rate.
+ *    @param[in]    u32ClkMask      UART clock sources to consider:
+ *                                  - \ref UART_BAUD_PLAN_CURRENT : keep the current UART clock source and divider
+ *                                  - \ref UART_BAUD_PLAN_HXT, \ref UART_BAUD_PLAN_PLL, \ref UART_BAUD_PLAN_HIRC or
+ *                                    \ref UART_BAUD_PLAN_ALL : search these clock sources and UART_N 1 ~ 16
+ *    @param[out]   psPlan          The plan with the smallest baud rate error.
+ *
+ *    @retval       0   Success
+ *    @retval       -1  The baud rate can not be reached
+ *
+ *    @details      Clock sources that are not stable are skipped. On equal error the current clock source and the
+ *                  smaller UART_N are preferred. The UART clock is shared by all UART modules, so a plan that changes
+ *                  it also changes the baud rate of the other UARTs. Nothing is written, see UART_ApplyBaudPlan().
+ */
+int32_t UART_PlanBaud(uint32_t u32BaudRate, uint32_t u32ClkMask, UART_BAUD_PLAN_T *psPlan)
+{
+    uint32_t au32Src[4] = {0, CLK_CLKSEL1_UART_S_HXT, CLK_CLKSEL1_UART_S_PLL, CLK_CLKSEL1_UART_S_HIRC};
+    uint32_t au32Stable[4] = {CLK_CLKSTATUS_XTL12M_STB_Msk, CLK_CLKSTATUS_PLL_STB_Msk, 0, CLK_CLKSTATUS_OSC22M_STB_Msk};
+    UART_BAUD_PLAN_T sTry;
+    uint32_t u32Src, u32Sel, u32Div, i;
+
+    psPlan->u32ClkSrc = UART_CLK_SRC_SEL();
+    psPlan->u32ClkDiv = UART_CLK_DIV();
+
+    if(u32ClkMask == UART_BAUD_PLAN_CURRENT)
+        return UART_CalcBaud(UART_GetClockFreq(psPlan->u32ClkSrc, psPlan->u32ClkDiv), u32BaudRate, psPlan);
+
+    psPlan->u32Actual = 0;
+    psPlan->i32ErrPpm = 0x7FFFFFFF;
+
+    /* The current clock source first */
+    au32Src[0] = psPlan->u32ClkSrc;
+
+    for(i = 0; i < 4; i++)
+    {
+        u32Src = au32Src[i];
+        u32Sel = u32Src >> CLK_CLKSEL1_UART_S_Pos;
+
+        if(((i > 0) && (u32Src == au32Src[0])) || ((u32ClkMask & (1UL << u32Sel)) == 0) ||
+                ((CLK->CLKSTATUS & au32Stable[u32Sel]) == 0))
+            continue;
+
+        for(u32Div = 1; u32Div <= 16; u32Div++)
+        {
+            if(UART_CalcBaud(UART_GetClockFreq(u32Src, u32Div), u32BaudRate, &sTry) != 0)
+                continue;
+
+            if((sTry.i32ErrPpm < 0 ? -sTry.i32ErrPpm : sTry.i32ErrPpm) <
+                    (psPlan->i32ErrPpm < 0 ? -psPlan->i32ErrPpm : psPlan->i32ErrPpm))
+            {
+                *psPlan = sTry;
+                psPlan->u32ClkSrc = u32Src;
+                psPlan->u32ClkDiv = u32Div;
+            }
+        }
     }
+
+    return (psPlan->u32Actual != 0) ? 0 : -1;
+}
+
+
+/**
+ *    @brief        Apply a baud rate plan
+ *
+ *    @param[in]    uart    The pointer of the specified UART module.
+ *    @param[in]    psPlan  Plan from UART_PlanBaud().
+ *
+ *    @return       None
+ *
+ *    @details      The UART clock source and divider are shared by all UART modules.
+ */
+void UART_ApplyBaudPlan(UART_T* uart, const UART_BAUD_PLAN_T *psPlan)
+{
+    CLK_SetModuleClock(UART0_MODULE, psPlan->u32ClkSrc, CLK_CLKDIV_UART(psPlan->u32ClkDiv));
+    uart->BAUD = psPlan->u32Baud;
 }
 
 
@@ -287,33 +444,13 @@ uint32_t UART_Read(UART_T* uart, uint8_t *pu8RxBuf, uint32_t u32ReadBytes)
  *    @return       None
  *
  *    @details      This function use to config UART line setting.
+ *                  A baud rate out of the divider range is set to the nearest rate the UART clock reaches.
  */
 void UART_SetLine_Config(UART_T* uart, uint32_t u32baudrate, uint32_t u32data_width, uint32_t u32parity, uint32_t  u32stop_bits)
 {
-    uint8_t u8UartClkSrcSel, u8UartClkDivNum;
-    uint32_t au32ClkTbl[4] = {__HXT, 0, 0, __HIRC};
-    uint32_t u32Baud_Div = 0;
-
-    /* Get UART clock source selection */
-    u8UartClkSrcSel = (CLK->CLKSEL1 & CLK_CLKSEL1_UART_S_Msk) >> CLK_CLKSEL1_UART_S_Pos;
-
-    /* Get UART clock divider number */
-    u8UartClkDivNum = (CLK->CLKDIV & CLK_CLKDIV_UART_N_Msk) >> CLK_CLKDIV_UART_N_Pos;
-
-    /* Get PLL clock frequency if UART clock source selection is PLL */
-    if(u8UartClkSrcSel == 1)
-        au32ClkTbl[u8UartClkSrcSel] = CLK_GetPLLClockFreq();
-
     /* Set UART baud rate */
     if(u32baudrate != 0)
-    {
-        u32Baud_Div = UART_BAUD_MODE2_DIVIDER((au32ClkTbl[u8UartClkSrcSel]) / (u8UartClkDivNum + 1), u32baudrate);
-
-        if(u32Baud_Div > 0xFFFF)
-            uart->BAUD = (UART_BAUD_MODE0 | UART_BAUD_MODE0_DIVIDER((au32ClkTbl[u8UartClkSrcSel]) / (u8UartClkDivNum + 1), u32baudrate));
-        else
-            uart->BAUD = (UART_BAUD_MODE2 | u32Baud_Div);
-    }
+        UART_SetBaudRate(uart, u32baudrate);
 
     /* Set UART line configuration */
     uart->LCR = u32data_width | u32parity | u32stop_bits;
@@ -355,27 +492,15 @@ void UART_SetTimeoutCnt(UART_T* uart, uint32_t u32TOC)
  */
 void UART_SelectIrDAMode(UART_T* uart, uint32_t u32Buadrate, uint32_t u32Direction)
 {
-    uint8_t u8UartClkSrcSel, u8UartClkDivNum;
-    uint32_t au32ClkTbl[4] = {__HXT, 0, 0, __HIRC};
     uint32_t u32Baud_Div;
 
     /* Select IrDA function mode */
     uart->FUN_SEL = UART_FUNC_SEL_IrDA;
 
-    /* Get UART clock source selection */
-    u8UartClkSrcSel = (CLK->CLKSEL1 & CLK_CLKSEL1_UART_S_Msk) >> CLK_CLKSEL1_UART_S_Pos;
-
-    /* Get UART clock divider number */
-    u8UartClkDivNum = (CLK->CLKDIV & CLK_CLKDIV_UART_N_Msk) >> CLK_CLKDIV_UART_N_Pos;
-
-    /* Get PLL clock frequency if UART clock source selection is PLL */
-    if(u8UartClkSrcSel == 1)
-        au32ClkTbl[u8UartClkSrcSel] = CLK_GetPLLClockFreq();
-
     /* Set UART IrDA baud rate in mode 0 */
     if(u32Buadrate != 0)
     {
-        u32Baud_Div = UART_BAUD_MODE0_DIVIDER((au32ClkTbl[u8UartClkSrcSel]) / (u8UartClkDivNum + 1), u32Buadrate);
+        u32Baud_Div = UART_BAUD_MODE0_DIVIDER(UART_GetClockFreq(UART_CLK_SRC_SEL(), UART_CLK_DIV()), u32Buadrate);
 
         if(u32Baud_Div < 0xFFFF)
             uart->BAUD = (UART_BAUD_MODE0 | u32Baud_Div);
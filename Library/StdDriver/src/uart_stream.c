@@ -0,0 +1,308 @@
+/**************************************************************************//**
+ * @file     uart_stream.c
+ * @version  V3.00
+ * @brief    NUC1311 series UART streaming with auto flow control source file
+ *
+ * @note     Received bytes are moved from the RX FIFO to a ring buffer on the FIFO trigger level and the RX time-out
+ *           interrupts, transmitted bytes from a ring buffer to the TX FIFO on the THRE interrupt, in blocks of up to
+ *           one FIFO. Auto RTS/CTS flow control is on. When the RX ring is full the RX interrupts are turned off, so
+ *           the RX FIFO fills up and the hardware deasserts RTS; they are turned on again once the application has
+ *           read enough. No byte is lost as long as the peer stops within the FIFO room above the RTS trigger level.
+ *           Throttle times are measured with the timestamp service (tstamp.c) and read 0 if it is not open.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "uart_stream.h"
+#include "tstamp.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup UARTSTREAM_Driver UART Streaming
+  @{
+*/
+
+/** @addtogroup UARTSTREAM_EXPORTED_FUNCTIONS UART Streaming Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+#define UARTSTREAM_RX_IEN       (UART_IER_RDA_IEN_Msk | UART_IER_TOUT_IEN_Msk)
+
+static IRQn_Type UARTSTREAM_GetIRQn(UART_T *uart)
+{
+    return (uart == UART1) ? UART1_IRQn : UART02_IRQn;
+}
+
+static void UARTSTREAM_Receive(UARTSTREAM_T *psStream)
+{
+    UART_T *uart = psStream->uart;
+    uint8_t *pu8Buf = psStream->pu8RxBuf;
+    uint32_t u32Mask = psStream->u32RxMask;
+    uint32_t u32Head = psStream->u32RxHead;
+    uint32_t u32Fsr = uart->FSR;
+    uint32_t u32Level, u32Free, u32Used;
+
+    u32Level = (u32Fsr & UART_FSR_RX_FULL_Msk) ? UART0_FIFO_SIZE :
+               ((u32Fsr & UART_FSR_RX_POINTER_Msk) >> UART_FSR_RX_POINTER_Pos);
+    if(u32Level > psStream->sStat.u32RxFifoHigh)
+        psStream->sStat.u32RxFifoHigh = u32Level;
+
+    u32Free = u32Mask + 1 - (u32Head - psStream->u32RxTail);
+    if(u32Level > u32Free)
+        u32Level = u32Free;
+
+    psStream->sStat.u32RxBytes += u32Level;
+    while(u32Level--)
+        pu8Buf[u32Head++ & u32Mask] = (uint8_t)uart->RBR;
+    psStream->u32RxHead = u32Head;
+
+    u32Used = u32Head - psStream->u32RxTail;
+    if(u32Used > psStream->sStat.u32RxRingHigh)
+        psStream->sStat.u32RxRingHigh = u32Used;
+
+    if((u32Used > u32Mask) && ((uart->FSR & UART_FSR_RX_EMPTY_Msk) == 0))
+    {
+        /* Ring full: leave the bytes in the FIFO and let auto RTS hold the peer */
+        uart->IER &= ~UARTSTREAM_RX_IEN;
+        psStream->u32Throttled = 1;
+        psStream->u32ThrottleStart = TSTAMP_Get32();
+        psStream->sStat.u32Throttles++;
+    }
+}
+
+static void UARTSTREAM_Transmit(UARTSTREAM_T *psStream)
+{
+    UART_T *uart = psStream->uart;
+    uint8_t *pu8Buf = psStream->pu8TxBuf;
+    uint32_t u32Mask = psStream->u32TxMask;
+    uint32_t u32Tail = psStream->u32TxTail;
+    uint32_t u32Count;
+
+    /* THRE: the TX FIFO is empty */
+    u32Count = psStream->u32TxHead - u32Tail;
+    if(u32Count > UART0_FIFO_SIZE)
+        u32Count = UART0_FIFO_SIZE;
+
+    psStream->sStat.u32TxBytes += u32Count;
+    while(u32Count--)
+        uart->THR = pu8Buf[u32Tail++ & u32Mask];
+    psStream->u32TxTail = u32Tail;
+
+    if(u32Tail == psStream->u32TxHead)
+        uart->IER &= ~UART_IER_THRE_IEN_Msk;
+}
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Open a UART stream.
+  * @param[in]  psStream   Stream control block. It must stay valid while the stream is open.
+  * @param[in]  uart       The pointer of the specified UART module, UART0 ~ UART2. It must be opened with UART_Open()
+  *                        and its CTS and RTS pins set up.
+  * @param[in]  pu8RxBuf   RX ring buffer.
+  * @param[in]  u32RxSize  RX ring size, a power of 2, 16 or more.
+  * @param[in]  pu8TxBuf   TX ring buffer.
+  * @param[in]  u32TxSize  TX ring size, a power of 2, 16 or more.
+  * @retval     0                       Success
+  * @retval     UARTSTREAM_ERR_PARAM    Invalid parameter
+  * @details    Auto flow control is enabled with low active CTS and RTS. The thresholds start as RX trigger level
+  *             8 bytes, RTS trigger level 14 bytes, RX time-out 32 bit times and resume at a quarter of the RX ring,
+  *             see UARTSTREAM_SetThreshold(). UARTSTREAM_IRQHandler() must be called from the UART interrupt handler.
+  */
+int32_t UARTSTREAM_Open(UARTSTREAM_T *psStream, UART_T *uart, uint8_t *pu8RxBuf, uint32_t u32RxSize, uint8_t *pu8TxBuf, uint32_t u32TxSize)
+{
+    /* UART0 ~ UART2 have FIFOs of the same depth, UART0_FIFO_SIZE */
+    if((uart == UART3) || (u32RxSize < UART0_FIFO_SIZE) || (u32TxSize < UART0_FIFO_SIZE) ||
+            (u32RxSize & (u32RxSize - 1)) || (u32TxSize & (u32TxSize - 1)))
+        return UARTSTREAM_ERR_PARAM;
+
+    psStream->uart = uart;
+    psStream->pu8RxBuf = pu8RxBuf;
+    psStream->pu8TxBuf = pu8TxBuf;
+    psStream->u32RxMask = u32RxSize - 1;
+    psStream->u32TxMask = u32TxSize - 1;
+    psStream->u32RxHead = 0;
+    psStream->u32RxTail = 0;
+    psStream->u32TxHead = 0;
+    psStream->u32TxTail = 0;
+    psStream->u32Throttled = 0;
+    UARTSTREAM_ClearStat(psStream);
+
+    uart->IER = 0;
+    uart->FCR |= UART_FCR_RFR_Msk | UART_FCR_TFR_Msk;
+    UARTSTREAM_SetThreshold(psStream, UART_FCR_RFITL_8BYTES, UART_FCR_RTS_TRI_LEV_14BYTES, 32, u32RxSize / 4);
+    UART_ClearIntFlag(uart, UART_ISR_BUF_ERR_INT_Msk);
+
+    UART_EnableFlowCtrl(uart);
+    uart->IER |= UARTSTREAM_RX_IEN | UART_IER_BUF_ERR_IEN_Msk;
+
+    NVIC_EnableIRQ(UARTSTREAM_GetIRQn(uart));
+
+    return 0;
+}
+
+/**
+  * @brief      Tune the stream thresholds.
+  * @param[in]  psStream        Stream opened by UARTSTREAM_Open().
+  * @param[in]  u32RxTrigger    RX FIFO interrupt trigger level, \ref UART_FCR_RFITL_1BYTE ~ \ref UART_FCR_RFITL_14BYTES.
+  *                             Higher levels mean fewer interrupts.
+  * @param[in]  u32RtsTrigger   RX FIFO level that deasserts RTS, \ref UART_FCR_RTS_TRI_LEV_1BYTE ~
+  *                             \ref UART_FCR_RTS_TRI_LEV_14BYTES. The FIFO room above it must hold what the peer
+  *                             sends after RTS is deasserted.
+  * @param[in]  u32TimeoutBits  Idle bit times before the bytes below the RX trigger level are moved, 1 ~ 255.
+  * @param[in]  u32Resume       Free RX ring bytes needed before a throttled receiver is resumed.
+  * @return     None
+  */
+void UARTSTREAM_SetThreshold(UARTSTREAM_T *psStream, uint32_t u32RxTrigger, uint32_t u32RtsTrigger, uint32_t u32TimeoutBits, uint32_t u32Resume)
+{
+    UART_T *uart = psStream->uart;
+
+    uart->FCR = (uart->FCR & ~(UART_FCR_RFITL_Msk | UART_FCR_RTS_TRI_LEV_Msk)) | u32RxTrigger | u32RtsTrigger;
+    UART_SetTimeoutCnt(uart, u32TimeoutBits);
+
+    if(u32Resume == 0)
+        u32Resume = 1;
+    if(u32Resume > psStream->u32RxMask + 1)
+        u32Resume = psStream->u32RxMask + 1;
+    psStream->u32Resume = u32Resume;
+}
+
+/**
+  * @brief      Close a UART stream.
+  * @param[in]  psStream  Stream opened by UARTSTREAM_Open().
+  * @return     None
+  * @details    Bytes still in the TX ring are discarded.
+  */
+void UARTSTREAM_Close(UARTSTREAM_T *psStream)
+{
+    NVIC_DisableIRQ(UARTSTREAM_GetIRQn(psStream->uart));
+    UART_DisableFlowCtrl(psStream->uart);
+    UART_Close(psStream->uart);
+}
+
+/**
+  * @brief      Read received bytes.
+  * @param[in]  psStream  Stream opened by UARTSTREAM_Open().
+  * @param[out] pu8Buf    Buffer for the bytes.
+  * @param[in]  u32Len    Buffer size.
+  * @return     Number of bytes read, 0 if none are waiting. The function does not block.
+  */
+uint32_t UARTSTREAM_Read(UARTSTREAM_T *psStream, uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t u32Tail = psStream->u32RxTail;
+    uint32_t u32Mask = psStream->u32RxMask;
+    uint32_t u32Count, u32Elapsed, u32PriMask, i;
+
+    u32Count = psStream->u32RxHead - u32Tail;
+    if(u32Count > u32Len)
+        u32Count = u32Len;
+
+    for(i = 0; i < u32Count; i++)
+        pu8Buf[i] = psStream->pu8RxBuf[u32Tail++ & u32Mask];
+    psStream->u32RxTail = u32Tail;
+
+    if(psStream->u32Throttled && (u32Mask + 1 - (psStream->u32RxHead - u32Tail) >= psStream->u32Resume))
+    {
+        u32Elapsed = TSTAMP_Get32() - psStream->u32ThrottleStart;
+        psStream->sStat.u32ThrottleUs += u32Elapsed;
+        if(u32Elapsed > psStream->sStat.u32ThrottleMaxUs)
+            psStream->sStat.u32ThrottleMaxUs = u32Elapsed;
+
+        u32PriMask = __get_PRIMASK();
+        __disable_irq();
+        psStream->u32Throttled = 0;
+        psStream->uart->IER |= UARTSTREAM_RX_IEN;
+        __set_PRIMASK(u32PriMask);
+    }
+
+    return u32Count;
+}
+
+/**
+  * @brief      Queue bytes for transmission.
+  * @param[in]  psStream  Stream opened by UARTSTREAM_Open().
+  * @param[in]  pu8Buf    Bytes to send.
+  * @param[in]  u32Len    Number of bytes.
+  * @return     Number of bytes queued, less than u32Len if the TX ring is full. The function does not block.
+  */
+uint32_t UARTSTREAM_Write(UARTSTREAM_T *psStream, const uint8_t *pu8Buf, uint32_t u32Len)
+{
+    uint32_t u32Head = psStream->u32TxHead;
+    uint32_t u32Mask = psStream->u32TxMask;
+    uint32_t u32Count, u32PriMask, i;
+
+    u32Count = u32Mask + 1 - (u32Head - psStream->u32TxTail);
+    if(u32Count > u32Len)
+        u32Count = u32Len;
+
+    for(i = 0; i < u32Count; i++)
+        psStream->pu8TxBuf[u32Head++ & u32Mask] = pu8Buf[i];
+    psStream->u32TxHead = u32Head;
+
+    if(u32Count)
+    {
+        u32PriMask = __get_PRIMASK();
+        __disable_irq();
+        psStream->uart->IER |= UART_IER_THRE_IEN_Msk;
+        __set_PRIMASK(u32PriMask);
+    }
+
+    return u32Count;
+}
+
+/**
+  * @brief      Clear the stream statistics.
+  * @param[in]  psStream  Stream opened by UARTSTREAM_Open().
+  * @return     None
+  */
+void UARTSTREAM_ClearStat(UARTSTREAM_T *psStream)
+{
+    psStream->sStat.u32RxBytes = 0;
+    psStream->sStat.u32TxBytes = 0;
+    psStream->sStat.u32RxFifoHigh = 0;
+    psStream->sStat.u32RxRingHigh = 0;
+    psStream->sStat.u32Overruns = 0;
+    psStream->sStat.u32Throttles = 0;
+    psStream->sStat.u32ThrottleUs = 0;
+    psStream->sStat.u32ThrottleMaxUs = 0;
+}
+
+/**
+  * @brief      UART stream interrupt handler.
+  * @param[in]  psStream  Stream opened by UARTSTREAM_Open().
+  * @return     None
+  * @details    Must be called from the interrupt handler of the stream UART. UART0 and UART2 share one handler, which
+  *             calls this function for each open stream.
+  */
+void UARTSTREAM_IRQHandler(UARTSTREAM_T *psStream)
+{
+    UART_T *uart = psStream->uart;
+    uint32_t u32Isr = uart->ISR;
+
+    if(u32Isr & UART_ISR_BUF_ERR_INT_Msk)
+    {
+        if(uart->FSR & UART_FSR_RX_OVER_IF_Msk)
+            psStream->sStat.u32Overruns++;
+        UART_ClearIntFlag(uart, UART_ISR_BUF_ERR_INT_Msk);
+    }
+
+    if(u32Isr & (UART_ISR_RDA_INT_Msk | UART_ISR_TOUT_INT_Msk))
+        UARTSTREAM_Receive(psStream);
+
+    if(u32Isr & UART_ISR_THRE_INT_Msk)
+        UARTSTREAM_Transmit(psStream);
+}
+
+/*@}*/ /* end of group UARTSTREAM_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group UARTSTREAM_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,183 @@
+/**************************************************************************//**
+ * @file     wdmux.c
+ * @version  V3.00
+ * @brief    NUC1311 series watchdog multiplexer source file
+ *
+ * @note     Any number of tasks are supervised by WWDT and WDT together. Every WWDT compare match interrupt is
+ *           one supervision period. If all tasks checked in within their deadline the interrupt reloads WWDT and
+ *           resets the WDT counter. Otherwise neither is refreshed, the starved task is reported and WWDT resets
+ *           the chip when its counter reaches 0. WDT is the backstop if the WWDT interrupt stops being served.
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include "NUC1311.h"
+#include "wdmux.h"
+
+/** @addtogroup Device_Driver NUC1311 Device Driver
+  @{
+*/
+
+/** @addtogroup WDMUX_Driver Watchdog Multiplexer
+  @{
+*/
+
+/** @addtogroup WDMUX_EXPORTED_FUNCTIONS Watchdog Multiplexer Exported Functions
+  @{
+*/
+
+/// @cond HIDDEN_SYMBOLS
+
+static WDMUX_TASK_T *s_psHead = NULL;
+static WDMUX_TASK_T *s_psStarved = NULL;
+static WDMUX_STARVED_FUNC_T s_pfnStarved = NULL;
+
+/// @endcond HIDDEN_SYMBOLS
+
+
+/**
+  * @brief      Start the watchdog multiplexer.
+  * @param[in]  u32WdtTimeout    WDT time-out interval, \ref WDT_TIMEOUT_2POW4 ~ \ref WDT_TIMEOUT_2POW18.
+  *                              It must be longer than one WWDT period.
+  * @param[in]  u32WwdtPrescale  WWDT pre-scale, \ref WWDT_PRESCALER_1 ~ \ref WWDT_PRESCALER_2048.
+  * @param[in]  u32WwdtCmp       WWDT window compare value, 0x1 ~ 0x3E. One supervision period is (0x3F - u32WwdtCmp)
+  *                              WWDT counts; the starved handler has u32WwdtCmp counts before the reset.
+  * @param[in]  pfnStarved       Called with the first starved task before the reset. Could be NULL.
+  * @return     None
+  * @details    WDT and WWDT clocks must be enabled and the register write-protection disabled before calling this
+  *             function. WWDTCR can only be written once after reset, so this function can only be called once.
+  *             WDMUX_IRQHandler() must be called from WDT_IRQHandler.
+  */
+void WDMUX_Open(uint32_t u32WdtTimeout, uint32_t u32WwdtPrescale, uint32_t u32WwdtCmp, WDMUX_STARVED_FUNC_T pfnStarved)
+{
+    s_psStarved = NULL;
+    s_pfnStarved = pfnStarved;
+
+    WDT_Open(u32WdtTimeout, WDT_RESET_DELAY_1026CLK, TRUE, FALSE);
+    WWDT_Open(u32WwdtPrescale, u32WwdtCmp, TRUE);
+
+    NVIC_EnableIRQ(WDT_IRQn);
+}
+
+/**
+  * @brief      Add a task to the supervision.
+  * @param[in]  psTask      Task control block. It must stay valid while registered.
+  * @param[in]  u32Periods  Deadline in supervision periods. The task must call WDMUX_CheckIn() at least this often.
+  * @param[in]  pcName      Task name reported on starvation. Could be NULL.
+  * @return     None
+  * @details    The deadline starts with this call.
+  */
+void WDMUX_Register(WDMUX_TASK_T *psTask, uint32_t u32Periods, const char *pcName)
+{
+    uint32_t u32PriMask;
+
+    psTask->u32Periods = u32Periods;
+    psTask->u32Remain = u32Periods;
+    psTask->pcName = pcName;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+    psTask->psNext = s_psHead;
+    s_psHead = psTask;
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Remove a task from the supervision.
+  * @param[in]  psTask  Task control block passed to WDMUX_Register().
+  * @return     None
+  */
+void WDMUX_Unregister(WDMUX_TASK_T *psTask)
+{
+    WDMUX_TASK_T **ppsLink;
+    uint32_t u32PriMask;
+
+    u32PriMask = __get_PRIMASK();
+    __disable_irq();
+
+    for(ppsLink = &s_psHead; *ppsLink != NULL; ppsLink = &(*ppsLink)->psNext)
+    {
+        if(*ppsLink == psTask)
+        {
+            *ppsLink = psTask->psNext;
+            break;
+        }
+    }
+
+    __set_PRIMASK(u32PriMask);
+}
+
+/**
+  * @brief      Get the task that stopped the watchdog refresh.
+  * @param      None
+  * @return     The first starved task, NULL while all tasks meet their deadlines.
+  */
+WDMUX_TASK_T *WDMUX_GetStarved(void)
+{
+    return s_psStarved;
+}
+
+/**
+  * @brief      Watchdog multiplexer interrupt handler.
+  * @param      None
+  * @return     None
+  * @details    Must be called from WDT_IRQHandler. The cost is one decrement per registered task and period.
+  *             Each decrement runs with interrupts disabled, so a WDMUX_CheckIn() cannot land between its read
+  *             and write and be overwritten.
+  */
+void WDMUX_IRQHandler(void)
+{
+    WDMUX_TASK_T *psTask;
+    uint32_t u32Locked, u32Remain, u32PriMask;
+
+    if(WDT_GET_TIMEOUT_INT_FLAG())
+        WDT_CLEAR_TIMEOUT_INT_FLAG();
+
+    if(WWDT_GET_INT_FLAG() == 0)
+        return;
+
+    WWDT_CLEAR_INT_FLAG();
+
+    if(s_psStarved != NULL)
+        return;     /* Waiting for the reset */
+
+    for(psTask = s_psHead; psTask != NULL; psTask = psTask->psNext)
+    {
+        u32PriMask = __get_PRIMASK();
+        __disable_irq();
+        u32Remain = psTask->u32Remain;
+        if(u32Remain != 0)
+            psTask->u32Remain = u32Remain - 1;
+        __set_PRIMASK(u32PriMask);
+
+        if(u32Remain == 0)
+        {
+            s_psStarved = psTask;
+            break;
+        }
+    }
+
+    if(s_psStarved != NULL)
+    {
+        if(s_pfnStarved != NULL)
+            s_pfnStarved(s_psStarved);
+        return;
+    }
+
+    WWDT_RELOAD_COUNTER();
+
+    u32Locked = SYS_IsRegLocked();
+    if(u32Locked)
+        SYS_UnlockReg();
+    WDT_RESET_COUNTER();
+    if(u32Locked)
+        SYS_LockReg();
+}
+
+/*@}*/ /* end of group WDMUX_EXPORTED_FUNCTIONS */
+
+/*@}*/ /* end of group WDMUX_Driver */
+
+/*@}*/ /* end of group Device_Driver */
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,140 @@
+# Per-function code size and estimated cycle report of static libraries.
+#
+#   cmake -DNM=<nm> -DOBJDUMP=<objdump> -DLIBS=<lib>[,<lib>...] -DOUT=<file> [-DPROFILE=<name>] -P size_report.cmake
+#
+# Cycles are a static estimate for one straight pass through each function on Cortex-M0 without
+# flash wait states: loads and stores 2, BL 4, other taken branches 3, conditional branches 2,
+# PUSH/POP/LDM/STM 1 + number of registers (+3 when POP loads PC), everything else 1.
+# Loops are counted once, so the value ranks functions rather than predicting their run time.
+
+string(REPLACE "," ";" LIBS "${LIBS}")
+
+set(ROWS "")
+set(TOTAL_SIZE 0)
+set(TOTAL_FUNCS 0)
+
+foreach(LIB ${LIBS})
+    #-----------------------------------------------------------------------------------------------------
+    # Function sizes
+    #-----------------------------------------------------------------------------------------------------
+    execute_process(COMMAND ${NM} --print-size --defined-only ${LIB}
+                    OUTPUT_VARIABLE NM_OUT RESULT_VARIABLE RES)
+    if(NOT RES EQUAL 0)
+        message(FATAL_ERROR "${NM} failed on ${LIB}")
+    endif()
+
+    string(REPLACE ";" " " NM_OUT "${NM_OUT}")
+    string(REPLACE "\n" ";" NM_LINES "${NM_OUT}")
+    foreach(LINE ${NM_LINES})
+        if(LINE MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) [TtWw] (.+)$")
+            math(EXPR SIZE "0x${CMAKE_MATCH_1}")
+            set(SIZE_${CMAKE_MATCH_2} ${SIZE})
+            list(APPEND FUNCS ${CMAKE_MATCH_2})
+        endif()
+    endforeach()
+
+    #-----------------------------------------------------------------------------------------------------
+    # Instruction count and cycle estimate
+    #-----------------------------------------------------------------------------------------------------
+    execute_process(COMMAND ${OBJDUMP} -d --no-show-raw-insn ${LIB}
+                    OUTPUT_VARIABLE DIS_OUT RESULT_VARIABLE RES)
+    if(NOT RES EQUAL 0)
+        message(FATAL_ERROR "${OBJDUMP} failed on ${LIB}")
+    endif()
+
+    string(REPLACE ";" " " DIS_OUT "${DIS_OUT}")
+    string(REPLACE "[" "(" DIS_OUT "${DIS_OUT}")
+    string(REPLACE "]" ")" DIS_OUT "${DIS_OUT}")
+    string(REPLACE "\n" ";" DIS_LINES "${DIS_OUT}")
+
+    set(FUNC "")
+    foreach(LINE ${DIS_LINES})
+        if(LINE MATCHES "^[0-9a-fA-F]+ <([^>]+)>:")
+            set(FUNC ${CMAKE_MATCH_1})
+            set(INSN_${FUNC} 0)
+            set(CYC_${FUNC} 0)
+        elseif(FUNC AND LINE MATCHES "^ *[0-9a-fA-F]+:\t([a-z0-9.]+)(.*)$")
+            set(MN ${CMAKE_MATCH_1})
+            set(OPS "${CMAKE_MATCH_2}")
+            string(REGEX REPLACE "\\.[nw]$" "" MN "${MN}")
+
+            if(MN MATCHES "^(push|pop|ldm|ldmia|stm|stmia)$")
+                string(REGEX MATCH "{[^}]*}" REGS "${OPS}")
+                string(REGEX MATCHALL "," COMMAS "${REGS}")
+                list(LENGTH COMMAS N)
+                math(EXPR CYC "2 + ${N}")
+                if(MN STREQUAL "pop" AND REGS MATCHES "pc")
+                    math(EXPR CYC "${CYC} + 3")
+                endif()
+            elseif(MN MATCHES "^(ldr|str)")
+                set(CYC 2)
+            elseif(MN STREQUAL "bl")
+                set(CYC 4)
+            elseif(MN MATCHES "^(b|bx|blx)$")
+                set(CYC 3)
+            elseif(MN MATCHES "^b(eq|ne|cs|cc|hs|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le)$")
+                set(CYC 2)
+            else()
+                set(CYC 1)
+            endif()
+
+            math(EXPR INSN_${FUNC} "${INSN_${FUNC}} + 1")
+            math(EXPR CYC_${FUNC} "${CYC_${FUNC}} + ${CYC}")
+        endif()
+    endforeach()
+endforeach()
+
+#---------------------------------------------------------------------------------------------------------
+# Report sorted by size
+#---------------------------------------------------------------------------------------------------------
+if(FUNCS)
+    list(REMOVE_DUPLICATES FUNCS)
+endif()
+
+foreach(FUNC ${FUNCS})
+    set(SIZE ${SIZE_${FUNC}})
+    if(NOT DEFINED INSN_${FUNC})
+        set(INSN_${FUNC} 0)
+        set(CYC_${FUNC} 0)
+    endif()
+
+    # Zero padded key so that the lexical sort is numerical
+    string(LENGTH "${SIZE}" LEN)
+    math(EXPR PAD "8 - ${LEN}")
+    string(REPEAT "0" ${PAD} ZEROS)
+    list(APPEND ROWS "${ZEROS}${SIZE}|${FUNC}")
+
+    math(EXPR TOTAL_SIZE "${TOTAL_SIZE} + ${SIZE}")
+    math(EXPR TOTAL_FUNCS "${TOTAL_FUNCS} + 1")
+endforeach()
+
+if(ROWS)
+    list(SORT ROWS ORDER DESCENDING)
+endif()
+
+function(pad_left OUTVAR VALUE WIDTH)
+    string(LENGTH "${VALUE}" LEN)
+    if(LEN LESS WIDTH)
+        math(EXPR PAD "${WIDTH} - ${LEN}")
+        string(REPEAT " " ${PAD} SPACES)
+        set(VALUE "${SPACES}${VALUE}")
+    endif()
+    set(${OUTVAR} "${VALUE}" PARENT_SCOPE)
+endfunction()
+
+set(REPORT "NUC1311 library size report, profile ${PROFILE}\n\n")
+string(APPEND REPORT "    Size   Insns  Cycles  Function\n")
+
+foreach(ROW ${ROWS})
+    string(REGEX MATCH "^([0-9]+)\\|(.*)$" _ "${ROW}")
+    set(FUNC ${CMAKE_MATCH_2})
+    pad_left(C1 "${SIZE_${FUNC}}" 8)
+    pad_left(C2 "${INSN_${FUNC}}" 8)
+    pad_left(C3 "${CYC_${FUNC}}" 8)
+    string(APPEND REPORT "${C1}${C2}${C3}  ${FUNC}\n")
+endforeach()
+
+string(APPEND REPORT "\nTotal: ${TOTAL_SIZE} bytes in ${TOTAL_FUNCS} functions\n")
+
+file(WRITE ${OUT} "${REPORT}")
+message(STATUS "Total: ${TOTAL_SIZE} bytes in ${TOTAL_FUNCS} functions")
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "NUC1311.h"
+#include "can_txq.h"
 
 #define V6M_AIRCR_VECTKEY_DATA            0x05FA0000UL
 #define V6M_AIRCR_SYSRESETREQ             0x00000004UL
@@ -24,6 +25,7 @@
 #define Device0_ISP_ID                    0x784
 #define CAN_ISP_DtatLength                0x08
 #define CAN_RETRY_COUNTS                  0x1fffffff
+#define CAN_ISP_ACK_QUEUE                 4
 
 #define CMD_READ_CONFIG                   0xA2000000
 #define CMD_RUN_APROM                     0xAB000000
@@ -42,19 +44,28 @@ typedef struct
 } STR_CANMSG_ISP;
 
 STR_CANMSG_T rrMsg;
-volatile uint8_t u8CAN_PackageFlag = 0, u8CAN_AckFlag = 0;
+volatile uint8_t u8CAN_PackageFlag = 0;
 uint32_t Chip_EndAddress = 0;
 
+/* Acknowledges wait in a transmit queue sent from message object 5 */
+CANTXQ_T sAckQ;
+CANTXQ_ENTRY_T asAckBuf[CAN_ISP_ACK_QUEUE];
+
 /*---------------------------------------------------------------------------------------------------------*/
 /* ISR to handle CAN interrupt event                                                                       */
 /*---------------------------------------------------------------------------------------------------------*/
-void CAN_MsgInterrupt(CAN_T *tCAN, uint32_t u32IIDR)
+void CAN_MsgInterrupt(CAN_T *tCAN, uint32_t u32MsgNum, void *pvArg)
 {
-    if(u32IIDR == 1)
-    {
-        CAN_Receive(tCAN, 0, &rrMsg);
-        u8CAN_PackageFlag = 1;
-    }
+    CAN_Receive(tCAN, u32MsgNum, &rrMsg);
+    u8CAN_PackageFlag = 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* Transmit interrupt of the acknowledge object, loads the next queued acknowledge                         */
+/*---------------------------------------------------------------------------------------------------------*/
+void CAN_AckInterrupt(CAN_T *tCAN, uint32_t u32MsgNum, void *pvArg)
+{
+    CANTXQ_IRQHandler((CANTXQ_T *)pvArg, u32MsgNum);
 }
 
 /*---------------------------------------------------------------------------------------------------------*/
@@ -62,30 +73,7 @@ void CAN_MsgInterrupt(CAN_T *tCAN, uint32_t u32IIDR)
 /*---------------------------------------------------------------------------------------------------------*/
 void CAN0_IRQHandler(void)
 {
-    uint32_t u8IIDRstatus;
-    u8IIDRstatus = CAN0->IIDR;
-
-    if(u8IIDRstatus == 0x00008000)        /* Check Status Interrupt Flag (Error status Int and Status change Int) */
-    {
-        /**************************/
-        /* Status Change interrupt*/
-        /**************************/
-        if(CAN0->STATUS & CAN_STATUS_RXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_RXOK_Msk;   /* Clear RxOK status*/
-        }
-
-        if(CAN0->STATUS & CAN_STATUS_TXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_TXOK_Msk;    /* Clear TxOK status*/
-            u8CAN_AckFlag = 0;
-        }
-    }
-    else if(u8IIDRstatus != 0)
-    {
-        CAN_MsgInterrupt(CAN0, u8IIDRstatus);
-        CAN_CLR_INT_PENDING_BIT(CAN0, (u8IIDRstatus - 1)); /* Clear Interrupt Pending */
-    }
+    CAN_IRQDispatch(CAN0);
 }
 
 int32_t SYS_Init(void)
@@ -122,12 +110,11 @@ int32_t SYS_Init(void)
 }
 
 /*----------------------------------------------------------------------------*/
-/*  Tx Msg by Normal Mode Function (With Message RAM)                         */
+/*  Queue the acknowledge, the next command is handled while it is sent       */
 /*----------------------------------------------------------------------------*/
 void CAN_Package_ACK(CAN_T *tCAN)
 {
     STR_CANMSG_T tMsg;
-    u8CAN_AckFlag = 1;
     /* Send a 11-bit Standard Identifier message */
     tMsg.FrameType = CAN_DATA_FRAME;
     tMsg.IdType    = CAN_STD_ID;
@@ -135,12 +122,8 @@ void CAN_Package_ACK(CAN_T *tCAN)
     tMsg.DLC       = CAN_ISP_DtatLength;
     memcpy(&tMsg.Data, &rrMsg.Data, 8);
 
-    if(CAN_Transmit(tCAN, MSG(5), &tMsg) == FALSE)    // Configure Msg RAM and send the Msg in the RAM
-    {
-        return;
-    }
-
-    while(u8CAN_AckFlag);
+    /* The host waits for each acknowledge, a full queue means it has given up on them */
+    CANTXQ_Send(&sAckQ, &tMsg);
 }
 
 void CAN_Init(void)
@@ -153,7 +136,10 @@ void CAN_Init(void)
     SYS->GPD_MFP |= SYS_GPD_MFP_PD6_CAN0_RXD | SYS_GPD_MFP_PD7_CAN0_TXD;
 
     CAN_Open(CAN0, CAN_BAUD_RATE, CAN_NORMAL_MODE);
-    CAN_EnableInt(CAN0, (CAN_CON_IE_Msk | CAN_CON_SIE_Msk | CAN_CON_EIE_Msk));
+    CANTXQ_Open(&sAckQ, CAN0, MSG(5), 1, asAckBuf, CAN_ISP_ACK_QUEUE);
+    CAN_InstallMsgHandler(CAN0, MSG(0), CAN_MsgInterrupt, NULL);
+    CAN_InstallMsgHandler(CAN0, MSG(5), CAN_AckInterrupt, &sAckQ);
+    CAN_EnableInt(CAN0, (CAN_CON_IE_Msk | CAN_CON_EIE_Msk));
     NVIC_SetPriority(CAN0_IRQn, (1 << __NVIC_PRIO_BITS) - 2);
     NVIC_EnableIRQ(CAN0_IRQn);
     /* Set CAN reveive message */
@@ -1,6 +1,6 @@
 /***************************************************************************//**
  * @file     fmc_user.c
- * @brief    NUC1311 series FMC driver source file
+ * @brief    NUC1311 series ISP flash access source file
  * @version  2.0.0
  *
  * @copyright SPDX-License-Identifier: Apache-2.0
@@ -9,18 +9,21 @@
 #include <stdio.h>
 #include "fmc_user.h"
 
+#define CONFIG0_DFEN                0x01
+#define CONFIG0_DFVSEN              0x04
+
+uint32_t g_apromSize, g_dataFlashAddr, g_dataFlashSize;
+
 int FMC_Proc(unsigned int u32Cmd, unsigned int addr_start, unsigned int addr_end, unsigned int *data)
 {
     unsigned int u32Addr, Reg;
     uint32_t u32TimeOutCnt;
 
-    for(u32Addr = addr_start; u32Addr < addr_end; data++)
-    {
+    for (u32Addr = addr_start; u32Addr < addr_end; data++) {
         FMC->ISPCMD = u32Cmd;
         FMC->ISPADR = u32Addr;
 
-        if(u32Cmd == FMC_ISPCMD_PROGRAM)
-        {
+        if (u32Cmd == FMC_ISPCMD_PROGRAM) {
             FMC->ISPDAT = *data;
         }
 
@@ -29,28 +32,23 @@ int FMC_Proc(unsigned int u32Cmd, unsigned int addr_start, unsigned int addr_end
 
         /* Wait for ISP command done. */
         u32TimeOutCnt = FMC_TIMEOUT_WRITE;
-        while(FMC->ISPTRG & 0x1)
-            if(--u32TimeOutCnt == 0) return -1;
+        while (FMC->ISPTRG & 0x1)
+            if (--u32TimeOutCnt == 0) return -1;
 
         Reg = FMC->ISPCON;
 
-        if(Reg & FMC_ISPCON_ISPFF_Msk)
-        {
+        if (Reg & FMC_ISPCON_ISPFF_Msk) {
             FMC->ISPCON = Reg;
             return -1;
         }
 
-        if(u32Cmd == FMC_ISPCMD_READ)
-        {
+        if (u32Cmd == FMC_ISPCMD_READ) {
             *data = FMC->ISPDAT;
         }
 
-        if(u32Cmd == FMC_ISPCMD_PAGE_ERASE)
-        {
+        if (u32Cmd == FMC_ISPCMD_PAGE_ERASE) {
             u32Addr += FMC_FLASH_PAGE_SIZE;
-        }
-        else
-        {
+        } else {
             u32Addr += 4;
         }
     }
@@ -117,34 +115,74 @@ int FMC_Erase_User(unsigned int u32Addr)
 void ReadData(unsigned int addr_start, unsigned int addr_end, unsigned int *data)    // Read data from flash
 {
     FMC_Proc(FMC_ISPCMD_READ, addr_start, addr_end, data);
-    return;
 }
 
 void WriteData(unsigned int addr_start, unsigned int addr_end, unsigned int *data)  // Write data into flash
 {
     FMC_Proc(FMC_ISPCMD_PROGRAM, addr_start, addr_end, data);
-    return;
 }
 
-int EraseAP(unsigned int addr_start, unsigned int size)
+void EraseAP(unsigned int addr_start, unsigned int addr_end)    // Erase the pages from addr_start up to addr_end
 {
-    return FMC_Proc(FMC_ISPCMD_PAGE_ERASE, addr_start, addr_start + size, NULL);
+    FMC_Proc(FMC_ISPCMD_PAGE_ERASE, addr_start, addr_end, NULL);
 }
 
 void UpdateConfig(unsigned int *data, unsigned int *res)
 {
-    // For NUC1311 series, CONIFG2 must be 0xFFFFFF5A (Don't modify this value. It should be 0xFFFFFF5A after reset.)
-    unsigned int u32Size = 8;
     FMC_ENABLE_CFG_UPDATE();
-    FMC_Proc(FMC_ISPCMD_PAGE_ERASE, Config0, Config0 + 8, 0);
-    FMC_Proc(FMC_ISPCMD_PROGRAM, Config0, Config0 + u32Size, data);
+    FMC_Erase_User(Config0);
+    FMC_Proc(FMC_ISPCMD_PROGRAM, Config0, Config0 + 8, data);
 
-    if(res)
-    {
-        FMC_Proc(FMC_ISPCMD_READ, Config0, Config0 + u32Size, res);
+    if (res) {
+        FMC_Proc(FMC_ISPCMD_READ, Config0, Config0 + 8, res);
     }
 
     FMC_DISABLE_CFG_UPDATE();
 }
 
-/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
+// Supports 32K/64K (APROM)
+uint32_t GetApromSize(void)
+{
+    uint32_t size = 0xA000, data;
+    int result;
+    result = FMC_Read_User(size, &data);
+
+    if (result < 0) {
+        return 32 * 1024;
+    } else {
+        return 64 * 1024;
+    }
+}
+
+void GetDataFlashInfo(uint32_t *addr, uint32_t *size)
+{
+    uint32_t uData;
+    g_apromSize = GetApromSize();
+    *size = 0;
+    /* Note: DFVSEN = 1, DATA Flash Size is 4K bytes
+             DFVSEN = 0, DATA Flash Size is based on CONFIG1 */
+    FMC_Read_User(Config0, &uData);
+
+    if (uData & CONFIG0_DFVSEN) {
+        *addr = 0x1F000;
+        *size = 4096;//4K
+    } else if (uData & CONFIG0_DFEN) {
+        g_apromSize += 4096;
+        *addr = g_apromSize;
+        *size = 0;
+    } else {
+        g_apromSize += 4096;
+        FMC_Read_User(Config1, &uData);
+        uData &= 0x000FFE00UL;
+
+        if (uData > (g_apromSize + 4096)) { //avoid config1 value from error
+            uData = g_apromSize;
+        }
+
+        *addr = uData;
+        *size = g_apromSize - uData;
+        g_apromSize -= *size;
+    }
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,32 @@
+/***************************************************************************//**
+ * @file     fmc_user.h
+ * @brief    NUC1311 series ISP flash access header file
+ * @version  2.0.0
+ *
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef FMC_USER_H
+#define FMC_USER_H
+
+#include "NUC1311.h"
+
+#define Config0         FMC_CONFIG_BASE
+#define Config1         (FMC_CONFIG_BASE+4)
+
+extern uint32_t g_apromSize, g_dataFlashAddr, g_dataFlashSize;
+
+int FMC_Proc(unsigned int u32Cmd, unsigned int addr_start, unsigned int addr_end, unsigned int *data);
+int FMC_Write_User(unsigned int u32Addr, unsigned int u32Data);
+int FMC_Read_User(unsigned int u32Addr, unsigned int *data);
+int FMC_Erase_User(unsigned int u32Addr);
+void ReadData(unsigned int addr_start, unsigned int addr_end, unsigned int *data);
+void WriteData(unsigned int addr_start, unsigned int addr_end, unsigned int *data);
+void EraseAP(unsigned int addr_start, unsigned int addr_end);
+void UpdateConfig(unsigned int *data, unsigned int *res);
+uint32_t GetApromSize(void);
+void GetDataFlashInfo(uint32_t *addr, uint32_t *size);
+
+#endif
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
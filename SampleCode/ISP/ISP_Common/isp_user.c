@@ -1,7 +1,7 @@
 /******************************************************************************
- * @file     ISP_USER.c
- * @brief    ISP sample source file
- * @version  0x27
+ * @file     isp_user.c
+ * @brief    ISP command core source file shared by the UART, RS485, I2C and SPI ISP
+ * @version  0x34
  *
  * @note
  * @copyright SPDX-License-Identifier: Apache-2.0
@@ -9,12 +9,21 @@
  ******************************************************************************/
 #include <stdio.h>
 #include "string.h"
-#include "ISP_USER.h"
+#include "isp_user.h"
 
-__attribute__((aligned(4))) uint8_t response_buff[64];
+__attribute__((aligned(4))) uint8_t response_buff[ISP_PKT_SIZE];
 __attribute__((aligned(4))) static uint8_t aprom_buf[FMC_FLASH_PAGE_SIZE];
 uint32_t bUpdateApromCmd;
-uint32_t g_apromSize, g_dataFlashAddr, g_dataFlashSize;
+
+/* Transport ISP_Run() serves, reported by CMD_GET_XFER_INFO */
+static const ISP_XFER_T *isp_xfer;
+
+/* CMD_UPDATE_APROM_LZ: decoder, bytes waiting in aprom_buf and SysTick cycles spent on the update */
+static LZDEC_T lz_dec;
+static uint32_t lz_page_len, lz_cycles;
+
+/* CMD_UPDATE_APROM/DATAFLASH: packet number and start address of the last data packets, oldest first */
+static uint32_t sent_packno[ISP_MAX_DEPTH], sent_addr[ISP_MAX_DEPTH], sent_count;
 
 static uint16_t Checksum(unsigned char *buf, int len)
 {
@@ -30,7 +39,7 @@ static uint16_t Checksum(unsigned char *buf, int len)
 
 static uint16_t CalCheckSum(uint32_t start, uint32_t len)
 {
-    int i;
+    uint32_t i;
     register uint16_t lcksum = 0;
 
     for (i = 0; i < len; i += FMC_FLASH_PAGE_SIZE) {
@@ -46,36 +55,17 @@ static uint16_t CalCheckSum(uint32_t start, uint32_t len)
     return lcksum;
 }
 
-//bAprom == TRUE erase all aprom besides data flash
-void EraseAP(unsigned int addr_start, unsigned int addr_end)
+/* SysTick cycles since start, 0 when SysTick is stopped. The ISP main() leaves it running with the connect time-out reload. */
+static uint32_t SysTickSince(uint32_t start)
 {
-    unsigned int eraseLoop = addr_start;
+    uint32_t now = SysTick->VAL;
 
-    for (; eraseLoop < addr_end; eraseLoop += FMC_FLASH_PAGE_SIZE) {
-        FMC_Erase_User(eraseLoop);
-    }
-
-    return;
+    return (start >= now) ? (start - now) : (start + SysTick->LOAD + 1 - now);
 }
 
-void UpdateConfig(unsigned int *data, unsigned int *res)
+int ParseCmd(unsigned char *buffer, uint32_t len)
 {
-    FMC_ENABLE_CFG_UPDATE();
-    FMC_Erase_User(Config0);
-    FMC_Write_User(Config0, *data);
-    FMC_Write_User(Config1, *(data + 1));
-
-    if (res) {
-        FMC_Read_User(Config0, res);
-        FMC_Read_User(Config1, res + 1);
-    }
-
-    FMC_DISABLE_CFG_UPDATE();
-}
-
-int ParseCmd(unsigned char *buffer, uint8_t len)
-{
-    static uint32_t StartAddress, StartAddress_bak, TotalLen, TotalLen_bak, LastDataLen, g_packno = 1;
+    static uint32_t StartAddress, StartAddress_bak, TotalLen, TotalLen_bak, g_packno = 1;
     uint8_t *response;
     uint16_t lcksum;
     uint32_t lcmd, srclen, i, regcnf0, security;
@@ -101,7 +91,7 @@ int ParseCmd(unsigned char *buffer, uint8_t len)
     }
 
     if (lcmd == CMD_GET_FWVER) {
-        response[8] = FW_VERSION;//version 2.3
+        response[8] = FW_VERSION;
     } else if (lcmd == CMD_GET_DEVICEID) {
         outpw(response + 8, SYS->PDID);
         goto out;
@@ -128,7 +118,17 @@ int ParseCmd(unsigned char *buffer, uint8_t len)
         goto out;
     } else if (lcmd == CMD_DISCONNECT) {
         return 0;
-    } else if ((lcmd == CMD_UPDATE_APROM) || (lcmd == CMD_ERASE_ALL)) {
+    } else if (lcmd == CMD_GET_XFER_INFO) {
+        outpw(response + 8, isp_xfer ? isp_xfer->u32MaxFrame : ISP_PKT_SIZE);
+        outpw(response + 12, isp_xfer ? isp_xfer->u32Depth : 1);
+        goto out;
+    } else if (lcmd == CMD_GET_LZ_STATUS) {
+        outpw(response + 8, lz_dec.u32InCount);
+        outpw(response + 12, lz_dec.u32OutCount);
+        outpw(response + 16, lz_cycles);
+        outpw(response + 20, SystemCoreClock);
+        goto out;
+    } else if ((lcmd == CMD_UPDATE_APROM) || (lcmd == CMD_ERASE_ALL) || (lcmd == CMD_UPDATE_APROM_LZ)) {
         EraseAP(FMC_APROM_BASE, (g_apromSize < g_dataFlashAddr) ? g_apromSize : g_dataFlashAddr);
 
         if (lcmd == CMD_ERASE_ALL) { //erase APROM + data flash
@@ -143,7 +143,7 @@ int ParseCmd(unsigned char *buffer, uint8_t len)
         outpw(response + 8, (FMC->ISPCON & 0x2) ? 2 : 1);
     }
 
-    if ((lcmd == CMD_UPDATE_APROM) || (lcmd == CMD_UPDATE_DATAFLASH)) {
+    if ((lcmd == CMD_UPDATE_APROM) || (lcmd == CMD_UPDATE_DATAFLASH) || (lcmd == CMD_UPDATE_APROM_LZ)) {
         if (lcmd == CMD_UPDATE_DATAFLASH) {
             StartAddress = g_dataFlashAddr;
 
@@ -162,6 +162,13 @@ int ParseCmd(unsigned char *buffer, uint8_t len)
         srclen -= 8;
         StartAddress_bak = StartAddress;
         TotalLen_bak = TotalLen;
+        sent_count = 0;
+
+        if (lcmd == CMD_UPDATE_APROM_LZ) { //TotalLen is the decompressed size
+            LZDEC_Init(&lz_dec);
+            lz_page_len = 0;
+            lz_cycles = 0;
+        }
     } else if (lcmd == CMD_UPDATE_CONFIG) {
         if ((security == 0) && (!bUpdateApromCmd)) { //security lock
             goto out;
@@ -171,19 +178,39 @@ int ParseCmd(unsigned char *buffer, uint8_t len)
         GetDataFlashInfo(&g_dataFlashAddr, &g_dataFlashSize);
         goto out;
     } else if (lcmd == CMD_RESEND_PACKET) { //for APROM&Data flash only
-        StartAddress -= LastDataLen;
-        TotalLen += LastDataLen;
+        uint32_t PageAddress, EndAddress, packno = inpw(pSrc);
 
-        if ((StartAddress & 0xFFE00) >= Config0) {
+        if (gcmd == CMD_UPDATE_APROM_LZ) { //decoder cannot step back, the final checksum fails and the host starts over
             goto out;
         }
 
-        ReadData(StartAddress & 0xFFE00, StartAddress, (uint32_t *)aprom_buf);
-        FMC_Erase_User(StartAddress & 0xFFE00);
-        WriteData(StartAddress & 0xFFE00, StartAddress, (uint32_t *)aprom_buf);
+        /* Roll back to the packet sent again. The packets parsed after it are sent again too. */
+        for (i = sent_count; i > 0; i--) {
+            if ((packno == 0) || (sent_packno[i - 1] == packno)) {
+                break;
+            }
+        }
 
-        if ((StartAddress % FMC_FLASH_PAGE_SIZE) >= (FMC_FLASH_PAGE_SIZE - LastDataLen)) {
-            FMC_Erase_User((StartAddress & 0xFFE00) + FMC_FLASH_PAGE_SIZE);
+        if (i == 0) {
+            goto out;
+        }
+
+        sent_count = i - 1;
+        EndAddress = StartAddress;
+        StartAddress = sent_addr[sent_count];
+        TotalLen += EndAddress - StartAddress;
+        PageAddress = StartAddress & (0x100000 - FMC_FLASH_PAGE_SIZE);
+
+        if (PageAddress >= Config0) {
+            goto out;
+        }
+
+        ReadData(PageAddress, StartAddress, (uint32_t *)aprom_buf);
+        FMC_Erase_User(PageAddress);
+        WriteData(PageAddress, StartAddress, (uint32_t *)aprom_buf);
+
+        for (PageAddress += FMC_FLASH_PAGE_SIZE; PageAddress < EndAddress; PageAddress += FMC_FLASH_PAGE_SIZE) {
+            FMC_Erase_User(PageAddress);
         }
 
         goto out;
@@ -194,12 +221,56 @@ int ParseCmd(unsigned char *buffer, uint8_t len)
             srclen = TotalLen;//prevent last package from over writing
         }
 
+        if (sent_count == ISP_MAX_DEPTH) {
+            for (i = 1; i < ISP_MAX_DEPTH; i++) {
+                sent_packno[i - 1] = sent_packno[i];
+                sent_addr[i - 1] = sent_addr[i];
+            }
+
+            sent_count--;
+        }
+
+        sent_packno[sent_count] = inpw(buffer + 4);
+        sent_addr[sent_count++] = StartAddress;
         TotalLen -= srclen;
         WriteData(StartAddress, StartAddress + srclen, (uint32_t *)pSrc);
         memset(pSrc, 0, srclen);
         ReadData(StartAddress, StartAddress + srclen, (uint32_t *)pSrc);
         StartAddress += srclen;
-        LastDataLen =  srclen;
+
+        if (TotalLen == 0) {
+            lcksum = CalCheckSum(StartAddress_bak, TotalLen_bak);
+            outps(response + 8, lcksum);
+        }
+    }
+
+    if (gcmd == CMD_UPDATE_APROM_LZ) {
+        uint32_t used, start = SysTick->VAL;
+        int32_t got;
+
+        /* Decompress the packet into aprom_buf and program every full page */
+        while ((srclen > 0) && (TotalLen > 0)) {
+            i = FMC_FLASH_PAGE_SIZE - lz_page_len;
+            got = LZDEC_Decode(&lz_dec, pSrc, srclen, &used, aprom_buf + lz_page_len, (TotalLen < i) ? TotalLen : i);
+
+            if (got < 0) { //corrupt stream, stop here and let the checksum tell the host
+                TotalLen = 0;
+                break;
+            }
+
+            pSrc += used;
+            srclen -= used;
+            lz_page_len += got;
+            TotalLen -= got;
+
+            if ((lz_page_len == FMC_FLASH_PAGE_SIZE) || (TotalLen == 0)) {
+                WriteData(StartAddress, StartAddress + ((lz_page_len + 3) & ~3), (uint32_t *)aprom_buf);
+                StartAddress += lz_page_len;
+                lz_page_len = 0;
+            }
+        }
+
+        lz_cycles += SysTickSince(start);
 
         if (TotalLen == 0) {
             lcksum = CalCheckSum(StartAddress_bak, TotalLen_bak);
@@ -216,4 +287,24 @@ out:
     return 0;
 }
 
-/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
+/* Parse the frames of a transport and answer each of them, never returns */
+void ISP_Run(const ISP_XFER_T *psXfer)
+{
+    uint8_t *frame;
+    uint32_t len;
+
+    isp_xfer = psXfer;
+
+    while (1) {
+        len = psXfer->pfnRecv(&frame);
+
+        if (len) {
+            WDT->WTCR &= ~(WDT_WTCR_WTE_Msk | WDT_WTCR_DBGACK_WDT_Msk);
+            WDT->WTCR |= (WDT_TIMEOUT_2POW18 | WDT_WTCR_WTR_Msk);
+            ParseCmd(frame, len);
+            psXfer->pfnSend(response_buff, ISP_PKT_SIZE);
+        }
+    }
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,72 @@
+/**************************************************************************//**
+ * @file     isp_user.h
+ * @brief    ISP command core header file shared by the UART, RS485, I2C and SPI ISP
+ * @version  0x34
+ *
+ * @note
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef ISP_USER_H
+#define ISP_USER_H
+
+#define FW_VERSION                  0x34
+
+#include "fmc_user.h"
+#include "lzdec.h"
+
+#define CMD_UPDATE_APROM            0x000000A0
+#define CMD_UPDATE_CONFIG           0x000000A1
+#define CMD_READ_CONFIG             0x000000A2
+#define CMD_ERASE_ALL               0x000000A3
+#define CMD_SYNC_PACKNO             0x000000A4
+#define CMD_GET_FWVER               0x000000A6
+#define CMD_SET_APPINFO             0x000000A7
+#define CMD_GET_APPINFO             0x000000A8
+#define CMD_RUN_APROM               0x000000AB
+#define CMD_RUN_LDROM               0x000000AC
+#define CMD_RESET                   0x000000AD
+#define CMD_CONNECT                 0x000000AE
+#define CMD_DISCONNECT              0x000000AF
+
+#define CMD_GET_DEVICEID            0x000000B1
+
+#define CMD_UPDATE_DATAFLASH        0x000000C3
+#define CMD_UPDATE_APROM_LZ         0x000000C4
+#define CMD_GET_LZ_STATUS           0x000000C5
+#define CMD_GET_XFER_INFO           0x000000C6
+#define CMD_WRITE_CHECKSUM          0x000000C9
+#define CMD_GET_FLASHMODE           0x000000CA
+
+#define CMD_RESEND_PACKET           0x000000FF
+
+#define V6M_AIRCR_VECTKEY_DATA      0x05FA0000UL
+#define V6M_AIRCR_SYSRESETREQ       0x00000004UL
+
+#define ISP_PKT_SIZE                64      /* Response size, and the frame size of the fixed size transports */
+#define ISP_MAX_DEPTH               4       /* Data packets kept for CMD_RESEND_PACKET, no transport may report more */
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  Transport of the ISP commands                                                                          */
+/*                                                                                                         */
+/*  A frame is one command packet: command, packet number and data, the same layout on every link. The     */
+/*  host reads u32MaxFrame and u32Depth with CMD_GET_XFER_INFO and then sends frames of up to u32MaxFrame  */
+/*  bytes, with up to u32Depth frames on the way before it waits for a response.                           */
+/*                                                                                                         */
+/*  CMD_RESEND_PACKET carries in its first data word the packet number of the data packet to send again,   */
+/*  0 for the last one. The host then sends that packet and every packet after it again.                   */
+/*---------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint32_t (*pfnRecv)(uint8_t **ppu8Frame);           /* Length of the next received frame and its buffer, 0 if none */
+    void (*pfnSend)(uint8_t *pu8Rsp, uint32_t u32Len);  /* Send the response and hand the frame buffer back */
+    uint32_t u32MaxFrame;                               /* Largest frame in bytes, word aligned */
+    uint32_t u32Depth;                                  /* Frames the transport holds while one is parsed */
+} ISP_XFER_T;
+
+extern int ParseCmd(unsigned char *buffer, uint32_t len);
+extern void ISP_Run(const ISP_XFER_T *psXfer);
+
+extern __attribute__((aligned(4))) uint8_t response_buff[ISP_PKT_SIZE];
+#endif  // #ifndef ISP_USER_H
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -1,27 +1,39 @@
 /***************************************************************************//**
  * @file     i2c_transfer.c
  * @brief    ISP support function source file
- * @version  0x32
- * @date     14, June, 2017
+ * @version  0x33
+ *
+ * @note     The I2C0 interrupt jumps through a table indexed by I2CSTATUS >> 3. While the response to a frame
+ *           is not ready the SLA+R state leaves SI set, which holds SCL low, so the master simply waits in its
+ *           read instead of polling after a fixed delay.
  *
- * @note
  * @copyright SPDX-License-Identifier: Apache-2.0
  * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
  ******************************************************************************/
 #include <stdio.h>
 #include "targetdev.h"
+#include "i2c_transfer.h"
 
 #define I2C_ADDR 0x60
 
 /*---------------------------------------------------------------------------------------------------------*/
 /* Global variables                                                                                        */
 /*---------------------------------------------------------------------------------------------------------*/
-uint8_t au8I2cRcvBuf[64];
-volatile uint8_t u8I2cDataReady;
+uint32_t au32I2cRcvBuf[I2C_ISP_MAX_FRAME / 4];
+volatile uint8_t u8I2cDataReady;            /* A frame waits in au32I2cRcvBuf, further writes are NACKed */
+
+static volatile uint32_t s_u32RxLen;        /* Bytes received of the current write */
+static volatile uint32_t s_u32FrameLen;     /* Length of the frame waiting to be parsed */
+static uint8_t *volatile s_pu8Tx;           /* Response, NULL until ParseCmd() is done with the frame */
+static volatile uint32_t s_u32TxLen;
+static volatile uint32_t s_u32TxPos;
+static volatile uint8_t s_u8Stretch;        /* SLA+R is held with SI set until the response is ready */
 
-volatile uint8_t g_u8SlvDataLen;
+static uint32_t I2C_RecvFrame(uint8_t **ppu8Frame);
+static void I2C_SendFrame(uint8_t *pu8Rsp, uint32_t u32Len);
 
-__STATIC_INLINE void I2C_SlaveTRx(I2C_T *i2c, uint32_t u32Status);
+/* One frame at a time: the master reads the response before it writes the next frame */
+const ISP_XFER_T g_sI2cXfer = {I2C_RecvFrame, I2C_SendFrame, I2C_ISP_MAX_FRAME, 1};
 
 extern uint32_t u32Pclk0;
 extern uint32_t u32Pclk1;
@@ -45,108 +57,174 @@ void I2C_Init(void)
     NVIC_EnableIRQ(I2C0_IRQn);
 }
 
-/*---------------------------------------------------------------------------------------------------------*/
-/*  I2C1 IRQ Handler                                                                                       */
-/*---------------------------------------------------------------------------------------------------------*/
-void I2C0_IRQHandler(void)
+static uint32_t I2C_RecvFrame(uint8_t **ppu8Frame)
 {
-    uint32_t u32Status;
-    u32Status = I2C_GET_STATUS(I2C0);
-
-    if (I2C_GET_TIMEOUT_FLAG(I2C0))
+    if (u8I2cDataReady == 0)
     {
-        /* Clear I2C1 Timeout Flag */
-        I2C0->I2CTOC |= I2C_I2CTOC_TIF_Msk;
+        return 0;
     }
-    else
+
+    /* Parsed in place, the ISR does not touch au32I2cRcvBuf until the response is armed */
+    *ppu8Frame = (uint8_t *)au32I2cRcvBuf;
+    return s_u32FrameLen;
+}
+
+static void I2C_SendFrame(uint8_t *pu8Rsp, uint32_t u32Len)
+{
+    NVIC_DisableIRQ(I2C0_IRQn);
+
+    s_u32TxLen = u32Len;
+    s_u32TxPos = 0;
+    s_pu8Tx = pu8Rsp;
+    u8I2cDataReady = 0;
+
+    if (s_u8Stretch)
     {
-        I2C_SlaveTRx(I2C0, u32Status);
+        /* Master is waiting in SLA+R, hand it the first byte and release SCL */
+        s_u8Stretch = 0;
+        I2C_SET_DATA(I2C0, s_pu8Tx[s_u32TxPos++]);
+        I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_SI_AA);
+        NVIC_ClearPendingIRQ(I2C0_IRQn);
     }
+
+    NVIC_EnableIRQ(I2C0_IRQn);
 }
 
 /*---------------------------------------------------------------------------------------------------------*/
-/*  I2C TRx Callback Function                                                                               */
+/*  I2C slave states                                                                                       */
 /*---------------------------------------------------------------------------------------------------------*/
-void I2C_SlaveTRx(I2C_T *i2c, uint32_t u32Status)
+typedef void (*I2C_STATE_FUNC)(void);
+
+/* Anything else: stay addressable */
+static void I2C_StateIdle(void)
+{
+    I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_SI_AA);
+}
+
+/* 0x00: bus error, release the bus */
+static void I2C_StateBusError(void)
 {
-    uint8_t u8data;
+    s_u32RxLen = 0;
+    I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_STO_SI_AA);
+}
 
-    if (u32Status == 0x60)                      /* Own SLA+W has been receive; ACK has been return */
-    {
-        u8I2cDataReady = 0;
-        g_u8SlvDataLen = 0;
-        I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
-    }
-    else if (u32Status == 0x80)                 /* Previously address with own SLA address
-                                                   Data has been received; ACK has been returned*/
-    {
-        au8I2cRcvBuf[g_u8SlvDataLen] = I2C_GET_DATA(i2c);
-        g_u8SlvDataLen++;
-        g_u8SlvDataLen &= 0x3F;
-        u8I2cDataReady = (g_u8SlvDataLen == 0);
-
-        if (g_u8SlvDataLen == 0x3F)
-        {
-            I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI);
-        }
-        else
-        {
-            I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
-        }
-    }
-    else if (u32Status == 0xA8)                 /* Own SLA+R has been receive; ACK has been return */
-    {
-        g_u8SlvDataLen = 0;
-        u8data = response_buff[g_u8SlvDataLen];
-        I2C_SET_DATA(i2c, u8data);
-        g_u8SlvDataLen++;
-        I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
-    }
-    else if (u32Status == 0xB8)
-    {
-        u8data = response_buff[g_u8SlvDataLen];
-        I2C_SET_DATA(i2c, u8data);
-        g_u8SlvDataLen++;
-        g_u8SlvDataLen &= 0x3F;
-
-        if (g_u8SlvDataLen == 0x00)
-        {
-            I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI);
-        }
-        else
-        {
-            I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
-        }
-    }
-    else if (u32Status == 0xC8)
-    {
-        I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
-    }
-    else if (u32Status == 0xC0)                 /* Data byte or last data in I2CDAT has been transmitted
-                                                   Not ACK has been received */
+/* 0x60: own SLA+W received, ACK returned */
+static void I2C_StateWrite(void)
+{
+    s_u32RxLen = 0;
+
+    /* NACK the data while the previous frame is parsed */
+    I2C_SET_CONTROL_REG(I2C0, u8I2cDataReady ? I2C_I2CON_SI : I2C_I2CON_SI_AA);
+}
+
+/* 0x80: data received, ACK returned */
+static void I2C_StateRxData(void)
+{
+    ((uint8_t *)au32I2cRcvBuf)[s_u32RxLen++] = I2C_GET_DATA(I2C0);
+
+    /* NACK the byte after a full frame */
+    I2C_SET_CONTROL_REG(I2C0, (s_u32RxLen < I2C_ISP_MAX_FRAME) ? I2C_I2CON_SI_AA : I2C_I2CON_SI);
+}
+
+/* 0x88: data received, NACK returned. The frame overflowed or is not wanted, drop the byte */
+static void I2C_StateRxNack(void)
+{
+    I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_SI_AA);
+}
+
+/* 0xA0: STOP or repeated START ends the write */
+static void I2C_StateRxEnd(void)
+{
+    if ((u8I2cDataReady == 0) && (s_u32RxLen >= 8))
     {
-        I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
+        s_u32FrameLen = s_u32RxLen;
+        s_pu8Tx = NULL;
+        u8I2cDataReady = 1;
     }
-    else if (u32Status == 0x88)                 /* Previously addressed with own SLA address; NOT ACK has
-                                                   been returned */
+
+    s_u32RxLen = 0;
+    I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_SI_AA);
+}
+
+/* 0xA8: own SLA+R received, ACK returned */
+static void I2C_StateRead(void)
+{
+    if ((s_pu8Tx == NULL) && u8I2cDataReady)
     {
-        au8I2cRcvBuf[g_u8SlvDataLen] = I2C_GET_DATA(i2c);
-        g_u8SlvDataLen++;
-        u8I2cDataReady = (g_u8SlvDataLen == 64);
-        g_u8SlvDataLen = 0;
-        I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
+        /* Response not ready: keep SI set, which stretches SCL, until I2C_SendFrame() */
+        s_u8Stretch = 1;
+        NVIC_DisableIRQ(I2C0_IRQn);
+        return;
     }
-    else if (u32Status == 0xA0)                 /* A STOP or repeated START has been received while still
-                                                   addressed as Slave/Receiver*/
+
+    I2C_SET_DATA(I2C0, (s_pu8Tx && (s_u32TxPos < s_u32TxLen)) ? s_pu8Tx[s_u32TxPos++] : 0xFF);
+    I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_SI_AA);
+}
+
+/* 0xB8: data transmitted, ACK received. Pad with 0xFF past the end of the response */
+static void I2C_StateTxData(void)
+{
+    I2C_SET_DATA(I2C0, (s_pu8Tx && (s_u32TxPos < s_u32TxLen)) ? s_pu8Tx[s_u32TxPos++] : 0xFF);
+    I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_SI_AA);
+}
+
+/* 0xC0, 0xC8: master ended the read, the next read starts the response over */
+static void I2C_StateTxEnd(void)
+{
+    s_u32TxPos = 0;
+    I2C_SET_CONTROL_REG(I2C0, I2C_I2CON_SI_AA);
+}
+
+static const I2C_STATE_FUNC s_apfnI2cState[32] =
+{
+    I2C_StateBusError,  /* 0x00 */
+    I2C_StateIdle,      /* 0x08 */
+    I2C_StateIdle,      /* 0x10 */
+    I2C_StateIdle,      /* 0x18 */
+    I2C_StateIdle,      /* 0x20 */
+    I2C_StateIdle,      /* 0x28 */
+    I2C_StateIdle,      /* 0x30 */
+    I2C_StateIdle,      /* 0x38 */
+    I2C_StateIdle,      /* 0x40 */
+    I2C_StateIdle,      /* 0x48 */
+    I2C_StateIdle,      /* 0x50 */
+    I2C_StateIdle,      /* 0x58 */
+    I2C_StateWrite,     /* 0x60 */
+    I2C_StateWrite,     /* 0x68 arbitration lost, own SLA+W */
+    I2C_StateIdle,      /* 0x70 */
+    I2C_StateIdle,      /* 0x78 */
+    I2C_StateRxData,    /* 0x80 */
+    I2C_StateRxNack,    /* 0x88 */
+    I2C_StateIdle,      /* 0x90 */
+    I2C_StateIdle,      /* 0x98 */
+    I2C_StateRxEnd,     /* 0xA0 */
+    I2C_StateRead,      /* 0xA8 */
+    I2C_StateRead,      /* 0xB0 arbitration lost, own SLA+R */
+    I2C_StateTxData,    /* 0xB8 */
+    I2C_StateTxEnd,     /* 0xC0 */
+    I2C_StateTxEnd,     /* 0xC8 */
+    I2C_StateIdle,      /* 0xD0 */
+    I2C_StateIdle,      /* 0xD8 */
+    I2C_StateIdle,      /* 0xE0 */
+    I2C_StateIdle,      /* 0xE8 */
+    I2C_StateIdle,      /* 0xF0 */
+    I2C_StateIdle,      /* 0xF8 */
+};
+
+/*---------------------------------------------------------------------------------------------------------*/
+/*  I2C0 IRQ Handler                                                                                       */
+/*---------------------------------------------------------------------------------------------------------*/
+void I2C0_IRQHandler(void)
+{
+    if (I2C_GET_TIMEOUT_FLAG(I2C0))
     {
-        g_u8SlvDataLen = 0;
-        I2C_SET_CONTROL_REG(i2c, I2C_I2CON_SI_AA);
+        /* Clear I2C0 Timeout Flag */
+        I2C0->I2CTOC |= I2C_I2CTOC_TIF_Msk;
     }
-    else
+    else if (I2C0->I2CON & I2C_I2CON_SI_Msk)
     {
-        /* TO DO */
-        /* printf("Status 0x%x is NOT processed\n", u32Status); */
+        s_apfnI2cState[(I2C_GET_STATUS(I2C0) >> 3) & 0x1F]();
     }
 }
 
-
+/*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
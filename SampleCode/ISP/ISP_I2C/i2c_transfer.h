@@ -1,8 +1,7 @@
 /**************************************************************************//**
  * @file     i2c_transfer.h
  * @brief    ISP support function header file
- * @version  0x32
- * @date     14, June, 2017
+ * @version  0x33
  *
  * @note
  * @copyright SPDX-License-Identifier: Apache-2.0
@@ -11,9 +10,16 @@
 #ifndef __I2C_TRANS_H__
 #define __I2C_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
+
+/*-------------------------------------------------------------*/
+/* A frame is one write transaction, ended by STOP or repeated START. The response is read in the next
+   read transaction, the slave stretches SCL at SLA+R until it is ready. */
+#define I2C_ISP_MAX_FRAME       (FMC_FLASH_PAGE_SIZE + 16)  /* Command, packet number, address, length and one flash page */
 
 extern volatile uint8_t u8I2cDataReady;
-extern uint8_t au8I2cRcvBuf[];
+extern uint32_t au32I2cRcvBuf[];
+extern const ISP_XFER_T g_sI2cXfer;
 
 /*-------------------------------------------------------------*/
 void I2C_Init(void);
@@ -75,8 +75,6 @@ int32_t SYS_Init(void)
 
 int main(void)
 {
-    uint32_t au8CmdBuff[16];
-
     /* Unlock write-protected registers */
     SYS_UnlockReg();
 
@@ -120,17 +118,7 @@ int main(void)
 _ISP:
 
     /* Parse command from master and send response back */
-    while (1)
-    {
-        if (u8I2cDataReady == 1)
-        {
-            /* Get command from I2C receive buffer */
-            memcpy(au8CmdBuff, au8I2cRcvBuf, 64);
-            u8I2cDataReady = 0;
-            /* Parse the current command */
-            ParseCmd((unsigned char *)au8CmdBuff, 64);
-        }
-    }
+    ISP_Run(&g_sI2cXfer);
 
 _APROM:
 
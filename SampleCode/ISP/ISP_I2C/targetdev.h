@@ -8,6 +8,6 @@
  * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
  ******************************************************************************/
 #include "NUC1311.h"
-#include "ISP_USER.h"
+#include "isp_user.h"
 
 /*** (C) COPYRIGHT 2019 Nuvoton Technology Corp. ***/
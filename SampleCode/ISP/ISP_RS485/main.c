@@ -12,16 +12,12 @@
  * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
  ******************************************************************************/
 #include <stdio.h>
-#include "ISP_USER.h"
+#include "targetdev.h"
 #include "uart_transfer.h"
 
 #define PLLCON_SETTING  CLK_PLLCON_50MHz_HIRC
 #define PLL_CLOCK       50000000
 
-#define nRTSPin                 (PA8)
-#define REVEIVE_MODE            (0)
-#define TRANSMIT_MODE           (1)
-
 /*---------------------------------------------------------------------------------------------------------*/
 /* Define functions prototype                                                                              */
 /*---------------------------------------------------------------------------------------------------------*/
@@ -119,16 +115,8 @@ int main(void)
     while (1) {
         
         /* Wait for CMD_CONNECT command */
-        if ((bufhead >= 4) || (bUartDataReady == TRUE)) {
-            uint32_t lcmd;
-            lcmd = inpw(uart_rcvbuf);
-
-            if (lcmd == CMD_CONNECT) {
-                goto _ISP;
-            } else {
-                bUartDataReady = FALSE;
-                bufhead = 0;
-            }
+        if (UART_IS_CONNECT()) {
+            goto _ISP;
         }
 
         /* Systick time-out, then go to APROM */
@@ -141,26 +129,7 @@ int main(void)
 _ISP:
 
     /* Prase command from master and send response back */
-    while (1) {
-        if (bUartDataReady == TRUE) {
-            
-            WDT->WTCR &= ~(WDT_WTCR_WTE_Msk | WDT_WTCR_DBGACK_WDT_Msk);
-            WDT->WTCR |= (WDT_TIMEOUT_2POW18 | WDT_WTCR_WTR_Msk);
-            
-            bUartDataReady = FALSE;;        /* Reset UART data ready flag */
-            ParseCmd(uart_rcvbuf, 64);      /* Parse command from master */
-            NVIC_DisableIRQ(UART_T_IRQn);   /* Disable NVIC */
-            nRTSPin = TRANSMIT_MODE;        /* Control RTS in transmit mode */
-            PutString();                    /* Send response to master */
-
-            /* Wait for data transmission is finished */
-            while ((UART_T->FSR & UART_FSR_TE_FLAG_Msk) == 0);  
-
-            nRTSPin = REVEIVE_MODE;         /* Control RTS in reveive mode */
-            NVIC_EnableIRQ(UART_T_IRQn);    /* Enable NVIC */
-
-        }
-    }
+    ISP_Run(&g_sUartXfer);
 
 _APROM:
 
@@ -10,22 +10,28 @@
 #ifndef __UART_TRANS_H__
 #define __UART_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
 
 /*-------------------------------------------------------------*/
 /* Define maximum packet size */
-#define MAX_PKT_SIZE        	64
+#define MAX_PKT_SIZE        	ISP_PKT_SIZE
+
+/* Packets buffered. RS485 is half duplex, the host waits for each response. */
+#define MAX_PKT_DEPTH       	1
+
+/* RS485 transceiver direction */
+#define nRTSPin                 (PA8)
+#define REVEIVE_MODE            (0)
+#define TRANSMIT_MODE           (1)
 
 /*-------------------------------------------------------------*/
 
-extern uint8_t  uart_rcvbuf[];
-extern uint8_t volatile bUartDataReady;
+extern uint8_t  uart_rcvbuf[MAX_PKT_DEPTH][MAX_PKT_SIZE];
 extern uint8_t volatile bufhead;
+extern const ISP_XFER_T g_sUartXfer;
 
 /*-------------------------------------------------------------*/
 void UART_Init(void);
-void UART0_IRQHandler(void);
-void UART1_IRQHandler(void);
-void PutString(void);
 uint32_t UART_IS_CONNECT(void);
 
 #endif  /* __UART_TRANS_H__ */
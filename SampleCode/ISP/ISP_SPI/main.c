@@ -115,14 +115,11 @@ int32_t SYS_Init(void)
 /*---------------------------------------------------------------------------------------------------------*/
 int32_t main(void)
 {
-    uint32_t cmd_buff[16];
-
     /* Unlock protected registers */
     SYS_UnlockReg();
     /* Init System, peripheral clock and multi-function I/O */
     if( SYS_Init() < 0 ) goto _APROM;
     SPI_Init();
-    GPIO_Init();
     TIMER3_Init();
 
     CLK->AHBCLK |= CLK_AHBCLK_ISP_EN_Msk;
@@ -146,15 +143,7 @@ int32_t main(void)
     }
 
 _ISP:
-    while(1)
-    {
-        if(bSpiDataReady == 1)
-        {
-            memcpy(cmd_buff, spi_rcvbuf, 64);
-            bSpiDataReady = 0;
-            ParseCmd((unsigned char *)cmd_buff, 64);
-        }
-    }
+    ISP_Run(&g_sSpiXfer);
 
 _APROM:
     SYS->RSTSRC = (SYS_RSTSRC_RSTS_POR_Msk | SYS_RSTSRC_RSTS_RESET_Msk);
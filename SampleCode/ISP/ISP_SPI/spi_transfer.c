@@ -8,18 +8,28 @@
  ******************************************************************************/
 #include <stdio.h>
 #include "targetdev.h"
+#include "spi_transfer.h"
 
 /*---------------------------------------------------------------------------------------------------------*/
 /* Global variables                                                                                        */
 /*---------------------------------------------------------------------------------------------------------*/
-#define TEST_COUNT 16
-
-uint32_t spi_rcvbuf[TEST_COUNT];
-volatile uint32_t g_u32TxDataCount;
-volatile uint32_t g_u32RxDataCount;
+uint32_t spi_rcvbuf[SPI_ISP_MAX_FRAME / 4];
+volatile uint32_t g_u32SpiFrameLen;
 
 volatile uint8_t bSpiDataReady = 0;
 
+static volatile uint32_t s_u32RxExpect;     /* Payload words of current frame, 0 while hunting for a header */
+static volatile uint32_t s_u32RxCount;
+static uint32_t s_au32TxBuf[1 + SPI_ISP_RSP_SIZE / 4];
+static volatile uint32_t s_u32TxLen;        /* Words armed in s_au32TxBuf, 0 if no response is pending */
+static volatile uint32_t s_u32TxCount;
+
+static uint32_t SPI_RecvFrame(uint8_t **ppu8Frame);
+static void SPI_SendFrame(uint8_t *pu8Rsp, uint32_t u32Len);
+
+/* One frame at a time: the ISR ignores new frames until the response to the current one is armed */
+const ISP_XFER_T g_sSpiXfer = {SPI_RecvFrame, SPI_SendFrame, SPI_ISP_MAX_FRAME, 1};
+
 void SPI_Init(void)
 {
     /* Configure as a slave, clock idle low, 32-bit transaction, drive output on falling clock edge and latch input on rising edge. */
@@ -30,85 +40,123 @@ void SPI_Init(void)
     SPI0->CNTRL = SPI_SLAVE | ((32 & 0x1F) << SPI_CNTRL_TX_BIT_LEN_Pos) | (SPI_MODE_0) | SPI_CNTRL_FIFO_Msk;
     /* Set DIVIDER = 0 */
     SPI0->DIVIDER = 0UL;
-    /* Set TX FIFO threshold and enable FIFO mode. */
+    /* RX threshold interrupt when more than 3 words are received, TX threshold interrupt when 3 or fewer are queued.
+       Words below the RX threshold at the end of a frame are collected by the RX time-out interrupt. */
     SPI0->FIFO_CTL = (SPI0->FIFO_CTL & ~(SPI_FIFO_CTL_TX_THRESHOLD_Msk | SPI_FIFO_CTL_RX_THRESHOLD_Msk)) |
-                     (4 << SPI_FIFO_CTL_TX_THRESHOLD_Pos) |
-                     (4 << SPI_FIFO_CTL_RX_THRESHOLD_Pos);
-    SPI_WRITE_TX(SPI0, 0xFFFFFFFF);    /* Dummy Write to prevent TX under run */
+                     (3 << SPI_FIFO_CTL_TX_THRESHOLD_Pos) |
+                     (3 << SPI_FIFO_CTL_RX_THRESHOLD_Pos) |
+                     SPI_FIFO_CTL_RX_INTEN_Msk | SPI_FIFO_CTL_TIMEOUT_INTEN_Msk | SPI_FIFO_CTL_TX_INTEN_Msk;
+
+    s_u32RxExpect = 0;
+    s_u32RxCount = 0;
+    s_u32TxLen = 0;
+    s_u32TxCount = 0;
+    NVIC_EnableIRQ(SPI0_IRQn);
 }
 
-void GPIO_Init(void)
+/**
+  * @brief      Arm a response to be clocked out by the master in its next read transaction.
+  * @param[in]  pu8Rsp Response packet. Must be 4-byte aligned.
+  * @param[in]  u32Len Response length in bytes, up to SPI_ISP_RSP_SIZE.
+  * @return     None
+  * @details    Idle words already queued in TX FIFO are dropped so the header is the next word the
+  *             master reads. The remaining words are fed from the TX threshold interrupt.
+  *             SPI0_IRQn is masked until the response is armed, as the ISR refills TX FIFO on every
+  *             interrupt and must not queue words between the clear and the arming.
+  */
+void SPI_SetResponse(uint8_t *pu8Rsp, uint32_t u32Len)
 {
-    /* Enable PC.0 interrupt by falling edge trigger */
-    PC->IMD |= (GPIO_IMD_EDGE << 0);
-    PC->IEN |= (BIT0 << GPIO_IEN_IF_EN_Pos);
-    NVIC_EnableIRQ(GPCDEF_IRQn);
+    uint32_t i, u32Words = (u32Len + 3) / 4;
+
+    NVIC_DisableIRQ(SPI0_IRQn);
+
+    s_au32TxBuf[0] = SPI_ISP_FRAME_HDR(u32Len);
+    for(i = 0; i < u32Words; i++)
+        s_au32TxBuf[1 + i] = ((uint32_t *)pu8Rsp)[i];
+
+    SPI0->FIFO_CTL |= SPI_FIFO_CTL_TX_CLR_Msk;
+    s_u32TxCount = 0;
+    s_u32TxLen = 1 + u32Words;
+
+    NVIC_EnableIRQ(SPI0_IRQn);
+}
+
+static uint32_t SPI_RecvFrame(uint8_t **ppu8Frame)
+{
+    if(bSpiDataReady == 0)
+        return 0;
+
+    /* Parsed in place, spi_rcvbuf is not touched until bSpiDataReady is cleared */
+    *ppu8Frame = (uint8_t *)spi_rcvbuf;
+    return g_u32SpiFrameLen;
+}
+
+static void SPI_SendFrame(uint8_t *pu8Rsp, uint32_t u32Len)
+{
+    SPI_SetResponse(pu8Rsp, u32Len);
+    bSpiDataReady = 0;
 }
 
 /*---------------------------------------------------------------------------------------------------------*/
-/*  GPCDEF IRQ Handler                                                                                     */
+/*  SPI0 IRQ Handler                                                                                       */
 /*---------------------------------------------------------------------------------------------------------*/
-void GPCDEF_IRQHandler(void)
+void SPI0_IRQHandler(void)
 {
-    uint32_t *_response_buff;
-    _response_buff = (uint32_t *)response_buff; // in isp_user.c
+    uint32_t u32Data, u32Len;
 
-    if(GPIO_GET_INT_FLAG(PC, BIT0))
+    /* Drain RX FIFO. Serves both the RX threshold and the RX time-out interrupt. */
+    while((SPI0->STATUS & SPI_STATUS_RX_EMPTY_Msk) == 0)
     {
-        GPIO_CLR_INT_FLAG(PC, BIT0);
-        SPI0->FIFO_CTL |= (SPI_FIFO_CTL_RX_CLR_Msk | SPI_FIFO_CTL_TX_CLR_Msk);
-        g_u32TxDataCount = 0;
-        g_u32RxDataCount = 0;
+        u32Data = SPI0->RX;
 
-        // Active
-        while(PC0 == 0)
+        if(s_u32RxExpect == 0)
         {
-            /* Check TX FULL flag and TX data count */
-            if((SPI_GET_TX_FIFO_FULL_FLAG(SPI0) == 0) && (g_u32TxDataCount < TEST_COUNT))
-            {
-                SPI_WRITE_TX(SPI0, _response_buff[g_u32TxDataCount]);    /* Write to TX FIFO */
-                g_u32TxDataCount++;
-                /* Disable SysTick counter */
-                SysTick->CTRL = 0UL;
-                SysTick->LOAD = 1000 * CyclesPerUs;
-                SysTick->VAL   = (0x00);
-                SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
-            }
+            /* Hunting for a frame header. Idle words sent while the master reads a response are skipped here,
+               as is anything arriving before the previous frame has been parsed. */
+            u32Len = u32Data & 0xFFFF;
 
-            /* Check RX EMPTY flag */
-            if(SPI_GET_RX_FIFO_EMPTY_FLAG(SPI0) == 0)
+            if(!bSpiDataReady && ((u32Data >> 16) == (~u32Data & 0xFFFF)) &&
+                    (u32Len >= 8) && (u32Len <= SPI_ISP_MAX_FRAME))
             {
-                g_u32RxDataCount &= 0x0F;
-                spi_rcvbuf[g_u32RxDataCount++] = SPI_READ_RX(SPI0);    /* Read RX FIFO */
-            }
-
-            if(SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk)
-            {
-                /* Disable SysTick counter */
-                SysTick->CTRL = 0UL;
-                break;
+                g_u32SpiFrameLen = u32Len;
+                s_u32RxExpect = (u32Len + 3) / 4;
+                s_u32RxCount = 0;
             }
         }
-
-        if(PC0 == 1)
+        else
         {
-            if((g_u32RxDataCount == 16) && ((spi_rcvbuf[0] & 0xFFFFFF00) == 0x53504900))
+            spi_rcvbuf[s_u32RxCount++] = u32Data;
+
+            if(s_u32RxCount == s_u32RxExpect)
             {
+                s_u32RxExpect = 0;
                 bSpiDataReady = 1;
             }
+        }
+    }
 
-            spi_rcvbuf[0] &= 0x000000FF;
-            g_u32TxDataCount = 0;
-            g_u32RxDataCount = 0;
+    if(SPI0->STATUS & SPI_STATUS_TIMEOUT_Msk)
+        SPI0->STATUS = SPI_STATUS_TIMEOUT_Msk;
 
-            if(SPI_GET_TX_FIFO_FULL_FLAG(SPI0) == 0)
-            {
-                SPI_WRITE_TX(SPI0, 0xFFFFFFFF);    /* Write to TX FIFO */
-            }
-        }
+    if(SPI0->STATUS & SPI_STATUS_RX_OVERRUN_Msk)
+    {
+        /* Frame is corrupted, resynchronize on the next header */
+        SPI0->STATUS = SPI_STATUS_RX_OVERRUN_Msk;
+        s_u32RxExpect = 0;
     }
-    else
+
+    /* Refill TX FIFO with the armed response, or with idle words to prevent TX under run */
+    while((SPI0->STATUS & SPI_STATUS_TX_FULL_Msk) == 0)
     {
+        if(s_u32TxCount < s_u32TxLen)
+        {
+            SPI0->TX = s_au32TxBuf[s_u32TxCount++];
+        }
+        else
+        {
+            s_u32TxLen = 0;
+            SPI0->TX = 0xFFFFFFFF;
+        }
     }
 }
 
@@ -9,13 +9,27 @@
 #ifndef __SPI_TRANS_H__
 #define __SPI_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
+
+/*
+ * Frame format on the wire (32-bit words, MSB first):
+ *   word 0     : header, [15:0] = payload length in bytes, [31:16] = ~length
+ *   word 1..n  : payload, ISP packet (command, packet number, data), little-endian bytes
+ * Any word that is not a valid header is ignored while the slave waits for a frame, so the master
+ * reads a response by clocking idle words (0xFFFFFFFF) until it sees the response header.
+ */
+#define SPI_ISP_FRAME_HDR(len)  ((((~(uint32_t)(len)) & 0xFFFF) << 16) | ((uint32_t)(len) & 0xFFFF))
+#define SPI_ISP_MAX_FRAME       (FMC_FLASH_PAGE_SIZE + 16)  /* Command, packet number, address, length and one flash page */
+#define SPI_ISP_RSP_SIZE        64
 
 extern volatile uint8_t bSpiDataReady;
+extern volatile uint32_t g_u32SpiFrameLen;
 extern uint32_t spi_rcvbuf[];
+extern const ISP_XFER_T g_sSpiXfer;
 
 /*-------------------------------------------------------------*/
 void SPI_Init(void);
-void GPIO_Init(void);
+void SPI_SetResponse(uint8_t *pu8Rsp, uint32_t u32Len);
 
 #endif  /* __SPI_TRANS_H__ */
 
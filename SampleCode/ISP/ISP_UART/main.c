@@ -12,7 +12,7 @@
  * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
  ******************************************************************************/
 #include <stdio.h>
-#include "ISP_USER.h"
+#include "targetdev.h"
 #include "uart_transfer.h"
 
 #define PLLCON_SETTING  CLK_PLLCON_50MHz_HIRC
@@ -112,16 +112,8 @@ int main(void)
     while (1) {
         
         /* Wait for CMD_CONNECT command */ 
-        if ((bufhead >= 4) || (bUartDataReady == TRUE)) {
-            uint32_t lcmd;
-            lcmd = inpw(uart_rcvbuf);
-
-            if (lcmd == CMD_CONNECT) {
-                goto _ISP;
-            } else {
-                bUartDataReady = FALSE;
-                bufhead = 0;
-            }
+        if (UART_IS_CONNECT()) {
+            goto _ISP;
         }
 
         /* Systick time-out, then go to APROM */
@@ -134,15 +126,7 @@ int main(void)
 _ISP:
 
     /* Prase command from master and send response back */    
-    while (1) {
-        if (bUartDataReady == TRUE) {
-            WDT->WTCR &= ~(WDT_WTCR_WTE_Msk | WDT_WTCR_DBGACK_WDT_Msk);
-            WDT->WTCR |= (WDT_TIMEOUT_2POW18 | WDT_WTCR_WTR_Msk);
-            bUartDataReady = FALSE;
-            ParseCmd(uart_rcvbuf, 64);
-            PutString();
-        }
-    }
+    ISP_Run(&g_sUartXfer);
 
 _APROM:
     
@@ -15,14 +15,21 @@
 
 #ifdef __ICCARM__
 #pragma data_alignment=4
-uint8_t  uart_rcvbuf[MAX_PKT_SIZE] = {0};
+uint8_t  uart_rcvbuf[MAX_PKT_DEPTH][MAX_PKT_SIZE] = {0};
 #else
-__attribute__((aligned(4))) uint8_t  uart_rcvbuf[MAX_PKT_SIZE] = {0};
+__attribute__((aligned(4))) uint8_t  uart_rcvbuf[MAX_PKT_DEPTH][MAX_PKT_SIZE] = {0};
 #endif
 
-uint8_t volatile bUartDataReady = 0;
 uint8_t volatile bufhead = 0;
 
+static uint8_t volatile rx_head = 0;     /* Packet being received */
+static uint8_t volatile rx_tail = 0;     /* Oldest complete packet */
+static uint8_t volatile rx_count = 0;    /* Complete packets not handed back yet */
+
+static uint32_t UART_RecvFrame(uint8_t **ppu8Frame);
+static void UART_SendFrame(uint8_t *pu8Rsp, uint32_t u32Len);
+
+const ISP_XFER_T g_sUartXfer = {UART_RecvFrame, UART_SendFrame, MAX_PKT_SIZE, MAX_PKT_DEPTH};
 
 /* please check "targetdev.h" for chip specifc define option */
 
@@ -37,33 +44,76 @@ void UART_T_IRQHandler(void)
     /* RDA FIFO interrupt and RDA timeout interrupt */
     if (u32IntSrc & (UART_ISR_RDA_IF_Msk|UART_ISR_TOUT_IF_Msk)) {
         /* Read data until RX FIFO is empty or data is over maximum packet size */
-        while (((UART_T->FSR & UART_FSR_RX_EMPTY_Msk) == 0) && (bufhead < MAX_PKT_SIZE)) {	//RX fifo not empty
-            uart_rcvbuf[bufhead++] = UART_T->RBR;
+        while ((UART_T->FSR & UART_FSR_RX_EMPTY_Msk) == 0) {	//RX fifo not empty
+            if (rx_count == MAX_PKT_DEPTH) {
+                /* Host sent more packets than announced by CMD_GET_XFER_INFO, drop them */
+                (void)UART_T->RBR;
+                continue;
+            }
+
+            uart_rcvbuf[rx_head][bufhead++] = UART_T->RBR;
+
+            if (bufhead == MAX_PKT_SIZE) {
+                bufhead = 0;
+                rx_head = (rx_head + 1) % MAX_PKT_DEPTH;
+                rx_count++;
+            }
         }
     }
 
     /* Reset data buffer index */
-    if (bufhead == MAX_PKT_SIZE) {
-        bUartDataReady = TRUE;
+    if (u32IntSrc & UART_ISR_TOUT_IF_Msk) {
         bufhead = 0;
-    } else if (u32IntSrc & UART_ISR_TOUT_IF_Msk) {
+    }
+}
+
+/* CMD_CONNECT received. Anything else received before it is dropped. */
+uint32_t UART_IS_CONNECT(void)
+{
+    if ((bufhead >= 4) || (rx_count != 0)) {
+        if (inpw(uart_rcvbuf[0]) == CMD_CONNECT) {
+            return 1;
+        }
+
+        NVIC_DisableIRQ(UART_T_IRQn);
         bufhead = 0;
+        rx_head = 0;
+        rx_tail = 0;
+        rx_count = 0;
+        NVIC_EnableIRQ(UART_T_IRQn);
     }
+
+    return 0;
 }
 
-extern __attribute__((aligned(4))) uint8_t response_buff[64];
-void PutString(void)
+static uint32_t UART_RecvFrame(uint8_t **ppu8Frame)
+{
+    if (rx_count == 0) {
+        return 0;
+    }
+
+    *ppu8Frame = uart_rcvbuf[rx_tail];
+    return MAX_PKT_SIZE;
+}
+
+static void UART_SendFrame(uint8_t *pu8Rsp, uint32_t u32Len)
 {
     uint32_t i;
 
+    /* Packet is parsed, its buffer takes the next packet */
+    rx_tail = (rx_tail + 1) % MAX_PKT_DEPTH;
+    NVIC_DisableIRQ(UART_T_IRQn);
+    rx_count--;
+    NVIC_EnableIRQ(UART_T_IRQn);
+
     /* UART send response to master */
-    for (i = 0; i < MAX_PKT_SIZE; i++) {
-        
+    for (i = 0; i < u32Len; i++) {
+
         /* Wait for TX not full */
         while ((UART_T->FSR & UART_FSR_TX_FULL_Msk));
 
         /* UART send data */
-        UART_T->THR = response_buff[i];
+        UART_T->THR = pu8Rsp[i];
     }
 }
 
@@ -10,21 +10,23 @@
 #ifndef __UART_TRANS_H__
 #define __UART_TRANS_H__
 #include <stdint.h>
+#include "isp_user.h"
 
 /*-------------------------------------------------------------*/
 /* Define maximum packet size */
-#define MAX_PKT_SIZE        	64
+#define MAX_PKT_SIZE        	ISP_PKT_SIZE
+
+/* Packets buffered. The host may send the next packet while one is programmed. */
+#define MAX_PKT_DEPTH       	2
 
 /*-------------------------------------------------------------*/
 
-extern uint8_t  uart_rcvbuf[];
-extern uint8_t volatile bUartDataReady;
+extern uint8_t  uart_rcvbuf[MAX_PKT_DEPTH][MAX_PKT_SIZE];
 extern uint8_t volatile bufhead;
+extern const ISP_XFER_T g_sUartXfer;
 
 /*-------------------------------------------------------------*/
 void UART_Init(void);
-void UART0_IRQHandler(void);
-void PutString(void);
 uint32_t UART_IS_CONNECT(void);
 
 #endif  /* __UART_TRANS_H__ */
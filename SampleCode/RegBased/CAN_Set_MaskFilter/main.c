@@ -192,7 +192,7 @@ void CAN0_IRQHandler(void)
             printf("Receive error!\n") ;
         }
     }
-    else if((u8IIDRstatus >= 0x1) || (u8IIDRstatus <= 0x20))
+    else if((u8IIDRstatus >= 0x1) && (u8IIDRstatus <= 0x20))
     {
         MsgInterrupt(CAN0, u8IIDRstatus);
 
@@ -19,54 +19,42 @@ extern uint32_t CAN_GetCANBitRate(CAN_T *tCAN);
 extern void CAN_EnterTestMode(CAN_T *tCAN, uint8_t u8TestMask);
 
 /*---------------------------------------------------------------------------------------------------------*/
-/* CAN0 interrupt handler                                                                                  */
+/* Status change and error interrupt, called by CAN_IRQDispatch()                                          */
 /*---------------------------------------------------------------------------------------------------------*/
-void CAN0_IRQHandler(void)
+void CAN_StatusInterrupt(CAN_T *tCAN, uint32_t u32Status, void *pvArg)
 {
-    uint32_t u8IIDRstatus;
+    /* RxOK and TxOK are already cleared by CAN_IRQDispatch() */
 
-    u8IIDRstatus = CAN0->IIDR;
-
-    if(u8IIDRstatus == 0x00008000)        /* Check Status Interrupt Flag (Error status Int and Status change Int) */
+    /**************************/
+    /* Error Status interrupt */
+    /**************************/
+    if(u32Status & CAN_STATUS_BOFF_Msk)
+    {
+        printf("BOFF INT\n") ;
+    }
+    else if(u32Status & CAN_STATUS_EWARN_Msk)
+    {
+        printf("EWARN INT\n") ;
+    }
+    else if((tCAN->ERR & CAN_ERR_TEC_Msk) != 0)
     {
-        /**************************/
-        /* Status Change interrupt*/
-        /**************************/
-        if(CAN0->STATUS & CAN_STATUS_RXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_RXOK_Msk;   /* Clear RxOK status*/
-        }
-
-        if(CAN0->STATUS & CAN_STATUS_TXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_TXOK_Msk;    /* Clear TxOK status*/
-        }
-
-        /**************************/
-        /* Error Status interrupt */
-        /**************************/
-        if(CAN0->STATUS & CAN_STATUS_BOFF_Msk)
-        {
-            printf("BOFF INT\n") ;
-        }
-        else if(CAN0->STATUS & CAN_STATUS_EWARN_Msk)
-        {
-            printf("EWARN INT\n") ;
-        }
-        else if((CAN0->ERR & CAN_ERR_TEC_Msk) != 0)
-        {
-            printf("Transmit error!\n") ;
-        }
-        else if((CAN0->ERR & CAN_ERR_REC_Msk) != 0)
-        {
-            printf("Receive error!\n") ;
-        }
+        printf("Transmit error!\n") ;
     }
-    else if((u8IIDRstatus >= 0x1) || (u8IIDRstatus <= 0x20))
+    else if((tCAN->ERR & CAN_ERR_REC_Msk) != 0)
     {
-        CAN_CLR_INT_PENDING_BIT(CAN0, (u8IIDRstatus - 1)); /* Clear Interrupt Pending */
+        printf("Receive error!\n") ;
     }
-    else if(CAN0->WU_STATUS == 1)
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* CAN0 interrupt handler                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+void CAN0_IRQHandler(void)
+{
+    /* Service the status and every pending message object in one entry */
+    CAN_IRQDispatch(CAN0);
+
+    if(CAN0->WU_STATUS == 1)
     {
         printf("Wake up\n");
 
@@ -165,6 +153,9 @@ void CAN_SilentMode_Init(CAN_T *tCAN)
     CAN_EnterTestMode(tCAN, CAN_TEST_BASIC_Msk | CAN_TEST_SILENT_Msk);
 
     /* Enable CAN interrupt */
+    /* Install CAN call back functions */
+    CAN_InstallStatusHandler(tCAN, CAN_StatusInterrupt, NULL);
+
     CAN_EnableInt(tCAN, CAN_CON_IE_Msk | CAN_CON_SIE_Msk);
 
     /* Set Interrupt Priority */
@@ -32,61 +32,47 @@ void CAN_ShowMsg(STR_CANMSG_T* Msg);
 STR_CANMSG_T rrMsg;
 
 /*---------------------------------------------------------------------------------------------------------*/
-/* CAN0 interrupt handler                                                                                  */
+/* Status change and error interrupt, called by CAN_IRQDispatch()                                          */
 /*---------------------------------------------------------------------------------------------------------*/
-void CAN0_IRQHandler(void)
+void CAN_StatusInterrupt(CAN_T *tCAN, uint32_t u32Status, void *pvArg)
 {
-    uint32_t u8IIDRstatus;
-
-    u8IIDRstatus = CAN0->IIDR;
+    /* RxOK and TxOK are already cleared by CAN_IRQDispatch() */
 
-    if(u8IIDRstatus == 0x00008000)        /* Check Status Interrupt Flag (Error status Int and Status change Int) */
+    /**************************/
+    /* Error Status interrupt */
+    /**************************/
+    if(u32Status & CAN_STATUS_BOFF_Msk)
     {
-        /**************************/
-        /* Status Change interrupt*/
-        /**************************/
-        if(CAN0->STATUS & CAN_STATUS_RXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_RXOK_Msk;   /* Clear RxOK status*/
-        }
-
-        if(CAN0->STATUS & CAN_STATUS_TXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_TXOK_Msk;    /* Clear TxOK status*/
-        }
-
-        /**************************/
-        /* Error Status interrupt */
-        /**************************/
-        if(CAN0->STATUS & CAN_STATUS_BOFF_Msk)
-        {
-            printf("BOFF INT\n") ;
-        }
-        else if(CAN0->STATUS & CAN_STATUS_EWARN_Msk)
-        {
-            printf("EWARN INT\n") ;
-        }
-        else if((CAN0->ERR & CAN_ERR_TEC_Msk) != 0)
-        {
-            printf("Transmit error!\n") ;
-        }
-        else if((CAN0->ERR & CAN_ERR_REC_Msk) != 0)
-        {
-            printf("Receive error!\n") ;
-        }
-
+        printf("BOFF INT\n") ;
     }
-    else if((u8IIDRstatus >= 0x1) || (u8IIDRstatus <= 0x20))
+    else if(u32Status & CAN_STATUS_EWARN_Msk)
     {
-        CAN_CLR_INT_PENDING_BIT(CAN0, (u8IIDRstatus - 1)); /* Clear Interrupt Pending */
+        printf("EWARN INT\n") ;
     }
-    else if(CAN0->WU_STATUS == 1)
+    else if((tCAN->ERR & CAN_ERR_TEC_Msk) != 0)
+    {
+        printf("Transmit error!\n") ;
+    }
+    else if((tCAN->ERR & CAN_ERR_REC_Msk) != 0)
+    {
+        printf("Receive error!\n") ;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* CAN0 interrupt handler                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+void CAN0_IRQHandler(void)
+{
+    /* Service the status and every pending message object in one entry */
+    CAN_IRQDispatch(CAN0);
+
+    if(CAN0->WU_STATUS == 1)
     {
         printf("Wake up\n");
 
         CAN0->WU_STATUS = 0;    /* Write '0' to clear */
     }
-
 }
 
 /*---------------------------------------------------------------------------------------------------------*/
@@ -340,8 +326,11 @@ void Test_NormalMode_Tx(CAN_T *tCAN)
 {
     STR_CANMSG_T tMsg;
 
+    /* Install CAN call back functions */
+    CAN_InstallStatusHandler(tCAN, CAN_StatusInterrupt, NULL);
+
     CAN_EnableInt(tCAN, CAN_CON_IE_Msk | CAN_CON_SIE_Msk);      /* Enable CAN interrupt and corresponding NVIC of CAN */
-    NVIC_SetPriority(CAN0_IRQn, (1 << __NVIC_PRIO_BITS) - 2);   /* Install CAN call back functions */
+    NVIC_SetPriority(CAN0_IRQn, (1 << __NVIC_PRIO_BITS) - 2);
     NVIC_EnableIRQ(CAN0_IRQn);
     printf("Use Message Object No.0 to send STD_ID:0x7FF, Data[07,FF]\n");
     printf("Use Message Object No.1 to send EXT_ID:0x12345, Data[01,23,45]\n");
@@ -31,79 +31,50 @@ STR_CANMSG_T rrMsg;
 /*---------------------------------------------------------------------------------------------------------*/
 /* ISR to handle CAN interrupt event                                                                       */
 /*---------------------------------------------------------------------------------------------------------*/
-void CAN_MsgInterrupt(CAN_T *tCAN, uint32_t u32IIDR)
+void CAN_MsgInterrupt(CAN_T *tCAN, uint32_t u32MsgNum, void *pvArg)
 {
-    if(u32IIDR == 1)
-    {
-        printf("Msg-0 INT and Callback\n");
-        CAN_Receive(tCAN, 0, &rrMsg);
-        CAN_ShowMsg(&rrMsg);
-    }
-    if(u32IIDR == 5 + 1)
-    {
-        printf("Msg-5 INT and Callback \n");
-        CAN_Receive(tCAN, 5, &rrMsg);
-        CAN_ShowMsg(&rrMsg);
-    }
-    if(u32IIDR == 31 + 1)
-    {
-        printf("Msg-31 INT and Callback \n");
-        CAN_Receive(tCAN, 31, &rrMsg);
-        CAN_ShowMsg(&rrMsg);
+    printf("Msg-%d INT and Callback\n", u32MsgNum);
+    CAN_Receive(tCAN, u32MsgNum, &rrMsg);
+    CAN_ShowMsg(&rrMsg);
+    if(u32MsgNum == 31)
         printf("Enter any key to exit\n");
-    }
 }
 
 /*---------------------------------------------------------------------------------------------------------*/
-/* CAN0 interrupt handler                                                                                  */
+/* Status change and error interrupt, called by CAN_IRQDispatch()                                          */
 /*---------------------------------------------------------------------------------------------------------*/
-void CAN0_IRQHandler(void)
+void CAN_StatusInterrupt(CAN_T *tCAN, uint32_t u32Status, void *pvArg)
 {
-    uint32_t u8IIDRstatus;
+    /* RxOK and TxOK are already cleared by CAN_IRQDispatch() */
 
-    u8IIDRstatus = CAN0->IIDR;
-
-    if(u8IIDRstatus == 0x00008000)        /* Check Status Interrupt Flag (Error status Int and Status change Int) */
+    /**************************/
+    /* Error Status interrupt */
+    /**************************/
+    if(u32Status & CAN_STATUS_BOFF_Msk)
     {
-        /**************************/
-        /* Status Change interrupt*/
-        /**************************/
-        if(CAN0->STATUS & CAN_STATUS_RXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_RXOK_Msk;   /* Clear RxOK status*/
-        }
-
-        if(CAN0->STATUS & CAN_STATUS_TXOK_Msk)
-        {
-            CAN0->STATUS &= ~CAN_STATUS_TXOK_Msk;    /* Clear TxOK status*/
-        }
-
-        /**************************/
-        /* Error Status interrupt */
-        /**************************/
-        if(CAN0->STATUS & CAN_STATUS_BOFF_Msk)
-        {
-            printf("BOFF INT\n") ;
-        }
-        else if(CAN0->STATUS & CAN_STATUS_EWARN_Msk)
-        {
-            printf("EWARN INT\n") ;
-        }
-//        else if((CAN0->ERR & CAN_ERR_TEC_Msk) != 0)
-//        {
-//            printf("Transmit error!\n") ;
-//        }
-//        else if((CAN0->ERR & CAN_ERR_REC_Msk) != 0)
-//        {
-//            printf("Receive error!\n") ;
-//        }
+        printf("BOFF INT\n") ;
     }
-    else if((u8IIDRstatus >= 0x1) || (u8IIDRstatus <= 0x20))
+    else if(u32Status & CAN_STATUS_EWARN_Msk)
     {
-        CAN_MsgInterrupt(CAN0, u8IIDRstatus);
-
-        CAN_CLR_INT_PENDING_BIT(CAN0, (u8IIDRstatus - 1)); /* Clear Interrupt Pending */
+        printf("EWARN INT\n") ;
     }
+//    else if((tCAN->ERR & CAN_ERR_TEC_Msk) != 0)
+//    {
+//        printf("Transmit error!\n") ;
+//    }
+//    else if((tCAN->ERR & CAN_ERR_REC_Msk) != 0)
+//    {
+//        printf("Receive error!\n") ;
+//    }
+}
+
+/*---------------------------------------------------------------------------------------------------------*/
+/* CAN0 interrupt handler                                                                                  */
+/*---------------------------------------------------------------------------------------------------------*/
+void CAN0_IRQHandler(void)
+{
+    /* Service the status and every pending message object in one entry */
+    CAN_IRQDispatch(CAN0);
 
     if(CAN0->WU_STATUS == 1)
     {
@@ -111,7 +82,6 @@ void CAN0_IRQHandler(void)
 
         CAN0->WU_STATUS = 0;    /* Write '0' to clear */
     }
-
 }
 
 /*---------------------------------------------------------------------------------------------------------*/
@@ -363,6 +333,12 @@ void TestItem(void)
 /*----------------------------------------------------------------------------*/
 void WakeupTest(CAN_T *tCAN)
 {
+    /* Install CAN call back functions */
+    CAN_InstallStatusHandler(tCAN, CAN_StatusInterrupt, NULL);
+    CAN_InstallMsgHandler(tCAN, MSG(0), CAN_MsgInterrupt, NULL);
+    CAN_InstallMsgHandler(tCAN, MSG(5), CAN_MsgInterrupt, NULL);
+    CAN_InstallMsgHandler(tCAN, MSG(31), CAN_MsgInterrupt, NULL);
+
     /* Enable CAN interrupt and corresponding NVIC of CAN */
     CAN_EnableInt(tCAN, CAN_CON_IE_Msk | CAN_CON_SIE_Msk);
     NVIC_EnableIRQ(CAN0_IRQn);
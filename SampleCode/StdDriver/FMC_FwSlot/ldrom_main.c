@@ -0,0 +1,81 @@
+/**************************************************************************//**
+ * @file     ldrom_main.c
+ * @version  V3.00
+ * @brief    LDROM boot selector of the A/B firmware slot manager for NUC1311 series MCU
+ *
+ * @note     Boot from LDROM (CONFIG0 CBS) so that every reset passes through FWSLOT_Boot(). An image on
+ *           trial boots with the watchdog enabled: it keeps clearing it with WDT_RESET_COUNTER() until it
+ *           calls FWSLOT_Confirm(), so an image that hangs comes back here and uses up its trial boots.
+ * @copyright SPDX-License-Identifier: Apache-2.0
+ * @copyright Copyright (C) 2014 Nuvoton Technology Corp. All rights reserved.
+*****************************************************************************/
+#include <stdio.h>
+#include "NUC1311.h"
+#include "fwslot.h"
+
+
+void ProcessHardFault(void){}
+
+void SYS_Init(void)
+{
+    /*---------------------------------------------------------------------------------------------------------*/
+    /* Init System Clock                                                                                       */
+    /*---------------------------------------------------------------------------------------------------------*/
+
+    /* Enable Internal RC 22.1184MHz clock */
+    CLK_EnableXtalRC(CLK_PWRCON_OSC22M_EN_Msk);
+
+    /* Waiting for Internal RC clock ready */
+    CLK_WaitClockReady(CLK_CLKSTATUS_OSC22M_STB_Msk);
+
+    /* Switch HCLK clock source to Internal RC and HCLK source divide 1 */
+    CLK_SetHCLK(CLK_CLKSEL0_HCLK_S_HIRC, CLK_CLKDIV_HCLK(1));
+}
+
+void WDT_Init(void)
+{
+    /* Enable Internal RC 10KHz clock */
+    CLK_EnableXtalRC(CLK_PWRCON_OSC10K_EN_Msk);
+
+    /* Waiting for Internal RC clock ready */
+    CLK_WaitClockReady(CLK_CLKSTATUS_OSC10K_STB_Msk);
+
+    /* Enable WDT module clock and select LIRC as WDT clock source */
+    CLK_EnableModuleClock(WDT_MODULE);
+    CLK_SetModuleClock(WDT_MODULE, CLK_CLKSEL1_WDT_S_LIRC, 0);
+
+    /* Reset after 2^18 LIRC clocks, around 26 seconds, without a WDT_RESET_COUNTER() */
+    WDT_Open(WDT_TIMEOUT_2POW18, WDT_RESET_DELAY_1026CLK, TRUE, FALSE);
+}
+
+
+int main()
+{
+    FWSLOT_REC_T sRec;
+
+    /* Unlock protected register */
+    SYS_UnlockReg();
+
+    SYS_Init();
+
+    /* Enable FMC ISP function, the boot record is updated in data flash */
+    FMC_Open();
+
+    /* The image on trial gets the watchdog */
+    FWSLOT_ReadRecord(&sRec);
+    if(sRec.u8State == FWSLOT_STATE_TRIAL)
+        WDT_Init();
+
+    /* Change VECMAP to the selected slot and reset, does not return if a slot is valid */
+    FWSLOT_Boot();
+
+    /* Neither slot holds a valid image: stay in LDROM, a recovery loader would go here */
+    FMC_Close();
+
+    /* Lock protected Register */
+    SYS_LockReg();
+
+    while(1);
+}
+
+/*** (C) COPYRIGHT 2014 Nuvoton Technology Corp. ***/
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# Delta patch generator for the NUC1311 in-place delta update (Library/StdDriver/src/delta.c).
+#
+#   python3 delta_gen.py old.bin new.bin patch.dlt
+#
+# The patch is checked by applying it to old.bin page by page the way DELTA_Feed() does before it is
+# written. SPDX-License-Identifier: Apache-2.0
+
+import struct
+import sys
+import zlib
+
+PAGE_SIZE = 512
+MAGIC = 0x31544C44          # "DLT1"
+OP_COPY = 0x80
+OP_LEN_EXT = 0x7F
+MIN_MATCH = 8               # A COPY op costs 4 to 6 bytes
+MAX_LEN = 0xFFFF
+MAX_CANDIDATES = 64
+
+
+def page_base(offset):
+    return offset & ~(PAGE_SIZE - 1)
+
+
+def encode_op(op, length):
+    if length <= OP_LEN_EXT:
+        return bytes([op | (length - 1)])
+    return bytes([op | OP_LEN_EXT]) + struct.pack('<H', length)
+
+
+def match_length(old, new, src, dst):
+    # A source byte must not lie below the page its destination byte is assembled in
+    length = 0
+    while (dst + length < len(new) and src + length < len(old) and length < MAX_LEN and
+           old[src + length] == new[dst + length] and src + length >= page_base(dst + length)):
+        length += 1
+    return length
+
+
+def make_patch(old, new):
+    index = {}
+    for offset in range(len(old) - MIN_MATCH + 1):
+        index.setdefault(old[offset:offset + MIN_MATCH], []).append(offset)
+
+    out = bytearray(struct.pack('<5I', MAGIC, len(old), zlib.crc32(old), len(new), zlib.crc32(new)))
+    literal = bytearray()
+
+    def flush():
+        for start in range(0, len(literal), MAX_LEN):
+            chunk = literal[start:start + MAX_LEN]
+            out.extend(encode_op(0, len(chunk)) + chunk)
+        literal.clear()
+
+    dst = 0
+    while dst < len(new):
+        candidates = [dst] if dst < len(old) else []
+        candidates += [src for src in index.get(new[dst:dst + MIN_MATCH], [])
+                       if src >= page_base(dst)][-MAX_CANDIDATES:]
+
+        best_len, best_src = 0, 0
+        for src in candidates:
+            length = match_length(old, new, src, dst)
+            if length > best_len:
+                best_len, best_src = length, src
+
+        if best_len >= MIN_MATCH:
+            flush()
+            out.extend(encode_op(OP_COPY, best_len) + struct.pack('<I', best_src)[:3])
+            dst += best_len
+        else:
+            literal.append(new[dst])
+            dst += 1
+
+    flush()
+    return bytes(out)
+
+
+def apply_patch(old, patch):
+    magic, old_size, old_crc, new_size, new_crc = struct.unpack_from('<5I', patch)
+    if magic != MAGIC or old_size != len(old) or old_crc != zlib.crc32(old):
+        raise ValueError('patch does not match the old image')
+
+    flash = bytearray(old) + b'\xff' * (page_base(max(len(old), new_size) + PAGE_SIZE - 1) - len(old))
+    page = bytearray(b'\xff' * PAGE_SIZE)
+    pos, dst = 20, 0
+
+    def put(value):
+        nonlocal dst
+        page[dst % PAGE_SIZE] = value
+        dst += 1
+        if dst % PAGE_SIZE == 0 or dst == new_size:
+            fill = dst % PAGE_SIZE
+            if fill:
+                page[fill:] = b'\xff' * (PAGE_SIZE - fill)
+            flash[page_base(dst - 1):page_base(dst - 1) + PAGE_SIZE] = page
+
+    while dst < new_size:
+        op = patch[pos]
+        pos += 1
+        length = op & OP_LEN_EXT
+        if length == OP_LEN_EXT:
+            length = struct.unpack_from('<H', patch, pos)[0]
+            pos += 2
+        else:
+            length += 1
+        if op & OP_COPY:
+            src = struct.unpack('<I', patch[pos:pos + 3] + b'\0')[0]
+            pos += 3
+            for _ in range(length):
+                if src < page_base(dst):
+                    raise ValueError('COPY source overwritten at 0x%x' % dst)
+                put(flash[src])
+                src += 1
+        else:
+            for value in patch[pos:pos + length]:
+                put(value)
+            pos += length
+
+    return bytes(flash[:new_size])
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.stderr.write('usage: %s old.bin new.bin patch.dlt\n' % argv[0])
+        return 2
+
+    with open(argv[1], 'rb') as f:
+        old = f.read()
+    with open(argv[2], 'rb') as f:
+        new = f.read()
+
+    patch = make_patch(old, new)
+    if apply_patch(old, patch) != new:
+        sys.stderr.write('internal error: patch does not reproduce the new image\n')
+        return 1
+
+    with open(argv[3], 'wb') as f:
+        f.write(patch)
+
+    print('%s: %d bytes, %.1f%% of the new image' % (argv[3], len(patch), 100.0 * len(patch) / max(len(new), 1)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+# LZ compressor for the compressed ISP update (CMD_UPDATE_APROM_LZ, Library/StdDriver/src/lzdec.c).
+#
+#   python3 lz_pack.py image.bin image.lz
+#
+# The stream is decoded again and compared with the image before it is written. The ISP takes the size of
+# image.bin as the total length of the update. SPDX-License-Identifier: Apache-2.0
+
+import struct
+import sys
+
+WINDOW_SIZE = 1024
+MIN_MATCH = 3
+MAX_MATCH = 66
+MAX_CANDIDATES = 256
+
+
+def compress(data):
+    index = {}
+    out = bytearray()
+    flags_at, flags_bit = 0, 8
+    pos = 0
+
+    def token(is_literal):
+        nonlocal flags_at, flags_bit
+        if flags_bit == 8:
+            flags_at, flags_bit = len(out), 0
+            out.append(0)
+        if is_literal:
+            out[flags_at] |= 1 << flags_bit
+        flags_bit += 1
+
+    def insert(at):
+        if at + MIN_MATCH <= len(data):
+            index.setdefault(data[at:at + MIN_MATCH], []).append(at)
+
+    while pos < len(data):
+        best_len, best_dist = 0, 0
+        candidates = index.get(data[pos:pos + MIN_MATCH], [])
+        for src in reversed(candidates[-MAX_CANDIDATES:]):
+            if pos - src > WINDOW_SIZE:
+                break
+            length = 0
+            while length < MAX_MATCH and pos + length < len(data) and data[src + length] == data[pos + length]:
+                length += 1
+            if length > best_len:
+                best_len, best_dist = length, pos - src
+                if length == MAX_MATCH:
+                    break
+
+        if best_len >= MIN_MATCH:
+            token(False)
+            out.extend(struct.pack('<H', (best_dist - 1) | ((best_len - MIN_MATCH) << 10)))
+            for at in range(pos, pos + best_len):
+                insert(at)
+            pos += best_len
+        else:
+            token(True)
+            out.append(data[pos])
+            insert(pos)
+            pos += 1
+
+    return bytes(out)
+
+
+def decompress(stream, size):
+    out = bytearray()
+    pos, flags = 0, 1
+    while len(out) < size:
+        if flags == 1:
+            flags = stream[pos] | 0x100
+            pos += 1
+        is_literal = flags & 1
+        flags >>= 1
+        if is_literal:
+            out.append(stream[pos])
+            pos += 1
+        else:
+            value = struct.unpack_from('<H', stream, pos)[0]
+            pos += 2
+            dist, length = (value & 0x3FF) + 1, (value >> 10) + MIN_MATCH
+            if dist > len(out):
+                raise ValueError('match before the start of the stream')
+            for _ in range(length):
+                out.append(out[-dist])
+    return bytes(out[:size])
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('usage: %s image.bin image.lz\n' % argv[0])
+        return 2
+
+    with open(argv[1], 'rb') as f:
+        data = f.read()
+
+    stream = compress(data)
+    if decompress(stream, len(data)) != data:
+        sys.stderr.write('internal error: stream does not reproduce the image\n')
+        return 1
+
+    with open(argv[2], 'wb') as f:
+        f.write(stream)
+
+    print('%s: %d of %d bytes, %.1f%%' % (argv[2], len(stream), len(data), 100.0 * len(stream) / max(len(data), 1)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))